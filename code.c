@@ -22,6 +22,10 @@ Este método se basa en un tamaño de página, que dividirá la memoria principa
 Por otro lado, también se basa en dividir cada proceso en partes llamadas páginas, y asignarle una serie de marcos.
 Estas asignaciones, estarán almacenados en una tabla de mapa de paginas (PMT), que puede ser global para todos los procesos, o una por proceso.
 Para conocer cada proceso que subconjunto de valores le corresponden de la PMT, estos contienen un registro base y un registro límite de la misma. (RBTP y RLTP)
+También puede usarse una tabla de paginas invertida, con una entrada por marco en lugar de una por pagina, de modo que ocupa
+segun la memoria fisica y no segun el tamaño de los procesos. La pagina se busca con una tabla hash de (proceso, pagina).
+O una tabla multinivel por proceso, en la que el numero de pagina se parte en varios niveles y solo existen las tablas
+de las zonas usadas, para espacios de direcciones grandes y dispersos.
 
 
 
@@ -33,6 +37,13 @@ Los datos de cada particion (RB y RL, entre otros) se almacenan en una tabla de
 Para conocer que subconjunto de entradas de la SDT corresponde a cada proceso, estos contienen un registro base y un registro limite de la misma. (RBTS y RLTS)
 
 
+Las estructuras, la lectura del fichero de datos y la traduccion de direcciones estan en la biblioteca
+memmanager.c (ver memmanager.h), que otros programas pueden enlazar directamente; este fichero es la
+aplicacion de consola construida sobre ella. Se compilan juntos:
+
+	gcc -O2 -pthread -o code code.c memmanager.c -lm
+
+
 
 
 					**************************************
@@ -48,9 +59,10 @@ El formato sera el siguiente:
 3.- La tercera linea recibira los RBTS y RLTS de cada proceso. (idem a lo anterior)
 4.- la cuarta linea recibira los datos asociados a cada segmento de cada proceso. Tendremos tantas parejas de datos (RB y RL) como segmentos tengan los procesos que tengamos.
 5.- La quinta linea recibira el tamaño de pagina.
-6.- La sexta linea recibira el tipo de paginacion: 0 -> PMT global, 1 -> PMT por proceso
+6.- La sexta linea recibira el tipo de paginacion: 0 -> PMT global, 1 -> PMT por proceso, 2 -> tabla invertida, 3 -> multinivel
 7.- La septima linea recibira los RBTP y RLTP de cada proceso. (idem a lo anterior)
 8.- La octava linea recibira los datos asociados a cada pagina de cada proceso. Tendremos tantos datos como paginas tengan los procesos que tengamos, un dato por pagina.
+9.- La novena linea es opcional y recibira los marcos de las paginas de cada segmento, para la segmentacion paginada. Un segmento de limite L tiene L / tamaño + 1 paginas.
 
 ----------------------
 Ejemplo con PMT Global:
@@ -77,6 +89,31 @@ Ejemplo con PMT por Proceso:
 0 3 0 5																			// RBTP y RLTP por proceso
 0 1 3 7 0 2 4 7 -1 5															// Marcos de pagina asociados a cada pagina del proceso.
 
+Con la tabla invertida (tipo 2) las lineas 7 y 8 son como con PMT por proceso: la tabla se construye a partir de
+los marcos de cada pagina, y cada marco solo puede pertenecer a una pagina (aunque se use la opcion "-c"). No se
+puede usar con la paginacion bajo demanda ("-m"). En el modo por lotes se muestra la longitud de las cadenas del
+hash, las entradas comparadas por busqueda y la memoria de la tabla frente a la de la PMT equivalente.
+
+Con la tabla multinivel (tipo 3) la sexta linea lleva tambien los bits del numero de pagina que indexan cada nivel,
+del primero al ultimo (de 2 a 4 niveles de 1 a 20 bits, 31 bits como maximo en total). El RLTP de cada proceso es su
+ultima pagina, hasta 2^bits - 1, y la octava linea no tiene un marco por pagina sino regiones de paginas seguidas con
+marcos seguidos, en grupos de cuatro valores: proceso, primera pagina, primer marco y numero de paginas. Las paginas
+que no estan en ninguna region no tienen marco. Como las direcciones de un valor son enteros, para paginas altas se
+usa el formato de dos valores (pagina, desplazamiento). No se puede usar con "-m" ni guardar como imagen.
+
+3 10 9																			// Tipo 3: dos niveles de 10 y 9 bits
+0 524287 0 524287																// RBTP y RLTP: 2^19 paginas por proceso
+0 0 10 4 0 524280 20 8 1 100000 40 2											// Paginas 0-3 y 524280-524287 del proceso 0, 100000-100001 del 1
+
+En el modo por lotes se muestran los nodos de cada nivel, la memoria de la tabla por proceso y los niveles leidos
+por busqueda.
+
+Con la novena linea cada segmento tiene ademas su propia tabla de paginas. Con el ejemplo de PMT global, los segmentos
+del proceso 0 (limites 408, 85, 103 y 40) tienen 5, 1, 2 y 1 paginas, y los del proceso 1 (300, 700, 670 y 210) 4, 8,
+7 y 3, asi que la novena linea tiene 31 marcos:
+
+100 101 102 -1 104 105 106 107 108 109 110 111 112 113 114 115 116 117 118 119 120 121 122 123 124 125 126 127 128 129 130
+
 
 
 
@@ -86,6 +123,13 @@ Ejemplo con PMT por Proceso:
 
 El sistema mostrara por pantalla los datos del fichero almacenados en las correspondientes
 estructuras de datos utilizadas para implementar el gestor de memoria.
+
+Antes, comprueba que los procesos no colisionan en memoria fisica: que las particiones
+de registro base/limite no se solapan, que los segmentos de la SDT no se solapan y que
+ningun marco de pagina esta asignado a dos paginas. Cada conflicto se muestra como un
+aviso (por la salida de errores en el modo por lotes). Con la opcion "-c" se permite
+que procesos distintos compartan segmentos o marcos de forma intencionada, y solo se
+avisan los conflictos dentro de un mismo proceso y los de las particiones.
 	
 	
 	
@@ -99,87 +143,853 @@ La traduccion a direccion fisica correspondientes, por proceso y metodo, se most
 por pantalla, ademas de sacarla a un fichero de texto, cuyo nombre se relaciona
 con el fichero de texto donde estaban los datos inicialmente almacenados.
 
+
+
+					**************************************
+					*********** Modo por lotes ***********
+					**************************************
+
+Si ademas del fichero de datos se recibe la opcion "-t <traza>", el programa no es
+interactivo: lee direcciones logicas del fichero de traza (o de la entrada estandar
+si la traza es "-"), una por linea y en cualquiera de los dos formatos (306 o 2,46),
+y escribe por la salida estandar la traduccion de cada una en cada proceso y metodo.
+
+	code datos.txt -t traza.txt > resultados.txt
+
+Con la opcion "-compilar <imagen>" el fichero de datos, una vez validado, se guarda
+como imagen binaria (tablas contiguas con cabecera, version y suma de control):
+
+	code datos.txt -compilar datos.img
+
+Una imagen se puede usar en lugar del fichero de texto en cualquier modo. No se vuelve
+a leer ni a validar: se proyecta en memoria (mmap) y las tablas se usan directamente,
+de modo que el arranque es inmediato aunque el fichero sea muy grande, y varias
+ejecuciones simultaneas comparten la misma memoria fisica. La imagen depende de la
+version del formato y del orden de bytes de la maquina; si no coinciden hay que volver
+a compilarla.
+
+Las lineas vacias y las que empiezan por '#' se ignoran. Por cada direccion y proceso
+se escribe una linea con los campos separados por tabuladores:
+
+	direccion	proceso	base/limite	segmentacion	paginacion
+
+Cada metodo muestra la direccion fisica o el motivo del error: FORMATO, DIRECCION,
+SEGMENTO, INSTRUCCION, PAGINA o MARCO.
+
+La opcion "-f" cambia el formato de las traducciones: "texto" (por defecto), "csv" (con
+cabecera; la direccion de dos valores va entre comillas), "jsonl" (un objeto por linea,
+con la direccion de dos valores como array y los errores como cadenas) o "binario"
+(un registro de 28 bytes por traduccion en el orden de bytes de la maquina: direccion
+o pagina/segmento, desplazamiento, proceso, las tres direcciones fisicas (-1 si hay
+error), los tres codigos de error (0 si no lo hay) y el formato de la direccion).
+Con "-q" solo se escriben los resultados: sin cabecera, avisos de colisiones, resumen
+ni estadisticas. En el modo interactivo "-q" tambien quita los rotulos de la pantalla y
+del fichero de salida, y deja solo la direccion y el resultado de cada metodo.
+
+Una direccion puede ir precedida del proceso que la genera (p.ej. 1:306 o 1:2,46);
+en ese caso solo se traduce en ese proceso, como ocurre en una traza real.
+
+Con la opcion "-sp" la columna de segmentacion usa segmentacion paginada, con las tablas de
+paginas de la novena linea: la direccion (segmento, desplazamiento) se comprueba con el RLTS
+y el limite del segmento, el desplazamiento se parte en pagina y desplazamiento, y la pagina
+se comprueba con el limite de la tabla del segmento antes de leer su marco. Cada traduccion
+lee dos tablas en memoria (la SDT y la tabla de paginas del segmento) en lugar de una; al
+terminar se muestran las referencias a memoria por traduccion y la memoria de las tablas.
+No se puede usar con "-s", y la imagen binaria no guarda la novena linea.
+
+Con la opcion "-j hilos" la traza se traduce en paralelo con ese numero de hilos (0 para
+uno por procesador): se divide en trozos que los hilos se reparten, y los resultados se
+escriben en el orden de la traza, de modo que la salida es la misma que con un hilo.
+No se puede usar con "-tlb" ni "-m", y fuera de Windows hay que compilar con -pthread:
+
+	gcc -O2 -pthread -o code code.c memmanager.c -lm
+	code datos.txt -t traza.txt -j 0 > resultados.txt
+
+Sin TLB ni paginacion bajo demanda la traza se traduce por bloques: las direcciones de
+un valor de cada proceso se traducen juntas con instrucciones vectoriales (AVX2 o
+SSE4.1 si el procesador las tiene), y la salida es la misma que una a una. Con "-sp",
+las de dos valores tambien, en la segmentacion paginada (AVX2).
+
+La traza se lee por partes con buffers de tamano fijo, asi que se pueden traducir trazas
+mucho mayores que la memoria (salvo con "-m", que la carga completa). Si el fichero de
+traza esta comprimido con gzip o zstd, se descomprime a la vez que se traduce con "gzip"
+o "zstd" (que deben estar instalados), sin pasar por el disco:
+
+	code datos.txt -t traza.txt.zst -j 0 > resultados.txt
+
+Durante la traduccion se avisa del progreso por la salida de errores cada pocos
+segundos (salvo con "-q"): direcciones traducidas, velocidad y megabytes leidos, con
+el porcentaje si se conoce el tamano de la traza.
+
+Con la opcion "-tlb entradas,vias,politica,modo[,tTLB,tMemoria]" la paginacion pasa
+antes por una TLB simulada con el numero de entradas y vias (asociatividad) indicado,
+reemplazo "lru" o "aleatorio", y modo "asid" (las entradas se etiquetan con el proceso)
+o "vaciado" (la TLB se vacia en cada cambio de proceso). Al terminar se muestran los
+aciertos, fallos y el tiempo efectivo de acceso, con los tiempos de acceso a la TLB y
+a memoria indicados (1 y 100 ns por defecto). Por ejemplo: -tlb 64,4,lru,asid
+
+Con la opcion "-m marcos" se simula paginacion bajo demanda con ese numero de marcos
+fisicos: una pagina con marco -1 (o fuera de los marcos disponibles) no es un error,
+sino un fallo de pagina que la carga en un marco libre o expulsa otra pagina, que pasa
+a -1 en la PMT. La opcion "-r" indica la politica de reemplazo: "fifo", "lru" (por
+defecto), "reloj" (segunda oportunidad) u "opt" (optima de Belady, que conoce la traza
+completa). Al terminar se muestran las referencias y fallos de pagina por proceso.
+Si se indican varias politicas separadas por comas (-r fifo,lru,reloj,opt) la traza se
+simula con cada una y, en lugar de las traducciones, se escribe una tabla con los
+fallos de cada politica y proceso:
+
+	# politica	proceso	referencias	fallos	tasa
+
+Con la opcion "-a eventos" el registro base/limite no se toma del fichero de datos,
+sino que el simulador asigna las particiones segun llegan y terminan los procesos.
+El fichero de eventos tiene en su primera linea el tamano de la memoria y despues una
+linea por evento: "+proceso tamano" para la llegada de un proceso que pide una
+particion de ese tamano y "-proceso" para su finalizacion:
+
+	100000				// Tamano de la memoria
+	+0 1200				// Llega el proceso 0 y pide 1200 posiciones
+	+1 300
+	-0					// Termina el proceso 0
+
+La opcion "-p" indica la politica de asignacion: "primero" (primer ajuste, por
+defecto), "siguiente", "mejor", "peor" o "buddy", o varias separadas por comas para
+compararlas. Por cada politica se escribe una linea con las asignaciones, los fallos
+de asignacion (procesos que no caben en ningun hueco), la fragmentacion externa media
+y final, la fragmentacion interna (buddy) y el coste medio por operacion.
+Con una sola politica, las particiones que siguen asignadas al final pasan a ser el
+registro base/limite de los procesos del fichero de datos, y si tambien se indica
+"-t" la traza se traduce con ellas.
+
+La opcion "-s eventos" hace lo mismo con la segmentacion: cada llegada indica el
+tamano de cada segmento del proceso ("+3 1200 300 80") y los segmentos se asignan uno
+a uno con la politica de "-p" (salvo buddy). Si un segmento no cabe en ningun hueco
+pero hay memoria libre suficiente, se compacta la memoria moviendo los segmentos al
+principio (sin cambiar su orden) y reescribiendo su base en la SDT. Por cada politica
+se escriben las llegadas y los fallos, el numero de compactaciones, las posiciones
+movidas y el tiempo dedicado a compactar. Con una sola politica, los procesos del
+fichero de datos que siguen en memoria con el mismo numero de segmentos pasan a usar
+los segmentos asignados, y el resto quedan sin segmentos.
+
+La opcion "-i direcciones" hace la traduccion inversa: lee direcciones fisicas (de la
+entrada estandar si es "-"), una por linea, y escribe por cada metodo los procesos que
+ocupan cada una y su direccion logica, o "LIBRE" si ninguno la ocupa:
+
+	# direccion fisica	metodo	proceso	direccion logica
+	1099	base/limite	1	549
+	1099	segmentacion	1	1,500
+	1099	paginacion	1	99
+
+La direccion logica es el desplazamiento en la particion, el par "segmento,desplazamiento"
+o la direccion de un valor de la pagina (el par "pagina,desplazamiento" si no cabe en un
+entero). Al cargar el modelo se construye un indice inverso (arboles de intervalos de las
+particiones y los segmentos y las paginas de cada marco), de modo que cada consulta cuesta
+O(log n + k), siendo k el numero de propietarios, y no depende del numero de procesos. Con
+"-c" o con solapamientos se escriben todos los propietarios. Si se indican "-a" o "-s" se consulta el resultado de la
+asignacion, y con "-t" la traza se traduce despues. No admite la segmentacion paginada.
+
+
+
+					**************************************
+					******** Pruebas de rendimiento ******
+					**************************************
+
+Con la opcion "-generar parametros" no se lee el fichero de datos ni la traza, sino que
+se crean con un modelo y una traza sinteticos. Los parametros son pares "clave=valor"
+separados por comas; los que no se indican toman el valor entre parentesis:
+
+	procesos (16), segmentos (4) y paginas (64) por proceso, tamano de pagina (4096),
+	tipo de tabla de paginas (1), sinmarco (0, fraccion de paginas con marco -1),
+	marcos de la memoria fisica (tantos como paginas; si hay menos, las demas paginas
+	quedan sin marco), segpaginada (0; con 1 se escriben las tablas de paginas de los
+	segmentos en la novena linea), niveles (9/9/9, bits de cada nivel de la tabla multinivel; las
+	paginas de cada proceso se reparten en cuatro regiones separadas de su espacio),
+	direcciones de la traza (1000000), localidad ("uniforme", "zipf", "secuencial" o
+	"salto"), zipf (1.0, exponente), paso (tamano de pagina, para "salto"), rafaga (16,
+	direcciones seguidas de cada proceso), pares (0.5, fraccion de direcciones "seg,desp";
+	la segmentacion solo traduce estas y base/limite solo las demas, asi que con 0 la prueba
+	de segmentacion del benchmark solo mediria errores de formato), fuera (0, fraccion de
+	direcciones fuera del proceso) y semilla (1).
+
+	code modelo.txt -t traza.txt -generar procesos=64,paginas=1024,localidad=zipf
+
+El modelo no tiene colisiones y, con la misma semilla, los ficheros son siempre los
+mismos. Con la opcion "-benchmark repeticiones" se mide el rendimiento con un modelo
+(de texto o imagen) y una traza: la carga, la validacion y la traduccion de la traza
+en memoria con cada metodo, por lotes y completa con su salida. Por cada prueba se
+escribe la mediana, el minimo y el maximo del tiempo de las repeticiones, las
+traducciones por segundo y una suma de comprobacion de los resultados:
+
+	code modelo.txt -t traza.txt -benchmark 10
+
+Con "-sp" la prueba de segmentacion es la de segmentacion paginada, y se anade la de
+segmentacion paginada por lotes.
+
+Con la opcion "-rotacion parametros" no se lee ningun fichero: se mide el coste de crear,
+destruir y cambiar de tamano procesos con sus tablas (ver crearSistema() en memmanager.h).
+Se mantienen vivos un numero fijo de procesos y en cada operacion se elige uno al azar, que
+cambia de tamano o se destruye y se sustituye por otro nuevo con sus marcos y segmentos. Los
+parametros son pares "clave=valor" separados por comas:
+
+	procesos (10000, vivos a la vez), operaciones (1000000), paginas (256) y segmentos (4)
+	como maximo de cada proceso, redimensionar (0.3, fraccion de operaciones que cambian el
+	tamano de un proceso en lugar de sustituirlo), muestras (10), asignador ("almacen", las
+	tablas en los almacenes de bloques de la biblioteca, o "malloc", un malloc por tabla y
+	realloc al cambiar de tamano) y semilla (1).
+
+	code -rotacion procesos=100000,operaciones=5000000,asignador=malloc
+
+Se escribe una fila tras crear los procesos y otra tras cada muestra, con el tiempo medio
+de cada operacion, la memoria reservada para las tablas (solo con "almacen"), la que usan
+los procesos vivos y la memoria residente del programa (solo en Linux). Cada asignador se
+mide en su propia ejecucion para que la memoria residente de uno no incluya la del otro.
+
 */
 
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <conio.h>
 #include <string.h>
+#include <time.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <math.h>
+
+#include "memmanager.h"			// Nucleo del simulador: modelo, validacion y traduccion de direcciones
+
+#ifdef _WIN32
+	#include <conio.h>
+	#define popen _popen				// Descompresion de las trazas comprimidas
+	#define pclose _pclose
+#else
+	#include <sys/stat.h>
+	#include <pthread.h>				// Traduccion de la traza en paralelo (compilar con -pthread)
+	#include <unistd.h>
+	#define getch getchar				// Fuera de Windows no existe conio.h; la confirmacion se lee de la entrada estandar
+#endif
 
-#define max_paginas 100 				// Numero maximo de paginas que tendra cada tabla PMT, ya sea global o de cada proceso
-#define max_segmentos 100   			// Numero maximo de segmentos que tendra la tabla SDT del sistema
-#define max_procesos 100				// Numero maximo de procesos del sistema.
 #define longitudFichero 255 			// Maximo de caracteres de la ruta de un fichero
+#define longitudLinea 256				// Maximo de caracteres de una linea del fichero de traza
+#define tamBufferSalida (1 << 20)		// Tamano del buffer de la salida estandar en el modo por lotes
+#define tamBloque 65536					// Pares (direccion, proceso) que se traducen juntos en el modo por lotes
+#define intervaloProgreso 5.0			// Segundos entre los avisos de progreso de la traduccion de la traza
+
+// Politicas de reemplazo de la TLB
+#define TLB_LRU 0						// Se reemplaza la entrada usada hace mas tiempo
+#define TLB_ALEATORIA 1					// Se reemplaza una entrada al azar
+
+/* Formatos de salida de las traducciones de la traza */
+#define SALIDA_TEXTO 0					// Campos separados por tabuladores
+#define SALIDA_CSV 1					// Valores separados por comas, con cabecera
+#define SALIDA_JSONL 2					// Un objeto JSON por linea
+#define SALIDA_BINARIA 3				// Registros binarios de tamano fijo (registroBinario)
+#define maxDestinos 4					// Destinos (pantalla, ficheros) de un escritor
+
+/* Politicas de reemplazo de la paginacion bajo demanda */
+#define DEM_FIFO 0						// Se expulsa la pagina cargada hace mas tiempo
+#define DEM_LRU 1						// Se expulsa la pagina usada hace mas tiempo
+#define DEM_RELOJ 2						// Segunda oportunidad con bit de referencia
+#define DEM_OPT 3						// Se expulsa la pagina que mas tarde se volvera a usar (Belady)
+
+/* Politicas del asignador de particiones dinamicas */
+#define ASIG_PRIMERO 0					// Primer ajuste
+#define ASIG_SIGUIENTE 1				// Siguiente ajuste
+#define ASIG_MEJOR 2					// Mejor ajuste
+#define ASIG_PEOR 3						// Peor ajuste
+#define ASIG_BUDDY 4					// Sistema buddy
+#define ordenesBuddy 31					// Ordenes de bloque del sistema buddy (bloques de 1 a 2^30 posiciones)
+
+// Localidad de las trazas sinteticas
+#define LOC_UNIFORME 0					// Cualquier direccion del proceso con la misma probabilidad
+#define LOC_ZIPF 1						// Unas pocas paginas concentran la mayoria de los accesos
+#define LOC_SECUENCIAL 2				// Direcciones consecutivas
+#define LOC_SALTO 3						// Direcciones separadas por un paso fijo
 	
-// Estructura que implementa los conceptos de base y limite para cualquier sistema que necesite hacer uso de los mismos
-// Lo usamos para los siguientes escenarios:
-//		- Implementar el metodo de gestion de memoria Registro Base/Limite
-//		- Implementar los RBTP y RLTP de las paginas de cada proceso	
-//		- Implementar los RBTS y RLTS de los segmentos de cada proceso
-typedef struct registro{
-	int base;											// valor entero que representa el registro base
-	int limite;											// valor entero que representa el registro limite
-}registro;
-
-// Estructura que implementa el metodo de gestion de memoria de la paginación.
-typedef struct paginacion{
-	int tamano;											// Valor entero que representa el tamano de pagina del sistema
-	int tipo;											// Entero que representa el tipo de tabla que usara el sistema:
-														// 		0 - PMT global para todos los procesos
-														// 		1 - PMT por proceso
-	
-	int PMT_Global[max_paginas];						// Array Unidimensional. Representa la PMT del sistema para todos los procesos, con un numero maximo de paginas "num_Paginas".
-	int PMT[max_procesos][max_paginas]; 				// Array Bidimensional. Representa las PMT de cada proceso. Cada PMT tendra un numero maximo de paginas "num_paginas".
-	
-	registro RBTP_RLTP[max_procesos];					// Array Bidimensional de tipo registro. Almacena los registros RBTP y RLTP de cada proceso. Equivalen a:
-														// En el caso de PMT del sistema: Indice y longitud en el vector PMT_Global.
-														// En el caso de PMT por proceso: Indice y longitud de las columnas de cada fila (proceso) en la matriz PMT.
-}paginacion;
-
-// Estructura que implementa el metodo de gestion de memoria de la segmentacion.
-typedef struct segmentacion{
-	registro SDT[max_segmentos]; 		 				// Array de tipo registro. Representa la SDT. Tendra un numero maximo de segmentos "num_segmentos"
-	registro RBTS_RLTS[max_procesos];	 				// Array Bidimensional de tipo registro. Lo utilizaremos para almacenar los datos de segmentacion de los procesos del sistema.
-}segmentacion;
+// Estructura que representa una entrada de la TLB
+typedef struct entradaTLB{
+	int proceso;										// Proceso (ASID) al que pertenece la traduccion
+	int pagina;											// Numero de pagina
+	int marco;											// Marco de pagina asociado
+	unsigned int generacion;							// Solo es valida si coincide con la generacion de la TLB
+	unsigned long long ultimoUso;						// Instante del ultimo acceso, para el reemplazo LRU
+}entradaTLB;
+
+// Estructura que simula una TLB asociativa por conjuntos delante de la PMT
+typedef struct tlb{
+	int numEntradas;									// Numero total de entradas
+	int asociatividad;									// Entradas (vias) por conjunto
+	int numConjuntos;									// numEntradas / asociatividad. La pagina selecciona el conjunto
+	int politica;										// TLB_LRU o TLB_ALEATORIA
+	int asid;											// 1 - Entradas etiquetadas por proceso, 0 - Vaciado en cada cambio de proceso
+	double tiempoTLB;									// Tiempo de acceso a la TLB (ns)
+	double tiempoMemoria;								// Tiempo de acceso a memoria (ns)
+	
+	entradaTLB *entradas;								// numConjuntos * asociatividad entradas
+	unsigned int generacion;							// Vaciar la TLB es incrementar la generacion
+	unsigned long long reloj;							// Contador de accesos
+	unsigned long long semilla;							// Estado del generador aleatorio (xorshift)
+	int procesoActual;									// Ultimo proceso que ha usado la TLB
+	
+	int numProcesos;
+	long long *aciertos;								// Aciertos por proceso
+	long long *fallos;									// Fallos por proceso
+	long long vaciados;									// Numero de vaciados por cambio de proceso
+}tlb;
+
+// Estructura que simula la paginacion bajo demanda con un numero fijo de marcos fisicos
+typedef struct paginacionDemanda{
+	int politica;										// DEM_FIFO, DEM_LRU, DEM_RELOJ o DEM_OPT
+	int numMarcos;										// Marcos de memoria fisica disponibles
+	int *entradaMarco;									// Array de "numMarcos" enteros. Entrada de la PMT cargada en cada marco, o -1 si esta libre
+	int *procesoMarco;									// Array de "numMarcos" enteros. Proceso al que pertenece la pagina de cada marco
+	mapaMarcos libres;									// Marcos libres (se reserva siempre el mas bajo)
+	int ocupados;										// Marcos con pagina cargada
+	
+	int *cola;											// FIFO: cola circular de marcos por orden de carga
+	int cabeza;
+	
+	int *anterior;										// LRU: lista doblemente enlazada de marcos, del mas al menos reciente
+	int *siguiente;
+	int primero;
+	int ultimo;
+	
+	unsigned char *referenciado;						// Reloj: bit de referencia de cada marco
+	int manecilla;
+	
+	int *proximoUso;									// OPT: siguiente referencia a la pagina de cada marco
+	int *monticulo;										// OPT: monticulo de maximos de pares (proximoUso, marco)
+	int tamMonticulo;
+	const int *siguienteUso;							// OPT: siguiente referencia a la misma pagina, por cada referencia de la traza
+	int instante;										// Numero de la referencia actual
+	
+	int numProcesos;
+	long long *referencias;								// Referencias a paginas validas por proceso
+	long long *fallos;									// Fallos de pagina por proceso
+	int descartadas;									// Paginas de la PMT inicial que no caben en los marcos
+}paginacionDemanda;
+
+// Estructura que representa un hueco libre de la memoria en los arboles del asignador de particiones
+typedef struct nodoHueco{
+	int inicio;											// Primera posicion del hueco
+	int tamano;											// Posiciones libres
+	int maxTamano;										// Mayor hueco del subarbol por direccion
+	unsigned int prioridad;								// Prioridad aleatoria del treap
+	int izq, der;										// Hijos en el arbol ordenado por direccion
+	int izqT, derT;										// Hijos en el arbol ordenado por tamano
+	int propietario;									// En el arbol de ocupados, elemento (segmento) que ocupa el nodo
+}nodoHueco;
+
+// Estructura que implementa el asignador de particiones dinamicas del registro base/limite
+typedef struct asignador{
+	int politica;										// ASIG_PRIMERO, ASIG_SIGUIENTE, ASIG_MEJOR, ASIG_PEOR o ASIG_BUDDY
+	int memoria;										// Tamano de la memoria
+	int libre;											// Posiciones libres
+	int cursor;											// Siguiente ajuste: final de la ultima asignacion
+	
+	nodoHueco *nodos;									// Array de nodos de los arboles de huecos
+	int numNodos;
+	int capacidadNodos;
+	int nodoLibre;										// Lista de nodos liberados para reutilizar
+	int raiz;											// Arbol de huecos por direccion
+	int raizTamano;										// Arbol de huecos por tamano
+	int raizOrden[ordenesBuddy];						// Sistema buddy: arbol de bloques libres de cada orden
+	int raizOcupados;									// Arbol por direccion de los elementos asignados, para la compactacion
+	
+	unsigned long long semilla;							// Estado del generador aleatorio de prioridades
+	long long pasos;									// Nodos visitados, para medir el coste de las operaciones
+}asignador;
+
+// Estructura que representa la llegada o la finalizacion de un proceso
+typedef struct evento{
+	int proceso;										// Posicion del proceso en "procesos" de la lista de eventos
+	int numTamanos;										// Tamanos que pide (particion o segmentos), o 0 si el proceso finaliza
+	long primerTamano;									// Posicion del primero en el array de tamanos
+}evento;
+
+// Estructura con el contenido de un fichero de eventos
+typedef struct listaEventos{
+	int memoria;										// Tamano de la memoria
+	int numProcesos;									// Procesos distintos de los eventos
+	int *procesos;										// Array de "numProcesos" enteros. Numeros de proceso del fichero, de menor a mayor
+	evento *v;											// Array de "numEventos" eventos
+	long numEventos;
+	int *tamanos;										// Array de "numTamanos" tamanos de todas las llegadas
+	long numTamanos;
+}listaEventos;
+
+// Estructura que da formato a la salida en un buffer y lo vuelca en uno o varios destinos
+typedef struct escritor{
+	char *datos;										// Texto pendiente de escribir
+	size_t longitud;
+	size_t capacidad;
+	FILE *destinos[maxDestinos];						// Sin destinos, el buffer crece y el texto se queda en memoria
+	int numDestinos;
+	int formato;										// SALIDA_TEXTO, SALIDA_CSV, SALIDA_JSONL o SALIDA_BINARIA
+	int silencioso;										// Solo se escriben los resultados, sin cabeceras ni adornos
+	int error;											// No ha habido memoria suficiente para el buffer
+}escritor;
+
+// Registro de la salida binaria: la traduccion de una direccion en un proceso (28 bytes, orden de bytes de la maquina)
+typedef struct registroBinario{
+	int dLogica;										// Direccion de un valor, o numero de pagina o segmento si es de dos
+	int nInstruccion;									// Desplazamiento de la direccion de dos valores (0 si es de un valor)
+	int proceso;
+	int dFisica[3];										// Base/limite, segmentacion y paginacion, o -1 si hay error
+	unsigned char estado[3];							// Codigo TRAD_* de cada metodo
+	unsigned char formato;								// 1 - Un valor, 2 - Par de valores
+}registroBinario;
+
+// Estructura con un bloque de direcciones de la traza y el espacio para traducirlo
+typedef struct bloqueTraza{
+	int numProcesos;
+	int capacidad;										// Maximo de pares (direccion, proceso) del bloque
+	direccion *lineas;									// Direcciones del bloque, en el orden de la traza
+	int numLineas;
+	int numElementos;									// Pares (direccion, proceso) del bloque
+	int *cuenta;										// Array de "numProcesos + 1" enteros. Inicio del grupo de cada proceso
+	int *cuentaPares;									// Igual para las direcciones de dos valores con segmentacion paginada
+	int *posicion;										// Posicion de cada par en los grupos, o -1 si no esta agrupado
+	int *agrupadas;										// Direcciones de un valor agrupadas por proceso, seguidas de los segmentos de las de dos
+	int *desplazamientos;								// Desplazamiento de las direcciones de dos valores agrupadas
+	int *fisicas;										// Direccion fisica de cada direccion agrupada
+	unsigned char *estados;								// Resultado de la traduccion de cada direccion agrupada
+}bloqueTraza;
+
+// Estado de los avisos de progreso de la traduccion de una traza
+typedef struct progresoTraza{
+	int activo;											// 0 si no se avisa (salida silenciosa)
+	double inicio;										// Instante en que empieza la traduccion
+	double siguiente;									// Instante del siguiente aviso
+	long long tamano;									// Tamano del fichero de traza, o -1 si no se conoce (entrada estandar o comprimida)
+	FILE *fp;											// Traza de la que se obtiene la posicion si no se indican los bytes leidos
+}progresoTraza;
+
+// Parametros del generador de modelos y trazas sinteticos
+typedef struct generador{
+	int procesos;										// Numero de procesos
+	int segmentos;										// Segmentos por proceso
+	int paginas;										// Paginas por proceso
+	int tamano;											// Tamano de pagina
+	int tipo;											// 0 - PMT global, 1 - PMT por proceso, 2 - tabla invertida, 3 - multinivel
+	int numNiveles;										// Niveles y bits de cada nivel de la tabla multinivel
+	int bitsNivel[4];
+	double sinMarco;									// Fraccion de paginas sin marco asignado
+	int marcos;											// Marcos de la memoria fisica (0 para uno por pagina)
+	int segmentosPaginados;								// 1 - Se escribe la tabla de paginas de cada segmento (novena linea)
+	long direcciones;									// Direcciones de la traza
+	int localidad;										// LOC_UNIFORME, LOC_ZIPF, LOC_SECUENCIAL o LOC_SALTO
+	double zipf;										// Exponente de la distribucion de Zipf
+	int paso;											// Paso de la localidad LOC_SALTO
+	int rafaga;											// Direcciones seguidas de un mismo proceso
+	double pares;										// Fraccion de direcciones con formato de par de valores
+	double fuera;										// Fraccion de direcciones fuera del espacio del proceso
+	unsigned long long semilla;							// Semilla del generador aleatorio
+}generador;
+
+// Estructura con los parametros de la prueba de rotacion de procesos
+typedef struct rotacion{
+	int procesos;										// Procesos vivos a la vez
+	long operaciones;
+	int paginas;										// Maximo de paginas de un proceso
+	int segmentos;										// Maximo de segmentos de un proceso
+	double redimensionar;								// Fraccion de operaciones que cambian el tamano de un proceso
+	int muestras;
+	int almacen;										// 1 - Tablas en un sistemaProcesos, 0 - un malloc por tabla
+	unsigned long long semilla;
+}rotacion;
+
+#ifndef _WIN32
+
+// Estructura con un trozo de la traza que traduce un hilo en el modo paralelo
+typedef struct trozoTraza{
+	char *texto;										// Lineas completas de la traza
+	size_t longitud;
+	size_t capacidad;
+	escritor salida;									// Traducciones del trozo en memoria, con el mismo formato que en un solo hilo
+	long numLineas;										// Lineas del trozo, contadas como las lee fgets()
+	long *incorrectas;									// Lineas incorrectas del trozo, relativas a su primera linea
+	long numIncorrectas;
+	long capacidadIncorrectas;
+	long numDirecciones;								// Direcciones validas del trozo
+	int terminado;										// El trozo esta traducido y se puede escribir
+}trozoTraza;
+
+// Estructura compartida por los hilos que traducen la traza en paralelo
+typedef struct repartoTraza{
+	pthread_mutex_t cerrojo;
+	pthread_cond_t hayTrabajo;							// Se avisa a los hilos cuando hay un trozo nuevo o termina la traza
+	pthread_cond_t trozoTerminado;						// Se avisa al hilo principal cuando se termina un trozo
+	int numHilos;
+	int numTrozos;										// Trozos del anillo, que se reutilizan en orden
+	trozoTraza *trozos;
+	int *colas;											// Array de "numHilos * numTrozos" enteros. Cola de trozos pendientes de cada hilo
+	int *cabeza;										// Array de "numHilos" enteros. Primer trozo pendiente de cada cola
+	int *pendientes;									// Array de "numHilos" enteros. Trozos pendientes de cada cola
+	int fin;											// Ya no se van a anadir mas trozos
+	
+	int numProcesos;
+	const registro *t_registros;
+	const paginacion *t_paginacion;
+	const segmentacion *t_segmentacion;
+}repartoTraza;
+
+// Estructura de cada hilo del modo paralelo, con sus propias estadisticas
+typedef struct hiloTraza{
+	pthread_t id;
+	int indice;
+	repartoTraza *reparto;
+	bloqueTraza b;										// Bloque con el que el hilo traduce sus trozos
+	long trozos;										// Trozos traducidos
+	long robados;										// Trozos tomados de la cola de otro hilo
+	long direcciones;									// Direcciones traducidas
+	double ocupado;										// Segundos dedicados a traducir
+	paginacion paginas;									// Copia de la paginacion con los contadores de la tabla invertida del hilo
+	contadoresTabla contadores;
+	segmentacion segmentos;								// Copia de la segmentacion con los contadores de la segmentacion paginada del hilo
+	contadoresTabla contadoresSegmentos;
+}hiloTraza;
+
+#endif
+
+// Intervalos ordenados con compararIntervalos() y los arboles para buscar los que contienen un valor
+typedef struct arbolIntervalos{
+	intervalo *v;										// Array de "n" intervalos
+	int n;
+	long long *maximos;									// Arbol de segmentos con el mayor fin de cada rango de "v": las hojas empiezan en "hojas"
+	int hojas;
+	int *anterior;										// Array de "n" enteros. Intervalo anterior mas cercano que acaba igual o despues, o -1
+	int *izquierdo;										// Arbol cartesiano de los fines (ningun intervalo acaba despues que su padre):
+	int *derecho;										// hijos de cada intervalo, o -1. Su recorrido en orden es el de "v"
+}arbolIntervalos;
+
+// Indice inverso de la memoria fisica: procesos y direcciones logicas que ocupan cada direccion fisica
+typedef struct indiceInverso{
+	arbolIntervalos particiones;						// Particiones de registro base/limite
+	arbolIntervalos segmentos;							// Segmentos de la SDT (indice es el segmento del proceso)
+	int *pila;											// Espacio de las consultas: tantos enteros como intervalos tiene el mayor arbol
+	intervalo *marcos;									// Un intervalo de un solo valor por pagina con marco, ordenados por marco (indice es la pagina)
+	int numMarcos;
+	int *posicionMarco;									// Array de "maxMarco + 2" enteros. Primera posicion de cada marco en "marcos" (y del siguiente),
+	int maxMarco;										// para buscarlo en O(1); NULL si los marcos son muy dispersos y se busca en O(log n)
+	int tamano;											// Tamano de pagina
+}indiceInverso;
 
 /* Prototipos de las funciones auxiliares */
-int datosEntradaValidos (FILE * archivo);	
-void leerDatos(FILE *fp, int *numProcesos, registro t_registros[], paginacion *t_paginacion, segmentacion *t_segmentacion);
-void mostrarDatos(char *archivo, int numProcesos, registro t_registros[], paginacion t_paginacion, segmentacion t_segmentacion);
-void traducirDirecciones(char *archivo, int numProcesos, registro t_registros[], paginacion t_paginacion, segmentacion t_segmentacion);
-void validarDireccion(int opcion, FILE *fp, int *dLogica, int *nPag_Seg, int *nInstruccion);
+int construirIndiceInverso(indiceInverso *x, int numProcesos, const registro t_registros[], const paginacion *t_paginacion, const segmentacion *t_segmentacion);
+void liberarIndiceInverso(indiceInverso *x);
+void consultarIndiceInverso(indiceInverso *x, int dFisica, escritor *e);
+int traducirInversa(char *consultas, int numProcesos, const registro t_registros[], const paginacion *t_paginacion, const segmentacion *t_segmentacion, escritor *salida);
+void mostrarDatos(char *archivo, int numProcesos, const registro t_registros[], const paginacion *t_paginacion, const segmentacion *t_segmentacion);
+void traducirDirecciones(char *archivo, int numProcesos, const registro t_registros[], const paginacion *t_paginacion, const segmentacion *t_segmentacion, int silencioso);
+void validarDireccion(int opcion, escritor *e, FILE *fp, int *dLogica, int *nPag_Seg, int *nInstruccion);
+int crearEscritor(escritor *e, size_t capacidad, int formato, int silencioso);
+void liberarEscritor(escritor *e);
+void anadirDestino(escritor *e, FILE *destino);
+void vaciarEscritor(escritor *e);
+void escribirDatos(escritor *e, const void *datos, size_t n);
+void escribirCadena(escritor *e, const char *cadena);
+void escribirEntero(escritor *e, int valor);
+void escribirFormato(escritor *e, const char *formato, ...);
+int configurarTLB(tlb *t, const char *opciones, int numProcesos);
+void liberarTLB(tlb *t);
+void reiniciarTLB(tlb *t);
+int buscarTLB(tlb *t, int proceso, int nPagina, int *marco);
+void insertarTLB(tlb *t, int proceso, int nPagina, int marco);
+void invalidarTLB(tlb *t, int proceso, int nPagina);
+int configurarDemanda(paginacionDemanda *m, int numMarcos, int numProcesos);
+void liberarDemanda(paginacionDemanda *m);
+void iniciarDemanda(paginacionDemanda *m, paginacion *t_paginacion, int politica, const int *siguienteUso, const int *primerUso);
+int accederPagina(paginacionDemanda *m, paginacion *t_paginacion, tlb *t, int proceso, int entrada);
+void mostrarEstadisticasDemanda(const paginacionDemanda *m, FILE *salida);
+int traducirPaginaSimulada(tlb *t, paginacionDemanda *m, paginacion *t_paginacion, int proceso, const direccion *d, int *dFisica);
+void mostrarEstadisticasTLB(const tlb *t, FILE *salida);
+int leerDireccion(const char *linea, direccion *d);
+int leerPoliticas(const char *opciones, const char *nombres[], int numNombres, int politicas[]);
+void traducirLinea(const direccion *d, int numProcesos, registro t_registros[], paginacion *t_paginacion, segmentacion *t_segmentacion, tlb *t_tlb, paginacionDemanda *t_demanda, escritor *salida);
+void escribirTraduccion(escritor *e, const direccion *d, int proceso, const registro t_registros[], int estadoSegmento, int dFisicaSegmento, int estadoPagina, int dFisicaPagina);
+void escribirCabecera(escritor *e);
+int crearBloque(bloqueTraza *b, int numProcesos);
+void liberarBloque(bloqueTraza *b);
+int cabeEnBloque(const bloqueTraza *b, const direccion *d);
+void anadirBloque(bloqueTraza *b, const direccion *d);
+void traducirBloque(bloqueTraza *b, const registro t_registros[], const paginacion *t_paginacion, const segmentacion *t_segmentacion, escritor *salida);
+FILE *abrirTraza(const char *traza, int *comprimida);
+int cerrarTraza(FILE *fp, int comprimida, const char *traza);
+void iniciarProgreso(progresoTraza *p, FILE *fp, int comprimida, int silencioso);
+void avisarProgreso(progresoTraza *p, long direcciones, long long bytes);
+direccion *cargarTraza(FILE *fp, int numProcesos, long *numDirecciones);
+int *calcularSiguienteUso(const direccion v[], long n, int numProcesos, const paginacion *t_paginacion, int **primerUso);
+int traducirTraza(char *traza, int numProcesos, registro t_registros[], paginacion *t_paginacion, segmentacion *t_segmentacion, tlb *t_tlb, paginacionDemanda *t_demanda, const int politicas[], int numPoliticas, escritor *salida);
+#ifndef _WIN32
+int traducirTrazaParalela(char *traza, int numHilos, int numProcesos, const registro t_registros[], const paginacion *t_paginacion, const segmentacion *t_segmentacion, escritor *salida);
+#endif
+int configurarAsignador(asignador *a, int politica, int memoria);
+void liberarAsignador(asignador *a);
+int mayorHueco(const asignador *a);
+int asignarParticion(asignador *a, int tamano);
+int liberarParticion(asignador *a, int inicio, int tamano);
+int marcarOcupado(asignador *a, int inicio, int tamano, int propietario);
+void desmarcarOcupado(asignador *a, int inicio);
+long long compactarMemoria(asignador *a, registro elementos[]);
+int cargarEventos(const char *fichero, int segmentos, listaEventos *e);
+void liberarEventos(listaEventos *e);
+int simularAsignacion(const listaEventos *e, const int politicas[], int numPoliticas, registro t_registros[], int numProcesos);
+int simularSegmentacion(const listaEventos *e, const int politicas[], int numPoliticas, segmentacion *t_segmentacion, int numProcesos);
+int leerGenerador(const char *opciones, generador *g);
+int generarModelo(const generador *g, const char *fichero);
+int generarTraza(const generador *g, const char *fichero);
+double segundosReloj(void);
+int medirRendimiento(const char *archivo, const char *traza, int repeticiones, int compartir, int paginada);
+int leerRotacion(const char *opciones, rotacion *r);
+size_t memoriaResidente(void);
+int medirRotacion(const rotacion *r);
 
 /* Funcion Principal */
 int main(int argc, char *argv[]){
 	FILE *fp;												// Puntero a archivo que representa nuestro archivo
 	char archivo[longitudFichero];							// Nombre del archivo
-	int i, j, numProcesos, numPaginasProceso;				// Variable auxiliares
+	char *compilar = NULL;									// Fichero donde se guarda la imagen binaria de los datos
+	imagen t_imagen;										// Imagen binaria de la que se han cargado los datos, si la hay
+	char *traza = NULL;										// Fichero de traza del modo por lotes ("-" para la entrada estandar)
+	char *consultas = NULL;									// Fichero de direcciones fisicas para el indice inverso ("-" para la entrada estandar)
+	int compartir = 0;										// Permite que procesos distintos compartan segmentos y marcos
+	char *opcionesTLB = NULL;								// Configuracion de la TLB simulada en el modo por lotes
+	int numHilos = 1;										// Hilos que traducen la traza (0 para uno por procesador)
+	int formatoSalida = SALIDA_TEXTO;						// Formato de las traducciones de la traza
+	int silencioso = 0;										// Solo se escriben los resultados
+	escritor t_salida;										// Salida de las traducciones de la traza
+	tlb t_tlb;												// TLB simulada
+	int numMarcos = 0;										// Marcos fisicos de la paginacion bajo demanda (0 si no se simula)
+	char *opcionesDemanda = NULL;							// Politicas de reemplazo de la paginacion bajo demanda
+	int politicas[4] = {DEM_LRU}, numPoliticas = 1;			// Politicas de reemplazo a simular
+	paginacionDemanda t_demanda;							// Paginacion bajo demanda simulada
+	char *eventos = NULL;									// Fichero de eventos del asignador de particiones dinamicas
+	char *eventosSegmentos = NULL;							// Fichero de eventos de la asignacion dinamica de segmentos
+	char *opcionesAsignacion = NULL;						// Politicas del asignador de particiones dinamicas
+	int politicasAsignacion[5] = {ASIG_PRIMERO}, numPoliticasAsignacion = 1;
+	listaEventos t_eventos;									// Llegadas y finalizaciones de procesos
+	char *opcionesGenerador = NULL;							// Parametros del modelo y la traza sinteticos a generar
+	generador t_generador;									// Modelo y traza sinteticos
+	char *opcionesRotacion = NULL;							// Parametros de la prueba de rotacion de procesos
+	rotacion t_rotacion;
+	int repeticiones = 0;									// Repeticiones de cada prueba de rendimiento (0 si no se mide)
+	int segmentacionPaginada = 0;							// La segmentacion se traduce con la tabla de paginas de cada segmento
+	int lotes;												// Modo por lotes (traza, eventos o consultas), sin interaccion con el usuario
+	static const char *reemplazo[] = {"fifo", "lru", "reloj", "opt"};
+	static const char *asignacion[] = {"primero", "siguiente", "mejor", "peor", "buddy"};
+	static const char *formatos[] = {"texto", "csv", "jsonl", "binario"};
+	char *contenido;										// Contenido completo del archivo
+	size_t longitud;										// Longitud del contenido del archivo
+	int i, estado, numProcesos;								// Variable auxiliares
 	
 	/* Estructuras utilizadas en el ejercicio */
-	registro t_registros[max_procesos];						// Registro Base/Limite
+	registro *t_registros;									// Registro Base/Limite
 	paginacion t_paginacion;								// Paginacion
 	segmentacion t_segmentacion;							// Segmentacion		
 	
 	
-	/* Obtenemos el nombre del fichero de entrada de datos mediante parametros
-	o pidiendolo por teclado en caso contrario */
-	if (argc == 1){
-		printf ("Fichero no introducido por parametros. Introduzca nombre del fichero: ");
-		gets(archivo);
+	/* Obtenemos el nombre del fichero de entrada de datos y las opciones mediante parametros */
+	archivo[0] = '\0';
+	for (i = 1 ; i < argc ; i++){
+		if (strcmp(argv[i], "-t") == 0 && i + 1 < argc){
+			traza = argv[++i];
+		}
+		else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc){
+			consultas = argv[++i];
+		}
+		else if (strcmp(argv[i], "-compilar") == 0 && i + 1 < argc){
+			compilar = argv[++i];
+		}
+		else if (strcmp(argv[i], "-c") == 0){
+			compartir = 1;
+		}
+		else if (strcmp(argv[i], "-tlb") == 0 && i + 1 < argc){
+			opcionesTLB = argv[++i];
+		}
+		else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc){
+			i++;
+			for (formatoSalida = 0 ; formatoSalida < 4 && strcmp(argv[i], formatos[formatoSalida]) != 0 ; formatoSalida++);
+			if (formatoSalida == 4){
+				printf ("Error. Formato de salida incorrecto: \"%s\" (texto, csv, jsonl o binario).\n", argv[i]);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "-q") == 0){
+			silencioso = 1;
+		}
+		else if (strcmp(argv[i], "-sp") == 0){
+			segmentacionPaginada = 1;
+		}
+		else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc){
+			numHilos = atoi(argv[++i]);
+			if (numHilos < 0){
+				printf ("Error. El numero de hilos de \"-j\" no puede ser negativo.\n");
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc){
+			numMarcos = atoi(argv[++i]);
+			if (numMarcos <= 0){
+				printf ("Error. El numero de marcos de \"-m\" debe ser positivo.\n");
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc){
+			opcionesDemanda = argv[++i];
+			if ((numPoliticas = leerPoliticas(opcionesDemanda, reemplazo, 4, politicas)) == 0){
+				printf ("Error. Politicas de reemplazo incorrectas: \"%s\" (fifo,lru,reloj,opt).\n", opcionesDemanda);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc){
+			eventos = argv[++i];
+		}
+		else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc){
+			eventosSegmentos = argv[++i];
+		}
+		else if (strcmp(argv[i], "-generar") == 0 && i + 1 < argc){
+			opcionesGenerador = argv[++i];
+			if (!leerGenerador(opcionesGenerador, &t_generador)){
+				printf ("Error. Parametros del generador incorrectos: \"%s\".\n", opcionesGenerador);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "-rotacion") == 0 && i + 1 < argc){
+			opcionesRotacion = argv[++i];
+			if (!leerRotacion(opcionesRotacion, &t_rotacion)){
+				printf ("Error. Parametros de la rotacion de procesos incorrectos: \"%s\".\n", opcionesRotacion);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "-benchmark") == 0 && i + 1 < argc){
+			repeticiones = atoi(argv[++i]);
+			if (repeticiones <= 0){
+				printf ("Error. El numero de repeticiones de \"-benchmark\" debe ser positivo.\n");
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc){
+			opcionesAsignacion = argv[++i];
+			if ((numPoliticasAsignacion = leerPoliticas(opcionesAsignacion, asignacion, 5, politicasAsignacion)) == 0){
+				printf ("Error. Politicas de asignacion incorrectas: \"%s\" (primero,siguiente,mejor,peor,buddy).\n", opcionesAsignacion);
+				return 1;
+			}
+		}
+		else{
+			strncpy(archivo, argv[i], longitudFichero - 1);
+			archivo[longitudFichero - 1] = '\0';
+		}
 	}
-	else{
-		strcpy(archivo,argv[1]);
+	
+	if (opcionesDemanda != NULL && numMarcos == 0){
+		printf ("Error. La opcion \"-r\" necesita el numero de marcos fisicos (\"-m\").\n");
+		return 1;
+	}
+	
+	if (opcionesAsignacion != NULL && eventos == NULL && eventosSegmentos == NULL){
+		printf ("Error. La opcion \"-p\" necesita el fichero de eventos (\"-a\" o \"-s\").\n");
+		return 1;
+	}
+	
+	for (i = 0 ; eventosSegmentos != NULL && i < numPoliticasAsignacion ; i++){
+		if (politicasAsignacion[i] == ASIG_BUDDY){
+			printf ("Error. La asignacion de segmentos (\"-s\") no admite la politica buddy.\n");
+			return 1;
+		}
+	}
+	
+	if (segmentacionPaginada && traza == NULL){
+		printf ("Error. La segmentacion paginada (\"-sp\") solo se usa al traducir una traza (\"-t\").\n");
+		return 1;
+	}
+	
+	if (segmentacionPaginada && eventosSegmentos != NULL){
+		printf ("Error. La segmentacion paginada (\"-sp\") no admite la asignacion dinamica de segmentos (\"-s\").\n");
+		return 1;
+	}
+	
+	/* Prueba de rotacion de procesos, sin fichero de datos */
+	if (opcionesRotacion != NULL){
+		return medirRotacion(&t_rotacion);
+	}
+	
+	if ((opcionesGenerador != NULL || repeticiones > 0) && (archivo[0] == '\0' || traza == NULL)){
+		printf ("Error. Las opciones \"-generar\" y \"-benchmark\" necesitan el fichero de datos y el de traza (\"-t\").\n");
+		return 1;
+	}
+	
+	/* Generacion de un modelo y una traza sinteticos */
+	if (opcionesGenerador != NULL){
+		if (!generarModelo(&t_generador, archivo) || !generarTraza(&t_generador, traza)){
+			return 1;
+		}
+		fprintf (stderr, "Generados el modelo \"%s\" y la traza \"%s\" (%ld direcciones).\n", archivo, traza, t_generador.direcciones);
+		return 0;
+	}
+	
+	/* Medida del rendimiento con el modelo y la traza */
+	if (repeticiones > 0){
+		return medirRendimiento(archivo, traza, repeticiones, compartir, segmentacionPaginada);
+	}
+	
+	lotes = (traza != NULL || consultas != NULL || eventos != NULL || eventosSegmentos != NULL || compilar != NULL);
+	
+	/* o pidiendolo por teclado en caso contrario */
+	if (archivo[0] == '\0'){
+		printf ("Fichero no introducido por parametros. Introduzca nombre del fichero: ");
+		if (fgets(archivo, longitudFichero, stdin) == NULL){
+			archivo[0] = '\0';
+		}
+		archivo[strcspn(archivo, "\r\n")] = '\0';
 	}		
 	
-	system("cls");
-		
-	if((fp=fopen(archivo,"r"))==NULL){
+	if (!lotes){
 		system("cls");
+	}
+		
+	if((fp=fopen(archivo,"rb"))==NULL){
+		if (!lotes){
+			system("cls");
+		}
 		printf ("Error. Archivo no encontrado\n");
-		system("pause");
+		if (!lotes){
+			system("pause");
+		}
+		return 1;
+	}
+	
+	/*******************************/
+	/* Lectura de datos de fichero */
+	/*******************************/
+	
+	/* Una imagen binaria se usa directamente, sin leer ni validar su contenido de nuevo */
+	estado = abrirImagen(fp, &t_imagen, &numProcesos, &t_registros, &t_paginacion, &t_segmentacion, stdout);
+	
+	if (estado < 0){
+		fclose(fp);
+		if (!lotes){
+			system("pause");
+		}
+		return 1;
 	}
-	else if (!datosEntradaValidos(fp)){		
+	
+	/* Si no, cargamos el fichero completo y verificamos sus datos a la vez que los leemos */
+	if (estado == 0){
+		contenido = leerFichero(fp, &longitud);
+		estado = (contenido == NULL) ? -1 : leerDatos(contenido, longitud, &numProcesos, &t_registros, &t_paginacion, &t_segmentacion, stdout);
+		free(contenido);
+	}
+	
+	fclose(fp);
+	fp = NULL;
+	
+	if (estado < 0){
+		printf ("Error. No hay memoria suficiente para las tablas del fichero.\n");
+		if (!lotes){
+			system("pause");
+		}
+		return 1;
+	}
+	else if (estado == 0){		
 		printf ("--------------------------------------------------------------------------------\n");
 		printf ("La informacion del fichero no es valida. Debe cumplir el siguiente formato: \n\n");
 				
@@ -191,361 +1001,789 @@ int main(int argc, char *argv[]){
 		printf ("3ª linea -> RBTS y RLTS de cada proceso.\n");
 		printf ("4ª linea -> RB y RL de cada segmento de cada proceso.\n");
 		printf ("5ª linea -> Tamaño de pagina.\n");
-		printf ("6ª linea -> Tipo de Paginacion: 0 -> PMT Global, 1 -> PMT por proceso.\n");
+		printf ("6ª linea -> Tipo de Paginacion: 0 -> PMT Global, 1 -> PMT por proceso, 2 -> Tabla invertida, 3 -> Multinivel (y bits por nivel).\n");
 		printf ("7ª linea -> RBTP y RLTP de cada proceso.\n");
-		printf ("8ª linea -> Marco de pagina asociado a cada pagina de cada proceso.\n\n");
+		printf ("8ª linea -> Marco de pagina asociado a cada pagina de cada proceso.\n");
+		printf ("9ª linea (opcional) -> Marco de pagina asociado a cada pagina de cada segmento (segmentacion paginada).\n\n");
 		printf ("--------------------------------------------------------------------------------\n");
 			
+		if (!lotes){
+			system("pause");
+		}
+		return 1;
+	}
+	
+	/***************************************************/
+	/* Comprobacion de colisiones en la memoria fisica */
+	/***************************************************/
+	
+	if (lotes){
+		if (!silencioso){
+			comprobarMemoriaFisica(numProcesos, t_registros, &t_paginacion, &t_segmentacion, compartir, stderr);
+		}
+	}
+	else if (comprobarMemoriaFisica(numProcesos, t_registros, &t_paginacion, &t_segmentacion, compartir, stdout) > 0){
+		printf ("\n");
 		system("pause");
-	}else{	
+	}
+	
+	if (compilar != NULL){
 	
-		/* Rebobinamos el puntero a fichero despues de haber verificado sus datos */
-		rewind (fp);
+		/**********************************************************/
+		/* Modo por lotes - Compilacion de la imagen binaria       */
+		/**********************************************************/
 		
-		/*******************************/
-		/* Lectura de datos de fichero */
-		/*******************************/
+		if (t_segmentacion.tablasSegmentos != NULL && t_paginacion.tipo != 3 && !silencioso){
+			fprintf (stderr, "Aviso. La imagen binaria no guarda las tablas de paginas de los segmentos (novena linea).\n");
+		}
 		
-		leerDatos(fp, &numProcesos, t_registros, &t_paginacion, &t_segmentacion);    
-				
-		      
-        /**********************************************************/
-		/* Salida de la informacion por pantalla - Datos Procesos */
-		/**********************************************************/       
-	
-        mostrarDatos(archivo, numProcesos, t_registros, t_paginacion, t_segmentacion);	
-        
-        fclose(fp);
-        fp = NULL;
-        
-        
-		/*********************************************************************/
-		/* Salida de la informacion por pantalla - Traduccion de direcciones */
-		/*********************************************************************/
-		
-		traducirDirecciones(archivo, numProcesos, t_registros, t_paginacion, t_segmentacion);
-		
-	}	
+		if (t_paginacion.tipo == 3){
+			fprintf (stderr, "Error. La imagen binaria no admite la tabla de paginas multinivel.\n");
+			estado = 1;
+		}
+		else if ((estado = !guardarImagen(compilar, numProcesos, t_registros, &t_paginacion, &t_segmentacion)) != 0){
+			fprintf (stderr, "Error. No ha sido posible escribir la imagen \"%s\".\n", compilar);
+		}
+		else{
+			fprintf (stderr, "Imagen \"%s\" generada con %d procesos, %d segmentos y %d paginas.\n", compilar, numProcesos, t_segmentacion.numSegmentos, t_paginacion.numEntradas);
+		}
+		
+		liberarModelo(&t_imagen, t_registros, &t_paginacion, &t_segmentacion);
+		return estado;
+	}
+	
+	if (lotes){
+	
+		/**************************************************************************/
+		/* Modo por lotes - Asignacion dinamica de particiones y de segmentos     */
+		/**************************************************************************/
+		
+		estado = 0;
+		
+		if (eventos != NULL){
+			estado = !cargarEventos(eventos, 0, &t_eventos) || simularAsignacion(&t_eventos, politicasAsignacion, numPoliticasAsignacion, t_registros, numProcesos);
+			liberarEventos(&t_eventos);
+		}
+		
+		if (eventosSegmentos != NULL && estado == 0){
+			estado = !cargarEventos(eventosSegmentos, 1, &t_eventos) || simularSegmentacion(&t_eventos, politicasAsignacion, numPoliticasAsignacion, &t_segmentacion, numProcesos);
+			liberarEventos(&t_eventos);
+		}
+		
+		/**********************************************************/
+		/* Modo por lotes - Consulta del indice inverso            */
+		/**********************************************************/
+		
+		if (consultas != NULL && estado == 0){
+			if (!crearEscritor(&t_salida, tamBufferSalida, SALIDA_TEXTO, silencioso)){
+				fprintf (stderr, "Error. No hay memoria suficiente para la salida.\n");
+				estado = 1;
+			}
+			else{
+				anadirDestino(&t_salida, stdout);
+				estado = traducirInversa(consultas, numProcesos, t_registros, &t_paginacion, &t_segmentacion, &t_salida);
+				liberarEscritor(&t_salida);
+			}
+		}
+		
+		if (estado != 0 || traza == NULL){
+			fflush (stdout);
+			liberarModelo(&t_imagen, t_registros, &t_paginacion, &t_segmentacion);
+			return estado;
+		}
+		
+		/**********************************************************/
+		/* Modo por lotes - Traduccion de las direcciones de traza */
+		/**********************************************************/
+		
+		if (segmentacionPaginada && t_segmentacion.tablasSegmentos == NULL){
+			fprintf (stderr, "Error. La segmentacion paginada (\"-sp\") necesita la tabla de paginas de cada segmento (novena linea del fichero de datos).\n");
+			liberarModelo(&t_imagen, t_registros, &t_paginacion, &t_segmentacion);
+			return 1;
+		}
+		t_segmentacion.paginada = segmentacionPaginada;
+		
+		if (opcionesTLB != NULL && !configurarTLB(&t_tlb, opcionesTLB, numProcesos)){
+			fprintf (stderr, "Error. Opciones de TLB incorrectas: \"%s\" (entradas,vias,lru|aleatorio,asid|vaciado[,tTLB,tMemoria]).\n", opcionesTLB);
+			liberarModelo(&t_imagen, t_registros, &t_paginacion, &t_segmentacion);
+			return 1;
+		}
+		
+		if (numMarcos > 0 && t_paginacion.tipo >= 2){
+			fprintf (stderr, "Error. La paginacion bajo demanda (\"-m\") necesita una PMT: no admite la tabla de paginas invertida ni la multinivel.\n");
+			if (opcionesTLB != NULL){
+				liberarTLB(&t_tlb);
+			}
+			liberarModelo(&t_imagen, t_registros, &t_paginacion, &t_segmentacion);
+			return 1;
+		}
+		
+		if (numMarcos > 0 && !configurarDemanda(&t_demanda, numMarcos, numProcesos)){
+			fprintf (stderr, "Error. No hay memoria suficiente para %d marcos.\n", numMarcos);
+			if (opcionesTLB != NULL){
+				liberarTLB(&t_tlb);
+			}
+			liberarModelo(&t_imagen, t_registros, &t_paginacion, &t_segmentacion);
+			return 1;
+		}
+		
+#ifdef _WIN32
+		numHilos = 1;		// Sin pthreads la traza se traduce en un solo hilo
+#else
+		if (numHilos == 0){
+			numHilos = (int)sysconf(_SC_NPROCESSORS_ONLN);
+		}
+#endif
+		if (numHilos > 1 && (opcionesTLB != NULL || numMarcos > 0)){
+			fprintf (stderr, "Aviso. La TLB y la paginacion bajo demanda dependen del orden de las direcciones: se usa un solo hilo.\n");
+			numHilos = 1;
+		}
+		
+		if (!crearEscritor(&t_salida, tamBufferSalida, formatoSalida, silencioso)){
+			fprintf (stderr, "Error. No hay memoria suficiente para la salida.\n");
+			estado = 1;
+		}
+		else{
+			anadirDestino(&t_salida, stdout);
+			
+			if (numHilos > 1){
+#ifndef _WIN32
+				estado = traducirTrazaParalela(traza, numHilos, numProcesos, t_registros, &t_paginacion, &t_segmentacion, &t_salida);
+#endif
+			}
+			else{
+				estado = traducirTraza(traza, numProcesos, t_registros, &t_paginacion, &t_segmentacion, (opcionesTLB != NULL) ? &t_tlb : NULL,
+									   (numMarcos > 0) ? &t_demanda : NULL, politicas, numPoliticas, &t_salida);
+			}
+			
+			liberarEscritor(&t_salida);
+		}
+		
+		if (opcionesTLB != NULL){
+			liberarTLB(&t_tlb);
+		}
+		if (numMarcos > 0){
+			liberarDemanda(&t_demanda);
+		}
+		liberarModelo(&t_imagen, t_registros, &t_paginacion, &t_segmentacion);
+		return estado;
+	}
+			
+	      
+    /**********************************************************/
+	/* Salida de la informacion por pantalla - Datos Procesos */
+	/**********************************************************/       
+
+    mostrarDatos(archivo, numProcesos, t_registros, &t_paginacion, &t_segmentacion);	
+    
+    
+	/*********************************************************************/
+	/* Salida de la informacion por pantalla - Traduccion de direcciones */
+	/*********************************************************************/
+	
+	traducirDirecciones(archivo, numProcesos, t_registros, &t_paginacion, &t_segmentacion, silencioso);
+	
+	liberarModelo(&t_imagen, t_registros, &t_paginacion, &t_segmentacion);
 	         
 	return 0;
 }
 
 
 //*************************************************************
-//*	Funcion:
-//*		Funcion que verifica si los datos del fichero de entrada
-//*		son correctos.
+//*	Funcion: 
+//* -------
+//*		Funciones del indice inverso de la memoria fisica, que
+//*			 obtiene los procesos y direcciones logicas que ocupan
+//*			 una direccion fisica con los tres metodos.
 //*
 //*
-//* Algoritmo:
-//*		El algoritmo va obteniendo los datos del fichero, comprobando
-//*		que detras de cada numero aparece un espacio o un salto de linea, dependiendo
-//*		de la situacion.
-//*		Ademas, la cantidad de valores debe ser correcta respecto a los valores
-//*		que se dan en el fichero.
-//*		Por otro lado, no permite que existan tamaños de pagina negativos,
-//*		y tampoco un valor de tipo de paginacion distinto de 0 o 1.
+//*
+//*	Algoritmo:
+//* ---------
+//*		construirIndiceInverso() se llama una sola vez tras cargar el
+//*		modelo. Las particiones y los segmentos se guardan como intervalos
+//*		ordenados por su inicio, con dos arboles sobre sus fines: uno de
+//*		segmentos con el mayor fin de cada rango y uno cartesiano, en el
+//*		que ningun intervalo acaba despues que su padre y cuyo recorrido en
+//*		orden es el de los intervalos. Ambos se construyen en O(n). Las paginas con marco se guardan como intervalos de
+//*		un solo valor ordenados por marco, tomados de la PMT, de la tabla
+//*		invertida o de las regiones de la tabla multinivel segun el tipo de
+//*		paginacion. Si los marcos no son muy dispersos se guarda ademas la
+//*		posicion de cada marco, para buscarlo directamente.
+//*
+//*		consultarIndiceInverso() busca con una busqueda binaria el ultimo
+//*		intervalo que empieza en la direccion o antes, y con el arbol de
+//*		segmentos el ultimo de ellos que acaba en ella o despues, que la
+//*		contiene. Los demas que la contienen son los anteriores que acaban
+//*		igual o despues (una cadena de punteros) y, en el arbol cartesiano,
+//*		los de sus subarboles izquierdos que la alcanzan: como un intervalo
+//*		no acaba despues que su padre, el recorrido no baja por los que no
+//*		la alcanzan. Cada consulta cuesta O(log n + k), siendo k los
+//*		intervalos que la contienen (varios con "-c" o si hay solapamientos),
+//*		y escribe los intervalos en su orden.
+//*		El marco de la direccion se busca en O(1) o en O(log n).
+//*		Escribe una linea por metodo y propietario:
+//*
+//*			direccion fisica	metodo	proceso	direccion logica
+//*
+//*		La direccion logica es el desplazamiento en la particion, el par
+//*		"segmento,desplazamiento" o la direccion de un valor de la pagina
+//*		(el par "pagina,desplazamiento" si no cabe en un entero). Si ningun
+//*		proceso ocupa la direccion con un metodo se escribe "-" y "LIBRE".
+//*
+//*		traducirInversa() construye el indice y responde las direcciones
+//*		fisicas de un fichero (o de la entrada estandar si es "-"), una
+//*		por linea; las lineas vacias y las que empiezan por '#' se ignoran.
 //*
 //*************************************************************
-int datosEntradaValidos (FILE * fp){
-	int i, j, k, l, numProcesos;
-	char aux;
+
+// Ordena los intervalos y construye sus dos arboles. Devuelve 0 si no hay memoria
+static int construirArbolIntervalos(arbolIntervalos *a){
+	int i, j, hijo;
 	
-	// Estructuras temporales para verificar la integridad de los datos del fichero
-	registro t_registros[max_procesos];		// Registro Base/Limite
-	paginacion t_paginacion;				// Paginacion
-	segmentacion t_segmentacion;			// Segmentacion	
+	for (a->hojas = 1 ; a->hojas < a->n ; a->hojas *= 2);
+	a->maximos = (long long*)malloc(sizeof(long long) * 2 * a->hojas);
+	a->anterior = (int*)malloc(sizeof(int) * (a->n + 1));
+	a->izquierdo = (int*)malloc(sizeof(int) * (a->n + 1));
+	a->derecho = (int*)malloc(sizeof(int) * (a->n + 1));
+	if (a->maximos == NULL || a->anterior == NULL || a->izquierdo == NULL || a->derecho == NULL){
+		return 0;
+	}
 	
-	rewind (fp);
+	qsort(a->v, a->n, sizeof(intervalo), compararIntervalos);
 	
-	// Lectura del numero de procesos
-    fscanf (fp, "%d", &numProcesos);    
-
-    fscanf (fp, "%c", &aux);
-	if (aux != '\n'){
-		printf ("Numero de procesos incorrecto.\n\n");
-		return 0;	
-	} 
-		
-    // Lectura de los valores RB y RL de cada proceso, asociados al metodo Registro Base/Limite
-    for(i=0 ; i < numProcesos ; i++){
-    	
-        fscanf (fp, "%d", &t_registros[i].base);
-
-        fscanf (fp, "%c", &aux);
-		if (aux != ' '){
-			printf ("Valores de RB/RL incorrectos.\n\n");
-			return 0;	
-		}
-        
-    	fscanf (fp, "%d", &t_registros[i].limite);                
-    		
-		if (i < numProcesos - 1){
-			fscanf (fp, "%c", &aux);
-			if (aux != ' '){
-				printf ("Valores de RB/RL incorrectos.\n\n");
-				return 0;	
-			}
-		}
-    }        
-    
-    fscanf (fp, "%c", &aux);
-	if (aux != '\n'){
-		printf ("Valores de RB/RL incorrectos.\n\n");
-		return 0;	
+	for (i = 0 ; i < a->hojas ; i++){
+		a->maximos[a->hojas + i] = (i < a->n) ? a->v[i].fin : LLONG_MIN;
 	}
-    
-    // Lectura de los registros RBTS y RLTS de cada proceso
-    for(i=0 ; i < numProcesos ; i++){
-        fscanf (fp, "%d", &t_segmentacion.RBTS_RLTS[i].base);
-        
-        fscanf (fp, "%c", &aux);
-		if (aux != ' '){
-			printf ("Valores de RBTS/RLTS incorrectos.\n\n");
-			return 0;	
-		}
-        
-        fscanf (fp, "%d", &t_segmentacion.RBTS_RLTS[i].limite);
-        
-		if (i < numProcesos - 1){
-			fscanf (fp, "%c", &aux);
-			if (aux != ' '){
-				printf ("Valores de RBTS/RLTS incorrectos.\n\n");
-				return 0;	
-			} 	
-		}   
-    }
-    
-    fscanf (fp, "%c", &aux);
-	if (aux != '\n'){
-		printf ("Valores de RBTS/RLTS incorrectos.\n\n");
-		return 0;	
+	for (i = a->hojas - 1 ; i > 0 ; i--){
+		a->maximos[i] = (a->maximos[2 * i] > a->maximos[2 * i + 1]) ? a->maximos[2 * i] : a->maximos[2 * i + 1];
 	}
 	
-	// Solo tenemos una SDT global. Comprobamos que los valores RBTS/RLTS de cada proceso
-	// no se sobreescriban
-    for(i=0 ; i < numProcesos ; i++){
-		for(j=0 ; j < numProcesos ; j++){
-			if (i != j){				
-		    	for (k = t_segmentacion.RBTS_RLTS[i].base; k <= t_segmentacion.RBTS_RLTS[i].base + t_segmentacion.RBTS_RLTS[i].limite; k++){
-		    		for (l = t_segmentacion.RBTS_RLTS[j].base; l <= t_segmentacion.RBTS_RLTS[j].base + t_segmentacion.RBTS_RLTS[j].limite; l++){
-		    			if (k == l){
-		    				printf ("Valores de RBTS/RLTS incorrectos.\n");
-		    				printf ("Se esta usando una SDT global y se han introducido valores que se sobreescriben.\n\n");
-							return 0;	
-		    			}
-		    		}
-		    	}
-		    }
-	    }
-    }  
-    
-    // Lectura de los registros RB y RL de cada segmento
-    for(i=0 ; i < numProcesos ; i++){
-    	for (j = t_segmentacion.RBTS_RLTS[i].base; j <= t_segmentacion.RBTS_RLTS[i].base + t_segmentacion.RBTS_RLTS[i].limite; j++){	        	
-            fscanf (fp, "%d", &t_segmentacion.SDT[j].base);
-            
-            fscanf (fp, "%c", &aux);
-			if (aux != ' '){
-				printf ("Valores de RB/RL de cada segmento incorrectos.\n\n");
-				return 0;	
-			}
-            
-        	fscanf (fp, "%d", &t_segmentacion.SDT[j].limite);
-        	
-        	if (i < numProcesos - 1 || j < t_segmentacion.RBTS_RLTS[i].base + t_segmentacion.RBTS_RLTS[i].limite){
-				fscanf (fp, "%c", &aux);
-				if (aux != ' '){
-					printf ("Valores de RB/RL de cada segmento incorrectos.\n\n");
-					return 0;	
-				}
-			} 
-    	}
-    }
-    
-    fscanf (fp, "%c", &aux);
-	if (aux != '\n'){
-		printf ("Valores de RB/RL de cada segmento incorrectos.\n\n");
-		return 0;	
+	// La cadena de anteriores de cada intervalo es la pila del arbol cartesiano: los que acaban antes
+	// que el nuevo salen de ella y pasan a ser su subarbol izquierdo
+	for (i = 0 ; i < a->n ; i++){
+		for (j = i - 1, hijo = -1 ; j >= 0 && a->v[j].fin < a->v[i].fin ; hijo = j, j = a->anterior[j]);
+		a->anterior[i] = j;
+		a->izquierdo[i] = hijo;
+		a->derecho[i] = -1;
+		if (j >= 0){
+			a->derecho[j] = i;
+		}
 	}
-    
-    // Lectura del tamaño de pagina
-    fscanf (fp, "%d", &t_paginacion.tamano);        
-    
-    fscanf (fp, "%c", &aux);
-	if (t_paginacion.tamano <= 0 || aux != '\n'){
-		printf ("Valor de tamanyo de pagina incorrecto.\n\n");
-		return 0;	
+	return 1;
+}
+
+// Libera los intervalos y sus arboles
+static void liberarArbolIntervalos(arbolIntervalos *a){
+	free(a->v);
+	free(a->maximos);
+	free(a->anterior);
+	free(a->izquierdo);
+	free(a->derecho);
+}
+
+// Posicion del ultimo intervalo hasta "i" que acaba en "valor" o despues, o -1 si no hay ninguno
+static int ultimoAlcanza(const arbolIntervalos *a, int i, int valor){
+	int nodo;
+	
+	if (i < 0){
+		return -1;
 	}
-    
-    // Lectura del tipo de paginacion
-    fscanf (fp, "%d", &t_paginacion.tipo);
-    
-    fscanf (fp, "%c", &aux);
-	if ((t_paginacion.tipo != 0 && t_paginacion.tipo != 1) || aux != '\n'){
-		printf ("Valor de tipo de paginacion incorrecto.\n\n");
-		return 0;	
+	nodo = a->hojas + i;
+	if (a->maximos[nodo] >= valor){
+		return i;
 	}
-    
-    // Lectura de los registros RBTP y RLTP de cada proceso
-    for(i=0 ; i < numProcesos ; i++){
-        fscanf (fp, "%d", &t_paginacion.RBTP_RLTP[i].base);
-        
-        fscanf (fp, "%c", &aux);
-		if (aux != ' '){
-			printf ("Valores de RBTP/RLTP incorrectos.\n\n");
-			return 0;	
-		}
-        
-        fscanf (fp, "%d", &t_paginacion.RBTP_RLTP[i].limite);
-        
-		if (i < numProcesos - 1){
-			fscanf (fp, "%c", &aux);
-			if (aux != ' '){
-				printf ("Valores de RBTP/RLTP incorrectos.\n\n");
-				return 0;	
-			}
-		}         
-    }
-    
-    // Si tenemos una PMT Global, los RBTP y RLTP no deben sobreescribirse
-    if (t_paginacion.tipo == 0){
-    	for(i=0 ; i < numProcesos ; i++){
-			for(j=0 ; j < numProcesos ; j++){
-				if (i != j){				
-			    	for (k = t_paginacion.RBTP_RLTP[i].base; k <= t_paginacion.RBTP_RLTP[i].base + t_paginacion.RBTP_RLTP[i].limite; k++){
-			    		for (l = t_paginacion.RBTP_RLTP[j].base; l <= t_paginacion.RBTP_RLTP[j].base + t_paginacion.RBTP_RLTP[j].limite; l++){
-			    			if (k == l){
-			    				printf ("Valores de RBTP/RLTP incorrectos.\n");
-			    				printf ("Se esta usando una PMT global y se han introducido valores para una PMT por proceso.\n\n");
-								return 0;	
-			    			}
-			    		}
-			    	}
-			    }
-		    }
-	    } 	    	
-    }
-    
-    fscanf (fp, "%c", &aux);
-	if (aux != '\n'){
-		printf ("Valores de RBTP/RLTP incorrectos.\n\n");
-		return 0;	
+	
+	// Sube hasta un nodo cuyo hermano izquierdo tenga algun intervalo que alcance el valor y baja por el ultimo
+	while (nodo > 1 && !((nodo & 1) && a->maximos[nodo - 1] >= valor)){
+		nodo /= 2;
+	}
+	if (nodo <= 1){
+		return -1;
 	}
+	for (nodo-- ; nodo < a->hojas ; nodo = (a->maximos[2 * nodo + 1] >= valor) ? 2 * nodo + 1 : 2 * nodo);
+	return nodo - a->hojas;
+}
 
-	// Lectura del marco de pagina asociado a cada pagina de cada proceso
-    for(i=0 ; i < numProcesos ; i++){
-        for (j = t_paginacion.RBTP_RLTP[i].base; j <= t_paginacion.RBTP_RLTP[i].base + t_paginacion.RBTP_RLTP[i].limite; j++){	        	
-        	if (t_paginacion.tipo == 0){
-	        	// PMT Global
-	        	fscanf (fp, "%d", &t_paginacion.PMT_Global[j]);
-	        }
-	        else{
-	        	// PMT por proceso
-	        	fscanf (fp, "%d", &t_paginacion.PMT[i][j]);
-	        }		          
-	        
-	        if (i < numProcesos - 1 || j < t_paginacion.RBTP_RLTP[i].base + t_paginacion.RBTP_RLTP[i].limite){
-				fscanf (fp, "%c", &aux);
-				if (aux != ' '){
-					printf ("Valores de marcos de pagina asociados a cada pagina de cada proceso incorrectos.\n\n");
-					return 0;	
-				}
-			} 
-       	}
-    }
-    
-    // Si no se ha llegado a final de fichero...
-    if (!feof(fp)){
-    	fscanf (fp, "%c", &aux);
-    
-		// Si el siguiente caracter no es un espacio o un salto de linea...	
-		if (aux != 32 && aux != 10){
-			printf ("Final de fichero incorrecto.\n\n");
-			return 0;
-		}else{
-			fscanf (fp, "%c", &aux);
-			
-			// Si no se ha llegado a final de fichero...
-			if (!feof(fp)){
-				printf ("Final de fichero incorrecto.\n\n");
-				return 0;		
+// Posicion del ultimo intervalo que empieza en "valor" o antes, o -1 si no hay ninguno
+static int ultimoAnterior(const intervalo v[], int n, int valor){
+	int izq = 0, der = n, m;
+	
+	while (izq < der){
+		m = izq + (der - izq) / 2;
+		if (v[m].inicio <= valor){
+			izq = m + 1;
+		}
+		else{
+			der = m;
+		}
+	}
+	return izq - 1;
+}
+
+int construirIndiceInverso(indiceInverso *x, int numProcesos, const registro t_registros[], const paginacion *t_paginacion, const segmentacion *t_segmentacion){
+	int i, j, k, n;
+	size_t paginas = 0;
+	
+	memset(x, 0, sizeof(indiceInverso));
+	x->maxMarco = -1;
+	x->tamano = t_paginacion->tamano;
+	
+	// Paginas con marco, para reservar su espacio
+	if (t_paginacion->tipo == 3){
+		for (i = 0 ; i < t_paginacion->numRegiones ; i++){
+			paginas += t_paginacion->regiones[i].paginas;
+		}
+	}
+	else{
+		paginas = (t_paginacion->tipo == 2) ? t_paginacion->numMarcos : t_paginacion->numEntradas;
+	}
+	if (paginas >= INT_MAX){
+		return 0;
+	}
+	
+	x->particiones.v = (intervalo*)malloc(sizeof(intervalo) * (numProcesos + 1));
+	x->segmentos.v = (intervalo*)malloc(sizeof(intervalo) * (t_segmentacion->numSegmentos + 1));
+	x->marcos = (intervalo*)malloc(sizeof(intervalo) * (paginas + 1));
+	x->pila = (int*)malloc(sizeof(int) * ((numProcesos > t_segmentacion->numSegmentos) ? numProcesos + 1 : t_segmentacion->numSegmentos + 1));
+	if (x->particiones.v == NULL || x->segmentos.v == NULL || x->marcos == NULL || x->pila == NULL){
+		liberarIndiceInverso(x);
+		return 0;
+	}
+	
+	// Particiones del metodo registro base/limite
+	for (i = 0, n = 0 ; i < numProcesos ; i++){
+		if (t_registros[i].limite >= 0){
+			x->particiones.v[n].inicio = t_registros[i].base;
+			x->particiones.v[n].fin = (long long)t_registros[i].base + t_registros[i].limite;
+			x->particiones.v[n].proceso = i;
+			x->particiones.v[n].indice = i;
+			n++;
+		}
+	}
+	x->particiones.n = n;
+	
+	// Segmentos de la SDT
+	for (i = 0, n = 0 ; i < numProcesos ; i++){
+		for (j = 0 ; j <= t_segmentacion->RBTS_RLTS[i].limite ; j++){
+			k = t_segmentacion->desplazamientoSDT[i] + j;
+			if (t_segmentacion->SDT[k].limite >= 0){
+				x->segmentos.v[n].inicio = t_segmentacion->SDT[k].base;
+				x->segmentos.v[n].fin = (long long)t_segmentacion->SDT[k].base + t_segmentacion->SDT[k].limite;
+				x->segmentos.v[n].proceso = i;
+				x->segmentos.v[n].indice = j;
+				n++;
 			}
 		}
-    }
-    	
+	}
+	x->segmentos.n = n;
+	
+	// Marcos de pagina: regiones de la tabla multinivel, tabla invertida o PMT
+	n = 0;
+	for (i = 0 ; t_paginacion->tipo == 3 && i < t_paginacion->numRegiones ; i++){
+		for (j = 0 ; j < t_paginacion->regiones[i].paginas ; j++){
+			x->marcos[n].inicio = x->marcos[n].fin = t_paginacion->regiones[i].marco + j;
+			x->marcos[n].proceso = t_paginacion->regiones[i].proceso;
+			x->marcos[n].indice = t_paginacion->regiones[i].pagina + j;
+			n++;
+		}
+	}
+	
+	for (k = 0 ; t_paginacion->tipo == 2 && k < t_paginacion->numMarcos ; k++){
+		if (t_paginacion->invertida[k].proceso >= 0){
+			x->marcos[n].inicio = x->marcos[n].fin = k;
+			x->marcos[n].proceso = t_paginacion->invertida[k].proceso;
+			x->marcos[n].indice = t_paginacion->invertida[k].pagina;
+			n++;
+		}
+	}
+	
+	for (i = 0 ; t_paginacion->tipo < 2 && i < numProcesos ; i++){
+		for (j = 0 ; j <= t_paginacion->RBTP_RLTP[i].limite ; j++){
+			k = t_paginacion->PMT[t_paginacion->desplazamientoPMT[i] + j];
+			if (k >= 0){
+				x->marcos[n].inicio = x->marcos[n].fin = k;
+				x->marcos[n].proceso = i;
+				x->marcos[n].indice = j;
+				n++;
+			}
+		}
+	}
+	x->numMarcos = n;
+	
+	if (!construirArbolIntervalos(&x->particiones) || !construirArbolIntervalos(&x->segmentos)){
+		liberarIndiceInverso(x);
+		return 0;
+	}
+	
+	qsort(x->marcos, x->numMarcos, sizeof(intervalo), compararIntervalos);
+	
+	// Posicion directa de cada marco, si no ocupa mas de 16 enteros por pagina
+	if (x->numMarcos > 0){
+		x->maxMarco = x->marcos[x->numMarcos - 1].inicio;
+	}
+	if (x->maxMarco >= 0 && x->maxMarco / 16 <= x->numMarcos){
+		x->posicionMarco = (int*)malloc(sizeof(int) * ((size_t)x->maxMarco + 2));
+	}
+	if (x->posicionMarco != NULL){
+		for (k = 0, n = 0 ; k <= x->maxMarco + 1 ; k++){
+			while (n < x->numMarcos && x->marcos[n].inicio < k){
+				n++;
+			}
+			x->posicionMarco[k] = n;
+		}
+	}
+	
+	return 1;
+}
+
+void liberarIndiceInverso(indiceInverso *x){
+	liberarArbolIntervalos(&x->particiones);
+	liberarArbolIntervalos(&x->segmentos);
+	free(x->pila);
+	free(x->marcos);
+	free(x->posicionMarco);
+	memset(x, 0, sizeof(indiceInverso));
+}
+
+// Escribe el comienzo de una linea de la consulta: direccion fisica, metodo y proceso
+static void escribirPropietario(escritor *e, int dFisica, const char *metodo, int proceso){
+	escribirEntero(e, dFisica);
+	escribirCadena(e, metodo);
+	escribirEntero(e, proceso);
+	escribirCadena(e, "\t");
+}
+
+// Escribe la linea de un intervalo que contiene la direccion fisica
+static void escribirIntervalo(escritor *e, const intervalo *v, int dFisica, const char *metodo, int segmentos){
+	escribirPropietario(e, dFisica, metodo, v->proceso);
+	if (segmentos){
+		escribirEntero(e, v->indice);
+		escribirCadena(e, ",");
+	}
+	escribirEntero(e, dFisica - v->inicio);
+	escribirCadena(e, "\n");
+}
+
+// Escribe en orden los intervalos que contienen la direccion fisica, o la linea de direccion libre
+static void consultarIntervalos(escritor *e, const arbolIntervalos *a, int pila[], int dFisica, const char *metodo, int segmentos){
+	int i, nodo, cadena = 0, cima;
+	
+	// El ultimo que la contiene y sus anteriores que acaban igual o despues, del ultimo al primero
+	for (i = ultimoAlcanza(a, ultimoAnterior(a->v, a->n, dFisica), dFisica) ; i >= 0 ; i = a->anterior[i]){
+		pila[cadena++] = i;
+	}
+	
+	// Cada uno va detras de los de su subarbol izquierdo que la alcanzan, recorridos en orden encima de la cadena
+	for (i = cadena - 1 ; i >= 0 ; i--){
+		cima = cadena;
+		nodo = a->izquierdo[pila[i]];
+		for (;;){
+			if (nodo >= 0 && a->v[nodo].fin >= dFisica){
+				pila[cima++] = nodo;
+				nodo = a->izquierdo[nodo];
+			}
+			else if (cima > cadena){
+				nodo = pila[--cima];
+				escribirIntervalo(e, &a->v[nodo], dFisica, metodo, segmentos);
+				nodo = a->derecho[nodo];
+			}
+			else{
+				break;
+			}
+		}
+		escribirIntervalo(e, &a->v[pila[i]], dFisica, metodo, segmentos);
+	}
+	
+	if (cadena == 0){
+		escribirEntero(e, dFisica);
+		escribirCadena(e, metodo);
+		escribirCadena(e, "-\tLIBRE\n");
+	}
+}
+
+void consultarIndiceInverso(indiceInverso *x, int dFisica, escritor *e){
+	int a, b, k, marco, desplazamiento;
+	long long dLogica;
+	
+	consultarIntervalos(e, &x->particiones, x->pila, dFisica, "\tbase/limite\t", 0);
+	consultarIntervalos(e, &x->segmentos, x->pila, dFisica, "\tsegmentacion\t", 1);
+	
+	// Paginas cargadas en el marco de la direccion: posiciones [a, b) de "marcos"
+	marco = dFisica / x->tamano;
+	desplazamiento = dFisica % x->tamano;
+	if (x->posicionMarco != NULL){
+		a = b = 0;
+		if (marco <= x->maxMarco){
+			a = x->posicionMarco[marco];
+			b = x->posicionMarco[marco + 1];
+		}
+	}
+	else{
+		a = ultimoAnterior(x->marcos, x->numMarcos, marco - 1) + 1;
+		b = ultimoAnterior(x->marcos, x->numMarcos, marco) + 1;
+	}
+	
+	for (k = a ; k < b ; k++){
+		escribirPropietario(e, dFisica, "\tpaginacion\t", x->marcos[k].proceso);
+		dLogica = (long long)x->marcos[k].indice * x->tamano + desplazamiento;
+		if (dLogica <= INT_MAX){
+			escribirEntero(e, (int)dLogica);
+		}
+		else{
+			escribirEntero(e, x->marcos[k].indice);
+			escribirCadena(e, ",");
+			escribirEntero(e, desplazamiento);
+		}
+		escribirCadena(e, "\n");
+	}
+	
+	if (a == b){
+		escribirEntero(e, dFisica);
+		escribirCadena(e, "\tpaginacion\t-\tLIBRE\n");
+	}
+}
+
+// Lee una direccion fisica de una linea: 1 si la hay, 0 si la linea esta vacia o es un comentario y -1 si no es valida
+static int leerDireccionFisica(const char *linea, int *dFisica){
+	char *fin;
+	long valor;
+	
+	while (*linea == ' ' || *linea == '\t'){
+		linea++;
+	}
+	
+	if (*linea == '\0' || *linea == '\n' || *linea == '\r' || *linea == '#'){
+		return 0;
+	}
+	
+	valor = strtol(linea, &fin, 10);
+	if (fin == linea || valor < 0 || valor > INT_MAX){
+		return -1;
+	}
+	
+	while (*fin == ' ' || *fin == '\t' || *fin == '\r' || *fin == '\n'){
+		fin++;
+	}
+	if (*fin != '\0'){
+		return -1;
+	}
+	
+	*dFisica = (int)valor;
 	return 1;
 }
 
+int traducirInversa(char *consultas, int numProcesos, const registro t_registros[], const paginacion *t_paginacion, const segmentacion *t_segmentacion, escritor *salida){
+	FILE *fp;
+	char linea[longitudLinea];
+	indiceInverso x;
+	int estado, dFisica;
+	long nLinea = 0, nDirecciones = 0;
+	double inicio = segundosReloj(), construido;
+	
+	if (strcmp(consultas, "-") == 0){
+		fp = stdin;
+	}
+	else if ((fp = fopen(consultas, "r")) == NULL){
+		fprintf (stderr, "Error. No ha sido posible abrir el fichero de direcciones fisicas \"%s\".\n", consultas);
+		return 1;
+	}
+	
+	if (!construirIndiceInverso(&x, numProcesos, t_registros, t_paginacion, t_segmentacion)){
+		fprintf (stderr, "Error. No hay memoria suficiente para el indice inverso.\n");
+		if (fp != stdin){
+			fclose(fp);
+		}
+		return 1;
+	}
+	construido = segundosReloj();
+	
+	if (!salida->silencioso){
+		escribirCadena(salida, "# direccion fisica\tmetodo\tproceso\tdireccion logica\n");
+	}
+	
+	while (fgets(linea, longitudLinea, fp) != NULL){
+		nLinea++;
+		
+		estado = leerDireccionFisica(linea, &dFisica);
+		if (estado < 0){
+			fprintf (stderr, "Linea %ld de las direcciones fisicas incorrecta. Se ignora.\n", nLinea);
+			continue;
+		}
+		if (estado == 1){
+			consultarIndiceInverso(&x, dFisica, salida);
+			nDirecciones++;
+		}
+	}
+	
+	vaciarEscritor(salida);
+	
+	if (fp != stdin){
+		fclose(fp);
+	}
+	
+	if (!salida->silencioso){
+		fprintf (stderr, "Indice inverso: %d particiones, %d segmentos y %d paginas con marco (%s), construido en %.3f segundos.\n",
+				 x.particiones.n, x.segmentos.n, x.numMarcos, (x.posicionMarco != NULL) ? "acceso directo por marco" : "busqueda binaria por marco", construido - inicio);
+		fprintf (stderr, "Consultadas %ld direcciones fisicas en %.3f segundos.\n", nDirecciones, segundosReloj() - construido);
+	}
+	
+	liberarIndiceInverso(&x);
+	return 0;
+}
+
 
 
 //*************************************************************
-//*	Funcion:
-//*		Funcion que lee los datos de fichero y los almacena
-//*			 en las correspondientes variables.
+//*	Funcion: 
+//* -------
+//*		Funciones del escritor con buffer que usan todas las salidas
+//*			 de resultados.
 //*
 //*
-//* Algoritmo:
-//*		El algoritmo va obteniendo valores enteros del fichero
-//* 	de entrada y asignandolos a las distintas variables y
-//*		estructuras utilizadas.
-//*		Es necesario que el fichero de entrada este en el formato de entrada
-//*		pedido, tanto en sintaxis como en cantidad de informacion, no pudiendo
-//*		tener mas o menos informacion de la necesaria.	
+//*
+//*	Algoritmo:
+//* ---------
+//*		El texto se da formato una sola vez en un buffer grande, que se
+//*		vuelca con fwrite() en cada uno de sus destinos (pantalla, fichero)
+//*		cuando se llena o con vaciarEscritor(). Sin destinos, el buffer
+//*		crece y el resultado se queda en memoria (lo usan los hilos del
+//*		modo paralelo); si no hay memoria suficiente se marca el error y se
+//*		descarta lo que no cabe.
+//*		escribirEntero() convierte el numero a texto sin printf(), porque
+//*		en la traduccion de trazas el formato de cada numero es la mayor
+//*		parte del tiempo de escritura.
 //*
 //*************************************************************
-void leerDatos(FILE *fp, int *numProcesos, registro t_registros[], paginacion *t_paginacion, segmentacion *t_segmentacion){        
-	int i, j, aux;
+int crearEscritor(escritor *e, size_t capacidad, int formato, int silencioso){
+	e->capacidad = capacidad;
+	e->longitud = 0;
+	e->numDestinos = 0;
+	e->formato = formato;
+	e->silencioso = silencioso;
+	e->error = 0;
 	
-	// Lectura del numero de procesos
-    fscanf (fp, "%d", numProcesos);
+	return (e->datos = (char*)malloc(capacidad)) != NULL;
+}
 
-    // Lectura de los valores RB y RL de cada proceso, asociados al metodo Registro Base/Limite
-    for(i=0 ; i < *numProcesos ; i++){
-        fscanf (fp, "%d", &t_registros[i].base);
-    	fscanf (fp, "%d", &t_registros[i].limite);                
-    }
-    
-    // Lectura de los registros RBTS y RLTS de cada proceso
-    for(i=0 ; i < *numProcesos ; i++){
-        fscanf (fp, "%d", &t_segmentacion->RBTS_RLTS[i].base);
-        fscanf (fp, "%d", &t_segmentacion->RBTS_RLTS[i].limite);
-    }
-    
-    // Lectura de los registros RB y RL de cada segmento
-    for(i=0 ; i < *numProcesos ; i++){
-    	for (j = t_segmentacion->RBTS_RLTS[i].base; j <= t_segmentacion->RBTS_RLTS[i].base + t_segmentacion->RBTS_RLTS[i].limite; j++){	        	
-            fscanf (fp, "%d", &t_segmentacion->SDT[j].base);
-        	fscanf (fp, "%d", &t_segmentacion->SDT[j].limite);
-    	}
-    }
-    
-    // Lectura del tamaño de pagina
-    fscanf (fp, "%d", &t_paginacion->tamano);
-    
-    // Lectura del tipo de paginacion
-    fscanf (fp, "%d", &t_paginacion->tipo);
-    
-    // Lectura de los registros RBTP y RLTP de cada proceso
-    for(i=0 ; i < *numProcesos ; i++){
-        fscanf (fp, "%d", &t_paginacion->RBTP_RLTP[i].base);
-        fscanf (fp, "%d", &t_paginacion->RBTP_RLTP[i].limite);
-    }
+void liberarEscritor(escritor *e){
+	vaciarEscritor(e);
+	free(e->datos);
+	e->datos = NULL;
+}
 
-	// Lectura del marco de pagina asociado a cada pagina de cada proceso
-    for(i=0 ; i < *numProcesos ; i++){
-        for (j = t_paginacion->RBTP_RLTP[i].base; j <= t_paginacion->RBTP_RLTP[i].base + t_paginacion->RBTP_RLTP[i].limite; j++){	        	
-        	if (t_paginacion->tipo == 0){
-	        	// PMT Global
-	        	fscanf (fp, "%d", &t_paginacion->PMT_Global[j]);
-	        }
-	        else{
-	        	// PMT por proceso
-	        	fscanf (fp, "%d", &t_paginacion->PMT[i][j]);
-	        }		          
-       	}
-    }
+void anadirDestino(escritor *e, FILE *destino){
+	if (e->numDestinos < maxDestinos){
+		e->destinos[e->numDestinos++] = destino;
+	}
+}
+
+void vaciarEscritor(escritor *e){
+	int i;
+	
+	for (i = 0 ; i < e->numDestinos ; i++){
+		fwrite(e->datos, 1, e->longitud, e->destinos[i]);
+		fflush(e->destinos[i]);
+	}
+	
+	if (e->numDestinos > 0){
+		e->longitud = 0;
+	}
+}
+
+// Asegura que caben n caracteres mas en el buffer, vaciandolo o haciendolo crecer. Devuelve 0 si no es posible
+static int reservarEscritor(escritor *e, size_t n){
+	char *aux;
+	size_t capacidad;
+	
+	if (e->longitud + n <= e->capacidad){
+		return 1;
+	}
+	
+	if (e->numDestinos > 0){
+		vaciarEscritor(e);
+		if (n <= e->capacidad){
+			return 1;
+		}
+	}
+	
+	for (capacidad = 2 * e->capacidad ; capacidad < e->longitud + n ; capacidad *= 2);
+	if ((aux = (char*)realloc(e->datos, capacidad)) == NULL){
+		e->error = 1;
+		return 0;
+	}
+	e->datos = aux;
+	e->capacidad = capacidad;
+	return 1;
+}
+
+void escribirDatos(escritor *e, const void *datos, size_t n){
+	int i;
+	
+	// Los bloques mayores que el buffer se escriben directamente en los destinos
+	if (e->numDestinos > 0 && n > e->capacidad){
+		vaciarEscritor(e);
+		for (i = 0 ; i < e->numDestinos ; i++){
+			fwrite(datos, 1, n, e->destinos[i]);
+		}
+		return;
+	}
+	
+	if (reservarEscritor(e, n)){
+		memcpy(e->datos + e->longitud, datos, n);
+		e->longitud += n;
+	}
+}
+
+void escribirCadena(escritor *e, const char *cadena){
+	escribirDatos(e, cadena, strlen(cadena));
+}
+
+void escribirEntero(escritor *e, int valor){
+	char cifras[12];
+	int n = 0;
+	unsigned int v = (valor < 0) ? 0u - (unsigned int)valor : (unsigned int)valor;
+	
+	if (!reservarEscritor(e, 12)){
+		return;
+	}
+	
+	do{
+		cifras[n++] = (char)('0' + v % 10);
+		v /= 10;
+	}while (v > 0);
+	
+	if (valor < 0){
+		e->datos[e->longitud++] = '-';
+	}
+	while (n > 0){
+		e->datos[e->longitud++] = cifras[--n];
+	}
+}
 
+void escribirFormato(escritor *e, const char *formato, ...){
+	va_list argumentos;
+	int n;
+	
+	va_start(argumentos, formato);
+	n = vsnprintf(e->datos + e->longitud, e->capacidad - e->longitud, formato, argumentos);
+	va_end(argumentos);
+	
+	if (n < 0){
+		return;
+	}
+	
+	// Si no cabia, se hace sitio y se vuelve a dar formato
+	if ((size_t)n >= e->capacidad - e->longitud){
+		if (!reservarEscritor(e, (size_t)n + 1)){
+			return;
+		}
+		va_start(argumentos, formato);
+		vsnprintf(e->datos + e->longitud, e->capacidad - e->longitud, formato, argumentos);
+		va_end(argumentos);
+	}
+	
+	e->longitud += (size_t)n;
 }
 
 
@@ -563,8 +1801,9 @@ void leerDatos(FILE *fp, int *numProcesos, registro t_registros[], paginacion *t
 //* 	los distintos sistemas de gestion de memoria.
 //*
 //*************************************************************
-void mostrarDatos(char *archivo, int numProcesos, registro t_registros[], paginacion t_paginacion, segmentacion t_segmentacion){        
-	int i, j;
+void mostrarDatos(char *archivo, int numProcesos, const registro t_registros[], const paginacion *t_paginacion, const segmentacion *t_segmentacion){        
+	int i, j, k;
+	registro tabla;
 	
 	system("cls");        
 	
@@ -579,44 +1818,63 @@ void mostrarDatos(char *archivo, int numProcesos, registro t_registros[], pagina
            
     printf ("\n\nValores de cada proceso con el metodo de segmentacion:\n\n");
     for(i=0 ; i < numProcesos ; i++){
-        printf ("\tProceso %d: RBTS = %d, RLTS = %d\n", i, t_segmentacion.RBTS_RLTS[i].base, t_segmentacion.RBTS_RLTS[i].limite);
+        printf ("\tProceso %d: RBTS = %d, RLTS = %d\n", i, t_segmentacion->RBTS_RLTS[i].base, t_segmentacion->RBTS_RLTS[i].limite);
     }             		
 	
 	printf ("\n\nValores de los registros base y limite de cada segmento de cada proceso:\n\n");
 	for(i=0 ; i < numProcesos ; i++){
 		printf ("Entradas en la SDT del Proceso %d:\n", i);
-    	for (j = t_segmentacion.RBTS_RLTS[i].base; j <= t_segmentacion.RBTS_RLTS[i].base + t_segmentacion.RBTS_RLTS[i].limite; j++){	        	
-    		printf ("\t[%d] %d - %d\n", j, t_segmentacion.SDT[j].base, t_segmentacion.SDT[j].limite);
+    	for (j = 0; j <= t_segmentacion->RBTS_RLTS[i].limite; j++){	        	
+    		printf ("\t[%d] %d - %d\n", t_segmentacion->RBTS_RLTS[i].base + j, t_segmentacion->SDT[t_segmentacion->desplazamientoSDT[i] + j].base, t_segmentacion->SDT[t_segmentacion->desplazamientoSDT[i] + j].limite);
     	}
     } 
     
-    printf ("\n\nTamano de pagina: %d\n", t_paginacion.tamano);
+    if (t_segmentacion->tablasSegmentos != NULL){
+    	printf ("\n\nMarcos de pagina asociados a cada pagina de cada segmento (segmentacion paginada):\n\n");
+    	for(i=0 ; i < numProcesos ; i++){
+    		for (j = 0; j <= t_segmentacion->RBTS_RLTS[i].limite; j++){
+    			tabla = t_segmentacion->tablasSegmentos[t_segmentacion->desplazamientoSDT[i] + j];
+    			printf ("Tabla de paginas del Segmento %d del Proceso %d:\n", j, i);
+    			for (k = 0; k <= tabla.limite; k++){
+    				printf ("\t[%d] %d\n", k, t_segmentacion->marcosSegmentos[tabla.base + k]);
+    			}
+    		}
+    	}
+    }
+    
+    printf ("\n\nTamano de pagina: %d\n", t_paginacion->tamano);
     
     printf ("\nValores de cada proceso con el metodo de paginacion:\n\n");
     for(i=0 ; i < numProcesos ; i++){
-        printf ("\tProceso %d: RBTP = %d, RLTP = %d\n", i, t_paginacion.RBTP_RLTP[i].base, t_paginacion.RBTP_RLTP[i].limite);
+        printf ("\tProceso %d: RBTP = %d, RLTP = %d\n", i, t_paginacion->RBTP_RLTP[i].base, t_paginacion->RBTP_RLTP[i].limite);
     }		 
     
     printf ("\n\nValores del marco de pagina asociado a cada pagina de cada proceso:\n\n");
-	for(i=0 ; i < numProcesos ; i++){
+	for(i=0 ; i < numProcesos && t_paginacion->tipo == 3 ; i++){
+		/* Tabla multinivel: solo las regiones con marco */
+		printf ("Regiones del Proceso %d en la tabla multinivel:\n", i);
+		for (j = 0; j < t_paginacion->numRegiones; j++){
+			if (t_paginacion->regiones[j].proceso == i){
+				printf ("\t[%d-%d] %d-%d\n", t_paginacion->regiones[j].pagina, t_paginacion->regiones[j].pagina + t_paginacion->regiones[j].paginas - 1,
+						t_paginacion->regiones[j].marco, t_paginacion->regiones[j].marco + t_paginacion->regiones[j].paginas - 1);
+			}
+		}
+	}
+	for(i=0 ; i < numProcesos && t_paginacion->tipo != 3 ; i++){
 		
-		if (t_paginacion.tipo == 0){
+		if (t_paginacion->tipo == 0){
 			/* PMT Global */
 			printf ("Entradas del Proceso %d en la PMT Global:\n", i);
+		}else if (t_paginacion->tipo == 2){
+			/* Tabla invertida */
+			printf ("Paginas del Proceso %d en la tabla invertida:\n", i);
 		}else{
 			/* PMT por proceso */
 			printf ("Entradas en la PMT del Proceso %d:\n", i);
 		}
 		
-    	for (j = t_paginacion.RBTP_RLTP[i].base; j <= t_paginacion.RBTP_RLTP[i].base + t_paginacion.RBTP_RLTP[i].limite; j++){	        
-			if (t_paginacion.tipo == 0){
-	        	/* PMT Global */
-	        	printf ("\t[%d] %d\n", j, t_paginacion.PMT_Global[j]);
-	        }
-	        else{
-	        	/* PMT por proceso */
-	        	printf ("\t[%d] %d\n", j, t_paginacion.PMT[i][j]);
-	        }		                  		
+    	for (j = 0; j <= t_paginacion->RBTP_RLTP[i].limite; j++){	        
+        	printf ("\t[%d] %d\n", t_paginacion->RBTP_RLTP[i].base + j, buscarMarco(t_paginacion, i, j));
     	}
     } 		        
     
@@ -654,8 +1912,9 @@ void mostrarDatos(char *archivo, int numProcesos, registro t_registros[], pagina
 //*       	- Error. Formato Incompatible.
 //*
 //*************************************************************
-void traducirDirecciones(char *archivo, int numProcesos, registro t_registros[], paginacion t_paginacion, segmentacion t_segmentacion){
+void traducirDirecciones(char *archivo, int numProcesos, const registro t_registros[], const paginacion *t_paginacion, const segmentacion *t_segmentacion, int silencioso){
 	FILE *fp;
+	escritor e;
 	int i, opcion, dLogica, marco, nPag_Seg, nInstruccion, nPaginas, nSegmentos;
 	registro segmento;	
 	char *salida = (char*)malloc(sizeof(char) * 100);		// Nombre del archivo de salida
@@ -664,13 +1923,20 @@ void traducirDirecciones(char *archivo, int numProcesos, registro t_registros[],
 	strcpy (salida, "Salida_");
 	strcat (salida, archivo);
 	    	
-	if((fp=fopen(salida,"w"))==NULL){
+	if((fp=fopen(salida,"w"))==NULL || !crearEscritor(&e, tamBufferSalida, SALIDA_TEXTO, silencioso)){
 		system("cls");
 		printf ("Error. No ha sido posible abrir archivo de salida.\n");
 		system("pause");
+		if (fp != NULL){
+			fclose(fp);
+		}
 	}
     else{
     	
+    	/* Cada linea se escribe una sola vez y se vuelca a la pantalla y al fichero */
+    	anadirDestino(&e, stdout);
+    	anadirDestino(&e, fp);
+    	
     	do{
 		  	system("cls");
 
@@ -684,174 +1950,150 @@ void traducirDirecciones(char *archivo, int numProcesos, registro t_registros[],
 			
 			system("cls");
 						
-			validarDireccion(opcion, fp, &dLogica, &nPag_Seg, &nInstruccion);
+			validarDireccion(opcion, &e, fp, &dLogica, &nPag_Seg, &nInstruccion);
 			
 			switch (opcion){
 				case 1:
 				case 2:
 					for (i = 0 ; i < numProcesos ; i++){
-						printf ("\t\t----------------------------------\n");		fprintf (fp, "\t\t----------------------------------\n");
-						printf ("\t\tDirecciones Fisicas del Proceso %d\n", i);		fprintf (fp, "\t\tDirecciones Fisicas del Proceso %d\n", i);
-						printf ("\t\t----------------------------------\n\n");		fprintf (fp, "\t\t----------------------------------\n\n");
-						
-						printf ("********************\n");							fprintf (fp, "********************\n");
-						printf ("Registro Base/Limite\n");							fprintf (fp, "Registro Base/Limite\n");
-						printf ("********************\n\n");						fprintf (fp, "********************\n\n");
+						if (!silencioso){
+							escribirFormato (&e, "\t\t----------------------------------\n");
+							escribirFormato (&e, "\t\tDirecciones Fisicas del Proceso %d\n", i);
+							escribirFormato (&e, "\t\t----------------------------------\n\n");
+							
+							escribirFormato (&e, "********************\n");
+							escribirFormato (&e, "Registro Base/Limite\n");
+							escribirFormato (&e, "********************\n\n");
+						}
+						else{
+							escribirFormato (&e, "Proceso %d\n", i);
+						}
 						
 	
 						// Mostramos uns salida en funcion del tipo de dato introducido y su valor
 						if (opcion == 1){
 							// Valores de registro Base/Limite del proceso.		
-							printf ("\tBase: %d\tLimite: %d\t(Ultima direccion: %d)\n\n", t_registros[i].base, t_registros[i].limite, t_registros[i].base + t_registros[i].limite);
-							fprintf (fp, "\tBase: %d\tLimite: %d\t(Ultima direccion: %d)\n\n", t_registros[i].base, t_registros[i].limite, t_registros[i].base + t_registros[i].limite);
+							if (!silencioso){
+								escribirFormato (&e, "\tBase: %d\tLimite: %d\t(Ultima direccion: %d)\n\n", t_registros[i].base, t_registros[i].limite, t_registros[i].base + t_registros[i].limite);
+							}
 						
 							if (dLogica > t_registros[i].limite){
-								printf ("\tError. Direccion no permitida. ");
-								printf ("\t(%d > %d)", dLogica, t_registros[i].limite);
-								
-								fprintf (fp, "\tError. Direccion no permitida. ");
-								fprintf (fp, "\t(%d > %d)", dLogica, t_registros[i].limite);
+								escribirFormato (&e, "\tError. Direccion no permitida. ");
+								escribirFormato (&e, "\t(%d > %d)", dLogica, t_registros[i].limite);
 							} 
 							else{
-								printf ("\tDireccion fisica: %d ", t_registros[i].base + dLogica);
-								printf ("(%d + %d)", t_registros[i].base, dLogica);
-								
-								fprintf (fp,"\tDireccion fisica: %d ", t_registros[i].base + dLogica);
-								fprintf (fp,"(%d + %d)", t_registros[i].base, dLogica);
+								escribirFormato (&e, "\tDireccion fisica: %d ", t_registros[i].base + dLogica);
+								escribirFormato (&e, "(%d + %d)", t_registros[i].base, dLogica);
 							}
 						}
 						else{
-							printf ("\tIncompatible. Error de formato.");	
-							fprintf (fp,"\tIncompatible. Error de formato.");	
+							escribirFormato (&e, "\tIncompatible. Error de formato.");	
 						}				
 						
-						printf ("\n\n\n");											fprintf (fp,"\n\n\n");
-						
-						printf ("************\n");									fprintf (fp,"************\n");
-						printf ("Segmentacion\n");									fprintf (fp,"Segmentacion\n");
-						printf ("************\n\n");								fprintf (fp,"************\n\n");
+						if (!silencioso){
+							escribirFormato (&e, "\n\n\n");
+							
+							escribirFormato (&e, "************\n");
+							escribirFormato (&e, "Segmentacion\n");
+							escribirFormato (&e, "************\n\n");
+						}
+						else{
+							escribirFormato (&e, "\n");
+						}
 	
 						
 						// Mostramos uns salida en funcion del tipo de dato introducido y su valor
 						if (opcion == 1){
-							printf ("\tIncompatible. Error de formato.");	
-							fprintf (fp,"\tIncompatible. Error de formato.");
+							escribirFormato (&e, "\tIncompatible. Error de formato.");	
 						}
 						else{
 							// Numero de segmentos del proceso
-							nSegmentos = t_segmentacion.RBTS_RLTS[i].limite + 1;
-							printf ("\tNumero de segmentos del proceso: %d ", nSegmentos);							
-							printf ("(del %d al %d)\n\n", t_segmentacion.RBTS_RLTS[i].base, t_segmentacion.RBTS_RLTS[i].base + t_segmentacion.RBTS_RLTS[i].limite);
-							
-							fprintf (fp,"\tNumero de segmentos del proceso: %d ", nSegmentos);
-							fprintf (fp,"(del %d al %d)\n\n", t_segmentacion.RBTS_RLTS[i].base, t_segmentacion.RBTS_RLTS[i].base + t_segmentacion.RBTS_RLTS[i].limite);
+							nSegmentos = t_segmentacion->RBTS_RLTS[i].limite + 1;
+							if (!silencioso){
+								escribirFormato (&e, "\tNumero de segmentos del proceso: %d ", nSegmentos);							
+								escribirFormato (&e, "(del %d al %d)\n\n", t_segmentacion->RBTS_RLTS[i].base, t_segmentacion->RBTS_RLTS[i].base + t_segmentacion->RBTS_RLTS[i].limite);
+							}
 						
 							if (nPag_Seg >= nSegmentos){
-								printf ("\tError. Segmento incorrecto.");
-								printf ("(%d > %d)", nPag_Seg, nSegmentos - 1);
-								
-								fprintf (fp,"\tError. Segmento incorrecto.");
-								fprintf (fp,"(%d > %d)", nPag_Seg, nSegmentos - 1);
+								escribirFormato (&e, "\tError. Segmento incorrecto.");
+								escribirFormato (&e, "(%d > %d)", nPag_Seg, nSegmentos - 1);
 							}else{							
-								segmento = t_segmentacion.SDT[t_segmentacion.RBTS_RLTS[i].base + nPag_Seg];
-								printf ("\tBase Segmento: %d\tLimite Segmento: %d\n\n", segmento.base, segmento.limite);
-								fprintf (fp,"\tBase Segmento: %d\tLimite Segmento: %d\n\n", segmento.base, segmento.limite);
+								segmento = t_segmentacion->SDT[t_segmentacion->desplazamientoSDT[i] + nPag_Seg];
+								if (!silencioso){
+									escribirFormato (&e, "\tBase Segmento: %d\tLimite Segmento: %d\n\n", segmento.base, segmento.limite);
+								}
 								if (nInstruccion > segmento.limite){
-									printf ("\tError. Valor de instruccion incorrecta. ");								
-									printf ("(%d > %d)", nInstruccion, segmento.limite);
-									
-									fprintf (fp,"\tError. Valor de instruccion incorrecta. ");								
-									fprintf (fp,"(%d > %d)", nInstruccion, segmento.limite);
+									escribirFormato (&e, "\tError. Valor de instruccion incorrecta. ");								
+									escribirFormato (&e, "(%d > %d)", nInstruccion, segmento.limite);
 								}	
 								else{
-									printf ("\tDireccion fisica: %d ", segmento.base + nInstruccion);	
-									printf ("(%d + %d)", segmento.base, nInstruccion);
-									
-									fprintf (fp,"\tDireccion fisica: %d ", segmento.base + nInstruccion);	
-									fprintf (fp,"(%d + %d)", segmento.base, nInstruccion);
+									escribirFormato (&e, "\tDireccion fisica: %d ", segmento.base + nInstruccion);	
+									escribirFormato (&e, "(%d + %d)", segmento.base, nInstruccion);
 								}
 							}
 						}
 						
-						printf ("\n\n\n");											fprintf (fp,"\n\n\n");
-						
-						printf ("***********\n");									fprintf (fp,"***********\n");
-						printf ("Paginacion:\n");									fprintf (fp,"Paginacion:\n");
-						printf ("***********\n\n");									fprintf (fp,"***********\n\n");
+						if (!silencioso){
+							escribirFormato (&e, "\n\n\n");
+							
+							escribirFormato (&e, "***********\n");
+							escribirFormato (&e, "Paginacion:\n");
+							escribirFormato (&e, "***********\n\n");
 												
-						// Valores generales de paginacion interesantes de mostrar por pantalla.											
-						printf ("\tTamanyo de pagina: %d ", t_paginacion.tamano);
-						printf ("(Del 0 al %d)\n\n", t_paginacion.tamano - 1);
-						
-						fprintf (fp,"\tTamanyo de pagina: %d ", t_paginacion.tamano);
-						fprintf (fp,"(Del 0 al %d)\n\n", t_paginacion.tamano - 1);
-						
-						nPaginas = t_paginacion.RBTP_RLTP[i].limite + 1;
+							// Valores generales de paginacion interesantes de mostrar por pantalla.											
+							escribirFormato (&e, "\tTamanyo de pagina: %d ", t_paginacion->tamano);
+							escribirFormato (&e, "(Del 0 al %d)\n\n", t_paginacion->tamano - 1);
+						}
+						else{
+							escribirFormato (&e, "\n");
+						}
 						
-						printf ("\tNumero de paginas del proceso: %d ", nPaginas);
-						printf ("(de la %d a la %d)\n\n", t_paginacion.RBTP_RLTP[i].base, t_paginacion.RBTP_RLTP[i].base + t_paginacion.RBTP_RLTP[i].limite);
+						nPaginas = t_paginacion->RBTP_RLTP[i].limite + 1;
 						
-						fprintf (fp,"\tNumero de paginas del proceso: %d ", nPaginas);
-						fprintf (fp,"(de la %d a la %d)\n\n", t_paginacion.RBTP_RLTP[i].base, t_paginacion.RBTP_RLTP[i].base + t_paginacion.RBTP_RLTP[i].limite);
+						if (!silencioso){
+							escribirFormato (&e, "\tNumero de paginas del proceso: %d ", nPaginas);
+							escribirFormato (&e, "(de la %d a la %d)\n\n", t_paginacion->RBTP_RLTP[i].base, t_paginacion->RBTP_RLTP[i].base + t_paginacion->RBTP_RLTP[i].limite);
+						}
 						
 						// Si el formato es de un valor, lo convertimos al formato de dos valores.
 						if (opcion == 1){
-							nPag_Seg = dLogica / t_paginacion.tamano;
-							nInstruccion = dLogica % t_paginacion.tamano;						
+							partirDireccion(t_paginacion, dLogica, &nPag_Seg, &nInstruccion);
 						}
 						
 						if (nPag_Seg >= nPaginas){
-							printf ("\tError. Pagina incorrecta. (");
-							fprintf (fp,"\tError. Pagina incorrecta. (");
+							escribirFormato (&e, "\tError. Pagina incorrecta. (");
 							if (opcion == 1){
-								printf ("%d/%d = ", dLogica, t_paginacion.tamano);	
-								fprintf (fp,"%d/%d = ", dLogica, t_paginacion.tamano);
+								escribirFormato (&e, "%d/%d = ", dLogica, t_paginacion->tamano);	
 							}
-							printf ("%d > %d)", nPag_Seg, nPaginas - 1);
-							fprintf (fp,"%d > %d)", nPag_Seg, nPaginas - 1);
-						}else if(nInstruccion >= t_paginacion.tamano){
-							printf ("\tError. Valor de instruccion incorrecto. ");
-							printf ("(%d > %d)", nInstruccion, t_paginacion.tamano - 1);
-							
-							fprintf (fp,"\tError. Valor de instruccion incorrecto. ");
-							fprintf (fp,"(%d > %d)", nInstruccion, t_paginacion.tamano - 1);
+							escribirFormato (&e, "%d > %d)", nPag_Seg, nPaginas - 1);
+						}else if(nInstruccion >= t_paginacion->tamano){
+							escribirFormato (&e, "\tError. Valor de instruccion incorrecto. ");
+							escribirFormato (&e, "(%d > %d)", nInstruccion, t_paginacion->tamano - 1);
 						}else{
 						
-							if (t_paginacion.tipo == 0){
-					        	/* PMT Global */
-					        	marco = t_paginacion.PMT_Global[t_paginacion.RBTP_RLTP[i].base + nPag_Seg];	
-					        }
-					        else{
-					        	/* PMT por proceso */
-					        	marco = t_paginacion.PMT[i][t_paginacion.RBTP_RLTP[i].base + nPag_Seg];	
-					        }
+							// Tanto con PMT global como por proceso, las paginas del proceso estan contiguas en la PMT
+				        	marco = buscarMarco(t_paginacion, i, nPag_Seg);
 					    	
-							printf ("\tMarco de pagina donde esta la pagina ");
-							fprintf (fp,"\tMarco de pagina donde esta la pagina ");
-							
-							if (opcion == 1){
-								printf ("(%d/%d = ) ", dLogica, t_paginacion.tamano);	
-								fprintf (fp,"(%d/%d = ) ", dLogica, t_paginacion.tamano);
-							} 
-							printf ("%d: %d\n\n", nPag_Seg, marco);
-							fprintf (fp,"%d: %d\n\n", nPag_Seg, marco);
+							if (!silencioso){
+								escribirFormato (&e, "\tMarco de pagina donde esta la pagina ");
+								
+								if (opcion == 1){
+									escribirFormato (&e, "(%d/%d = ) ", dLogica, t_paginacion->tamano);	
+								} 
+								escribirFormato (&e, "%d: %d\n\n", nPag_Seg, marco);
+							}
 							
 							if (marco == -1){
-								printf ("\tMarco de pagina no valido.");
-								fprintf (fp,"\tMarco de pagina no valido.");
+								escribirFormato (&e, "\tMarco de pagina no valido.");
 							}else{						
-								printf ("\tDireccion fisica: %d ", marco*t_paginacion.tamano + nInstruccion);
-								printf ("(%d*%d + %d)", marco, t_paginacion.tamano, nInstruccion);
-								
-								fprintf (fp,"\tDireccion fisica: %d ", marco*t_paginacion.tamano + nInstruccion);
-								fprintf (fp,"(%d*%d + %d)", marco, t_paginacion.tamano, nInstruccion);
+								escribirFormato (&e, "\tDireccion fisica: %d ", marco*t_paginacion->tamano + nInstruccion);
+								escribirFormato (&e, "(%d*%d + %d)", marco, t_paginacion->tamano, nInstruccion);
 							}
 							
 							
 						}
 						
-						printf ("\n\n\n\n\n\n");
-						fprintf (fp,"\n\n\n\n\n\n");
+						escribirFormato (&e, silencioso ? "\n" : "\n\n\n\n\n\n");
 					}
 					
 					break;
@@ -864,13 +2106,17 @@ void traducirDirecciones(char *archivo, int numProcesos, registro t_registros[],
 					break;
 			}
 			
+			vaciarEscritor(&e);
 			system("pause");
 	
 		}while (opcion != 0);
     	
+    	liberarEscritor(&e);
     	fclose(fp);
     	fp = NULL;
     }           
+    
+    free(salida);
 }
 
 
@@ -893,7 +2139,7 @@ void traducirDirecciones(char *archivo, int numProcesos, registro t_registros[],
 //*		En caso contrario, vuelve a pedir la direccion.
 //*
 //*************************************************************
-void validarDireccion(int opcion, FILE *fp, int *dLogica, int *nPag_Seg, int *nInstruccion){
+void validarDireccion(int opcion, escritor *e, FILE *fp, int *dLogica, int *nPag_Seg, int *nInstruccion){
 	char validez;
 				
 	switch (opcion){
@@ -916,11 +2162,15 @@ void validarDireccion(int opcion, FILE *fp, int *dLogica, int *nPag_Seg, int *nI
 			
 			system("cls");
 			
-			fprintf (fp, "*****************************************************************\n");
-			fprintf (fp, "*****************************************************************\n");
+			if (!e->silencioso){
+				fprintf (fp, "*****************************************************************\n");
+				fprintf (fp, "*****************************************************************\n");
 				
-			printf ("\t\tDireccion Logica: %d\n\n\n", *dLogica);
-			fprintf (fp, "\t\tDireccion Logica: %d\n\n\n", *dLogica);
+				escribirFormato (e, "\t\tDireccion Logica: %d\n\n\n", *dLogica);
+			}
+			else{
+				escribirFormato (e, "Direccion Logica: %d\n", *dLogica);
+			}
 		
 			break;
 			
@@ -942,14 +2192,4027 @@ void validarDireccion(int opcion, FILE *fp, int *dLogica, int *nPag_Seg, int *nI
 						
 			system("cls");
 	
-			fprintf (fp, "*****************************************************************\n");
-			fprintf (fp, "*****************************************************************\n");	
+			if (!e->silencioso){
+				fprintf (fp, "*****************************************************************\n");
+				fprintf (fp, "*****************************************************************\n");	
 				
-			printf ("\t\tDireccion Logica: (%d,%d)\n\n\n", *nPag_Seg, *nInstruccion);
-			fprintf (fp, "\t\tDireccion Logica: (%d,%d)\n\n\n", *nPag_Seg, *nInstruccion);	
+				escribirFormato (e, "\t\tDireccion Logica: (%d,%d)\n\n\n", *nPag_Seg, *nInstruccion);
+			}
+			else{
+				escribirFormato (e, "Direccion Logica: (%d,%d)\n", *nPag_Seg, *nInstruccion);
+			}
 		
 			break;		
 	}
 	
 }
 
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funciones que simulan una TLB delante de la PMT.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		configurarTLB() interpreta las opciones "entradas,vias,politica,modo
+//*		[,tTLB,tMemoria]" y reserva las entradas. Con 0 vias, o tantas como
+//*		entradas, la TLB es totalmente asociativa. Devuelve 0 si no son validas.
+//*		reiniciarTLB() la vacia y pone a cero sus estadisticas.
+//*
+//*		buscarTLB() busca la pagina en su conjunto (pagina % numConjuntos),
+//*		recorriendo sus vias, y cuenta el acierto o el fallo.
+//*		insertarTLB() guarda una traduccion tras un fallo en una via libre
+//*		o en la elegida por la politica de reemplazo: la de menor ultimoUso
+//*		(LRU) o una al azar. invalidarTLB() elimina la traduccion de una
+//*		pagina, cuando la paginacion bajo demanda la expulsa de memoria.
+//*		En modo asid la etiqueta incluye el proceso; en modo vaciado, al
+//*		cambiar de proceso se invalidan todas las entradas incrementando la
+//*		generacion, sin recorrerlas.
+//*
+//*		El coste por referencia es proporcional a la asociatividad.
+//*
+//*************************************************************
+int configurarTLB(tlb *t, const char *opciones, int numProcesos){
+	char politica[16], modo[16];
+	int leidos;
+	
+	memset(t, 0, sizeof(tlb));
+	t->tiempoTLB = 1;
+	t->tiempoMemoria = 100;
+	
+	leidos = sscanf(opciones, "%d,%d,%15[^,],%15[^,],%lf,%lf", &t->numEntradas, &t->asociatividad, politica, modo, &t->tiempoTLB, &t->tiempoMemoria);
+	if (leidos != 4 && leidos != 6){
+		return 0;
+	}
+	
+	if (t->asociatividad == 0){
+		t->asociatividad = t->numEntradas;
+	}
+	
+	if (t->numEntradas <= 0 || t->asociatividad <= 0 || t->numEntradas % t->asociatividad != 0 || t->tiempoTLB < 0 || t->tiempoMemoria < 0){
+		return 0;
+	}
+	
+	if (strcmp(politica, "lru") == 0){
+		t->politica = TLB_LRU;
+	}
+	else if (strcmp(politica, "aleatorio") == 0){
+		t->politica = TLB_ALEATORIA;
+	}
+	else{
+		return 0;
+	}
+	
+	if (strcmp(modo, "asid") == 0){
+		t->asid = 1;
+	}
+	else if (strcmp(modo, "vaciado") == 0){
+		t->asid = 0;
+	}
+	else{
+		return 0;
+	}
+	
+	t->numConjuntos = t->numEntradas / t->asociatividad;
+	t->numProcesos = numProcesos;
+	
+	t->entradas = (entradaTLB*)malloc(sizeof(entradaTLB) * t->numEntradas);
+	t->aciertos = (long long*)malloc(sizeof(long long) * numProcesos);
+	t->fallos = (long long*)malloc(sizeof(long long) * numProcesos);
+	
+	if (t->entradas == NULL || t->aciertos == NULL || t->fallos == NULL){
+		liberarTLB(t);
+		return 0;
+	}
+	
+	reiniciarTLB(t);
+	return 1;
+}
+
+void reiniciarTLB(tlb *t){
+	memset(t->entradas, 0, sizeof(entradaTLB) * t->numEntradas);
+	memset(t->aciertos, 0, sizeof(long long) * t->numProcesos);
+	memset(t->fallos, 0, sizeof(long long) * t->numProcesos);
+	
+	t->generacion = 1;
+	t->reloj = 0;
+	t->semilla = 88172645463325252ULL;
+	t->procesoActual = -1;
+	t->vaciados = 0;
+}
+
+void liberarTLB(tlb *t){
+	free(t->entradas);
+	free(t->aciertos);
+	free(t->fallos);
+	t->entradas = NULL;
+	t->aciertos = NULL;
+	t->fallos = NULL;
+}
+
+int buscarTLB(tlb *t, int proceso, int nPagina, int *marco){
+	entradaTLB *conjunto;
+	int i;
+	
+	// Sin ASID, el cambio de proceso vacia la TLB
+	if (!t->asid && proceso != t->procesoActual){
+		if (t->procesoActual != -1){
+			t->generacion++;
+			t->vaciados++;
+		}
+		t->procesoActual = proceso;
+	}
+	
+	t->reloj++;
+	conjunto = &t->entradas[(nPagina % t->numConjuntos) * t->asociatividad];
+	
+	for (i = 0 ; i < t->asociatividad ; i++){
+		if (conjunto[i].generacion == t->generacion && conjunto[i].pagina == nPagina && conjunto[i].proceso == proceso){
+			t->aciertos[proceso]++;
+			conjunto[i].ultimoUso = t->reloj;
+			*marco = conjunto[i].marco;
+			return 1;
+		}
+	}
+	
+	t->fallos[proceso]++;
+	return 0;
+}
+
+void insertarTLB(tlb *t, int proceso, int nPagina, int marco){
+	entradaTLB *conjunto, *victima = NULL;
+	int i;
+	
+	conjunto = &t->entradas[(nPagina % t->numConjuntos) * t->asociatividad];
+	
+	for (i = 0 ; i < t->asociatividad && (victima == NULL || victima->generacion == t->generacion) ; i++){
+		if (conjunto[i].generacion != t->generacion){
+			// Via libre
+			victima = &conjunto[i];
+		}
+		else if (t->politica == TLB_LRU && (victima == NULL || conjunto[i].ultimoUso < victima->ultimoUso)){
+			victima = &conjunto[i];
+		}
+	}
+	
+	if (t->politica == TLB_ALEATORIA && (victima == NULL || victima->generacion == t->generacion)){
+		t->semilla ^= t->semilla << 13;
+		t->semilla ^= t->semilla >> 7;
+		t->semilla ^= t->semilla << 17;
+		victima = &conjunto[t->semilla % t->asociatividad];
+	}
+	
+	victima->proceso = proceso;
+	victima->pagina = nPagina;
+	victima->marco = marco;
+	victima->generacion = t->generacion;
+	victima->ultimoUso = t->reloj;
+}
+
+void invalidarTLB(tlb *t, int proceso, int nPagina){
+	entradaTLB *conjunto;
+	int i;
+	
+	conjunto = &t->entradas[(nPagina % t->numConjuntos) * t->asociatividad];
+	
+	for (i = 0 ; i < t->asociatividad ; i++){
+		if (conjunto[i].generacion == t->generacion && conjunto[i].pagina == nPagina && conjunto[i].proceso == proceso){
+			conjunto[i].generacion = t->generacion - 1;
+		}
+	}
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funciones de la paginacion bajo demanda con un numero fijo
+//*			 de marcos fisicos.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		configurarDemanda() reserva las estructuras para "numMarcos" marcos.
+//*
+//*		iniciarDemanda() toma como cargadas las paginas de la PMT cuyo marco
+//*		existe (menor que numMarcos) y no esta ya ocupado; el resto de
+//*		paginas pasan a -1 (no cargadas). Los marcos sin pagina quedan libres
+//*		en un mapaMarcos, que en cada fallo da el marco libre mas bajo.
+//*
+//*		accederPagina() se llama en cada referencia a una pagina valida.
+//*		Si la pagina esta cargada solo actualiza la politica; si no, es un
+//*		fallo de pagina: la carga en un marco libre o, si no lo hay, en el
+//*		de la pagina victima, que pasa a -1 en la PMT (y se invalida en la
+//*		TLB). Devuelve el marco de la pagina. Las politicas son:
+//*
+//*			- FIFO: cola circular de marcos por orden de carga. O(1).
+//*			- LRU exacto: lista doblemente enlazada de marcos, del usado mas
+//*			  recientemente al menos reciente. Cada acceso lleva el marco al
+//*			  principio y la victima es el ultimo. O(1).
+//*			- Reloj (segunda oportunidad): bit de referencia por marco y una
+//*			  manecilla que lo borra hasta encontrar uno a 0. O(1) amortizado.
+//*			- OPT (Belady): cada referencia conoce la posicion de la siguiente
+//*			  referencia a la misma pagina (siguienteUso, calculado de
+//*			  antemano sobre la traza). Un monticulo de maximos ordenado por
+//*			  ese valor da la pagina que mas tarde se volvera a usar. Las
+//*			  entradas antiguas se descartan al salir (borrado perezoso) y el
+//*			  monticulo se reconstruye si crece demasiado. O(log n).
+//*
+//*************************************************************
+int configurarDemanda(paginacionDemanda *m, int numMarcos, int numProcesos){
+	memset(m, 0, sizeof(paginacionDemanda));
+	
+	m->numMarcos = numMarcos;
+	m->numProcesos = numProcesos;
+	
+	m->entradaMarco = (int*)malloc(sizeof(int) * numMarcos);
+	m->procesoMarco = (int*)malloc(sizeof(int) * numMarcos);
+	m->cola = (int*)malloc(sizeof(int) * numMarcos);
+	m->anterior = (int*)malloc(sizeof(int) * numMarcos);
+	m->siguiente = (int*)malloc(sizeof(int) * numMarcos);
+	m->referenciado = (unsigned char*)malloc(numMarcos);
+	m->proximoUso = (int*)malloc(sizeof(int) * numMarcos);
+	m->monticulo = (int*)malloc(sizeof(int) * 2 * (2 * numMarcos + 64));
+	m->referencias = (long long*)malloc(sizeof(long long) * numProcesos);
+	m->fallos = (long long*)malloc(sizeof(long long) * numProcesos);
+	
+	if (!crearMapaMarcos(&m->libres, numMarcos) || m->entradaMarco == NULL || m->procesoMarco == NULL || m->cola == NULL ||
+		m->anterior == NULL || m->siguiente == NULL || m->referenciado == NULL || m->proximoUso == NULL ||
+		m->monticulo == NULL || m->referencias == NULL || m->fallos == NULL){
+		liberarDemanda(m);
+		return 0;
+	}
+	
+	return 1;
+}
+
+void liberarDemanda(paginacionDemanda *m){
+	free(m->entradaMarco);
+	free(m->procesoMarco);
+	liberarMapaMarcos(&m->libres);
+	free(m->cola);
+	free(m->anterior);
+	free(m->siguiente);
+	free(m->referenciado);
+	free(m->proximoUso);
+	free(m->monticulo);
+	free(m->referencias);
+	free(m->fallos);
+	memset(m, 0, sizeof(paginacionDemanda));
+}
+
+// Intercambia dos elementos (proximoUso, marco) del monticulo de OPT
+static void intercambiarMonticulo(int *v, int i, int j){
+	int u = v[2 * i], f = v[2 * i + 1];
+	
+	v[2 * i] = v[2 * j];
+	v[2 * i + 1] = v[2 * j + 1];
+	v[2 * j] = u;
+	v[2 * j + 1] = f;
+}
+
+static void insertarMonticulo(paginacionDemanda *m, int uso, int marco){
+	int i = m->tamMonticulo++, padre;
+	
+	m->monticulo[2 * i] = uso;
+	m->monticulo[2 * i + 1] = marco;
+	
+	while (i > 0 && m->monticulo[2 * (padre = (i - 1) / 2)] < m->monticulo[2 * i]){
+		intercambiarMonticulo(m->monticulo, i, padre);
+		i = padre;
+	}
+}
+
+static void extraerMonticulo(paginacionDemanda *m){
+	int i = 0, hijo;
+	
+	m->tamMonticulo--;
+	intercambiarMonticulo(m->monticulo, 0, m->tamMonticulo);
+	
+	while ((hijo = 2 * i + 1) < m->tamMonticulo){
+		if (hijo + 1 < m->tamMonticulo && m->monticulo[2 * (hijo + 1)] > m->monticulo[2 * hijo]){
+			hijo++;
+		}
+		if (m->monticulo[2 * hijo] <= m->monticulo[2 * i]){
+			break;
+		}
+		intercambiarMonticulo(m->monticulo, i, hijo);
+		i = hijo;
+	}
+}
+
+// Actualiza la politica cuando se referencia el marco de una pagina cargada (o recien cargada)
+static void usarMarco(paginacionDemanda *m, int marco, int cargado){
+	int i;
+	
+	switch (m->politica){
+		case DEM_FIFO:
+			if (cargado){
+				m->cola[(m->cabeza + m->ocupados - 1) % m->numMarcos] = marco;
+			}
+			break;
+			
+		case DEM_LRU:
+			if (!cargado){
+				if (m->primero == marco){
+					break;
+				}
+				// Se saca de su posicion en la lista
+				m->siguiente[m->anterior[marco]] = m->siguiente[marco];
+				if (m->siguiente[marco] != -1){
+					m->anterior[m->siguiente[marco]] = m->anterior[marco];
+				}
+				else{
+					m->ultimo = m->anterior[marco];
+				}
+			}
+			// Se coloca al principio de la lista
+			m->anterior[marco] = -1;
+			m->siguiente[marco] = m->primero;
+			if (m->primero != -1){
+				m->anterior[m->primero] = marco;
+			}
+			else{
+				m->ultimo = marco;
+			}
+			m->primero = marco;
+			break;
+			
+		case DEM_RELOJ:
+			m->referenciado[marco] = 1;
+			break;
+			
+		case DEM_OPT:
+			m->proximoUso[marco] = (m->siguienteUso != NULL && m->instante >= 0) ? m->siguienteUso[m->instante] : INT_MAX;
+			
+			if (m->tamMonticulo == 2 * m->numMarcos + 64){
+				// Reconstruccion con los valores vigentes de los marcos ocupados
+				m->tamMonticulo = 0;
+				for (i = 0 ; i < m->numMarcos ; i++){
+					if (m->entradaMarco[i] != -1 && i != marco){
+						insertarMonticulo(m, m->proximoUso[i], i);
+					}
+				}
+			}
+			insertarMonticulo(m, m->proximoUso[marco], marco);
+			break;
+	}
+}
+
+// Elige el marco cuya pagina se expulsa cuando no hay marcos libres
+static int elegirVictima(paginacionDemanda *m){
+	int marco;
+	
+	switch (m->politica){
+		case DEM_FIFO:
+			marco = m->cola[m->cabeza];
+			m->cabeza = (m->cabeza + 1) % m->numMarcos;
+			return marco;
+			
+		case DEM_LRU:
+			marco = m->ultimo;
+			m->ultimo = m->anterior[marco];
+			if (m->ultimo != -1){
+				m->siguiente[m->ultimo] = -1;
+			}
+			else{
+				m->primero = -1;
+			}
+			return marco;
+			
+		case DEM_RELOJ:
+			while (m->referenciado[m->manecilla]){
+				m->referenciado[m->manecilla] = 0;
+				m->manecilla = (m->manecilla + 1) % m->numMarcos;
+			}
+			marco = m->manecilla;
+			m->manecilla = (m->manecilla + 1) % m->numMarcos;
+			return marco;
+			
+		default:
+			// OPT: se descartan las entradas del monticulo que ya no son vigentes
+			while (m->monticulo[0] != m->proximoUso[m->monticulo[1]]){
+				extraerMonticulo(m);
+			}
+			marco = m->monticulo[1];
+			extraerMonticulo(m);
+			return marco;
+	}
+}
+
+void iniciarDemanda(paginacionDemanda *m, paginacion *t_paginacion, int politica, const int *siguienteUso, const int *primerUso){
+	int i, j, k, marco;
+	
+	m->politica = politica;
+	m->siguienteUso = siguienteUso;
+	m->instante = -1;
+	m->cabeza = m->ocupados = m->manecilla = m->tamMonticulo = 0;
+	m->primero = m->ultimo = -1;
+	m->descartadas = 0;
+	
+	memset(m->referencias, 0, sizeof(long long) * m->numProcesos);
+	memset(m->fallos, 0, sizeof(long long) * m->numProcesos);
+	memset(m->referenciado, 0, m->numMarcos);
+	
+	for (marco = 0 ; marco < m->numMarcos ; marco++){
+		m->entradaMarco[marco] = -1;
+	}
+	liberarMarcos(&m->libres, 0, m->numMarcos);
+	
+	// Paginas cargadas inicialmente
+	for (i = 0 ; i < m->numProcesos ; i++){
+		for (j = 0 ; j <= t_paginacion->RBTP_RLTP[i].limite ; j++){
+			k = t_paginacion->desplazamientoPMT[i] + j;
+			marco = t_paginacion->PMT[k];
+			
+			if (marco >= 0 && !ocuparMarco(&m->libres, marco)){
+				t_paginacion->PMT[k] = -1;
+				m->descartadas++;
+			}
+			else if (marco >= 0){
+				m->entradaMarco[marco] = k;
+				m->procesoMarco[marco] = i;
+				m->ocupados++;
+				
+				// OPT: hasta su primera referencia, la pagina se usa en primerUso
+				if (politica == DEM_OPT){
+					m->proximoUso[marco] = (primerUso != NULL) ? primerUso[k] : INT_MAX;
+					insertarMonticulo(m, m->proximoUso[marco], marco);
+				}
+				else{
+					usarMarco(m, marco, 1);
+				}
+			}
+		}
+	}
+}
+
+int accederPagina(paginacionDemanda *m, paginacion *t_paginacion, tlb *t, int proceso, int entrada){
+	int marco, victima;
+	
+	m->instante++;
+	m->referencias[proceso]++;
+	
+	marco = t_paginacion->PMT[entrada];
+	if (marco >= 0){
+		usarMarco(m, marco, 0);
+		return marco;
+	}
+	
+	// Fallo de pagina
+	m->fallos[proceso]++;
+	
+	if (m->libres.libres > 0){
+		marco = reservarMarco(&m->libres);
+	}
+	else{
+		marco = elegirVictima(m);
+		victima = m->entradaMarco[marco];
+		m->ocupados--;
+		
+		t_paginacion->PMT[victima] = -1;
+		if (t != NULL){
+			invalidarTLB(t, m->procesoMarco[marco], victima - t_paginacion->desplazamientoPMT[m->procesoMarco[marco]]);
+		}
+	}
+	
+	t_paginacion->PMT[entrada] = marco;
+	m->entradaMarco[marco] = entrada;
+	m->procesoMarco[marco] = proceso;
+	m->ocupados++;
+	
+	usarMarco(m, marco, 1);
+	return marco;
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funcion que muestra los fallos de pagina de una politica.
+//*
+//*************************************************************
+void mostrarEstadisticasDemanda(const paginacionDemanda *m, FILE *salida){
+	static const char *politicas[] = {"FIFO", "LRU", "Reloj", "OPT"};
+	long long referencias = 0, fallos = 0;
+	int i;
+	
+	for (i = 0 ; i < m->numProcesos ; i++){
+		referencias += m->referencias[i];
+		fallos += m->fallos[i];
+	}
+	
+	fprintf (salida, "Paginacion bajo demanda: %d marcos, politica %s\n", m->numMarcos, politicas[m->politica]);
+	if (m->descartadas > 0){
+		fprintf (salida, "\t%d paginas de la PMT sin marco valido o con marco repetido se consideran no cargadas.\n", m->descartadas);
+	}
+	fprintf (salida, "\tReferencias: %lld\tFallos de pagina: %lld (%.2f%%)\n",
+			referencias, fallos, (referencias > 0) ? 100.0 * fallos / referencias : 0);
+	
+	for (i = 0 ; i < m->numProcesos ; i++){
+		if (m->referencias[i] > 0){
+			fprintf (salida, "\tProceso %d: Referencias: %lld\tFallos: %lld\t(%.2f%%)\n",
+					i, m->referencias[i], m->fallos[i], 100.0 * m->fallos[i] / m->referencias[i]);
+		}
+	}
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funcion que traduce una direccion con paginacion a traves
+//*			 de la TLB y/o de la paginacion bajo demanda.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Traduce como traducirPagina(), pero antes de leer la PMT busca la
+//*		pagina en la TLB, si la hay. En un fallo de TLB se lee la PMT y, si
+//*		la pagina tiene marco, se guarda la traduccion en la TLB.
+//*		Con paginacion bajo demanda toda referencia a una pagina pasa por
+//*		accederPagina(), que actualiza la politica de reemplazo y, si la
+//*		pagina no esta en memoria (-1), atiende el fallo de pagina cargandola
+//*		en un marco, de modo que la traduccion siempre tiene exito.
+//*
+//*************************************************************
+int traducirPaginaSimulada(tlb *t, paginacionDemanda *m, paginacion *t_paginacion, int proceso, const direccion *d, int *dFisica){
+	int estado, nPagina, nInstruccion, marco, entrada;
+	
+	estado = separarPagina(t_paginacion, proceso, d, &nPagina, &nInstruccion);
+	if (estado != TRAD_OK){
+		return estado;
+	}
+	
+	entrada = t_paginacion->desplazamientoPMT[proceso] + nPagina;
+	
+	if (t != NULL && buscarTLB(t, proceso, nPagina, &marco)){
+		if (m != NULL){
+			accederPagina(m, t_paginacion, t, proceso, entrada);
+		}
+	}
+	else{
+		if (m != NULL){
+			marco = accederPagina(m, t_paginacion, t, proceso, entrada);
+		}
+		else{
+			marco = buscarMarco(t_paginacion, proceso, nPagina);
+		}
+		
+		if (marco < 0){
+			return TRAD_MARCO;
+		}
+		
+		if (t != NULL){
+			insertarTLB(t, proceso, nPagina, marco);
+		}
+	}
+	
+	*dFisica = marco * t_paginacion->tamano + nInstruccion;
+	return TRAD_OK;
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funcion que muestra las estadisticas de la TLB.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Muestra la configuracion, los aciertos y fallos totales y por
+//*		proceso, y el tiempo efectivo de acceso (EAT):
+//*			EAT = h * (tTLB + tMemoria) + (1 - h) * (tTLB + 2 * tMemoria)
+//*		siendo h la tasa de aciertos. En un fallo se accede a la PMT en
+//*		memoria ademas de al dato.
+//*
+//*************************************************************
+void mostrarEstadisticasTLB(const tlb *t, FILE *salida){
+	long long aciertos = 0, fallos = 0, referencias;
+	double tasa;
+	int i;
+	
+	for (i = 0 ; i < t->numProcesos ; i++){
+		aciertos += t->aciertos[i];
+		fallos += t->fallos[i];
+	}
+	
+	referencias = aciertos + fallos;
+	tasa = (referencias > 0) ? (double)aciertos / referencias : 0;
+	
+	fprintf (salida, "TLB: %d entradas, %d vias, %d conjuntos, reemplazo %s, %s\n",
+			t->numEntradas, t->asociatividad, t->numConjuntos,
+			(t->politica == TLB_LRU) ? "LRU" : "aleatorio", t->asid ? "con ASID" : "vaciado en cada cambio de proceso");
+	fprintf (salida, "\tReferencias: %lld\tAciertos: %lld (%.2f%%)\tFallos: %lld\tVaciados: %lld\n",
+			referencias, aciertos, 100 * tasa, fallos, t->vaciados);
+	fprintf (salida, "\tTiempo efectivo de acceso: %.2f ns (TLB %.2f ns, memoria %.2f ns)\n",
+			tasa * (t->tiempoTLB + t->tiempoMemoria) + (1 - tasa) * (t->tiempoTLB + 2 * t->tiempoMemoria), t->tiempoTLB, t->tiempoMemoria);
+	
+	for (i = 0 ; i < t->numProcesos ; i++){
+		referencias = t->aciertos[i] + t->fallos[i];
+		if (referencias > 0){
+			fprintf (salida, "\tProceso %d: Aciertos: %lld\tFallos: %lld\t(%.2f%%)\n",
+					i, t->aciertos[i], t->fallos[i], 100.0 * t->aciertos[i] / referencias);
+		}
+	}
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funcion que interpreta una linea del fichero de traza.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Admite los dos formatos de direccion logica: un valor entero (306)
+//*		o un par de valores separados por una coma (2,46), opcionalmente
+//*		entre parentesis. Puede ir precedida del proceso que la genera
+//*		y dos puntos (1:306).
+//*		Devuelve 1 si la linea contiene una direccion, 0 si es una linea
+//*		vacia o un comentario ('#'), y -1 si la linea no es valida.
+//*
+//*************************************************************
+int leerDireccion(const char *linea, direccion *d){
+	char *fin;
+	long valor;
+	
+	while (*linea == ' ' || *linea == '\t'){
+		linea++;
+	}
+	
+	if (*linea == '\0' || *linea == '\n' || *linea == '\r' || *linea == '#'){
+		return 0;
+	}
+	
+	d->proceso = -1;
+	
+	valor = strtol(linea, &fin, 10);
+	if (fin != linea && *fin == ':'){
+		if (valor < 0){
+			return -1;
+		}
+		d->proceso = (int)valor;
+		linea = fin + 1;
+	}
+	
+	if (*linea == '('){
+		linea++;
+	}
+	
+	valor = strtol(linea, &fin, 10);
+	if (fin == linea){
+		return -1;
+	}
+	
+	if (*fin == ','){
+		d->formato = 2;
+		d->nPag_Seg = (int)valor;
+		
+		linea = fin + 1;
+		valor = strtol(linea, &fin, 10);
+		if (fin == linea){
+			return -1;
+		}
+		d->nInstruccion = (int)valor;
+	}
+	else{
+		d->formato = 1;
+		d->dLogica = (int)valor;
+	}
+	
+	if (*fin == ')'){
+		fin++;
+	}
+	
+	while (*fin == ' ' || *fin == '\t' || *fin == '\r' || *fin == '\n'){
+		fin++;
+	}
+	
+	return (*fin == '\0') ? 1 : -1;
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funcion que interpreta una lista de politicas separadas por
+//*			 comas (p.ej. "fifo,lru,reloj,opt" en la opcion "-r").
+//*
+//*		Cada politica es su posicion en "nombres". Devuelve el numero de
+//*		politicas, o 0 si la lista no es valida.
+//*
+//*************************************************************
+int leerPoliticas(const char *opciones, const char *nombres[], int numNombres, int politicas[]){
+	int n = 0, i, longitud;
+	
+	while (*opciones != '\0'){
+		longitud = (int)strcspn(opciones, ",");
+		
+		for (i = 0 ; i < numNombres && (strncmp(opciones, nombres[i], longitud) != 0 || nombres[i][longitud] != '\0') ; i++);
+		if (i == numNombres || n == numNombres){
+			return 0;
+		}
+		politicas[n++] = i;
+		
+		opciones += longitud;
+		if (*opciones == ','){
+			opciones++;
+		}
+	}
+	
+	return n;
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funcion que traduce una direccion de la traza en su proceso
+//*			 o en todos ellos.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Escribe en "salida" una linea (o registro) por proceso con el
+//*		resultado de los tres metodos de gestion de memoria. Si es NULL solo se
+//*		simula la paginacion (TLB y paginacion bajo demanda), sin escribir
+//*		nada, para comparar politicas de reemplazo.
+//*
+//*************************************************************
+void traducirLinea(const direccion *d, int numProcesos, registro t_registros[], paginacion *t_paginacion, segmentacion *t_segmentacion, tlb *t_tlb, paginacionDemanda *t_demanda, escritor *salida){
+	int i, primero, ultimo, estado, estadoSegmento, dFisica = -1, dFisicaSegmento = -1;
+	
+	primero = (d->proceso == -1) ? 0 : d->proceso;
+	ultimo = (d->proceso == -1) ? numProcesos - 1 : d->proceso;
+	
+	for (i = primero ; i <= ultimo ; i++){
+		if (salida == NULL){
+			traducirPaginaSimulada(t_tlb, t_demanda, t_paginacion, i, d, &dFisica);
+			continue;
+		}
+		
+		if (t_tlb != NULL || t_demanda != NULL){
+			estado = traducirPaginaSimulada(t_tlb, t_demanda, t_paginacion, i, d, &dFisica);
+		}
+		else{
+			estado = traducirPagina(t_paginacion, i, d, &dFisica);
+		}
+		
+		estadoSegmento = traducirSegmento(t_segmentacion, i, d, &dFisicaSegmento);
+		escribirTraduccion(salida, d, i, t_registros, estadoSegmento, dFisicaSegmento, estado, dFisica);
+	}
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funcion que escribe la linea de resultados de una direccion
+//*			 en un proceso.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Traduce la direccion con base/limite y escribe el resultado junto
+//*		a los de segmentacion y paginacion, que ya recibe calculados
+//*		porque pueden venir de la traduccion por bloques (y la paginacion
+//*		tambien de la TLB o de la paginacion bajo demanda).
+//*		Los formatos de texto, CSV y JSON Lines solo se distinguen en los
+//*		separadores y en como se escriben los errores y las direcciones de
+//*		dos valores; el binario escribe un registroBinario.
+//*
+//*************************************************************
+void escribirTraduccion(escritor *e, const direccion *d, int proceso, const registro t_registros[], int estadoSegmento, int dFisicaSegmento, int estadoPagina, int dFisicaPagina){
+	static const char *errores[] = {"", "FORMATO", "DIRECCION", "SEGMENTO", "INSTRUCCION", "PAGINA", "MARCO"};
+	static const char *separadores[][6] = {
+		{"",			"\t",			"\t",				"\t",					"\t",					"\n"},		// Texto
+		{"",			",",			",",				",",					",",					"\n"},		// CSV
+		{"{\"direccion\":", ",\"proceso\":", ",\"base_limite\":", ",\"segmentacion\":", ",\"paginacion\":", "}\n"}	// JSON Lines
+	};
+	registroBinario r;
+	int estados[3], fisicas[3], k;
+	
+	// Registro Base/Limite, Segmentacion y Paginacion
+	estados[0] = traducirBaseLimite(&t_registros[proceso], d, &fisicas[0]);
+	estados[1] = estadoSegmento;
+	fisicas[1] = dFisicaSegmento;
+	estados[2] = estadoPagina;
+	fisicas[2] = dFisicaPagina;
+	
+	if (e->formato == SALIDA_BINARIA){
+		r.dLogica = (d->formato == 1) ? d->dLogica : d->nPag_Seg;
+		r.nInstruccion = (d->formato == 1) ? 0 : d->nInstruccion;
+		r.proceso = proceso;
+		for (k = 0 ; k < 3 ; k++){
+			r.dFisica[k] = (estados[k] == TRAD_OK) ? fisicas[k] : -1;
+			r.estado[k] = (unsigned char)estados[k];
+		}
+		r.formato = (unsigned char)d->formato;
+		escribirDatos(e, &r, sizeof(registroBinario));
+		return;
+	}
+	
+	escribirCadena(e, separadores[e->formato][0]);
+	if (d->formato == 1){
+		escribirEntero(e, d->dLogica);
+	}
+	else{
+		// Con dos valores la coma se protege: entre comillas en CSV y como array en JSON
+		escribirCadena(e, (e->formato == SALIDA_CSV) ? "\"" : (e->formato == SALIDA_JSONL) ? "[" : "");
+		escribirEntero(e, d->nPag_Seg);
+		escribirCadena(e, ",");
+		escribirEntero(e, d->nInstruccion);
+		escribirCadena(e, (e->formato == SALIDA_CSV) ? "\"" : (e->formato == SALIDA_JSONL) ? "]" : "");
+	}
+	escribirCadena(e, separadores[e->formato][1]);
+	escribirEntero(e, proceso);
+	
+	for (k = 0 ; k < 3 ; k++){
+		escribirCadena(e, separadores[e->formato][k + 2]);
+		if (estados[k] == TRAD_OK){
+			escribirEntero(e, fisicas[k]);
+		}
+		else if (e->formato == SALIDA_JSONL){
+			escribirCadena(e, "\"");
+			escribirCadena(e, errores[estados[k]]);
+			escribirCadena(e, "\"");
+		}
+		else{
+			escribirCadena(e, errores[estados[k]]);
+		}
+	}
+	escribirCadena(e, separadores[e->formato][5]);
+}
+
+// Cabecera de las traducciones de la traza en los formatos de texto y CSV
+void escribirCabecera(escritor *e){
+	if (e->silencioso){
+		return;
+	}
+	
+	if (e->formato == SALIDA_TEXTO){
+		escribirCadena(e, "# direccion\tproceso\tbase/limite\tsegmentacion\tpaginacion\n");
+	}
+	else if (e->formato == SALIDA_CSV){
+		escribirCadena(e, "direccion,proceso,base_limite,segmentacion,paginacion\n");
+	}
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funciones que traducen la traza por bloques en el modo
+//*			 por lotes sin TLB.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Las direcciones se acumulan en un bloque de hasta tamBloque pares
+//*		(direccion, proceso), o numProcesos si es mayor, para que quepa una
+//*		direccion que se traduce en todos los procesos.
+//*		Al traducir el bloque, las direcciones de un valor se agrupan por
+//*		proceso con una ordenacion por recuento (dos recorridos del bloque)
+//*		y cada grupo se traduce de una vez con traducirPaginasLote(). Las
+//*		de dos valores se traducen una a una con traducirPagina(). Con la
+//*		segmentacion paginada, las de dos valores tambien se agrupan por
+//*		proceso, a continuacion de las de un valor, y la segmentacion de
+//*		cada grupo se traduce con traducirSegmentosLote().
+//*		Despues se escriben los resultados en el orden de la traza, asi
+//*		que la salida es identica a la de traducirLinea().
+//*		crearBloque() devuelve 0 si no hay memoria suficiente.
+//*
+//*************************************************************
+int crearBloque(bloqueTraza *b, int numProcesos){
+	b->numProcesos = numProcesos;
+	b->capacidad = (numProcesos > tamBloque) ? numProcesos : tamBloque;
+	b->numLineas = 0;
+	b->numElementos = 0;
+	
+	b->lineas = (direccion*)malloc(sizeof(direccion) * b->capacidad);
+	b->cuenta = (int*)malloc(sizeof(int) * (numProcesos + 1));
+	b->cuentaPares = (int*)malloc(sizeof(int) * (numProcesos + 1));
+	b->posicion = (int*)malloc(sizeof(int) * b->capacidad);
+	b->agrupadas = (int*)malloc(sizeof(int) * b->capacidad);
+	b->desplazamientos = (int*)malloc(sizeof(int) * b->capacidad);
+	b->fisicas = (int*)malloc(sizeof(int) * b->capacidad);
+	b->estados = (unsigned char*)malloc(b->capacidad);
+	
+	if (b->lineas == NULL || b->cuenta == NULL || b->cuentaPares == NULL || b->posicion == NULL || b->agrupadas == NULL ||
+		b->desplazamientos == NULL || b->fisicas == NULL || b->estados == NULL){
+		liberarBloque(b);
+		return 0;
+	}
+	
+	return 1;
+}
+
+void liberarBloque(bloqueTraza *b){
+	free(b->lineas);
+	free(b->cuenta);
+	free(b->cuentaPares);
+	free(b->posicion);
+	free(b->agrupadas);
+	free(b->desplazamientos);
+	free(b->fisicas);
+	free(b->estados);
+	b->lineas = NULL;
+	b->cuenta = b->cuentaPares = b->posicion = b->agrupadas = b->desplazamientos = b->fisicas = NULL;
+	b->estados = NULL;
+}
+
+int cabeEnBloque(const bloqueTraza *b, const direccion *d){
+	return b->numElementos + ((d->proceso == -1) ? b->numProcesos : 1) <= b->capacidad;
+}
+
+void anadirBloque(bloqueTraza *b, const direccion *d){
+	b->lineas[b->numLineas++] = *d;
+	b->numElementos += (d->proceso == -1) ? b->numProcesos : 1;
+}
+
+void traducirBloque(bloqueTraza *b, const registro t_registros[], const paginacion *t_paginacion, const segmentacion *t_segmentacion, escritor *salida){
+	const direccion *d;
+	int i, j, k, p, primero, ultimo, inicio, estado, dFisica, estadoSegmento, dFisicaSegmento;
+	
+	// Tamano del grupo de cada proceso
+	memset(b->cuenta, 0, sizeof(int) * (b->numProcesos + 1));
+	memset(b->cuentaPares, 0, sizeof(int) * (b->numProcesos + 1));
+	for (j = 0 ; j < b->numLineas ; j++){
+		d = &b->lineas[j];
+		if (d->formato != 1 && !t_segmentacion->paginada){
+			continue;
+		}
+		primero = (d->proceso == -1) ? 0 : d->proceso;
+		ultimo = (d->proceso == -1) ? b->numProcesos - 1 : d->proceso;
+		
+		for (i = primero ; i <= ultimo ; i++){
+			((d->formato == 1) ? b->cuenta : b->cuentaPares)[i + 1]++;
+		}
+	}
+	for (p = 0 ; p < b->numProcesos ; p++){
+		b->cuenta[p + 1] += b->cuenta[p];
+	}
+	b->cuentaPares[0] = b->cuenta[b->numProcesos];
+	for (p = 0 ; p < b->numProcesos ; p++){
+		b->cuentaPares[p + 1] += b->cuentaPares[p];
+	}
+	
+	// Reparto en grupos: al terminar, cuenta[p] (o cuentaPares[p]) es el final del grupo del proceso p
+	for (j = 0, k = 0 ; j < b->numLineas ; j++){
+		d = &b->lineas[j];
+		primero = (d->proceso == -1) ? 0 : d->proceso;
+		ultimo = (d->proceso == -1) ? b->numProcesos - 1 : d->proceso;
+		
+		for (i = primero ; i <= ultimo ; i++, k++){
+			if (d->formato == 1){
+				b->posicion[k] = b->cuenta[i];
+				b->agrupadas[b->cuenta[i]++] = d->dLogica;
+			}
+			else if (t_segmentacion->paginada){
+				b->posicion[k] = b->cuentaPares[i];
+				b->agrupadas[b->cuentaPares[i]] = d->nPag_Seg;
+				b->desplazamientos[b->cuentaPares[i]++] = d->nInstruccion;
+			}
+			else{
+				b->posicion[k] = -1;
+			}
+		}
+	}
+	
+	for (p = 0, inicio = 0 ; p < b->numProcesos ; inicio = b->cuenta[p++]){
+		if (b->cuenta[p] > inicio){
+			traducirPaginasLote(t_paginacion, p, b->agrupadas + inicio, b->cuenta[p] - inicio, b->fisicas + inicio, b->estados + inicio);
+		}
+	}
+	for (p = 0, inicio = b->cuenta[b->numProcesos] ; p < b->numProcesos && t_segmentacion->paginada ; inicio = b->cuentaPares[p++]){
+		if (b->cuentaPares[p] > inicio){
+			traducirSegmentosLote(t_segmentacion, p, b->agrupadas + inicio, b->desplazamientos + inicio, b->cuentaPares[p] - inicio, b->fisicas + inicio, b->estados + inicio);
+		}
+	}
+	
+	// Escritura en el orden de la traza
+	for (j = 0, k = 0 ; j < b->numLineas ; j++){
+		d = &b->lineas[j];
+		primero = (d->proceso == -1) ? 0 : d->proceso;
+		ultimo = (d->proceso == -1) ? b->numProcesos - 1 : d->proceso;
+		
+		for (i = primero ; i <= ultimo ; i++, k++){
+			if (b->posicion[k] >= 0 && d->formato == 1){
+				estado = b->estados[b->posicion[k]];
+				dFisica = b->fisicas[b->posicion[k]];
+			}
+			else{
+				estado = traducirPagina(t_paginacion, i, d, &dFisica);
+			}
+			
+			if (b->posicion[k] >= 0 && d->formato != 1){
+				estadoSegmento = b->estados[b->posicion[k]];
+				dFisicaSegmento = b->fisicas[b->posicion[k]];
+			}
+			else{
+				estadoSegmento = traducirSegmento(t_segmentacion, i, d, &dFisicaSegmento);
+			}
+			escribirTraduccion(salida, d, i, t_registros, estadoSegmento, dFisicaSegmento, estado, dFisica);
+		}
+	}
+	
+	b->numLineas = 0;
+	b->numElementos = 0;
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funciones que abren las trazas, comprimidas o no, y avisan
+//*			 del progreso de su traduccion.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		abrirTraza() abre la traza (la entrada estandar si es "-"). Si el
+//*		fichero empieza por la marca de gzip (1f 8b) o de zstd (28 b5 2f fd),
+//*		no se lee directamente, sino la salida de "gzip -dc" o "zstd -dc"
+//*		sobre el fichero a traves de una tuberia: se descomprime a la vez
+//*		que se traduce, en otro proceso, sin pasar por el disco. La marca
+//*		solo se comprueba si el fichero se puede volver a leer desde el
+//*		principio, asi que la entrada estandar se lee siempre tal cual.
+//*		cerrarTraza() la cierra y devuelve 0 si el descompresor ha fallado.
+//*
+//*		La traza se lee siempre en buffers de tamano fijo, de modo que la
+//*		memoria no depende de su longitud (salvo con paginacion bajo
+//*		demanda, que la carga completa). avisarProgreso() escribe por la
+//*		salida de errores, cada intervaloProgreso segundos, las direcciones
+//*		traducidas, la velocidad y los bytes leidos de la traza (con el
+//*		porcentaje si se conoce su tamano). Se llama cada muchas lineas
+//*		para que consultar el reloj no cueste.
+//*
+//*************************************************************
+FILE *abrirTraza(const char *traza, int *comprimida){
+	static const unsigned char gzip[] = {0x1f, 0x8b}, zstd[] = {0x28, 0xb5, 0x2f, 0xfd};
+	static const char *descompresores[] = {"gzip -dc -- ", "zstd -dcq -- "};
+	unsigned char marca[4];
+	char *orden, *q;
+	const char *c;
+	size_t n;
+	int k;
+	FILE *fp;
+	
+	*comprimida = 0;
+	
+	if (strcmp(traza, "-") == 0){
+		return stdin;
+	}
+	if ((fp = fopen(traza, "r")) == NULL || fseek(fp, 0, SEEK_CUR) != 0){
+		return fp;
+	}
+	
+	n = fread(marca, 1, 4, fp);
+	rewind(fp);
+	if (n >= 2 && memcmp(marca, gzip, 2) == 0){
+		k = 0;
+	}
+	else if (n == 4 && memcmp(marca, zstd, 4) == 0){
+		k = 1;
+	}
+	else{
+		return fp;
+	}
+	fclose(fp);
+	
+	// Orden del descompresor, con el nombre del fichero entre comillas
+	if ((orden = (char*)malloc(strlen(descompresores[k]) + 4 * strlen(traza) + 3)) == NULL){
+		return NULL;
+	}
+	strcpy(orden, descompresores[k]);
+	q = orden + strlen(orden);
+#ifdef _WIN32
+	*q++ = '"';
+	for (c = traza ; *c != '\0' ; c++){
+		*q++ = *c;
+	}
+	*q++ = '"';
+#else
+	*q++ = '\'';
+	for (c = traza ; *c != '\0' ; c++){
+		if (*c == '\''){
+			memcpy(q, "'\\''", 4);
+			q += 4;
+		}
+		else{
+			*q++ = *c;
+		}
+	}
+	*q++ = '\'';
+#endif
+	*q = '\0';
+	
+	fp = popen(orden, "r");
+	free(orden);
+	*comprimida = (fp != NULL);
+	return fp;
+}
+
+int cerrarTraza(FILE *fp, int comprimida, const char *traza){
+	if (fp == stdin){
+		return 1;
+	}
+	if (!comprimida){
+		fclose(fp);
+		return 1;
+	}
+	if (pclose(fp) != 0){
+		fprintf (stderr, "Error. No ha sido posible descomprimir la traza \"%s\" con gzip o zstd.\n", traza);
+		return 0;
+	}
+	return 1;
+}
+
+void iniciarProgreso(progresoTraza *p, FILE *fp, int comprimida, int silencioso){
+#ifndef _WIN32
+	struct stat datos;
+#endif
+	
+	p->activo = !silencioso;
+	p->inicio = segundosReloj();
+	p->siguiente = p->inicio + intervaloProgreso;
+	p->tamano = -1;
+	p->fp = NULL;
+	
+#ifndef _WIN32
+	if (!comprimida && fstat(fileno(fp), &datos) == 0 && S_ISREG(datos.st_mode)){
+		p->tamano = (long long)datos.st_size;
+		p->fp = fp;
+	}
+#endif
+}
+
+void avisarProgreso(progresoTraza *p, long direcciones, long long bytes){
+	double ahora;
+	
+	if (!p->activo || (ahora = segundosReloj()) < p->siguiente){
+		return;
+	}
+	p->siguiente = ahora + intervaloProgreso;
+	
+#ifndef _WIN32
+	if (bytes < 0 && p->fp != NULL){
+		bytes = (long long)ftello(p->fp);
+	}
+#endif
+	
+	fprintf (stderr, "Progreso: %ld direcciones en %.0f s (%.0f direcciones/s)", direcciones, ahora - p->inicio, direcciones / (ahora - p->inicio));
+	if (bytes >= 0){
+		fprintf (stderr, ", %.1f MB leidos", bytes / 1048576.0);
+		if (p->tamano > 0){
+			fprintf (stderr, " (%.1f%%)", 100.0 * bytes / p->tamano);
+		}
+	}
+	fprintf (stderr, ".\n");
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funcion que carga en memoria todas las direcciones de la traza.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		La paginacion bajo demanda recorre la traza una vez por politica,
+//*		y OPT necesita conocer las referencias futuras, asi que la traza se
+//*		guarda completa en un array que crece al doble cuando se llena.
+//*		Las lineas que no son validas se avisan y se ignoran.
+//*		Devuelve NULL si no hay memoria suficiente.
+//*
+//*************************************************************
+direccion *cargarTraza(FILE *fp, int numProcesos, long *numDirecciones){
+	char linea[longitudLinea];
+	direccion *v = NULL, *aux;
+	long n = 0, capacidad = 0, nLinea = 0;
+	int estado;
+	
+	while (fgets(linea, longitudLinea, fp) != NULL){
+		nLinea++;
+		
+		if (n == capacidad){
+			capacidad = (capacidad == 0) ? 4096 : 2 * capacidad;
+			if ((aux = (direccion*)realloc(v, sizeof(direccion) * capacidad)) == NULL){
+				free(v);
+				return NULL;
+			}
+			v = aux;
+		}
+		
+		estado = leerDireccion(linea, &v[n]);
+		if (estado < 0 || v[n].proceso >= numProcesos){
+			fprintf (stderr, "Linea %ld de la traza incorrecta. Se ignora.\n", nLinea);
+		}
+		else if (estado > 0){
+			n++;
+		}
+	}
+	
+	*numDirecciones = n;
+	return (v != NULL) ? v : (direccion*)malloc(sizeof(direccion));
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funcion que calcula el indice de siguiente uso que necesita
+//*			 la politica OPT.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Primero obtiene, en el mismo orden en que se simularan, las
+//*		referencias a paginas validas de la traza (las unicas que llegan a
+//*		accederPagina()), como entradas de la PMT. Despues las recorre de la
+//*		ultima a la primera guardando la ultima posicion vista de cada
+//*		entrada: asi, en O(n), siguienteUso[r] es la siguiente referencia a
+//*		la misma pagina que la referencia r (INT_MAX si no la hay) y
+//*		primerUso[e] la primera referencia a la entrada e.
+//*		Devuelve siguienteUso, o NULL si no hay memoria suficiente.
+//*
+//*************************************************************
+int *calcularSiguienteUso(const direccion v[], long n, int numProcesos, const paginacion *t_paginacion, int **primerUso){
+	int *referencias = NULL, *aux, *ultimoUso;
+	long numReferencias = 0, capacidad = 0, j;
+	int i, primero, ultimo, nPagina, nInstruccion;
+	
+	for (j = 0 ; j < n ; j++){
+		primero = (v[j].proceso == -1) ? 0 : v[j].proceso;
+		ultimo = (v[j].proceso == -1) ? numProcesos - 1 : v[j].proceso;
+		
+		for (i = primero ; i <= ultimo ; i++){
+			if (separarPagina(t_paginacion, i, &v[j], &nPagina, &nInstruccion) != TRAD_OK){
+				continue;
+			}
+			
+			if (numReferencias == capacidad){
+				capacidad = (capacidad == 0) ? 4096 : 2 * capacidad;
+				if (capacidad > INT_MAX || (aux = (int*)realloc(referencias, sizeof(int) * capacidad)) == NULL){
+					free(referencias);
+					return NULL;
+				}
+				referencias = aux;
+			}
+			referencias[numReferencias++] = t_paginacion->desplazamientoPMT[i] + nPagina;
+		}
+	}
+	
+	ultimoUso = (int*)malloc(sizeof(int) * (t_paginacion->numEntradas + 1));
+	if (ultimoUso == NULL){
+		free(referencias);
+		return NULL;
+	}
+	
+	for (i = 0 ; i < t_paginacion->numEntradas ; i++){
+		ultimoUso[i] = INT_MAX;
+	}
+	
+	// Cada referencia se sustituye por la posicion de la siguiente a la misma entrada
+	for (j = numReferencias - 1 ; j >= 0 ; j--){
+		i = referencias[j];
+		referencias[j] = ultimoUso[i];
+		ultimoUso[i] = (int)j;
+	}
+	
+	*primerUso = ultimoUso;
+	return (referencias != NULL) ? referencias : (int*)malloc(sizeof(int));
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funcion que traduce todas las direcciones logicas de un
+//*			 fichero de traza sin interaccion con el usuario.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Lee la traza linea a linea (de la entrada estandar si el nombre
+//*		es "-") y, por cada direccion valida, escribe una linea por proceso
+//*		(o solo la del proceso indicado en la direccion) con el resultado
+//*		de los tres metodos de gestion de memoria.
+//*		Si se recibe una TLB, la paginacion se traduce a traves de ella.
+//*		La salida estandar usa un buffer grande para que la escritura no
+//*		limite la velocidad de traduccion.
+//*		Las lineas de la traza que no son validas se avisan por la salida
+//*		de errores y se ignoran.
+//*		Al terminar se muestra un resumen por la salida de errores.
+//*
+//*		Con paginacion bajo demanda la traza se carga en memoria y se
+//*		simula una vez por cada politica, partiendo siempre de la PMT y la
+//*		TLB iniciales. Con una sola politica se escriben las traducciones;
+//*		con varias solo se escribe, por la salida estandar, la tabla de
+//*		fallos de pagina por politica y proceso para compararlas.
+//*
+//*************************************************************
+int traducirTraza(char *traza, int numProcesos, registro t_registros[], paginacion *t_paginacion, segmentacion *t_segmentacion, tlb *t_tlb, paginacionDemanda *t_demanda, const int politicas[], int numPoliticas, escritor *salida){
+	static const char *nombres[] = {"fifo", "lru", "reloj", "opt"};
+	FILE *fp;
+	char linea[longitudLinea];
+	direccion d, *v = NULL;
+	bloqueTraza b;
+	progresoTraza progreso;
+	int i, p, estado, comprimida, *siguienteUso = NULL, *primerUso = NULL, *PMTinicial = NULL;
+	long j, nLinea = 0, nDirecciones = 0;
+	clock_t inicio = clock();
+	
+	if ((fp = abrirTraza(traza, &comprimida)) == NULL){
+		fprintf (stderr, "Error. No ha sido posible abrir el fichero de traza \"%s\".\n", traza);
+		return 1;
+	}
+	iniciarProgreso(&progreso, fp, comprimida, salida->silencioso);
+	
+	if (t_demanda == NULL){
+		if (t_tlb == NULL && !crearBloque(&b, numProcesos)){
+			fprintf (stderr, "Error. No hay memoria suficiente para traducir la traza.\n");
+			cerrarTraza(fp, comprimida, traza);
+			return 1;
+		}
+		
+		escribirCabecera(salida);
+		
+		while (fgets(linea, longitudLinea, fp) != NULL){
+			nLinea++;
+			if ((nLinea & 0xFFFF) == 0){
+				avisarProgreso(&progreso, nDirecciones, -1);
+			}
+			
+			estado = leerDireccion(linea, &d);
+			if (estado < 0 || d.proceso >= numProcesos){
+				fprintf (stderr, "Linea %ld de la traza incorrecta. Se ignora.\n", nLinea);
+				continue;
+			}
+			if (estado == 0){
+				continue;
+			}
+			
+			nDirecciones++;
+			
+			if (t_tlb != NULL){
+				traducirLinea(&d, numProcesos, t_registros, t_paginacion, t_segmentacion, t_tlb, NULL, salida);
+				continue;
+			}
+			
+			if (!cabeEnBloque(&b, &d)){
+				traducirBloque(&b, t_registros, t_paginacion, t_segmentacion, salida);
+			}
+			anadirBloque(&b, &d);
+		}
+		
+		if (t_tlb == NULL){
+			traducirBloque(&b, t_registros, t_paginacion, t_segmentacion, salida);
+			liberarBloque(&b);
+		}
+	}
+	else{
+		v = cargarTraza(fp, numProcesos, &nDirecciones);
+		PMTinicial = (int*)malloc(sizeof(int) * (t_paginacion->numEntradas + 1));
+		
+		for (p = 0 ; p < numPoliticas && politicas[p] != DEM_OPT ; p++);
+		if (v != NULL && p < numPoliticas){
+			siguienteUso = calcularSiguienteUso(v, nDirecciones, numProcesos, t_paginacion, &primerUso);
+		}
+		
+		if (v == NULL || PMTinicial == NULL || (p < numPoliticas && siguienteUso == NULL)){
+			fprintf (stderr, "Error. No hay memoria suficiente para cargar la traza.\n");
+			free(v);
+			free(PMTinicial);
+			cerrarTraza(fp, comprimida, traza);
+			return 1;
+		}
+		
+		memcpy(PMTinicial, t_paginacion->PMT, sizeof(int) * t_paginacion->numEntradas);
+		
+		if (numPoliticas == 1){
+			escribirCabecera(salida);
+		}
+		else if (!salida->silencioso){
+			escribirCadena(salida, "# politica\tproceso\treferencias\tfallos\ttasa\n");
+		}
+		
+		for (p = 0 ; p < numPoliticas ; p++){
+			memcpy(t_paginacion->PMT, PMTinicial, sizeof(int) * t_paginacion->numEntradas);
+			if (t_tlb != NULL){
+				reiniciarTLB(t_tlb);
+			}
+			iniciarDemanda(t_demanda, t_paginacion, politicas[p], siguienteUso, primerUso);
+			
+			for (j = 0 ; j < nDirecciones ; j++){
+				traducirLinea(&v[j], numProcesos, t_registros, t_paginacion, t_segmentacion, t_tlb, t_demanda, (numPoliticas == 1) ? salida : NULL);
+			}
+			
+			if (numPoliticas > 1){
+				for (i = 0 ; i < numProcesos ; i++){
+					if (t_demanda->referencias[i] > 0){
+						escribirFormato (salida, "%s\t%d\t%lld\t%lld\t%.4f\n", nombres[politicas[p]], i, t_demanda->referencias[i], t_demanda->fallos[i],
+										 (double)t_demanda->fallos[i] / t_demanda->referencias[i]);
+					}
+				}
+			}
+			
+			if (!salida->silencioso){
+				mostrarEstadisticasDemanda(t_demanda, stderr);
+				if (t_tlb != NULL){
+					mostrarEstadisticasTLB(t_tlb, stderr);
+				}
+			}
+		}
+		
+		// La PMT vuelve a su estado inicial
+		memcpy(t_paginacion->PMT, PMTinicial, sizeof(int) * t_paginacion->numEntradas);
+		
+		free(v);
+		free(PMTinicial);
+		free(siguienteUso);
+		free(primerUso);
+	}
+	
+	vaciarEscritor(salida);
+	
+	if (!cerrarTraza(fp, comprimida, traza)){
+		return 1;
+	}
+	
+	if (salida->silencioso){
+		return 0;
+	}
+	
+	fprintf (stderr, "Traducidas %ld direcciones logicas en %d procesos (%.3f s).\n",
+			nDirecciones, numProcesos, (double)(clock() - inicio) / CLOCKS_PER_SEC);
+	
+	if (t_tlb != NULL && t_demanda == NULL){
+		mostrarEstadisticasTLB(t_tlb, stderr);
+	}
+	mostrarEstadisticasPaginacion(t_paginacion, numProcesos, stderr);
+	mostrarEstadisticasSegmentacion(t_segmentacion, stderr);
+	
+	return 0;
+}
+
+
+
+#ifndef _WIN32
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funciones que traducen la traza en paralelo con varios hilos.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Solo se usan sin TLB ni paginacion bajo demanda, porque entonces
+//*		cada direccion se traduce sin depender de las anteriores.
+//*		El hilo principal lee la traza (a traves de abrirTraza(), que la
+//*		descomprime si hace falta) en bloques grandes y la corta, en
+//*		finales de linea, en trozos de unos tamBloque pares (direccion,
+//*		proceso): una linea con ':' cuenta como un par y otra sin ':' como
+//*		numProcesos. Los trozos se guardan en un anillo de 4 por hilo y se
+//*		reparten por turno en la cola de cada hilo.
+//*		Cada hilo toma el trozo mas antiguo de su cola y, si esta vacia, lo
+//*		roba de la cola de otro hilo, de modo que los trozos lentos no
+//*		retrasan a los demas hilos. Lee las lineas del trozo como lo haria
+//*		fgets(), las traduce por bloques con traducirBloque() y escribe el
+//*		resultado en el escritor en memoria del propio trozo, anotando las lineas
+//*		incorrectas y sus estadisticas. Las busquedas en la tabla invertida
+//*		y las referencias de la segmentacion paginada se cuentan en una
+//*		copia de la paginacion y la segmentacion de cada hilo y se suman al
+//*		terminar.
+//*		El hilo principal escribe los trozos en el orden de la traza cuando
+//*		necesita reutilizar su hueco del anillo y al terminar, asi que la
+//*		salida es identica a la de traducirTraza() en un solo hilo.
+//*		Lectura, traduccion y escritura avanzan a la vez (los hilos formatean
+//*		cada trozo en su escritor), y como el anillo tiene un numero fijo de
+//*		trozos la memoria no depende de la longitud de la traza.
+//*
+//*************************************************************
+// Toma el trozo pendiente mas antiguo de la cola del hilo o, si no tiene, de otro hilo. Con el cerrojo tomado
+static int tomarTrozo(repartoTraza *r, int hilo, int *robado){
+	int i, cola, t;
+	
+	for (i = 0 ; i < r->numHilos ; i++){
+		cola = (hilo + i) % r->numHilos;
+		if (r->pendientes[cola] > 0){
+			t = r->colas[cola * r->numTrozos + r->cabeza[cola]];
+			r->cabeza[cola] = (r->cabeza[cola] + 1) % r->numTrozos;
+			r->pendientes[cola]--;
+			*robado = (i > 0);
+			return t;
+		}
+	}
+	
+	return -1;
+}
+
+// Anota una linea incorrecta del trozo. Devuelve 0 si no hay memoria suficiente
+static int anotarIncorrecta(trozoTraza *t, long linea){
+	long *aux;
+	
+	if (t->numIncorrectas == t->capacidadIncorrectas){
+		t->capacidadIncorrectas = (t->capacidadIncorrectas == 0) ? 64 : 2 * t->capacidadIncorrectas;
+		if ((aux = (long*)realloc(t->incorrectas, sizeof(long) * t->capacidadIncorrectas)) == NULL){
+			return 0;
+		}
+		t->incorrectas = aux;
+	}
+	
+	t->incorrectas[t->numIncorrectas++] = linea;
+	return 1;
+}
+
+// Traduce un trozo de la traza en la memoria del propio trozo. Devuelve 0 si no hay memoria suficiente
+static int traducirTrozo(hiloTraza *h, trozoTraza *t){
+	const repartoTraza *r = h->reparto;
+	char linea[longitudLinea];
+	const char *p = t->texto, *fin = t->texto + t->longitud, *salto;
+	size_t n;
+	direccion d;
+	int estado;
+	
+	t->salida.longitud = 0;
+	t->numLineas = 0;
+	t->numIncorrectas = 0;
+	t->numDirecciones = 0;
+	
+	while (p < fin){
+		// Igual que fgets(): hasta el salto de linea o longitudLinea - 1 caracteres
+		n = (size_t)(fin - p);
+		if (n > longitudLinea - 1){
+			n = longitudLinea - 1;
+		}
+		if ((salto = (const char*)memchr(p, '\n', n)) != NULL){
+			n = (size_t)(salto - p) + 1;
+		}
+		memcpy(linea, p, n);
+		linea[n] = '\0';
+		p += n;
+		t->numLineas++;
+		
+		estado = leerDireccion(linea, &d);
+		if (estado < 0 || d.proceso >= r->numProcesos){
+			if (!anotarIncorrecta(t, t->numLineas)){
+				return 0;
+			}
+			continue;
+		}
+		if (estado == 0){
+			continue;
+		}
+		
+		t->numDirecciones++;
+		if (!cabeEnBloque(&h->b, &d)){
+			traducirBloque(&h->b, r->t_registros, &h->paginas, &h->segmentos, &t->salida);
+		}
+		anadirBloque(&h->b, &d);
+	}
+	
+	traducirBloque(&h->b, r->t_registros, &h->paginas, &h->segmentos, &t->salida);
+	
+	return !t->salida.error;
+}
+
+// Funcion de cada hilo: traduce trozos hasta que se terminan
+static void *hiloTraduccion(void *argumento){
+	hiloTraza *h = (hiloTraza*)argumento;
+	repartoTraza *r = h->reparto;
+	int t, robado;
+	double inicio;
+	
+	pthread_mutex_lock(&r->cerrojo);
+	while (1){
+		while ((t = tomarTrozo(r, h->indice, &robado)) < 0 && !r->fin){
+			pthread_cond_wait(&r->hayTrabajo, &r->cerrojo);
+		}
+		if (t < 0){
+			break;
+		}
+		pthread_mutex_unlock(&r->cerrojo);
+		
+		inicio = segundosReloj();
+		if (!traducirTrozo(h, &r->trozos[t])){
+			fprintf (stderr, "Error. No hay memoria suficiente para traducir la traza.\n");
+			exit(1);
+		}
+		h->ocupado += segundosReloj() - inicio;
+		h->trozos++;
+		h->robados += robado;
+		h->direcciones += r->trozos[t].numDirecciones;
+		
+		pthread_mutex_lock(&r->cerrojo);
+		r->trozos[t].terminado = 1;
+		pthread_cond_signal(&r->trozoTerminado);
+	}
+	pthread_mutex_unlock(&r->cerrojo);
+	
+	return NULL;
+}
+
+// Espera a que el trozo t este traducido y lo escribe: primero las traducciones y despues los avisos
+static void escribirTrozo(repartoTraza *r, int t, escritor *salida, long *nLinea, long *nDirecciones){
+	trozoTraza *trozo = &r->trozos[t];
+	long i;
+	
+	pthread_mutex_lock(&r->cerrojo);
+	while (!trozo->terminado){
+		pthread_cond_wait(&r->trozoTerminado, &r->cerrojo);
+	}
+	pthread_mutex_unlock(&r->cerrojo);
+	
+	escribirDatos(salida, trozo->salida.datos, trozo->salida.longitud);
+	for (i = 0 ; i < trozo->numIncorrectas ; i++){
+		fprintf (stderr, "Linea %ld de la traza incorrecta. Se ignora.\n", *nLinea + trozo->incorrectas[i]);
+	}
+	
+	*nLinea += trozo->numLineas;
+	*nDirecciones += trozo->numDirecciones;
+}
+
+// Copia un trozo de la traza en el anillo, escribiendo antes el trozo anterior de ese hueco, y lo reparte
+static int enviarTrozo(repartoTraza *r, long secuencia, const char *texto, size_t longitud, escritor *salida, long *nLinea, long *nDirecciones){
+	int t = (int)(secuencia % r->numTrozos), cola = (int)(secuencia % r->numHilos);
+	trozoTraza *trozo = &r->trozos[t];
+	char *aux;
+	
+	if (secuencia >= r->numTrozos){
+		escribirTrozo(r, t, salida, nLinea, nDirecciones);
+	}
+	else if (!crearEscritor(&trozo->salida, tamBufferSalida / 16, salida->formato, salida->silencioso)){
+		return 0;
+	}
+	
+	if (longitud > trozo->capacidad){
+		if ((aux = (char*)realloc(trozo->texto, longitud)) == NULL){
+			return 0;
+		}
+		trozo->texto = aux;
+		trozo->capacidad = longitud;
+	}
+	memcpy(trozo->texto, texto, longitud);
+	trozo->longitud = longitud;
+	trozo->terminado = 0;
+	
+	pthread_mutex_lock(&r->cerrojo);
+	r->colas[cola * r->numTrozos + (r->cabeza[cola] + r->pendientes[cola]) % r->numTrozos] = t;
+	r->pendientes[cola]++;
+	pthread_cond_signal(&r->hayTrabajo);
+	pthread_mutex_unlock(&r->cerrojo);
+	
+	return 1;
+}
+
+int traducirTrazaParalela(char *traza, int numHilos, int numProcesos, const registro t_registros[], const paginacion *t_paginacion, const segmentacion *t_segmentacion, escritor *salida){
+	FILE *fp;
+	repartoTraza r;
+	hiloTraza *hilos;
+	char *lectura = NULL, *aux, *salto;
+	size_t capacidad = tamBufferSalida, longitud = 0, inicio = 0, posicion = 0, leidos;
+	long secuencia = 0, elementos = 0, nLinea = 0, nDirecciones = 0, j;
+	long long totalLeidos = 0;
+	int i, creados = 0, finFichero = 0, valido = 1, comprimida, descomprimida;
+	double comienzo = segundosReloj();
+	progresoTraza progreso;
+	
+	if ((fp = abrirTraza(traza, &comprimida)) == NULL){
+		fprintf (stderr, "Error. No ha sido posible abrir el fichero de traza \"%s\".\n", traza);
+		return 1;
+	}
+	iniciarProgreso(&progreso, fp, comprimida, salida->silencioso);
+	
+	r.numHilos = numHilos;
+	r.numTrozos = 4 * numHilos;
+	r.fin = 0;
+	r.numProcesos = numProcesos;
+	r.t_registros = t_registros;
+	r.t_paginacion = t_paginacion;
+	r.t_segmentacion = t_segmentacion;
+	r.trozos = (trozoTraza*)calloc(r.numTrozos, sizeof(trozoTraza));
+	r.colas = (int*)malloc(sizeof(int) * r.numTrozos * numHilos);
+	r.cabeza = (int*)calloc(numHilos, sizeof(int));
+	r.pendientes = (int*)calloc(numHilos, sizeof(int));
+	hilos = (hiloTraza*)calloc(numHilos, sizeof(hiloTraza));
+	lectura = (char*)malloc(capacidad);
+	
+	valido = (r.trozos != NULL && r.colas != NULL && r.cabeza != NULL && r.pendientes != NULL && hilos != NULL && lectura != NULL);
+	for (i = 0 ; valido && i < numHilos ; i++){
+		hilos[i].indice = i;
+		hilos[i].reparto = &r;
+		// Cada hilo cuenta las busquedas en la tabla invertida por separado
+		hilos[i].paginas = *t_paginacion;
+		if (t_paginacion->contadores != NULL){
+			hilos[i].paginas.contadores = &hilos[i].contadores;
+		}
+		hilos[i].segmentos = *t_segmentacion;
+		if (t_segmentacion->contadores != NULL){
+			hilos[i].segmentos.contadores = &hilos[i].contadoresSegmentos;
+		}
+		valido = crearBloque(&hilos[i].b, numProcesos);
+	}
+	
+	if (!valido){
+		fprintf (stderr, "Error. No hay memoria suficiente para traducir la traza.\n");
+		for (j = 0 ; hilos != NULL && j < i - 1 ; j++){
+			liberarBloque(&hilos[j].b);
+		}
+		free(r.trozos);
+		free(r.colas);
+		free(r.cabeza);
+		free(r.pendientes);
+		free(hilos);
+		free(lectura);
+		cerrarTraza(fp, comprimida, traza);
+		return 1;
+	}
+	
+	pthread_mutex_init(&r.cerrojo, NULL);
+	pthread_cond_init(&r.hayTrabajo, NULL);
+	pthread_cond_init(&r.trozoTerminado, NULL);
+	
+	for (creados = 0 ; creados < numHilos ; creados++){
+		if (pthread_create(&hilos[creados].id, NULL, hiloTraduccion, &hilos[creados]) != 0){
+			break;
+		}
+	}
+	valido = (creados > 0);
+	
+	escribirCabecera(salida);
+	
+	// Corte de la traza en trozos de lineas completas
+	while (valido){
+		salto = (char*)memchr(lectura + posicion, '\n', longitud - posicion);
+		
+		if (salto == NULL){
+			if (finFichero){
+				if (longitud > inicio){
+					valido = enviarTrozo(&r, secuencia++, lectura + inicio, longitud - inicio, salida, &nLinea, &nDirecciones);
+				}
+				break;
+			}
+			
+			// Se conserva la parte del trozo ya leida y se lee mas
+			memmove(lectura, lectura + inicio, longitud - inicio);
+			longitud -= inicio;
+			posicion -= inicio;
+			inicio = 0;
+			if (longitud == capacidad){
+				if ((aux = (char*)realloc(lectura, 2 * capacidad)) == NULL){
+					valido = 0;
+					break;
+				}
+				lectura = aux;
+				capacidad *= 2;
+			}
+			leidos = fread(lectura + longitud, 1, capacidad - longitud, fp);
+			longitud += leidos;
+			totalLeidos += leidos;
+			finFichero = (leidos == 0);
+			continue;
+		}
+		
+		elementos += (memchr(lectura + posicion, ':', (size_t)(salto - lectura) - posicion) != NULL) ? 1 : numProcesos;
+		posicion = (size_t)(salto - lectura) + 1;
+		
+		if (elementos >= tamBloque){
+			valido = enviarTrozo(&r, secuencia++, lectura + inicio, posicion - inicio, salida, &nLinea, &nDirecciones);
+			inicio = posicion;
+			elementos = 0;
+			avisarProgreso(&progreso, nDirecciones, totalLeidos - (long long)(longitud - posicion));
+		}
+	}
+	
+	pthread_mutex_lock(&r.cerrojo);
+	r.fin = 1;
+	pthread_cond_broadcast(&r.hayTrabajo);
+	pthread_mutex_unlock(&r.cerrojo);
+	
+	// Trozos que quedan por escribir, en orden
+	for (j = (secuencia > r.numTrozos) ? secuencia - r.numTrozos : 0 ; valido && j < secuencia ; j++){
+		escribirTrozo(&r, (int)(j % r.numTrozos), salida, &nLinea, &nDirecciones);
+	}
+	
+	for (i = 0 ; i < creados ; i++){
+		pthread_join(hilos[i].id, NULL);
+		if (t_paginacion->contadores != NULL){
+			t_paginacion->contadores->busquedas += hilos[i].contadores.busquedas;
+			t_paginacion->contadores->accesos += hilos[i].contadores.accesos;
+		}
+		if (t_segmentacion->contadores != NULL){
+			t_segmentacion->contadores->busquedas += hilos[i].contadoresSegmentos.busquedas;
+			t_segmentacion->contadores->accesos += hilos[i].contadoresSegmentos.accesos;
+		}
+	}
+	
+	vaciarEscritor(salida);
+	
+	descomprimida = cerrarTraza(fp, comprimida, traza);
+	
+	if (valido && descomprimida && !salida->silencioso){
+		fprintf (stderr, "Traducidas %ld direcciones logicas en %d procesos con %d hilos (%.3f s).\n",
+				nDirecciones, numProcesos, creados, segundosReloj() - comienzo);
+		for (i = 0 ; i < creados ; i++){
+			fprintf (stderr, "\tHilo %d: %ld trozos (%ld robados), %ld direcciones, %.3f s traduciendo\n",
+					i, hilos[i].trozos, hilos[i].robados, hilos[i].direcciones, hilos[i].ocupado);
+		}
+		mostrarEstadisticasPaginacion(t_paginacion, numProcesos, stderr);
+		mostrarEstadisticasSegmentacion(t_segmentacion, stderr);
+	}
+	else if (!valido){
+		fprintf (stderr, "Error. No hay memoria suficiente para traducir la traza.\n");
+	}
+	
+	pthread_mutex_destroy(&r.cerrojo);
+	pthread_cond_destroy(&r.hayTrabajo);
+	pthread_cond_destroy(&r.trozoTerminado);
+	for (i = 0 ; i < r.numTrozos ; i++){
+		free(r.trozos[i].texto);
+		liberarEscritor(&r.trozos[i].salida);
+		free(r.trozos[i].incorrectas);
+	}
+	for (i = 0 ; i < numHilos ; i++){
+		liberarBloque(&hilos[i].b);
+	}
+	free(r.trozos);
+	free(r.colas);
+	free(r.cabeza);
+	free(r.pendientes);
+	free(hilos);
+	free(lectura);
+	
+	return (valido && descomprimida) ? 0 : 1;
+}
+
+#endif
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funciones del arbol de huecos libres del asignador de
+//*			 particiones dinamicas.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Cada hueco libre es un nodo de un treap (arbol binario de busqueda
+//*		con prioridades aleatorias, de profundidad logaritmica esperada).
+//*		Los nodos estan en un array y se enlazan por indice (-1 = vacio).
+//*		Un mismo nodo pertenece a dos arboles:
+//*			- Por direccion (izq, der): ademas guarda el mayor hueco de su
+//*			  subarbol (maxTamano), lo que permite encontrar en O(log n) el
+//*			  primer hueco suficiente a partir de una direccion (primer y
+//*			  siguiente ajuste) o el mayor hueco (peor ajuste), y localizar
+//*			  los huecos vecinos al liberar para fusionarlos.
+//*			- Por tamano y direccion (izqT, derT): el menor hueco suficiente
+//*			  (mejor ajuste) es una busqueda de cota inferior.
+//*		El sistema buddy usa un arbol por direccion para cada orden.
+//*		Todas las operaciones se basan en dividir y unir arboles, y cuentan
+//*		los nodos visitados en "pasos" para medir su coste.
+//*
+//*************************************************************
+static void actualizarMaximo(asignador *a, int t){
+	nodoHueco *n = &a->nodos[t];
+	
+	n->maxTamano = n->tamano;
+	if (n->izq != -1 && a->nodos[n->izq].maxTamano > n->maxTamano){
+		n->maxTamano = a->nodos[n->izq].maxTamano;
+	}
+	if (n->der != -1 && a->nodos[n->der].maxTamano > n->maxTamano){
+		n->maxTamano = a->nodos[n->der].maxTamano;
+	}
+}
+
+// Divide el arbol por direccion "t" en los huecos con inicio menor que "clave" y el resto
+static void dividirDireccion(asignador *a, int t, int clave, int *izq, int *der){
+	if (t == -1){
+		*izq = *der = -1;
+		return;
+	}
+	
+	a->pasos++;
+	if (a->nodos[t].inicio < clave){
+		dividirDireccion(a, a->nodos[t].der, clave, &a->nodos[t].der, der);
+		*izq = t;
+	}
+	else{
+		dividirDireccion(a, a->nodos[t].izq, clave, izq, &a->nodos[t].izq);
+		*der = t;
+	}
+	actualizarMaximo(a, t);
+}
+
+// Une dos arboles por direccion, con todos los huecos de "x" antes que los de "y"
+static int unirDireccion(asignador *a, int x, int y){
+	if (x == -1 || y == -1){
+		return (x == -1) ? y : x;
+	}
+	
+	a->pasos++;
+	if (a->nodos[x].prioridad > a->nodos[y].prioridad){
+		a->nodos[x].der = unirDireccion(a, a->nodos[x].der, y);
+		actualizarMaximo(a, x);
+		return x;
+	}
+	a->nodos[y].izq = unirDireccion(a, x, a->nodos[y].izq);
+	actualizarMaximo(a, y);
+	return y;
+}
+
+static void insertarDireccion(asignador *a, int *raiz, int n){
+	int izq, der;
+	
+	dividirDireccion(a, *raiz, a->nodos[n].inicio, &izq, &der);
+	*raiz = unirDireccion(a, unirDireccion(a, izq, n), der);
+}
+
+// Saca del arbol el hueco que empieza en "inicio" y devuelve su nodo, o -1 si no existe
+static int borrarDireccion(asignador *a, int *raiz, int inicio){
+	int izq, medio, der;
+	
+	dividirDireccion(a, *raiz, inicio, &izq, &der);
+	dividirDireccion(a, der, inicio + 1, &medio, &der);
+	*raiz = unirDireccion(a, izq, der);
+	return medio;
+}
+
+// Orden del arbol por tamano: compara (tamano, inicio) de un nodo con una clave
+static int menorTamano(const nodoHueco *n, int tamano, int inicio){
+	return n->tamano < tamano || (n->tamano == tamano && n->inicio < inicio);
+}
+
+static void dividirTamano(asignador *a, int t, int tamano, int inicio, int *izq, int *der){
+	if (t == -1){
+		*izq = *der = -1;
+		return;
+	}
+	
+	a->pasos++;
+	if (menorTamano(&a->nodos[t], tamano, inicio)){
+		dividirTamano(a, a->nodos[t].derT, tamano, inicio, &a->nodos[t].derT, der);
+		*izq = t;
+	}
+	else{
+		dividirTamano(a, a->nodos[t].izqT, tamano, inicio, izq, &a->nodos[t].izqT);
+		*der = t;
+	}
+}
+
+static int unirTamano(asignador *a, int x, int y){
+	if (x == -1 || y == -1){
+		return (x == -1) ? y : x;
+	}
+	
+	a->pasos++;
+	if (a->nodos[x].prioridad > a->nodos[y].prioridad){
+		a->nodos[x].derT = unirTamano(a, a->nodos[x].derT, y);
+		return x;
+	}
+	a->nodos[y].izqT = unirTamano(a, x, a->nodos[y].izqT);
+	return y;
+}
+
+static void insertarTamano(asignador *a, int n){
+	int izq, der;
+	
+	dividirTamano(a, a->raizTamano, a->nodos[n].tamano, a->nodos[n].inicio, &izq, &der);
+	a->raizTamano = unirTamano(a, unirTamano(a, izq, n), der);
+}
+
+static void borrarTamano(asignador *a, int n){
+	int izq, medio, der;
+	
+	dividirTamano(a, a->raizTamano, a->nodos[n].tamano, a->nodos[n].inicio, &izq, &der);
+	dividirTamano(a, der, a->nodos[n].tamano, a->nodos[n].inicio + 1, &medio, &der);
+	a->raizTamano = unirTamano(a, izq, der);
+}
+
+// Reserva un nodo del array (reutilizando los liberados) o devuelve -1 si no hay memoria
+static int nuevoHueco(asignador *a, int inicio, int tamano){
+	nodoHueco *aux;
+	int n;
+	
+	if (a->nodoLibre != -1){
+		n = a->nodoLibre;
+		a->nodoLibre = a->nodos[n].izq;
+	}
+	else{
+		if (a->numNodos == a->capacidadNodos){
+			a->capacidadNodos = (a->capacidadNodos == 0) ? 1024 : 2 * a->capacidadNodos;
+			if ((aux = (nodoHueco*)realloc(a->nodos, sizeof(nodoHueco) * a->capacidadNodos)) == NULL){
+				return -1;
+			}
+			a->nodos = aux;
+		}
+		n = a->numNodos++;
+	}
+	
+	a->semilla ^= a->semilla << 13;
+	a->semilla ^= a->semilla >> 7;
+	a->semilla ^= a->semilla << 17;
+	
+	a->nodos[n].inicio = inicio;
+	a->nodos[n].tamano = tamano;
+	a->nodos[n].maxTamano = tamano;
+	a->nodos[n].prioridad = (unsigned int)a->semilla;
+	a->nodos[n].izq = a->nodos[n].der = a->nodos[n].izqT = a->nodos[n].derT = -1;
+	return n;
+}
+
+static void liberarHueco(asignador *a, int n){
+	a->nodos[n].izq = a->nodoLibre;
+	a->nodoLibre = n;
+}
+
+// Primer hueco, por direccion, que empieza en "desde" o despues y tiene al menos "tamano"
+static int buscarPrimerHueco(asignador *a, int t, int desde, int tamano){
+	int r;
+	
+	if (t == -1 || a->nodos[t].maxTamano < tamano){
+		return -1;
+	}
+	
+	a->pasos++;
+	if (a->nodos[t].inicio >= desde){
+		if ((r = buscarPrimerHueco(a, a->nodos[t].izq, desde, tamano)) != -1){
+			return r;
+		}
+		if (a->nodos[t].tamano >= tamano){
+			return t;
+		}
+	}
+	return buscarPrimerHueco(a, a->nodos[t].der, desde, tamano);
+}
+
+// Menor hueco con al menos "tamano" (a igual tamano, el de menor direccion)
+static int buscarMejorHueco(asignador *a, int tamano){
+	int t = a->raizTamano, r = -1;
+	
+	while (t != -1){
+		a->pasos++;
+		if (a->nodos[t].tamano >= tamano){
+			r = t;
+			t = a->nodos[t].izqT;
+		}
+		else{
+			t = a->nodos[t].derT;
+		}
+	}
+	return r;
+}
+
+// Mayor hueco (a igual tamano, el de menor direccion)
+static int buscarPeorHueco(asignador *a, int tamano){
+	int t = a->raiz, maximo;
+	
+	if (t == -1 || a->nodos[t].maxTamano < tamano){
+		return -1;
+	}
+	
+	maximo = a->nodos[t].maxTamano;
+	for (;;){
+		a->pasos++;
+		if (a->nodos[t].izq != -1 && a->nodos[a->nodos[t].izq].maxTamano == maximo){
+			t = a->nodos[t].izq;
+		}
+		else if (a->nodos[t].tamano == maximo){
+			return t;
+		}
+		else{
+			t = a->nodos[t].der;
+		}
+	}
+}
+
+// Recalcula maxTamano en el camino desde "t" hasta el hueco que empieza en "inicio"
+static void recalcularCamino(asignador *a, int t, int inicio){
+	if (t == -1){
+		return;
+	}
+	
+	a->pasos++;
+	if (a->nodos[t].inicio > inicio){
+		recalcularCamino(a, a->nodos[t].izq, inicio);
+	}
+	else if (a->nodos[t].inicio < inicio){
+		recalcularCamino(a, a->nodos[t].der, inicio);
+	}
+	actualizarMaximo(a, t);
+}
+
+// Hueco que empieza en "inicio", o -1 si no existe
+static int buscarHueco(asignador *a, int inicio){
+	int t = a->raiz;
+	
+	while (t != -1 && a->nodos[t].inicio != inicio){
+		a->pasos++;
+		t = (a->nodos[t].inicio > inicio) ? a->nodos[t].izq : a->nodos[t].der;
+	}
+	return t;
+}
+
+// Ultimo hueco que empieza antes de "inicio"
+static int buscarHuecoAnterior(asignador *a, int inicio){
+	int t = a->raiz, r = -1;
+	
+	while (t != -1){
+		a->pasos++;
+		if (a->nodos[t].inicio < inicio){
+			r = t;
+			t = a->nodos[t].der;
+		}
+		else{
+			t = a->nodos[t].izq;
+		}
+	}
+	return r;
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funciones del asignador de particiones dinamicas para el
+//*			 metodo de registro base/limite.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		configurarAsignador() parte de una memoria libre de "memoria"
+//*		posiciones: un unico hueco o, en el sistema buddy, la descomposicion
+//*		de la memoria en bloques alineados de potencias de 2.
+//*
+//*		asignarParticion() busca un hueco segun la politica:
+//*			- Primer ajuste: el hueco de menor direccion suficiente.
+//*			- Siguiente ajuste: igual, pero empezando donde acabo la ultima
+//*			  asignacion y volviendo al principio si no hay ninguno.
+//*			- Mejor ajuste: el menor hueco suficiente.
+//*			- Peor ajuste: el mayor hueco.
+//*		La particion ocupa el principio del hueco y el resto sigue libre.
+//*		En el sistema buddy se toma el menor bloque libre de orden
+//*		suficiente y se divide por la mitad hasta llegar al orden pedido.
+//*
+//*		liberarParticion() devuelve la particion a la memoria libre,
+//*		fusionandola con los huecos contiguos (o con su buddy mientras
+//*		este libre).
+//*
+//*		Todas las operaciones son O(log n) en el numero de huecos.
+//*
+//*************************************************************
+int configurarAsignador(asignador *a, int politica, int memoria){
+	int orden, inicio, n;
+	
+	memset(a, 0, sizeof(asignador));
+	a->politica = politica;
+	a->memoria = memoria;
+	a->libre = memoria;
+	a->raiz = a->raizTamano = a->raizOcupados = a->nodoLibre = -1;
+	a->semilla = 88172645463325252ULL;
+	
+	for (orden = 0 ; orden < ordenesBuddy ; orden++){
+		a->raizOrden[orden] = -1;
+	}
+	
+	if (politica != ASIG_BUDDY){
+		if ((n = nuevoHueco(a, 0, memoria)) == -1){
+			return 0;
+		}
+		insertarDireccion(a, &a->raiz, n);
+		insertarTamano(a, n);
+	}
+	else{
+		// Bloques alineados de mayor a menor: la memoria es una suma de potencias de 2
+		for (inicio = 0, orden = ordenesBuddy - 1 ; orden >= 0 ; orden--){
+			if (memoria & (1 << orden)){
+				if ((n = nuevoHueco(a, inicio, 1 << orden)) == -1){
+					return 0;
+				}
+				insertarDireccion(a, &a->raizOrden[orden], n);
+				inicio += 1 << orden;
+			}
+		}
+	}
+	
+	a->pasos = 0;
+	return 1;
+}
+
+void liberarAsignador(asignador *a){
+	free(a->nodos);
+	a->nodos = NULL;
+}
+
+// Menor orden cuyo bloque tiene al menos "tamano" posiciones
+static int ordenBuddy(int tamano){
+	int orden = 0;
+	
+	while ((1 << orden) < tamano){
+		orden++;
+	}
+	return orden;
+}
+
+// Mayor hueco libre, para la fragmentacion externa
+int mayorHueco(const asignador *a){
+	int orden;
+	
+	if (a->politica != ASIG_BUDDY){
+		return (a->raiz != -1) ? a->nodos[a->raiz].maxTamano : 0;
+	}
+	
+	for (orden = ordenesBuddy - 1 ; orden >= 0 && a->raizOrden[orden] == -1 ; orden--);
+	return (orden >= 0) ? 1 << orden : 0;
+}
+
+int asignarParticion(asignador *a, int tamano){
+	int n, m, inicio, orden, k;
+	
+	if (a->politica == ASIG_BUDDY){
+		if (tamano > 1 << (ordenesBuddy - 1)){
+			return -1;
+		}
+		
+		orden = ordenBuddy(tamano);
+		for (k = orden ; k < ordenesBuddy && a->raizOrden[k] == -1 ; k++);
+		if (k == ordenesBuddy){
+			return -1;
+		}
+		
+		// Bloque de menor direccion del orden k
+		for (n = a->raizOrden[k] ; a->nodos[n].izq != -1 ; n = a->nodos[n].izq){
+			a->pasos++;
+		}
+		inicio = a->nodos[n].inicio;
+		borrarDireccion(a, &a->raizOrden[k], inicio);
+		liberarHueco(a, n);
+		
+		// Division en mitades: la mitad superior queda libre en el orden inferior
+		while (k > orden){
+			k--;
+			if ((m = nuevoHueco(a, inicio + (1 << k), 1 << k)) == -1){
+				return -2;
+			}
+			insertarDireccion(a, &a->raizOrden[k], m);
+		}
+		
+		a->libre -= 1 << orden;
+		return inicio;
+	}
+	
+	switch (a->politica){
+		case ASIG_PRIMERO:
+			n = buscarPrimerHueco(a, a->raiz, 0, tamano);
+			break;
+		case ASIG_SIGUIENTE:
+			n = buscarPrimerHueco(a, a->raiz, a->cursor, tamano);
+			if (n == -1){
+				n = buscarPrimerHueco(a, a->raiz, 0, tamano);
+			}
+			break;
+		case ASIG_MEJOR:
+			n = buscarMejorHueco(a, tamano);
+			break;
+		default:
+			n = buscarPeorHueco(a, tamano);
+			break;
+	}
+	
+	if (n == -1){
+		return -1;
+	}
+	
+	inicio = a->nodos[n].inicio;
+	borrarTamano(a, n);
+	
+	if (a->nodos[n].tamano == tamano){
+		borrarDireccion(a, &a->raiz, inicio);
+		liberarHueco(a, n);
+	}
+	else{
+		// El resto del hueco conserva su posicion en el arbol por direccion: solo cambia su camino
+		a->nodos[n].inicio += tamano;
+		a->nodos[n].tamano -= tamano;
+		a->nodos[n].izqT = a->nodos[n].derT = -1;
+		recalcularCamino(a, a->raiz, a->nodos[n].inicio);
+		insertarTamano(a, n);
+	}
+	
+	a->cursor = inicio + tamano;
+	a->libre -= tamano;
+	return inicio;
+}
+
+int liberarParticion(asignador *a, int inicio, int tamano){
+	int n, vecino, anterior, siguiente, orden;
+	
+	if (a->politica == ASIG_BUDDY){
+		orden = ordenBuddy(tamano);
+		a->libre += 1 << orden;
+		
+		// Fusion con el buddy mientras este libre
+		while (orden < ordenesBuddy - 1 && (vecino = borrarDireccion(a, &a->raizOrden[orden], inicio ^ (1 << orden))) != -1){
+			liberarHueco(a, vecino);
+			inicio &= ~(1 << orden);
+			orden++;
+		}
+		
+		if ((n = nuevoHueco(a, inicio, 1 << orden)) == -1){
+			return 0;
+		}
+		insertarDireccion(a, &a->raizOrden[orden], n);
+		return 1;
+	}
+	
+	a->libre += tamano;
+	
+	// Huecos contiguos anterior y siguiente
+	anterior = buscarHuecoAnterior(a, inicio);
+	if (anterior != -1 && a->nodos[anterior].inicio + a->nodos[anterior].tamano != inicio){
+		anterior = -1;
+	}
+	siguiente = buscarHueco(a, inicio + tamano);
+	
+	if (anterior != -1 && siguiente != -1){
+		// Los tres se funden en el hueco anterior
+		borrarTamano(a, siguiente);
+		borrarDireccion(a, &a->raiz, inicio + tamano);
+		tamano += a->nodos[siguiente].tamano;
+		liberarHueco(a, siguiente);
+	}
+	
+	if (anterior != -1){
+		borrarTamano(a, anterior);
+		a->nodos[anterior].tamano += tamano;
+		n = anterior;
+	}
+	else if (siguiente != -1){
+		// El hueco siguiente pasa a empezar en la particion liberada, sin cambiar de orden
+		borrarTamano(a, siguiente);
+		a->nodos[siguiente].inicio = inicio;
+		a->nodos[siguiente].tamano += tamano;
+		n = siguiente;
+	}
+	else{
+		if ((n = nuevoHueco(a, inicio, tamano)) == -1){
+			return 0;
+		}
+		insertarDireccion(a, &a->raiz, n);
+		insertarTamano(a, n);
+		return 1;
+	}
+	
+	// El hueco ampliado conserva su posicion en el arbol por direccion
+	a->nodos[n].izqT = a->nodos[n].derT = -1;
+	recalcularCamino(a, a->raiz, a->nodos[n].inicio);
+	insertarTamano(a, n);
+	return 1;
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funciones que mantienen el arbol de elementos ocupados del
+//*			 asignador y compactan la memoria.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Los elementos asignados (segmentos) se guardan en un arbol por
+//*		direccion, con los mismos nodos que los huecos, para recorrerlos en
+//*		orden de direccion sin ordenar nada en cada compactacion.
+//*
+//*		compactarMemoria() recorre ese arbol en orden y desplaza cada
+//*		elemento al final del anterior, empezando en la posicion 0, de modo
+//*		que conservan su orden y toda la memoria libre queda en un unico
+//*		hueco al final. Como el orden no cambia, el arbol sigue siendo
+//*		valido tras reescribir las direcciones. La nueva base de cada
+//*		elemento se escribe en "elementos" (por ejemplo, la SDT) y se
+//*		devuelven las posiciones de memoria movidas. Es O(n) en el numero
+//*		de elementos y huecos.
+//*
+//*************************************************************
+int marcarOcupado(asignador *a, int inicio, int tamano, int propietario){
+	int n;
+	
+	if ((n = nuevoHueco(a, inicio, tamano)) == -1){
+		return 0;
+	}
+	a->nodos[n].propietario = propietario;
+	insertarDireccion(a, &a->raizOcupados, n);
+	return 1;
+}
+
+void desmarcarOcupado(asignador *a, int inicio){
+	int n = borrarDireccion(a, &a->raizOcupados, inicio);
+	
+	if (n != -1){
+		liberarHueco(a, n);
+	}
+}
+
+// Desplaza los elementos del subarbol "t" a partir de la posicion "*cursor"
+static void desplazarOcupados(asignador *a, int t, int *cursor, registro elementos[], long long *movidas){
+	nodoHueco *n;
+	
+	if (t == -1){
+		return;
+	}
+	
+	desplazarOcupados(a, a->nodos[t].izq, cursor, elementos, movidas);
+	
+	n = &a->nodos[t];
+	if (n->inicio != *cursor){
+		*movidas += n->tamano;
+		n->inicio = *cursor;
+		elementos[n->propietario].base = *cursor;
+	}
+	*cursor += n->tamano;
+	
+	desplazarOcupados(a, a->nodos[t].der, cursor, elementos, movidas);
+}
+
+// Devuelve a la lista de nodos libres todos los huecos del subarbol "t"
+static void vaciarHuecos(asignador *a, int t){
+	if (t == -1){
+		return;
+	}
+	vaciarHuecos(a, a->nodos[t].izq);
+	vaciarHuecos(a, a->nodos[t].der);
+	liberarHueco(a, t);
+}
+
+long long compactarMemoria(asignador *a, registro elementos[]){
+	long long movidas = 0;
+	int cursor = 0, n;
+	
+	desplazarOcupados(a, a->raizOcupados, &cursor, elementos, &movidas);
+	
+	vaciarHuecos(a, a->raiz);
+	a->raiz = a->raizTamano = -1;
+	a->cursor = cursor;
+	
+	if (cursor < a->memoria && (n = nuevoHueco(a, cursor, a->memoria - cursor)) != -1){
+		insertarDireccion(a, &a->raiz, n);
+		insertarTamano(a, n);
+	}
+	
+	return movidas;
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funcion que carga el fichero de eventos del asignador de
+//*			 particiones dinamicas o de segmentos.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		La primera linea con datos es el tamano de la memoria. Cada una de
+//*		las siguientes es la llegada de un proceso con el tamano de su
+//*		particion ("+3 1200") o, si "segmentos" es 1, con el de cada uno de
+//*		sus segmentos ("+3 1200 300 80"), o bien su finalizacion ("-3").
+//*		Los tamanos de todas las llegadas se guardan seguidos en un unico
+//*		array y cada evento indica donde empiezan los suyos.
+//*		Los numeros de proceso del fichero se ordenan y cada evento guarda
+//*		la posicion del suyo (numerarProcesos), de modo que los simuladores
+//*		reservan un elemento por proceso distinto y no por el mayor numero.
+//*		Las lineas vacias y las que empiezan por '#' se ignoran, y las
+//*		incorrectas se avisan y se ignoran.
+//*		Devuelve 1 si se ha cargado el fichero y 0 si no.
+//*
+//*************************************************************
+// Orden de las claves (proceso, evento) de numerarProcesos()
+static int compararClaves(const void *a, const void *b){
+	unsigned long long x = *(const unsigned long long*)a, y = *(const unsigned long long*)b;
+	
+	return (x > y) - (x < y);
+}
+
+// Sustituye el numero de proceso de cada evento por su posicion entre los procesos distintos, ordenados
+static int numerarProcesos(listaEventos *e){
+	unsigned long long *claves;
+	long j;
+	
+	claves = (unsigned long long*)malloc(sizeof(unsigned long long) * (e->numEventos + 1));
+	e->procesos = (int*)malloc(sizeof(int) * (e->numEventos + 1));
+	if (claves == NULL || e->procesos == NULL){
+		free(claves);
+		return 0;
+	}
+	
+	for (j = 0 ; j < e->numEventos ; j++){
+		claves[j] = ((unsigned long long)e->v[j].proceso << 32) | (unsigned long long)j;
+	}
+	qsort(claves, e->numEventos, sizeof(unsigned long long), compararClaves);
+	
+	for (j = 0, e->numProcesos = 0 ; j < e->numEventos ; j++){
+		if (e->numProcesos == 0 || e->procesos[e->numProcesos - 1] != (int)(claves[j] >> 32)){
+			e->procesos[e->numProcesos++] = (int)(claves[j] >> 32);
+		}
+		e->v[claves[j] & 0xFFFFFFFFULL].proceso = e->numProcesos - 1;
+	}
+	
+	free(claves);
+	return 1;
+}
+
+// Posicion del proceso "proceso" del fichero en la lista de eventos, o -1 si no tiene eventos
+static int buscarProcesoEventos(const listaEventos *e, int proceso){
+	int izq = 0, der = e->numProcesos - 1, m;
+	
+	while (izq <= der){
+		m = izq + (der - izq) / 2;
+		if (e->procesos[m] == proceso){
+			return m;
+		}
+		if (e->procesos[m] < proceso){
+			izq = m + 1;
+		}
+		else{
+			der = m - 1;
+		}
+	}
+	return -1;
+}
+
+int cargarEventos(const char *fichero, int segmentos, listaEventos *e){
+	FILE *fp;
+	char linea[longitudLinea], *p, *fin;
+	evento *aux;
+	int *auxTamanos;
+	long capacidad = 0, capacidadTamanos = 0, nLinea = 0, proceso, tamano;
+	int signo, valido, numTamanos;
+	
+	memset(e, 0, sizeof(listaEventos));
+	
+	if ((fp = fopen(fichero, "r")) == NULL){
+		fprintf (stderr, "Error. No ha sido posible abrir el fichero de eventos \"%s\".\n", fichero);
+		return 0;
+	}
+	
+	while (fgets(linea, longitudLinea, fp) != NULL){
+		nLinea++;
+		
+		for (p = linea ; *p == ' ' || *p == '\t' ; p++);
+		if (*p == '\0' || *p == '\n' || *p == '\r' || *p == '#'){
+			continue;
+		}
+		
+		if (e->memoria == 0){
+			tamano = strtol(p, &fin, 10);
+			if (fin == p || tamano <= 0 || tamano > INT_MAX){
+				fprintf (stderr, "Error. La linea %ld del fichero de eventos debe ser el tamano de la memoria.\n", nLinea);
+				fclose(fp);
+				liberarEventos(e);
+				return 0;
+			}
+			e->memoria = (int)tamano;
+			continue;
+		}
+		
+		if (e->numEventos == capacidad){
+			capacidad = (capacidad == 0) ? 4096 : 2 * capacidad;
+			if ((aux = (evento*)realloc(e->v, sizeof(evento) * capacidad)) == NULL){
+				fprintf (stderr, "Error. No hay memoria suficiente para los eventos.\n");
+				fclose(fp);
+				liberarEventos(e);
+				return 0;
+			}
+			e->v = aux;
+		}
+		
+		signo = *p;
+		proceso = strtol(p + 1, &fin, 10);
+		numTamanos = 0;
+		valido = (signo == '+' || signo == '-') && fin != p + 1 && proceso >= 0 && proceso < INT_MAX;
+		
+		// Tamanos de la llegada, a continuacion de los de las anteriores
+		while (valido && signo == '+'){
+			p = fin;
+			tamano = strtol(p, &fin, 10);
+			if (fin == p){
+				break;
+			}
+			if (tamano <= 0 || tamano > INT_MAX || (numTamanos == 1 && !segmentos)){
+				valido = 0;
+				break;
+			}
+			
+			if (e->numTamanos + numTamanos == capacidadTamanos){
+				capacidadTamanos = (capacidadTamanos == 0) ? 4096 : 2 * capacidadTamanos;
+				if ((auxTamanos = (int*)realloc(e->tamanos, sizeof(int) * capacidadTamanos)) == NULL){
+					fprintf (stderr, "Error. No hay memoria suficiente para los eventos.\n");
+					fclose(fp);
+					liberarEventos(e);
+					return 0;
+				}
+				e->tamanos = auxTamanos;
+			}
+			e->tamanos[e->numTamanos + numTamanos++] = (int)tamano;
+		}
+		
+		while (*fin == ' ' || *fin == '\t' || *fin == '\r' || *fin == '\n'){
+			fin++;
+		}
+		
+		if (!valido || *fin != '\0' || (signo == '+' && numTamanos == 0)){
+			fprintf (stderr, "Linea %ld del fichero de eventos incorrecta. Se ignora.\n", nLinea);
+			continue;
+		}
+		
+		e->v[e->numEventos].proceso = (int)proceso;
+		e->v[e->numEventos].numTamanos = numTamanos;
+		e->v[e->numEventos].primerTamano = e->numTamanos;
+		e->numTamanos += numTamanos;
+		e->numEventos++;
+	}
+	
+	fclose(fp);
+	
+	if (e->memoria == 0){
+		fprintf (stderr, "Error. El fichero de eventos no indica el tamano de la memoria.\n");
+		liberarEventos(e);
+		return 0;
+	}
+	
+	if (!numerarProcesos(e)){
+		fprintf (stderr, "Error. No hay memoria suficiente para los eventos.\n");
+		liberarEventos(e);
+		return 0;
+	}
+	
+	return 1;
+}
+
+void liberarEventos(listaEventos *e){
+	free(e->v);
+	free(e->tamanos);
+	free(e->procesos);
+	e->v = NULL;
+	e->tamanos = NULL;
+	e->procesos = NULL;
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funcion que simula la llegada y salida de procesos con
+//*			 particiones dinamicas para cada politica de asignacion.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Por cada politica recorre los eventos asignando y liberando las
+//*		particiones de los procesos. Una llegada que no cabe en ningun hueco
+//*		es un fallo de asignacion (el proceso no llega a ejecutarse y su
+//*		finalizacion se ignora). Tras cada evento mide la fragmentacion
+//*		externa, 1 - (mayor hueco / memoria libre), y al final escribe por
+//*		la salida estandar una linea por politica con:
+//*			- Asignaciones realizadas y fallos de asignacion.
+//*			- Fragmentacion externa media y final.
+//*			- Fragmentacion interna final (solo buddy): memoria asignada de
+//*			  mas al redondear las particiones a potencias de 2.
+//*			- Coste por operacion: nodos de los arboles visitados y tiempo
+//*			  de las llamadas al asignador (reloj monotono), sin contar la
+//*			  medida de la fragmentacion tras cada evento.
+//*		Con una sola politica, las particiones de los procesos del fichero de
+//*		datos que siguen en memoria al final pasan a ser su registro base y
+//*		limite (el resto quedan vacias), de modo que la traza posterior, si
+//*		la hay, se traduce con ellas.
+//*
+//*************************************************************
+int simularAsignacion(const listaEventos *e, const int politicas[], int numPoliticas, registro t_registros[], int numProcesos){
+	static const char *nombres[] = {"primero", "siguiente", "mejor", "peor", "buddy"};
+	asignador a;
+	registro *particiones;
+	long j, asignaciones, fallos, operaciones;
+	long long interna, ocupado;
+	double fragmentacion, suma, tiempo, instante;
+	int i, p, inicio, tamano, estado;
+	
+	particiones = (registro*)malloc(sizeof(registro) * (e->numProcesos + 1));
+	if (particiones == NULL){
+		fprintf (stderr, "Error. No hay memoria suficiente para las particiones.\n");
+		return 1;
+	}
+	
+	printf ("# politica\tasignaciones\tfallos\tfrag.externa media\tfrag.externa final\tfrag.interna\tnodos/operacion\tns/operacion\n");
+	
+	for (p = 0 ; p < numPoliticas ; p++){
+		if (!configurarAsignador(&a, politicas[p], e->memoria)){
+			fprintf (stderr, "Error. No hay memoria suficiente para el asignador.\n");
+			free(particiones);
+			return 1;
+		}
+		
+		for (i = 0 ; i < e->numProcesos ; i++){
+			particiones[i].base = -1;
+			particiones[i].limite = -1;
+		}
+		
+		asignaciones = fallos = operaciones = 0;
+		interna = ocupado = 0;
+		suma = tiempo = 0;
+		
+		for (j = 0 ; j < e->numEventos ; j++){
+			i = e->v[j].proceso;
+			
+			if (e->v[j].numTamanos > 0 && particiones[i].base == -1){
+				// Llegada del proceso
+				operaciones++;
+				tamano = e->tamanos[e->v[j].primerTamano];
+				instante = segundosReloj();
+				inicio = asignarParticion(&a, tamano);
+				tiempo += segundosReloj() - instante;
+				if (inicio == -2){
+					fprintf (stderr, "Error. No hay memoria suficiente para el asignador.\n");
+					break;
+				}
+				if (inicio == -1){
+					fallos++;
+				}
+				else{
+					asignaciones++;
+					particiones[i].base = inicio;
+					particiones[i].limite = tamano - 1;
+					ocupado += tamano;
+					if (a.politica == ASIG_BUDDY){
+						interna += (1LL << ordenBuddy(tamano)) - tamano;
+					}
+				}
+			}
+			else if (e->v[j].numTamanos == 0 && particiones[i].base != -1){
+				// Finalizacion del proceso
+				operaciones++;
+				tamano = particiones[i].limite + 1;
+				instante = segundosReloj();
+				estado = liberarParticion(&a, particiones[i].base, tamano);
+				tiempo += segundosReloj() - instante;
+				if (!estado){
+					fprintf (stderr, "Error. No hay memoria suficiente para el asignador.\n");
+					break;
+				}
+				particiones[i].base = -1;
+				ocupado -= tamano;
+				if (a.politica == ASIG_BUDDY){
+					interna -= (1LL << ordenBuddy(tamano)) - tamano;
+				}
+			}
+			
+			suma += (a.libre > 0) ? 1 - (double)mayorHueco(&a) / a.libre : 0;
+		}
+		
+		fragmentacion = (a.libre > 0) ? 1 - (double)mayorHueco(&a) / a.libre : 0;
+		
+		printf ("%s\t%ld\t%ld\t%.4f\t%.4f\t%.4f\t%.2f\t%.1f\n", nombres[politicas[p]], asignaciones, fallos,
+				(e->numEventos > 0) ? suma / e->numEventos : 0, fragmentacion, (ocupado + interna > 0) ? (double)interna / (ocupado + interna) : 0,
+				(operaciones > 0) ? (double)a.pasos / operaciones : 0, (operaciones > 0) ? 1e9 * tiempo / operaciones : 0);
+		
+		fprintf (stderr, "Asignacion %s: %ld eventos, %ld asignaciones, %ld fallos, %d posiciones libres de %d.\n",
+				nombres[politicas[p]], e->numEventos, asignaciones, fallos, a.libre, e->memoria);
+		
+		liberarAsignador(&a);
+	}
+	
+	if (numPoliticas == 1){
+		for (i = 0 ; i < numProcesos ; i++){
+			if ((p = buscarProcesoEventos(e, i)) != -1 && particiones[p].base != -1){
+				t_registros[i] = particiones[p];
+			}
+			else{
+				t_registros[i].base = 0;
+				t_registros[i].limite = -1;
+			}
+		}
+	}
+	
+	free(particiones);
+	return 0;
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funcion que simula la asignacion dinamica de los segmentos de
+//*			 los procesos, con compactacion, para cada politica.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Cada llegada asigna uno a uno los segmentos del proceso con el
+//*		asignador de particiones (primer, siguiente, mejor o peor ajuste).
+//*		Si un segmento no cabe en ningun hueco pero la memoria libre total
+//*		es suficiente, el fallo se debe a la fragmentacion externa: se
+//*		compacta la memoria, reescribiendo la base de los segmentos en la
+//*		SDT simulada, y se vuelve a intentar. Si aun asi no cabe, la llegada
+//*		falla y se liberan los segmentos del proceso ya asignados.
+//*		La SDT simulada tiene una entrada por cada tamano del fichero de
+//*		eventos, asi que cada llegada tiene sus propios segmentos.
+//*
+//*		Por cada politica escribe las llegadas atendidas y fallidas, las
+//*		compactaciones, las posiciones movidas en total y por compactacion,
+//*		el tiempo dedicado a compactar, la fragmentacion externa media y el
+//*		coste por operacion.
+//*		Con una sola politica, los procesos del fichero de datos que siguen
+//*		en memoria al final y tienen tantos segmentos como en su SDT pasan a
+//*		usar los segmentos simulados; el resto quedan sin segmentos.
+//*
+//*************************************************************
+int simularSegmentacion(const listaEventos *e, const int politicas[], int numPoliticas, segmentacion *t_segmentacion, int numProcesos){
+	static const char *nombres[] = {"primero", "siguiente", "mejor", "peor"};
+	asignador a;
+	registro *SDT;
+	long *llegada;
+	long j, k, atendidas, fallos, operaciones, compactaciones;
+	long long movidas;
+	double suma;
+	int i, p, inicio, tamano, error = 0;
+	clock_t reloj, tiempoCompactacion;
+	
+	SDT = (registro*)malloc(sizeof(registro) * (e->numTamanos + 1));
+	llegada = (long*)malloc(sizeof(long) * (e->numProcesos + 1));
+	if (SDT == NULL || llegada == NULL){
+		fprintf (stderr, "Error. No hay memoria suficiente para los segmentos.\n");
+		free(SDT);
+		free(llegada);
+		return 1;
+	}
+	
+	printf ("# politica\tllegadas\tfallos\tcompactaciones\tposiciones movidas\tmovidas/compactacion\tms compactando\tfrag.externa media\tnodos/operacion\tns/operacion\n");
+	
+	for (p = 0 ; p < numPoliticas && !error ; p++){
+		if (!configurarAsignador(&a, politicas[p], e->memoria)){
+			error = 1;
+			break;
+		}
+		
+		// llegada[i] es el evento con el que entro el proceso i, o -1 si no esta en memoria
+		for (i = 0 ; i < e->numProcesos ; i++){
+			llegada[i] = -1;
+		}
+		
+		atendidas = fallos = operaciones = compactaciones = 0;
+		movidas = 0;
+		suma = 0;
+		tiempoCompactacion = 0;
+		reloj = clock();
+		
+		for (j = 0 ; j < e->numEventos && !error ; j++){
+			i = e->v[j].proceso;
+			
+			if (e->v[j].numTamanos > 0 && llegada[i] == -1){
+				// Llegada del proceso: se asignan sus segmentos
+				operaciones++;
+				for (k = e->v[j].primerTamano ; k < e->v[j].primerTamano + e->v[j].numTamanos ; k++){
+					tamano = e->tamanos[k];
+					inicio = asignarParticion(&a, tamano);
+					
+					if (inicio == -1 && a.libre >= tamano){
+						tiempoCompactacion -= clock();
+						movidas += compactarMemoria(&a, SDT);
+						tiempoCompactacion += clock();
+						compactaciones++;
+						inicio = asignarParticion(&a, tamano);
+					}
+					if (inicio < 0){
+						break;
+					}
+					if (!marcarOcupado(&a, inicio, tamano, (int)k)){
+						inicio = -2;
+						break;
+					}
+					SDT[k].base = inicio;
+					SDT[k].limite = tamano - 1;
+				}
+				
+				if (k == e->v[j].primerTamano + e->v[j].numTamanos){
+					atendidas++;
+					llegada[i] = j;
+				}
+				else{
+					// Fallo: se liberan los segmentos ya asignados
+					fallos++;
+					error = (inicio == -2);
+					while (--k >= e->v[j].primerTamano){
+						desmarcarOcupado(&a, SDT[k].base);
+						error |= !liberarParticion(&a, SDT[k].base, SDT[k].limite + 1);
+					}
+				}
+			}
+			else if (e->v[j].numTamanos == 0 && llegada[i] != -1){
+				// Finalizacion del proceso: se liberan sus segmentos
+				operaciones++;
+				for (k = e->v[llegada[i]].primerTamano ; k < e->v[llegada[i]].primerTamano + e->v[llegada[i]].numTamanos ; k++){
+					desmarcarOcupado(&a, SDT[k].base);
+					error |= !liberarParticion(&a, SDT[k].base, SDT[k].limite + 1);
+				}
+				llegada[i] = -1;
+			}
+			
+			suma += (a.libre > 0) ? 1 - (double)mayorHueco(&a) / a.libre : 0;
+		}
+		
+		if (error){
+			liberarAsignador(&a);
+			break;
+		}
+		
+		reloj = clock() - reloj;
+		
+		printf ("%s\t%ld\t%ld\t%ld\t%lld\t%.1f\t%.3f\t%.4f\t%.2f\t%.1f\n", nombres[politicas[p]], atendidas, fallos, compactaciones, movidas,
+				(compactaciones > 0) ? (double)movidas / compactaciones : 0, 1000.0 * tiempoCompactacion / CLOCKS_PER_SEC,
+				(e->numEventos > 0) ? suma / e->numEventos : 0,
+				(operaciones > 0) ? (double)a.pasos / operaciones : 0, (operaciones > 0) ? 1e9 * reloj / CLOCKS_PER_SEC / operaciones : 0);
+		
+		fprintf (stderr, "Segmentacion %s: %ld eventos, %ld llegadas, %ld fallos, %ld compactaciones.\n",
+				nombres[politicas[p]], e->numEventos, atendidas, fallos, compactaciones);
+		
+		liberarAsignador(&a);
+	}
+	
+	if (error){
+		fprintf (stderr, "Error. No hay memoria suficiente para el asignador.\n");
+	}
+	else if (numPoliticas == 1){
+		for (i = 0 ; i < numProcesos ; i++){
+			j = ((p = buscarProcesoEventos(e, i)) != -1) ? llegada[p] : -1;
+			
+			if (j != -1 && e->v[j].numTamanos == t_segmentacion->RBTS_RLTS[i].limite + 1){
+				memcpy(&t_segmentacion->SDT[t_segmentacion->desplazamientoSDT[i]], &SDT[e->v[j].primerTamano], sizeof(registro) * e->v[j].numTamanos);
+			}
+			else{
+				t_segmentacion->RBTS_RLTS[i].limite = -1;
+			}
+		}
+	}
+	
+	free(SDT);
+	free(llegada);
+	return error;
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funciones que generan modelos y trazas sinteticos para medir
+//*			 el rendimiento del simulador.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		leerGenerador() interpreta las opciones "clave=valor" separadas
+//*		por comas de "-generar"; las que no se indican conservan su valor
+//*		por defecto. Devuelve 0 si no son validas.
+//*		El modelo se escribe con el formato de 8 lineas y sin colisiones:
+//*		las particiones y los segmentos de los procesos son contiguos y los
+//*		marcos son una permutacion aleatoria de los de la memoria fisica
+//*		(si hay menos marcos que paginas, las paginas sobrantes y una
+//*		fraccion "sinmarco" de las demas quedan con -1). Con "segpaginada"
+//*		se anade la novena linea, con otra permutacion para las paginas de
+//*		los segmentos. Todas las direcciones fisicas deben caber en un
+//*		entero.
+//*		La traza tiene una direccion por linea precedida de su proceso. Los
+//*		procesos cambian cada "rafaga" direcciones y, dentro del espacio de
+//*		direcciones del proceso, la direccion sigue la localidad indicada:
+//*			- uniforme: cualquier direccion con la misma probabilidad.
+//*			- zipf: pagina de rango k con probabilidad proporcional a
+//*			  1/(k+1)^s (las primeras paginas son las mas usadas) y
+//*			  desplazamiento uniforme.
+//*			- secuencial: cada proceso avanza una posicion cada vez.
+//*			- salto: cada proceso avanza "paso" posiciones cada vez.
+//*		Una fraccion "pares" de las direcciones se escribe con el formato
+//*		de dos valores (segmento, desplazamiento) y otra "fuera" se saca del
+//*		espacio del proceso para probar los errores.
+//*		Con la misma semilla se obtienen siempre los mismos ficheros.
+//*
+//*************************************************************
+int leerGenerador(const char *opciones, generador *g){
+	static const char *localidades[] = {"uniforme", "zipf", "secuencial", "salto"};
+	char clave[16], valor[32];
+	int longitud, i, bits;
+	
+	g->procesos = 16;
+	g->segmentos = 4;
+	g->paginas = 64;
+	g->tamano = 4096;
+	g->tipo = 1;
+	g->numNiveles = 3;
+	g->bitsNivel[0] = g->bitsNivel[1] = g->bitsNivel[2] = 9;
+	g->sinMarco = 0;
+	g->marcos = 0;
+	g->segmentosPaginados = 0;
+	g->direcciones = 1000000;
+	g->localidad = LOC_UNIFORME;
+	g->zipf = 1.0;
+	g->paso = -1;
+	g->rafaga = 16;
+	g->pares = 0.5;
+	g->fuera = 0;
+	g->semilla = 1;
+	
+	while (*opciones != '\0'){
+		longitud = (int)strcspn(opciones, ",");
+		if (sscanf(opciones, "%15[^=,]=%31[^,]", clave, valor) != 2){
+			return 0;
+		}
+		
+		if (strcmp(clave, "procesos") == 0)				g->procesos = atoi(valor);
+		else if (strcmp(clave, "segmentos") == 0)		g->segmentos = atoi(valor);
+		else if (strcmp(clave, "paginas") == 0)			g->paginas = atoi(valor);
+		else if (strcmp(clave, "tamano") == 0)			g->tamano = atoi(valor);
+		else if (strcmp(clave, "tipo") == 0)			g->tipo = atoi(valor);
+		else if (strcmp(clave, "sinmarco") == 0)		g->sinMarco = atof(valor);
+		else if (strcmp(clave, "marcos") == 0)			g->marcos = atoi(valor);
+		else if (strcmp(clave, "segpaginada") == 0)		g->segmentosPaginados = atoi(valor);
+		else if (strcmp(clave, "niveles") == 0){
+			// Bits de cada nivel separados por '/': 9/9/9
+			char *p = valor;
+			
+			for (g->numNiveles = 0 ; g->numNiveles < 5 && *p != '\0' ; g->numNiveles++){
+				g->bitsNivel[g->numNiveles < 4 ? g->numNiveles : 3] = (int)strtol(p, &p, 10);
+				if (*p == '/'){
+					p++;
+				}
+				else if (*p != '\0'){
+					return 0;
+				}
+			}
+		}
+		else if (strcmp(clave, "direcciones") == 0)		g->direcciones = atol(valor);
+		else if (strcmp(clave, "zipf") == 0)			g->zipf = atof(valor);
+		else if (strcmp(clave, "paso") == 0)			g->paso = atoi(valor);
+		else if (strcmp(clave, "rafaga") == 0)			g->rafaga = atoi(valor);
+		else if (strcmp(clave, "pares") == 0)			g->pares = atof(valor);
+		else if (strcmp(clave, "fuera") == 0)			g->fuera = atof(valor);
+		else if (strcmp(clave, "semilla") == 0)			g->semilla = strtoull(valor, NULL, 10);
+		else if (strcmp(clave, "localidad") == 0){
+			for (i = 0 ; i < 4 && strcmp(valor, localidades[i]) != 0 ; i++);
+			if (i == 4){
+				return 0;
+			}
+			g->localidad = i;
+		}
+		else{
+			return 0;
+		}
+		
+		opciones += longitud;
+		if (*opciones == ','){
+			opciones++;
+		}
+	}
+	
+	if (g->paso < 0){
+		g->paso = g->tamano;
+	}
+	for (i = 0, bits = 0 ; i < g->numNiveles && i < 4 ; i++){
+		if (g->bitsNivel[i] < 1 || g->bitsNivel[i] > 20){
+			return 0;
+		}
+		bits += g->bitsNivel[i];
+	}
+	if (g->tipo == 3 && (g->numNiveles < 2 || g->numNiveles > 4 || bits > 31 || (1LL << bits) / 4 < g->paginas)){
+		return 0;
+	}
+	if (g->semilla == 0){
+		g->semilla = 88172645463325252ULL;
+	}
+	
+	return g->procesos > 0 && g->segmentos > 0 && g->paginas > 0 && g->tamano > 0 && g->tipo >= 0 && g->tipo <= 3 &&
+		   g->sinMarco >= 0 && g->sinMarco <= 1 && g->direcciones >= 0 && g->zipf >= 0 && g->paso > 0 && g->rafaga > 0 &&
+		   g->pares >= 0 && g->pares <= 1 && g->fuera >= 0 && g->fuera <= 1 &&
+		   (long long)g->paginas * g->tamano / g->segmentos > 0 &&
+		   (long long)g->procesos * g->paginas * g->tamano <= INT_MAX && g->marcos >= 0 && (long long)g->marcos * g->tamano <= INT_MAX &&
+		   (g->segmentosPaginados == 0 || (g->segmentosPaginados == 1 &&
+		   (long long)g->procesos * g->segmentos * ((g->paginas * g->tamano / g->segmentos - 1) / g->tamano + 1) * g->tamano <= INT_MAX));
+}
+
+// Generador aleatorio xorshift64*: mismo resultado en cualquier plataforma
+static unsigned long long aleatorio(unsigned long long *semilla){
+	*semilla ^= *semilla >> 12;
+	*semilla ^= *semilla << 25;
+	*semilla ^= *semilla >> 27;
+	return *semilla * 2685821657736338717ULL;
+}
+
+// Numero aleatorio en [0, 1)
+static double aleatorioReal(unsigned long long *semilla){
+	return (aleatorio(semilla) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Paginas del espacio de direcciones de la tabla multinivel (2^bits)
+static long long paginasDispersas(const generador *g){
+	int i, bits = 0;
+	
+	for (i = 0 ; i < g->numNiveles ; i++){
+		bits += g->bitsNivel[i];
+	}
+	return 1LL << bits;
+}
+
+// Pagina del espacio disperso de la tabla multinivel que corresponde a la pagina j del espacio contiguo:
+// las paginas del proceso se reparten en cuatro regiones (codigo, datos, monticulo y pila) separadas
+static int paginaDispersa(const generador *g, int j){
+	int regiones = (g->paginas < 4) ? g->paginas : 4, tamRegion = g->paginas / regiones;
+	int r = (j / tamRegion < regiones - 1) ? j / tamRegion : regiones - 1;
+	long long total = paginasDispersas(g);
+	
+	if (r == regiones - 1){
+		// La ultima region, la pila, acaba en la ultima pagina
+		return (int)(total - g->paginas + j);
+	}
+	return (int)(r * (total / regiones) + j - r * tamRegion);
+}
+
+int generarModelo(const generador *g, const char *fichero){
+	FILE *fp;
+	escritor e;
+	unsigned long long semilla = g->semilla;
+	int i, j, k, aux, numPaginas = g->procesos * g->paginas;
+	int numMarcos = (g->marcos > 0) ? g->marcos : numPaginas;
+	int numPermutados = (numMarcos > numPaginas) ? numMarcos : numPaginas;
+	int espacio = g->paginas * g->tamano, tamSegmento = espacio / g->segmentos;
+	int *marcos;
+	
+	if ((fp = fopen(fichero, "w")) == NULL){
+		fprintf (stderr, "Error. No ha sido posible crear el fichero \"%s\".\n", fichero);
+		return 0;
+	}
+	
+	marcos = (int*)malloc(sizeof(int) * numPermutados);
+	if (marcos == NULL || !crearEscritor(&e, tamBufferSalida, SALIDA_TEXTO, 0)){
+		fprintf (stderr, "Error. No hay memoria suficiente para generar el modelo.\n");
+		free(marcos);
+		fclose(fp);
+		return 0;
+	}
+	anadirDestino(&e, fp);
+	
+	// 1. Procesos
+	escribirEntero(&e, g->procesos);
+	escribirCadena(&e, "\n");
+	
+	// 2. Particiones contiguas
+	for (i = 0 ; i < g->procesos ; i++){
+		escribirEntero(&e, i * espacio);
+		escribirCadena(&e, " ");
+		escribirEntero(&e, espacio - 1);
+		escribirCadena(&e, (i < g->procesos - 1) ? " " : "\n");
+	}
+	
+	// 3. RBTS y RLTS, y 4. segmentos contiguos
+	for (i = 0 ; i < g->procesos ; i++){
+		escribirEntero(&e, i * g->segmentos);
+		escribirCadena(&e, " ");
+		escribirEntero(&e, g->segmentos - 1);
+		escribirCadena(&e, (i < g->procesos - 1) ? " " : "\n");
+	}
+	for (i = 0 ; i < g->procesos * g->segmentos ; i++){
+		escribirEntero(&e, i * tamSegmento);
+		escribirCadena(&e, " ");
+		escribirEntero(&e, tamSegmento - 1);
+		escribirCadena(&e, (i < g->procesos * g->segmentos - 1) ? " " : "\n");
+	}
+	
+	// 5. Tamano de pagina y 6. tipo de paginacion
+	escribirEntero(&e, g->tamano);
+	escribirCadena(&e, "\n");
+	escribirEntero(&e, g->tipo);
+	for (i = 0 ; g->tipo == 3 && i < g->numNiveles ; i++){
+		escribirCadena(&e, " ");
+		escribirEntero(&e, g->bitsNivel[i]);
+	}
+	escribirCadena(&e, "\n");
+	
+	// 7. RBTP y RLTP. La tabla multinivel abarca todo el espacio disperso
+	for (i = 0 ; i < g->procesos ; i++){
+		escribirEntero(&e, (g->tipo == 0) ? i * g->paginas : 0);
+		escribirCadena(&e, " ");
+		escribirEntero(&e, (g->tipo == 3) ? (int)(paginasDispersas(g) - 1) : g->paginas - 1);
+		escribirCadena(&e, (i < g->procesos - 1) ? " " : "\n");
+	}
+	
+	// 8. Permutacion aleatoria de los marcos (Fisher-Yates). Si hay menos marcos
+	// que paginas, las paginas con un valor de la permutacion fuera de la memoria quedan sin marco
+	for (k = 0 ; k < numPermutados ; k++){
+		marcos[k] = k;
+	}
+	for (k = numPermutados - 1 ; k > 0 ; k--){
+		j = (int)(aleatorio(&semilla) % (unsigned long long)(k + 1));
+		aux = marcos[k];
+		marcos[k] = marcos[j];
+		marcos[j] = aux;
+	}
+	for (k = 0 ; k < numPaginas ; k++){
+		if (aleatorioReal(&semilla) < g->sinMarco || marcos[k] >= numMarcos){
+			marcos[k] = -1;
+		}
+	}
+	
+	// Con tabla multinivel se escriben regiones "proceso pagina marco paginas", uniendo las
+	// paginas seguidas que tienen marcos seguidos
+	for (k = 0, aux = 0 ; g->tipo == 3 && k < numPaginas ; k = j){
+		for (j = k + 1 ; j < numPaginas && marcos[k] >= 0 && j % g->paginas != 0 && marcos[j] == marcos[j - 1] + 1 &&
+			 paginaDispersa(g, j % g->paginas) == paginaDispersa(g, (j - 1) % g->paginas) + 1 ; j++);
+		
+		if (marcos[k] >= 0){
+			escribirCadena(&e, aux++ ? " " : "");
+			escribirEntero(&e, k / g->paginas);
+			escribirCadena(&e, " ");
+			escribirEntero(&e, paginaDispersa(g, k % g->paginas));
+			escribirCadena(&e, " ");
+			escribirEntero(&e, marcos[k]);
+			escribirCadena(&e, " ");
+			escribirEntero(&e, j - k);
+		}
+	}
+	
+	for (k = 0 ; g->tipo != 3 && k < numPaginas ; k++){
+		escribirEntero(&e, marcos[k]);
+		escribirCadena(&e, (k < numPaginas - 1) ? " " : "");
+	}
+	escribirCadena(&e, "\n");
+	
+	// 9. Tablas de paginas de los segmentos, con su propia permutacion de marcos
+	if (g->segmentosPaginados){
+		free(marcos);
+		numPermutados = g->procesos * g->segmentos * ((tamSegmento - 1) / g->tamano + 1);
+		if ((marcos = (int*)malloc(sizeof(int) * numPermutados)) == NULL){
+			fprintf (stderr, "Error. No hay memoria suficiente para generar el modelo.\n");
+			liberarEscritor(&e);
+			fclose(fp);
+			return 0;
+		}
+		
+		for (k = 0 ; k < numPermutados ; k++){
+			marcos[k] = k;
+		}
+		for (k = numPermutados - 1 ; k > 0 ; k--){
+			j = (int)(aleatorio(&semilla) % (unsigned long long)(k + 1));
+			aux = marcos[k];
+			marcos[k] = marcos[j];
+			marcos[j] = aux;
+		}
+		for (k = 0 ; k < numPermutados ; k++){
+			escribirEntero(&e, (aleatorioReal(&semilla) < g->sinMarco) ? -1 : marcos[k]);
+			escribirCadena(&e, (k < numPermutados - 1) ? " " : "\n");
+		}
+	}
+	
+	liberarEscritor(&e);
+	free(marcos);
+	
+	if (fclose(fp) != 0){
+		fprintf (stderr, "Error. No ha sido posible escribir el fichero \"%s\".\n", fichero);
+		return 0;
+	}
+	
+	return 1;
+}
+
+int generarTraza(const generador *g, const char *fichero){
+	FILE *fp;
+	escritor e;
+	unsigned long long semilla = g->semilla ^ 0x9E3779B97F4A7C15ULL;
+	int espacio = g->paginas * g->tamano, tamSegmento = espacio / g->segmentos;
+	int proceso = 0, direccion, primero, ultimo, medio, k, fuera;
+	int *cursor;
+	double *acumulada, u;
+	long long pagina = 0;
+	long j;
+	
+	if ((fp = fopen(fichero, "w")) == NULL){
+		fprintf (stderr, "Error. No ha sido posible crear el fichero \"%s\".\n", fichero);
+		return 0;
+	}
+	
+	cursor = (int*)calloc(g->procesos, sizeof(int));
+	acumulada = (double*)malloc(sizeof(double) * g->paginas);
+	if (cursor == NULL || acumulada == NULL || !crearEscritor(&e, tamBufferSalida, SALIDA_TEXTO, 0)){
+		fprintf (stderr, "Error. No hay memoria suficiente para generar la traza.\n");
+		free(cursor);
+		free(acumulada);
+		fclose(fp);
+		return 0;
+	}
+	anadirDestino(&e, fp);
+	
+	// Distribucion acumulada de Zipf sobre las paginas de un proceso
+	for (k = 0, u = 0 ; k < g->paginas ; k++){
+		u += 1.0 / pow(k + 1, g->zipf);
+		acumulada[k] = u;
+	}
+	
+	for (j = 0 ; j < g->direcciones ; j++){
+		if (j % g->rafaga == 0){
+			proceso = (int)(aleatorio(&semilla) % (unsigned long long)g->procesos);
+		}
+		
+		switch (g->localidad){
+			case LOC_ZIPF:
+				u = aleatorioReal(&semilla) * acumulada[g->paginas - 1];
+				for (primero = 0, ultimo = g->paginas - 1 ; primero < ultimo ; ){
+					medio = (primero + ultimo) / 2;
+					if (acumulada[medio] <= u){
+						primero = medio + 1;
+					}
+					else{
+						ultimo = medio;
+					}
+				}
+				direccion = primero * g->tamano + (int)(aleatorio(&semilla) % (unsigned long long)g->tamano);
+				break;
+			case LOC_SECUENCIAL:
+				direccion = cursor[proceso];
+				cursor[proceso] = (cursor[proceso] + 1) % espacio;
+				break;
+			case LOC_SALTO:
+				direccion = cursor[proceso];
+				cursor[proceso] = (int)(((long long)cursor[proceso] + g->paso) % espacio);
+				break;
+			default:
+				direccion = (int)(aleatorio(&semilla) % (unsigned long long)espacio);
+		}
+		
+		fuera = (g->fuera > 0 && aleatorioReal(&semilla) < g->fuera);
+		if (fuera && g->tipo != 3){
+			direccion = (direccion <= INT_MAX - espacio) ? direccion + espacio : INT_MAX;
+		}
+		
+		// Con tabla multinivel, la pagina se lleva a su region del espacio disperso o, si queda
+		// fuera, mas alla de su final. Si la direccion no cabe en un entero se escribe como (pagina, desplazamiento)
+		if (g->tipo == 3){
+			pagina = fuera ? paginasDispersas(g) + direccion / g->tamano : paginaDispersa(g, direccion / g->tamano);
+			if (pagina > INT_MAX){
+				pagina = INT_MAX;
+			}
+		}
+		
+		escribirEntero(&e, proceso);
+		escribirCadena(&e, ":");
+		if (g->pares > 0 && aleatorioReal(&semilla) < g->pares){
+			escribirEntero(&e, direccion / tamSegmento);
+			escribirCadena(&e, ",");
+			escribirEntero(&e, direccion % tamSegmento);
+		}
+		else if (g->tipo == 3 && pagina * g->tamano + direccion % g->tamano > INT_MAX){
+			escribirEntero(&e, (int)pagina);
+			escribirCadena(&e, ",");
+			escribirEntero(&e, direccion % g->tamano);
+		}
+		else if (g->tipo == 3){
+			escribirEntero(&e, (int)(pagina * g->tamano + direccion % g->tamano));
+		}
+		else{
+			escribirEntero(&e, direccion);
+		}
+		escribirCadena(&e, "\n");
+	}
+	
+	liberarEscritor(&e);
+	free(cursor);
+	free(acumulada);
+	
+	if (fclose(fp) != 0){
+		fprintf (stderr, "Error. No ha sido posible escribir el fichero \"%s\".\n", fichero);
+		return 0;
+	}
+	
+	return 1;
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funciones que miden el rendimiento del simulador con un
+//*			 modelo y una traza.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Cada prueba se repite "repeticiones" veces, despues de una
+//*		ejecucion de calentamiento que no se cuenta, y se muestra la
+//*		mediana, el minimo y el maximo del tiempo real. La mediana es el
+//*		valor estable para comparar versiones del simulador.
+//*			- carga: leer y validar el fichero de texto, o proyectar la
+//*			  imagen binaria.
+//*			- validacion: comprobar las colisiones en memoria fisica.
+//*			- base/limite, segmentacion y paginacion: traducir todas las
+//*			  direcciones de la traza, cargada en memoria, con cada metodo.
+//*			- paginacion por lotes: lo mismo con traducirPaginasLote(), con
+//*			  las direcciones de un valor ya agrupadas por proceso.
+//*			- traza completa: traducir por bloques con los tres metodos y
+//*			  dar formato de texto a la salida, sin escribirla.
+//*			- segmentacion paginada por lotes: solo con "-sp", lo mismo con
+//*			  traducirSegmentosLote() y las direcciones de dos valores. La
+//*			  prueba de segmentacion tambien es entonces la paginada.
+//*		La columna "suma" (suma de las direcciones fisicas validas, o bytes
+//*		de salida) permite comprobar que dos versiones calculan lo mismo, y
+//*		la memoria de la tabla de paginas comparar los tipos de tabla.
+//*
+//*************************************************************
+double segundosReloj(void){
+#ifdef _WIN32
+	return (double)clock() / CLOCKS_PER_SEC;
+#else
+	struct timespec t;
+	
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec / 1e9;
+#endif
+}
+
+// Orden de los tiempos para obtener la mediana
+static int compararTiempos(const void *a, const void *b){
+	double x = *(const double*)a, y = *(const double*)b;
+	
+	return (x > y) - (x < y);
+}
+
+// Escribe una fila de resultados. "traducciones" es 0 en las pruebas que no traducen
+static void mostrarPrueba(const char *prueba, double tiempos[], int repeticiones, long traducciones, unsigned long long suma){
+	double mediana;
+	
+	qsort(tiempos, repeticiones, sizeof(double), compararTiempos);
+	mediana = (repeticiones % 2) ? tiempos[repeticiones / 2] : (tiempos[repeticiones / 2 - 1] + tiempos[repeticiones / 2]) / 2;
+	
+	printf ("%s\t%.6f\t%.6f\t%.6f", prueba, mediana, tiempos[0], tiempos[repeticiones - 1]);
+	if (traducciones > 0){
+		printf ("\t%.0f\t%llu\n", traducciones / mediana, suma);
+	}
+	else{
+		printf ("\t-\t-\n");
+	}
+}
+
+int medirRendimiento(const char *archivo, const char *traza, int repeticiones, int compartir, int paginada){
+	static const char *pruebas[] = {"base/limite", "segmentacion", "paginacion", "paginacion por lotes", "traza completa", "segmentacion paginada por lotes"};
+	FILE *fp, *nulo;
+	imagen t_imagen = {0};
+	registro *t_registros = NULL;
+	paginacion t_paginacion;
+	segmentacion t_segmentacion = {0};
+	direccion *v = NULL;
+	bloqueTraza b;
+	escritor e;
+	char *contenido;
+	size_t longitud;
+	double *tiempos, inicio;
+	unsigned long long suma = 0;
+	long numDirecciones = 0, traducciones = 0, j;
+	int *cuenta = NULL, *cuentaPares = NULL, *agrupadas = NULL, *desplazamientos = NULL, *fisicas = NULL;
+	unsigned char *estados = NULL;
+	int i, p, r, m, k, estado = 0, numProcesos = 0, dFisica, comprimida;
+	
+	if ((tiempos = (double*)malloc(sizeof(double) * repeticiones)) == NULL){
+		fprintf (stderr, "Error. No hay memoria suficiente para medir el rendimiento.\n");
+		return 1;
+	}
+	
+	printf ("# prueba\tmediana (s)\tminimo (s)\tmaximo (s)\ttraducciones/s\tsuma\n");
+	
+	// Carga del modelo. Se queda cargado el de la ultima repeticion
+	for (r = -1 ; r < repeticiones ; r++){
+		if (r > -1 || estado == 1){
+			liberarModelo(&t_imagen, t_registros, &t_paginacion, &t_segmentacion);
+		}
+		
+		inicio = segundosReloj();
+		if ((fp = fopen(archivo, "rb")) == NULL){
+			fprintf (stderr, "Error. Archivo no encontrado\n");
+			free(tiempos);
+			return 1;
+		}
+		if ((estado = abrirImagen(fp, &t_imagen, &numProcesos, &t_registros, &t_paginacion, &t_segmentacion, stdout)) == 0){
+			contenido = leerFichero(fp, &longitud);
+			estado = (contenido == NULL) ? -1 : leerDatos(contenido, longitud, &numProcesos, &t_registros, &t_paginacion, &t_segmentacion, stdout);
+			free(contenido);
+		}
+		fclose(fp);
+		
+		if (estado != 1){
+			fprintf (stderr, "Error. No ha sido posible cargar el modelo \"%s\".\n", archivo);
+			free(tiempos);
+			return 1;
+		}
+		if (r >= 0){
+			tiempos[r] = segundosReloj() - inicio;
+		}
+	}
+	mostrarPrueba("carga", tiempos, repeticiones, 0, 0);
+	
+	if (paginada && t_segmentacion.tablasSegmentos == NULL){
+		fprintf (stderr, "Error. La segmentacion paginada (\"-sp\") necesita la tabla de paginas de cada segmento (novena linea del fichero de datos).\n");
+		liberarModelo(&t_imagen, t_registros, &t_paginacion, &t_segmentacion);
+		free(tiempos);
+		return 1;
+	}
+	t_segmentacion.paginada = paginada;
+	
+	// Validacion de la memoria fisica
+#ifdef _WIN32
+	nulo = fopen("NUL", "w");
+#else
+	nulo = fopen("/dev/null", "w");
+#endif
+	for (r = -1 ; r < repeticiones ; r++){
+		inicio = segundosReloj();
+		comprobarMemoriaFisica(numProcesos, t_registros, &t_paginacion, &t_segmentacion, compartir, (r == -1 || nulo == NULL) ? stderr : nulo);
+		if (r >= 0){
+			tiempos[r] = segundosReloj() - inicio;
+		}
+	}
+	mostrarPrueba("validacion", tiempos, repeticiones, 0, 0);
+	if (nulo != NULL){
+		fclose(nulo);
+	}
+	
+	// Traza en memoria, y sus direcciones de un valor agrupadas por proceso para la prueba por lotes
+	if ((fp = abrirTraza(traza, &comprimida)) == NULL){
+		fprintf (stderr, "Error. No ha sido posible abrir el fichero de traza \"%s\".\n", traza);
+		liberarModelo(&t_imagen, t_registros, &t_paginacion, &t_segmentacion);
+		free(tiempos);
+		return 1;
+	}
+	v = cargarTraza(fp, numProcesos, &numDirecciones);
+	if (!cerrarTraza(fp, comprimida, traza)){
+		free(v);
+		liberarModelo(&t_imagen, t_registros, &t_paginacion, &t_segmentacion);
+		free(tiempos);
+		return 1;
+	}
+	
+	for (j = 0 ; v != NULL && j < numDirecciones ; j++){
+		traducciones += (v[j].proceso == -1) ? numProcesos : 1;
+	}
+	
+	cuenta = (int*)calloc(numProcesos + 1, sizeof(int));
+	cuentaPares = (int*)calloc(numProcesos + 1, sizeof(int));
+	agrupadas = (int*)malloc(sizeof(int) * (traducciones + 1));
+	desplazamientos = (int*)malloc(sizeof(int) * (traducciones + 1));
+	fisicas = (int*)malloc(sizeof(int) * (traducciones + 1));
+	estados = (unsigned char*)malloc(traducciones + 1);
+	
+	if (v == NULL || cuenta == NULL || cuentaPares == NULL || agrupadas == NULL || desplazamientos == NULL || fisicas == NULL || estados == NULL || traducciones > INT_MAX ||
+		!crearBloque(&b, numProcesos) || !crearEscritor(&e, tamBufferSalida, SALIDA_TEXTO, 1)){
+		fprintf (stderr, "Error. No hay memoria suficiente para medir el rendimiento.\n");
+		free(v);
+		free(cuenta);
+		free(cuentaPares);
+		free(agrupadas);
+		free(desplazamientos);
+		free(fisicas);
+		free(estados);
+		liberarModelo(&t_imagen, t_registros, &t_paginacion, &t_segmentacion);
+		free(tiempos);
+		return 1;
+	}
+	
+	for (j = 0 ; j < numDirecciones ; j++){
+		for (p = (v[j].proceso == -1) ? 0 : v[j].proceso ; p <= ((v[j].proceso == -1) ? numProcesos - 1 : v[j].proceso) ; p++){
+			if (v[j].formato == 1){
+				cuenta[p + 1]++;
+			}
+		}
+	}
+	for (p = 0 ; p < numProcesos ; p++){
+		cuenta[p + 1] += cuenta[p];
+	}
+	for (j = 0 ; j < numDirecciones ; j++){
+		for (p = (v[j].proceso == -1) ? 0 : v[j].proceso ; p <= ((v[j].proceso == -1) ? numProcesos - 1 : v[j].proceso) ; p++){
+			if (v[j].formato == 1){
+				agrupadas[cuenta[p]++] = v[j].dLogica;
+			}
+		}
+	}
+	// cuenta[p] es ahora el final del grupo del proceso p
+	
+	// Con segmentacion paginada, las de dos valores se agrupan igual a continuacion
+	for (j = 0 ; paginada && j < numDirecciones ; j++){
+		for (p = (v[j].proceso == -1) ? 0 : v[j].proceso ; p <= ((v[j].proceso == -1) ? numProcesos - 1 : v[j].proceso) ; p++){
+			if (v[j].formato == 2){
+				cuentaPares[p + 1]++;
+			}
+		}
+	}
+	cuentaPares[0] = cuenta[numProcesos];
+	for (p = 0 ; p < numProcesos ; p++){
+		cuentaPares[p + 1] += cuentaPares[p];
+	}
+	for (j = 0 ; paginada && j < numDirecciones ; j++){
+		for (p = (v[j].proceso == -1) ? 0 : v[j].proceso ; p <= ((v[j].proceso == -1) ? numProcesos - 1 : v[j].proceso) ; p++){
+			if (v[j].formato == 2){
+				agrupadas[cuentaPares[p]] = v[j].nPag_Seg;
+				desplazamientos[cuentaPares[p]++] = v[j].nInstruccion;
+			}
+		}
+	}
+	
+	printf ("# %d procesos, %d segmentos, %d paginas de %d posiciones, %ld direcciones (%ld traducciones por metodo), %d repeticiones\n",
+			numProcesos, t_segmentacion.numSegmentos, t_paginacion.numEntradas, t_paginacion.tamano, numDirecciones, traducciones, repeticiones);
+	printf ("# tabla de paginas: %s, %zu bytes\n", (t_paginacion.tipo == 0) ? "PMT global" : (t_paginacion.tipo == 1) ? "PMT por proceso" : (t_paginacion.tipo == 2) ? "invertida" : "multinivel",
+			memoriaPaginacion(&t_paginacion, numProcesos));
+	
+	for (m = 0 ; m < (paginada ? 6 : 5) ; m++){
+		for (r = -1 ; r < repeticiones ; r++){
+			suma = 0;
+			inicio = segundosReloj();
+			
+			switch (m){
+				case 0:
+				case 1:
+				case 2:
+					for (j = 0 ; j < numDirecciones ; j++){
+						for (p = (v[j].proceso == -1) ? 0 : v[j].proceso ; p <= ((v[j].proceso == -1) ? numProcesos - 1 : v[j].proceso) ; p++){
+							estado = (m == 0) ? traducirBaseLimite(&t_registros[p], &v[j], &dFisica) :
+									 (m == 1) ? traducirSegmento(&t_segmentacion, p, &v[j], &dFisica) :
+												traducirPagina(&t_paginacion, p, &v[j], &dFisica);
+							if (estado == TRAD_OK){
+								suma += (unsigned int)dFisica;
+							}
+						}
+					}
+					break;
+				
+				case 3:
+					for (p = 0, k = 0 ; p < numProcesos ; k = cuenta[p++]){
+						traducirPaginasLote(&t_paginacion, p, agrupadas + k, cuenta[p] - k, fisicas + k, estados + k);
+					}
+					for (i = 0 ; i < cuenta[numProcesos] ; i++){
+						if (estados[i] == TRAD_OK){
+							suma += (unsigned int)fisicas[i];
+						}
+					}
+					break;
+				
+				case 4:
+					for (j = 0 ; j < numDirecciones ; j++){
+						if (!cabeEnBloque(&b, &v[j])){
+							traducirBloque(&b, t_registros, &t_paginacion, &t_segmentacion, &e);
+							suma += e.longitud;
+							e.longitud = 0;
+						}
+						anadirBloque(&b, &v[j]);
+					}
+					traducirBloque(&b, t_registros, &t_paginacion, &t_segmentacion, &e);
+					suma += e.longitud;
+					e.longitud = 0;
+					break;
+				
+				case 5:
+					for (p = 0, k = cuenta[numProcesos] ; p < numProcesos ; k = cuentaPares[p++]){
+						traducirSegmentosLote(&t_segmentacion, p, agrupadas + k, desplazamientos + k, cuentaPares[p] - k, fisicas + k, estados + k);
+					}
+					for (i = cuenta[numProcesos] ; i < cuentaPares[numProcesos] ; i++){
+						if (estados[i] == TRAD_OK){
+							suma += (unsigned int)fisicas[i];
+						}
+					}
+					break;
+			}
+			
+			if (r >= 0){
+				tiempos[r] = segundosReloj() - inicio;
+			}
+		}
+		
+		mostrarPrueba((m == 1 && paginada) ? "segmentacion paginada" : pruebas[m], tiempos, repeticiones,
+					  (m == 3) ? cuenta[numProcesos] : (m == 5) ? cuentaPares[numProcesos] - cuenta[numProcesos] : traducciones, suma);
+	}
+	
+	mostrarEstadisticasPaginacion(&t_paginacion, numProcesos, stderr);
+	mostrarEstadisticasSegmentacion(&t_segmentacion, stderr);
+	
+	liberarBloque(&b);
+	liberarEscritor(&e);
+	free(v);
+	free(cuenta);
+	free(cuentaPares);
+	free(agrupadas);
+	free(desplazamientos);
+	free(fisicas);
+	free(estados);
+	liberarModelo(&t_imagen, t_registros, &t_paginacion, &t_segmentacion);
+	free(tiempos);
+	
+	return 0;
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funciones que miden el coste de crear, destruir y cambiar de
+//*			 tamano procesos y la memoria que ocupan sus tablas.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Se crean "procesos" procesos y despues, en cada operacion, se elige
+//*		uno al azar y:
+//*			- con probabilidad "redimensionar" pasa a tener un numero de
+//*			  paginas y de segmentos al azar (al menos uno de cada) y se
+//*			  asigna un marco a su ultima pagina;
+//*			- en otro caso se destruye y se crea otro con tamanos al azar,
+//*			  con un marco en cada pagina (copiados con asignarMarcos()) y
+//*			  un segmento definido.
+//*		Con el asignador "almacen" las tablas estan en un sistemaProcesos;
+//*		con "malloc" cada proceso tiene su PMT y su SDT reservadas con
+//*		malloc, que crecen o se reducen con realloc, como haria un
+//*		simulador sin almacenes. Las dos versiones escriben las mismas
+//*		entradas, asi que la diferencia de tiempo es la de reservar y
+//*		liberar las tablas, y la suma de comprobacion (marcos de la ultima
+//*		pagina de cada proceso vivo al terminar) debe coincidir.
+//*		La memoria residente se lee de /proc/self/statm.
+//*
+//*************************************************************
+int leerRotacion(const char *opciones, rotacion *r){
+	char clave[16], valor[32];
+	int longitud;
+	
+	r->procesos = 10000;
+	r->operaciones = 1000000;
+	r->paginas = 256;
+	r->segmentos = 4;
+	r->redimensionar = 0.3;
+	r->muestras = 10;
+	r->almacen = 1;
+	r->semilla = 1;
+	
+	while (*opciones != '\0'){
+		longitud = (int)strcspn(opciones, ",");
+		if (sscanf(opciones, "%15[^=,]=%31[^,]", clave, valor) != 2){
+			return 0;
+		}
+		
+		if (strcmp(clave, "procesos") == 0)				r->procesos = atoi(valor);
+		else if (strcmp(clave, "operaciones") == 0)		r->operaciones = atol(valor);
+		else if (strcmp(clave, "paginas") == 0)			r->paginas = atoi(valor);
+		else if (strcmp(clave, "segmentos") == 0)		r->segmentos = atoi(valor);
+		else if (strcmp(clave, "redimensionar") == 0)	r->redimensionar = atof(valor);
+		else if (strcmp(clave, "muestras") == 0)		r->muestras = atoi(valor);
+		else if (strcmp(clave, "semilla") == 0)			r->semilla = strtoull(valor, NULL, 10);
+		else if (strcmp(clave, "asignador") == 0){
+			if (strcmp(valor, "almacen") != 0 && strcmp(valor, "malloc") != 0){
+				return 0;
+			}
+			r->almacen = (strcmp(valor, "almacen") == 0);
+		}
+		else{
+			return 0;
+		}
+		
+		opciones += longitud;
+		if (*opciones == ','){
+			opciones++;
+		}
+	}
+	
+	if (r->semilla == 0){
+		r->semilla = 88172645463325252ULL;
+	}
+	
+	return r->procesos > 0 && r->operaciones >= 0 && r->paginas > 0 && r->segmentos > 0 &&
+		   r->redimensionar >= 0 && r->redimensionar <= 1 && r->muestras > 0;
+}
+
+size_t memoriaResidente(void){
+#ifdef _WIN32
+	return 0;
+#else
+	FILE *fp = fopen("/proc/self/statm", "r");
+	unsigned long total, residentes = 0;
+	
+	if (fp != NULL){
+		if (fscanf(fp, "%lu %lu", &total, &residentes) != 2){
+			residentes = 0;
+		}
+		fclose(fp);
+	}
+	return (size_t)residentes * (size_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+// Escribe una fila de la prueba de rotacion: "parcial" son los segundos de las "hechas" ultimas operaciones y "reservada" es 0 si no se conoce
+static void mostrarRotacion(long operaciones, double segundos, double parcial, long hechas, int procesos, size_t reservada, size_t usada){
+	size_t residente = memoriaResidente();
+	
+	printf ("%ld\t%.3f\t%.1f\t%d\t", operaciones, segundos, (hechas > 0) ? parcial * 1e9 / hechas : 0.0, procesos);
+	printf (reservada > 0 ? "%zu\t" : "-\t", reservada);
+	printf ("%zu\t", usada);
+	printf (residente > 0 ? "%zu\n" : "-\n", residente);
+}
+
+int medirRotacion(const rotacion *r){
+	sistemaProcesos *s = NULL;
+	const paginacion *t_paginacion;
+	int **pmt = NULL;									// Tablas de cada proceso con el asignador "malloc"
+	registro **sdt = NULL;
+	int *id, *paginas, *segmentos;						// Proceso de cada posicion y tamano de sus tablas
+	int *marcos;										// Marcos que se copian en la PMT de los procesos nuevos
+	unsigned long long semilla = r->semilla, suma = 0;
+	size_t usada = 0, reservada;
+	double inicio, parcial, total = 0;
+	long op, siguiente, anterior = 0;
+	int i, j, k, np, ns, muestra = 0, estado = 1;
+	void *p, *q;
+	
+	id = (int*)malloc(sizeof(int) * r->procesos);
+	paginas = (int*)malloc(sizeof(int) * r->procesos);
+	segmentos = (int*)malloc(sizeof(int) * r->procesos);
+	marcos = (int*)malloc(sizeof(int) * ((size_t)r->paginas + 0x1000));
+	for (i = 0 ; marcos != NULL && i < r->paginas + 0x1000 ; i++){
+		marcos[i] = i;
+	}
+	if (r->almacen){
+		s = crearSistema(4096);
+	}
+	else{
+		pmt = (int**)calloc(r->procesos, sizeof(int*));
+		sdt = (registro**)calloc(r->procesos, sizeof(registro*));
+	}
+	if (id == NULL || paginas == NULL || segmentos == NULL || marcos == NULL || (r->almacen ? s == NULL : (pmt == NULL || sdt == NULL))){
+		fprintf (stderr, "Error. No hay memoria suficiente para la prueba de rotacion.\n");
+		estado = 0;
+	}
+	
+	printf ("# asignador %s: %d procesos vivos, hasta %d paginas y %d segmentos, %.0f%% de operaciones redimensionan\n",
+			r->almacen ? "almacen" : "malloc", r->procesos, r->paginas, r->segmentos, r->redimensionar * 100);
+	printf ("# operaciones\tsegundos\tns/operacion\tprocesos\treservada (bytes)\ten uso (bytes)\tresidente (bytes)\n");
+	
+	// Operacion -1 para cada posicion: creacion inicial. Despues, una posicion al azar en cada operacion
+	inicio = segundosReloj();
+	siguiente = 0;
+	for (op = -r->procesos ; estado && op < r->operaciones ; op++){
+		i = (op < 0) ? (int)(op + r->procesos) : (int)(aleatorio(&semilla) % r->procesos);
+		np = 1 + (int)(aleatorio(&semilla) % r->paginas);
+		ns = 1 + (int)(aleatorio(&semilla) % r->segmentos);
+		
+		if (op >= 0 && aleatorioReal(&semilla) < r->redimensionar){
+			if (r->almacen){
+				estado = (redimensionarProceso(s, id[i], np, ns) == 1 && asignarMarco(s, id[i], np - 1, i) == 1);
+			}
+			else{
+				p = realloc(pmt[i], sizeof(int) * np);
+				q = realloc(sdt[i], sizeof(registro) * ns);
+				if (p != NULL){
+					pmt[i] = (int*)p;
+				}
+				if (q != NULL){
+					sdt[i] = (registro*)q;
+				}
+				if ((estado = (p != NULL && q != NULL))){
+					for (j = paginas[i] ; j < np ; j++){
+						pmt[i][j] = -1;
+					}
+					for (j = segmentos[i] ; j < ns ; j++){
+						sdt[i][j].base = 0;
+						sdt[i][j].limite = -1;
+					}
+					pmt[i][np - 1] = i;
+					usada -= sizeof(int) * paginas[i] + sizeof(registro) * segmentos[i];
+					usada += sizeof(int) * np + sizeof(registro) * ns;
+				}
+			}
+		}
+		else{
+			if (r->almacen){
+				if (op >= 0){
+					destruirProceso(s, id[i]);
+				}
+				if ((estado = ((id[i] = crearProceso(s, np, ns)) >= 0))){
+					asignarMarcos(s, id[i], 0, np, marcos + (i & 0xFFF));
+					definirSegmento(s, id[i], 0, i, np);
+				}
+			}
+			else{
+				if (op >= 0){
+					free(pmt[i]);
+					free(sdt[i]);
+					usada -= sizeof(int) * paginas[i] + sizeof(registro) * segmentos[i];
+				}
+				pmt[i] = (int*)malloc(sizeof(int) * np);
+				sdt[i] = (registro*)malloc(sizeof(registro) * ns);
+				if ((estado = (pmt[i] != NULL && sdt[i] != NULL))){
+					memcpy(pmt[i], marcos + (i & 0xFFF), sizeof(int) * np);
+					for (j = 0 ; j < ns ; j++){
+						sdt[i][j].base = 0;
+						sdt[i][j].limite = -1;
+					}
+					sdt[i][0].base = i;
+					sdt[i][0].limite = np;
+					usada += sizeof(int) * np + sizeof(registro) * ns;
+				}
+			}
+		}
+		if (!estado){
+			fprintf (stderr, "Error. No hay memoria suficiente para la prueba de rotacion.\n");
+			break;
+		}
+		paginas[i] = np;
+		segmentos[i] = ns;
+		
+		// Fila tras la creacion inicial (operacion -1) y tras cada muestra, con el tiempo medio de sus operaciones
+		if (op == siguiente - 1 || op == r->operaciones - 1){
+			parcial = segundosReloj() - inicio;
+			total = (op < 0) ? 0 : total + parcial;
+			reservada = r->almacen ? memoriaSistema(s, &usada) : 0;
+			mostrarRotacion(op + 1, total, parcial, (op < 0) ? r->procesos : op + 1 - anterior, r->procesos, reservada, usada);
+			anterior = op + 1;
+			muestra++;
+			siguiente = (long)((double)r->operaciones * muestra / r->muestras);
+			inicio = segundosReloj();
+		}
+	}
+	
+	// Suma de comprobacion: marco de la ultima pagina de cada proceso, igual con los dos asignadores
+	if (estado){
+		t_paginacion = r->almacen ? paginacionSistema(s) : NULL;
+		for (i = 0 ; i < r->procesos ; i++){
+			k = r->almacen ? t_paginacion->PMT[t_paginacion->desplazamientoPMT[id[i]] + paginas[i] - 1] : pmt[i][paginas[i] - 1];
+			suma += (unsigned int)k;
+		}
+		printf ("# suma %llu\n", suma);
+	}
+	
+	if (r->almacen){
+		cerrarSistema(s);
+	}
+	else{
+		for (i = 0 ; pmt != NULL && i < r->procesos ; i++){
+			free(pmt[i]);
+			free(sdt[i]);
+		}
+		free(pmt);
+		free(sdt);
+	}
+	free(id);
+	free(paginas);
+	free(segmentos);
+	free(marcos);
+	
+	return !estado;
+}
@@ -0,0 +1,3765 @@
+/*
+	Implementacion de la biblioteca de gestion de memoria (ver memmanager.h): lectura del
+	fichero de datos y de las imagenes binarias, comprobacion de la memoria fisica, tablas
+	invertida y multinivel, segmentacion paginada y traduccion de direcciones.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include <stdatomic.h>					// Publicacion del modelo vigente entre hilos (RCU)
+
+#include "memmanager.h"
+
+#ifdef _WIN32
+	#include <windows.h>
+	#define cederProcesador() SwitchToThread()
+#else
+	#include <sys/mman.h>				// Proyeccion en memoria de las imagenes binarias
+	#include <sys/stat.h>
+	#include <sched.h>
+	#define cederProcesador() sched_yield()		// Espera de publicarModelo() a que los lectores salgan del modelo
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#include <immintrin.h>				// Traduccion vectorizada con SSE4.1 y AVX2 (elegida en tiempo de ejecucion)
+	#define SIMD_X86 1
+#else
+	#define SIMD_X86 0
+#endif
+
+#define marcaImagen "MEMIMAGE"			// Primeros bytes de una imagen binaria del fichero de datos
+#define versionImagen 1					// Version del formato de la imagen binaria
+
+// Estructura que recorre el contenido del fichero de entrada, cargado en memoria, para leer sus valores
+typedef struct lector{
+	const char *pos;									// Siguiente caracter a leer
+	const char *fin;									// Final del contenido
+	const char *inicioLinea;							// Primer caracter de la linea actual, para indicar la posicion de los errores
+	int linea;											// Numero de la linea actual, empezando en 1
+	FILE *salida;										// Fichero en el que se escriben los errores de formato, o NULL para no escribirlos
+}lector;
+
+/* Prototipos de las funciones internas (static: la biblioteca solo exporta las de memmanager.h) */
+static int leerCaracter(lector *l);
+static int leerEntero(lector *l, int *valor);
+static int errorFormato(const lector *l, const char *mensaje);
+static int leerRegistros(lector *l, registro r[], int n, const char *mensaje);
+static int leerMarcos(lector *l, int m[], int n, int ultimaLinea, const char *mensaje);
+static int leerTablasSegmentos(lector *l, segmentacion *t_segmentacion, int tamano, const char *mensaje);
+static int leerRegiones(lector *l, paginacion *t_paginacion, int numProcesos, const char *mensaje);
+static int rangosSolapados(const registro rangos[], int numProcesos, FILE *salida);
+static int barrerSolapamientos(intervalo v[], int n, int compartir, const char *elemento, FILE *salida);
+static int marcarMarcosRepetidos(const paginacion *t_paginacion, mapaMarcos *repetidos);
+static int rangosValidos (const registro rangos[], int numProcesos);
+static int calcularDesplazamientos (const registro rangos[], int numProcesos, int desplazamientos[]);
+static int bitsPotencia(int tamano);
+static int construirInvertida(paginacion *t_paginacion, int numProcesos, FILE *salida);
+static void liberarTablasPaginas(paginacion *t_paginacion);
+static int *reconstruirPMT(const paginacion *t_paginacion);
+static void mostrarEstadisticasInvertida(const paginacion *t_paginacion, int numProcesos, FILE *salida);
+static int rangosRadix(const paginacion *t_paginacion, int numProcesos);
+static int construirRadix(paginacion *t_paginacion, int numProcesos, FILE *salida);
+static int buscarRadix(const paginacion *t_paginacion, int proceso, int nPagina);
+static void mostrarEstadisticasRadix(const paginacion *t_paginacion, int numProcesos, FILE *salida);
+
+
+
+//*************************************************************
+//*	Funcion:
+//*		Funciones del lector de numeros utilizado por leerDatos().
+//*
+//*
+//* Algoritmo:
+//*		Recorren el contenido del fichero, ya cargado en memoria, caracter
+//*		a caracter y sin pasar por stdio.
+//*		leerEntero() salta los espacios y saltos de linea previos (igual que
+//*		fscanf con "%d") y convierte los digitos a mano, rechazando los
+//*		valores que no caben en un entero.
+//*		leerCaracter() devuelve el siguiente caracter, tratando "\r\n" como
+//*		un unico salto de linea, o EOF al llegar al final del contenido.
+//*		Ambas mantienen la linea y la posicion actuales, que errorFormato()
+//*		muestra junto al mensaje de error.
+//*
+//*************************************************************
+static int leerCaracter(lector *l){
+	int c;
+	
+	if (l->pos >= l->fin){
+		return EOF;
+	}
+	
+	c = (unsigned char)*l->pos++;
+	
+	if (c == '\r' && l->pos < l->fin && *l->pos == '\n'){
+		c = *l->pos++;
+	}
+	
+	if (c == '\n'){
+		l->linea++;
+		l->inicioLinea = l->pos;
+	}
+	
+	return c;
+}
+
+static int leerEntero(lector *l, int *valor){
+	const char *inicio;
+	long long v = 0;
+	int negativo = 0;
+	
+	// Espacios previos, como hace fscanf
+	while (l->pos < l->fin && (*l->pos == ' ' || *l->pos == '\t' || *l->pos == '\n' || *l->pos == '\r' || *l->pos == '\v' || *l->pos == '\f')){
+		leerCaracter(l);
+	}
+	
+	if (l->pos < l->fin && (*l->pos == '-' || *l->pos == '+')){
+		negativo = (*l->pos == '-');
+		l->pos++;
+	}
+	
+	inicio = l->pos;
+	while (l->pos < l->fin && *l->pos >= '0' && *l->pos <= '9'){
+		v = v * 10 + (*l->pos - '0');
+		if (v > (long long)INT_MAX + 1){
+			return 0;
+		}
+		l->pos++;
+	}
+	
+	if (l->pos == inicio){
+		return 0;
+	}
+	
+	if (negativo){
+		v = -v;
+	}
+	
+	if (v > INT_MAX){
+		return 0;
+	}
+	
+	*valor = (int)v;
+	return 1;
+}
+
+static int errorFormato(const lector *l, const char *mensaje){
+	if (l->salida != NULL){
+		fprintf (l->salida, "%s (Linea %d, posicion %d)\n\n", mensaje, l->linea, (int)(l->pos - l->inicioLinea) + 1);
+	}
+	return 0;
+}
+
+
+
+//*************************************************************
+//*	Funcion:
+//*		Funciones que leen una linea completa de valores del fichero.
+//*
+//*
+//* Algoritmo:
+//*		leerRegistros() lee "n" parejas de valores (base y limite) y
+//*		leerMarcos() lee "n" valores sueltos. Detras de cada numero debe
+//*		aparecer un espacio, salvo detras del ultimo, que debe ir seguido
+//*		de un salto de linea. Con la ultima linea del fichero (ultimaLinea)
+//*		el salto de linea no se comprueba, porque lo hace el llamador junto
+//*		con el final de fichero.
+//*		Si algun valor no es correcto se muestra "mensaje" y devuelven 0.
+//*
+//*************************************************************
+static int leerRegistros(lector *l, registro r[], int n, const char *mensaje){
+	int i;
+	
+	for (i = 0 ; i < n ; i++){
+		if (!leerEntero(l, &r[i].base) || leerCaracter(l) != ' ' || !leerEntero(l, &r[i].limite)){
+			return errorFormato(l, mensaje);
+		}
+		
+		if (leerCaracter(l) != (i < n - 1 ? ' ' : '\n')){
+			return errorFormato(l, mensaje);
+		}
+	}
+	
+	if (n == 0 && leerCaracter(l) != '\n'){
+		return errorFormato(l, mensaje);
+	}
+	
+	return 1;
+}
+
+static int leerMarcos(lector *l, int m[], int n, int ultimaLinea, const char *mensaje){
+	int i;
+	
+	for (i = 0 ; i < n ; i++){
+		if (!leerEntero(l, &m[i])){
+			return errorFormato(l, mensaje);
+		}
+		
+		if (i < n - 1){
+			if (leerCaracter(l) != ' '){
+				return errorFormato(l, mensaje);
+			}
+		}
+		else if (!ultimaLinea && leerCaracter(l) != '\n'){
+			return errorFormato(l, mensaje);
+		}
+	}
+	
+	return 1;
+}
+
+
+
+//*************************************************************
+//*	Funcion:
+//*		Funcion que comprueba si los rangos de una tabla global
+//*			 (RBTS/RLTS o RBTP/RLTP) de dos procesos se solapan.
+//*
+//*
+//* Algoritmo:
+//*		Ordena los rangos de los procesos por su primer indice y los
+//*		recorre en ese orden: cada rango solo puede solaparse con los
+//*		siguientes que empiezan antes de que el termine, por lo que el
+//*		coste es O(P log P) mas una comprobacion por cada solapamiento.
+//*		Los procesos sin entradas (limite -1) no se tienen en cuenta.
+//*		Si "salida" es NULL devuelve 1 en cuanto encuentra un solapamiento;
+//*		en caso contrario escribe en ella cada pareja de procesos en
+//*		conflicto y devuelve el numero de parejas.
+//*		Devuelve -1 si no hay memoria suficiente para la comprobacion.
+//*
+//*************************************************************
+int compararIntervalos(const void *a, const void *b){
+	const intervalo *x = (const intervalo*)a, *y = (const intervalo*)b;
+	
+	if (x->inicio != y->inicio){
+		return (x->inicio < y->inicio) ? -1 : 1;
+	}
+	if (x->fin != y->fin){
+		return (x->fin < y->fin) ? -1 : 1;
+	}
+	return (x->proceso > y->proceso) - (x->proceso < y->proceso);
+}
+
+static int rangosSolapados(const registro rangos[], int numProcesos, FILE *salida){
+	intervalo *intervalos;
+	int i, j, n = 0, conflictos = 0;
+	
+	intervalos = (intervalo*)malloc(sizeof(intervalo) * numProcesos);
+	if (intervalos == NULL){
+		return -1;
+	}
+	
+	for (i = 0 ; i < numProcesos ; i++){
+		if (rangos[i].limite >= 0){
+			intervalos[n].inicio = rangos[i].base;
+			intervalos[n].fin = (long long)rangos[i].base + rangos[i].limite;
+			intervalos[n].proceso = i;
+			intervalos[n].indice = 0;
+			n++;
+		}
+	}
+	
+	qsort(intervalos, n, sizeof(intervalo), compararIntervalos);
+	
+	for (i = 0 ; i < n ; i++){
+		for (j = i + 1 ; j < n && intervalos[j].inicio <= intervalos[i].fin ; j++){
+			conflictos++;
+			
+			if (salida == NULL){
+				free(intervalos);
+				return 1;
+			}
+			
+			fprintf (salida, "\tProcesos %d y %d: entradas %d-%lld y %d-%lld\n",
+					intervalos[i].proceso, intervalos[j].proceso,
+					intervalos[i].inicio, intervalos[i].fin, intervalos[j].inicio, intervalos[j].fin);
+		}
+	}
+	
+	free(intervalos);
+	return conflictos;
+}
+
+
+
+//*************************************************************
+//*	Funcion:
+//*		Funcion que busca colisiones en memoria fisica entre las
+//*			 particiones, los segmentos y los marcos de pagina.
+//*
+//*
+//* Algoritmo:
+//*		Particiones y segmentos: se ordenan los intervalos fisicos
+//*		[base, base+limite] por su inicio y se recorren en ese orden,
+//*		comparando cada uno solo con los siguientes que empiezan antes de
+//*		que el termine (barrerSolapamientos). Si se permite compartir entre
+//*		procesos, se ordenan antes por proceso y cada uno solo se compara
+//*		con los de su proceso, de modo que cada comparacion es un conflicto.
+//*		Marcos: un mapaMarcos de marcos ocupados detecta en O(n) los
+//*		marcos asignados mas de una vez (marcarMarcosRepetidos), tanto en
+//*		la PMT como en las regiones de la tabla multinivel. Solo las
+//*		paginas de esos marcos se ordenan como parejas (marco, proceso,
+//*		pagina), de modo que las que comparten marco quedan juntas y cada
+//*		una se compara con la primera de su grupo (de su marco o, si se
+//*		permite compartir, de su marco y su proceso). Si los numeros de marco
+//*		son demasiado grandes para el mapa de bits, se ordenan todas.
+//*		Las paginas sin marco (-1) no se tienen en cuenta.
+//*		El coste total es O(n log n) mas uno por conflicto.
+//*		Si "compartir" es 1 no se avisan los segmentos y marcos compartidos
+//*		entre procesos distintos. Devuelve el numero de conflictos avisados.
+//*
+//*************************************************************
+// Orden de los intervalos por proceso y, dentro de cada proceso, como compararIntervalos()
+static int compararIntervalosProceso(const void *a, const void *b){
+	const intervalo *x = (const intervalo*)a, *y = (const intervalo*)b;
+	
+	if (x->proceso != y->proceso){
+		return (x->proceso < y->proceso) ? -1 : 1;
+	}
+	return compararIntervalos(a, b);
+}
+
+static int barrerSolapamientos(intervalo v[], int n, int compartir, const char *elemento, FILE *salida){
+	int i, j, conflictos = 0;
+	
+	qsort(v, n, sizeof(intervalo), compartir ? compararIntervalosProceso : compararIntervalos);
+	
+	for (i = 0 ; i < n ; i++){
+		for (j = i + 1 ; j < n && (!compartir || v[j].proceso == v[i].proceso) && v[j].inicio <= v[i].fin ; j++){
+			conflictos++;
+			fprintf (salida, "\tAviso. %s %d del proceso %d (%d-%lld) y %s %d del proceso %d (%d-%lld) se solapan.\n",
+					elemento, v[i].indice, v[i].proceso, v[i].inicio, v[i].fin,
+					elemento, v[j].indice, v[j].proceso, v[j].inicio, v[j].fin);
+		}
+	}
+	
+	return conflictos;
+}
+
+static int marcarMarcosRepetidos(const paginacion *t_paginacion, mapaMarcos *repetidos){
+	mapaMarcos ocupados;
+	int i, j, k, marco, maxMarco = -1;
+	
+	for (k = 0 ; t_paginacion->tipo < 2 && k < t_paginacion->numEntradas ; k++){
+		if (t_paginacion->PMT[k] > maxMarco){
+			maxMarco = t_paginacion->PMT[k];
+		}
+	}
+	for (i = 0 ; t_paginacion->tipo == 3 && i < t_paginacion->numRegiones ; i++){
+		if (t_paginacion->regiones[i].marco + t_paginacion->regiones[i].paginas - 1 > maxMarco){
+			maxMarco = t_paginacion->regiones[i].marco + t_paginacion->regiones[i].paginas - 1;
+		}
+	}
+	
+	// El mapa de bits no puede ocupar mas de 16 bytes por pagina
+	if (maxMarco / 128 > t_paginacion->numEntradas){
+		return 0;
+	}
+	
+	if (!crearMapaMarcos(&ocupados, maxMarco + 1)){
+		return 0;
+	}
+	if (!crearMapaMarcos(repetidos, maxMarco + 1)){
+		liberarMapaMarcos(&ocupados);
+		return 0;
+	}
+	
+	// Los marcos que ya estaban ocupados se ocupan tambien en "repetidos"
+	for (k = 0 ; t_paginacion->tipo < 2 && k < t_paginacion->numEntradas ; k++){
+		marco = t_paginacion->PMT[k];
+		if (marco >= 0 && !ocuparMarco(&ocupados, marco)){
+			ocuparMarco(repetidos, marco);
+		}
+	}
+	for (i = 0 ; t_paginacion->tipo == 3 && i < t_paginacion->numRegiones ; i++){
+		for (j = 0 ; j < t_paginacion->regiones[i].paginas ; j++){
+			marco = t_paginacion->regiones[i].marco + j;
+			if (!ocuparMarco(&ocupados, marco)){
+				ocuparMarco(repetidos, marco);
+			}
+		}
+	}
+	
+	liberarMapaMarcos(&ocupados);
+	return 1;
+}
+
+int comprobarMemoriaFisica(int numProcesos, const registro t_registros[], const paginacion *t_paginacion, const segmentacion *t_segmentacion, int compartir, FILE *salida){
+	intervalo *v;
+	mapaMarcos repetidos;
+	int i, j, k, n, max, primero, marcados, conflictos = 0;
+	
+	max = numProcesos;
+	if (t_segmentacion->numSegmentos > max){
+		max = t_segmentacion->numSegmentos;
+	}
+	if (t_paginacion->numEntradas > max){
+		max = t_paginacion->numEntradas;
+	}
+	
+	v = (intervalo*)malloc(sizeof(intervalo) * (max + 1));
+	if (v == NULL){
+		fprintf (salida, "\tAviso. No hay memoria suficiente para comprobar la memoria fisica.\n");
+		return 0;
+	}
+	
+	// Particiones del metodo registro base/limite. Nunca se pueden compartir.
+	for (i = 0, n = 0 ; i < numProcesos ; i++){
+		if (t_registros[i].limite >= 0){
+			v[n].inicio = t_registros[i].base;
+			v[n].fin = (long long)t_registros[i].base + t_registros[i].limite;
+			v[n].proceso = i;
+			v[n].indice = i;
+			n++;
+		}
+	}
+	conflictos += barrerSolapamientos(v, n, 0, "Particion", salida);
+	
+	// Segmentos de la SDT
+	for (i = 0, n = 0 ; i < numProcesos ; i++){
+		for (j = 0 ; j <= t_segmentacion->RBTS_RLTS[i].limite ; j++){
+			k = t_segmentacion->desplazamientoSDT[i] + j;
+			if (t_segmentacion->SDT[k].limite >= 0){
+				v[n].inicio = t_segmentacion->SDT[k].base;
+				v[n].fin = (long long)t_segmentacion->SDT[k].base + t_segmentacion->SDT[k].limite;
+				v[n].proceso = i;
+				v[n].indice = j;
+				n++;
+			}
+		}
+	}
+	conflictos += barrerSolapamientos(v, n, compartir, "Segmento", salida);
+	
+	// Marcos de pagina: intervalos de un solo valor, agrupados por marco.
+	// La tabla invertida ya no admite marcos repetidos al construirse
+	marcados = (t_paginacion->tipo != 2) && marcarMarcosRepetidos(t_paginacion, &repetidos);
+	
+	// Con la tabla multinivel, las paginas con marco son las de sus regiones
+	for (i = 0, n = 0 ; t_paginacion->tipo == 3 && i < t_paginacion->numRegiones ; i++){
+		for (j = 0 ; j < t_paginacion->regiones[i].paginas ; j++){
+			k = t_paginacion->regiones[i].marco + j;
+			if (!marcados || !marcoLibre(&repetidos, k)){
+				v[n].inicio = v[n].fin = k;
+				v[n].proceso = t_paginacion->regiones[i].proceso;
+				v[n].indice = t_paginacion->regiones[i].pagina + j;
+				n++;
+			}
+		}
+	}
+	
+	for (i = 0 ; i < numProcesos && t_paginacion->tipo < 2 ; i++){
+		for (j = 0 ; j <= t_paginacion->RBTP_RLTP[i].limite ; j++){
+			k = t_paginacion->PMT[t_paginacion->desplazamientoPMT[i] + j];
+			if (k >= 0 && (!marcados || !marcoLibre(&repetidos, k))){
+				v[n].inicio = v[n].fin = k;
+				v[n].proceso = i;
+				v[n].indice = j;
+				n++;
+			}
+		}
+	}
+	
+	qsort(v, n, sizeof(intervalo), compararIntervalos);
+	
+	for (i = 1, primero = 0 ; i < n ; i++){
+		if (v[i].inicio != v[primero].inicio || (compartir && v[i].proceso != v[primero].proceso)){
+			primero = i;
+		}
+		else{
+			conflictos++;
+			fprintf (salida, "\tAviso. El marco %d esta asignado a la pagina %d del proceso %d y a la pagina %d del proceso %d.\n",
+					v[i].inicio, v[primero].indice, v[primero].proceso, v[i].indice, v[i].proceso);
+		}
+	}
+	
+	if (marcados){
+		liberarMapaMarcos(&repetidos);
+	}
+	free(v);
+	return conflictos;
+}
+
+
+
+//*************************************************************
+//*	Funcion:
+//*		Funcion que carga en memoria el contenido completo
+//*			 de un fichero.
+//*
+//*
+//* Algoritmo:
+//*		Lee el fichero en bloques sobre un buffer que crece al doble
+//*		cuando se llena, de modo que no depende de conocer el tamano del
+//*		fichero de antemano (funciona tambien con tuberias).
+//*		Devuelve el buffer, que debe liberar el llamador, y su longitud,
+//*		o NULL si no hay memoria suficiente.
+//*
+//*************************************************************
+char *leerFichero(FILE *fp, size_t *longitud){
+	size_t capacidad = 1 << 16, leidos;
+	char *contenido = (char*)malloc(capacidad), *aux;
+	
+	*longitud = 0;
+	
+	while (contenido != NULL && (leidos = fread(contenido + *longitud, 1, capacidad - *longitud, fp)) > 0){
+		*longitud += leidos;
+		
+		if (*longitud == capacidad){
+			capacidad *= 2;
+			aux = (char*)realloc(contenido, capacidad);
+			if (aux == NULL){
+				free(contenido);
+			}
+			contenido = aux;
+		}
+	}
+	
+	return contenido;
+}
+
+
+
+//*************************************************************
+//*	Funcion:
+//*		Funciones auxiliares para las tablas de tamano variable.
+//*
+//*
+//* Algoritmo:
+//*		rangosValidos() comprueba que los registros base de una tabla no
+//*		sean negativos, que los limites sean al menos -1 (proceso sin entradas)
+//*		y que el total de entradas quepa en un entero.
+//*		calcularDesplazamientos() obtiene la posicion de las entradas de
+//*		cada proceso dentro del array contiguo de la tabla (la suma de las
+//*		entradas de los procesos anteriores) y devuelve el total de entradas.
+//*
+//*************************************************************
+static int rangosValidos (const registro rangos[], int numProcesos){
+	int i;
+	long long total = 0;
+	
+	for (i = 0 ; i < numProcesos ; i++){
+		if (rangos[i].base < 0 || rangos[i].limite < -1 || (long long)rangos[i].base + rangos[i].limite > INT_MAX){
+			return 0;
+		}
+		total += rangos[i].limite + 1;
+	}
+	
+	return total <= INT_MAX;
+}
+
+static int calcularDesplazamientos (const registro rangos[], int numProcesos, int desplazamientos[]){
+	int i, total = 0;
+	
+	for (i = 0 ; i < numProcesos ; i++){
+		desplazamientos[i] = total;
+		total += rangos[i].limite + 1;
+	}
+	
+	return total;
+}
+
+
+
+//*************************************************************
+//*	Funcion:
+//*		Funcion que verifica los datos del fichero de entrada y
+//*			 los almacena en las correspondientes variables.
+//*
+//*
+//* Algoritmo:
+//*		El algoritmo recorre una sola vez el contenido del fichero, ya
+//*		cargado en memoria, obteniendo los valores con el lector de numeros
+//*		y asignandolos a las distintas variables y estructuras utilizadas.
+//*		A la vez comprueba que detras de cada numero aparece un espacio o un
+//*		salto de linea, dependiendo de la situacion, y que la cantidad de
+//*		valores es correcta respecto a los valores que se dan en el fichero.
+//*		Por otro lado, no permite que existan tamaños de pagina negativos,
+//*		y tampoco un valor de tipo de paginacion distinto de 0, 1, 2 o 3.
+//*		Con el tipo 2 la PMT leida se convierte en la tabla invertida, y
+//*		con el 3 la octava linea tiene regiones de paginas en lugar de un
+//*		marco por pagina, con las que se construye la tabla multinivel.
+//*		Si hay una novena linea, son las tablas de paginas de los segmentos
+//*		para la segmentacion paginada.
+//*		Las tablas se reservan con el tamano indicado en el propio fichero:
+//*		una vez leidos los RBTS/RLTS (o RBTP/RLTP) se conoce el numero total
+//*		de segmentos (o paginas) y la posicion de cada proceso en la tabla.
+//*
+//*		Devuelve 1 si los datos son correctos, 0 si no lo son (tras escribir
+//*		el error con su linea y posicion en "salida", si no es NULL) y -1
+//*		si no hay memoria suficiente.
+//*		Salvo cuando devuelve 1, no queda ninguna tabla reservada.
+//*
+//*************************************************************
+int leerDatos(const char *contenido, size_t longitud, int *numProcesos, registro **t_registros, paginacion *t_paginacion, segmentacion *t_segmentacion, FILE *salida){
+	lector l, lineaRangos;					// lineaRangos guarda el inicio de la linea de RBTS/RLTS, RBTP/RLTP o de los marcos para los errores
+	int c, valido, estado;
+	
+	l.pos = contenido;
+	l.fin = contenido + longitud;
+	l.inicioLinea = contenido;
+	l.linea = 1;
+	l.salida = salida;
+	
+	*t_registros = NULL;
+	t_segmentacion->RBTS_RLTS = NULL;
+	t_segmentacion->desplazamientoSDT = NULL;
+	t_segmentacion->SDT = NULL;
+	t_segmentacion->paginada = 0;
+	t_segmentacion->numPaginasSegmentos = 0;
+	t_segmentacion->marcosSegmentos = NULL;
+	t_segmentacion->tablasSegmentos = NULL;
+	t_segmentacion->contadores = NULL;
+	t_paginacion->RBTP_RLTP = NULL;
+	t_paginacion->desplazamientoPMT = NULL;
+	t_paginacion->PMT = NULL;
+	t_paginacion->numMarcos = 0;
+	t_paginacion->invertida = NULL;
+	t_paginacion->anclas = NULL;
+	t_paginacion->numNiveles = 0;
+	t_paginacion->raices = NULL;
+	t_paginacion->radix = NULL;
+	t_paginacion->numRadix = 0;
+	t_paginacion->regiones = NULL;
+	t_paginacion->numRegiones = 0;
+	t_paginacion->contadores = NULL;
+	
+	// Lectura del numero de procesos. Cada proceso ocupa al menos 4 caracteres en la linea de RB/RL ("0 0 "),
+	// asi que un numero mayor no cabe en el resto del fichero y se rechaza antes de reservar sus tablas
+	if (!leerEntero(&l, numProcesos) || *numProcesos <= 0 || leerCaracter(&l) != '\n' || (size_t)*numProcesos > (size_t)(l.fin - l.pos) / 4){
+		return errorFormato(&l, "Numero de procesos incorrecto.");
+	}
+    
+    *t_registros = (registro*)malloc(sizeof(registro) * *numProcesos);
+    t_segmentacion->RBTS_RLTS = (registro*)malloc(sizeof(registro) * *numProcesos);
+    t_segmentacion->desplazamientoSDT = (int*)malloc(sizeof(int) * *numProcesos);
+    t_paginacion->RBTP_RLTP = (registro*)malloc(sizeof(registro) * *numProcesos);
+    t_paginacion->desplazamientoPMT = (int*)malloc(sizeof(int) * *numProcesos);
+    
+    if (*t_registros == NULL || t_segmentacion->RBTS_RLTS == NULL || t_segmentacion->desplazamientoSDT == NULL ||
+    	t_paginacion->RBTP_RLTP == NULL || t_paginacion->desplazamientoPMT == NULL){
+    	liberarDatos(*t_registros, t_paginacion, t_segmentacion);
+    	return -1;
+    }
+
+    // Lectura de los valores RB y RL de cada proceso, asociados al metodo Registro Base/Limite
+    valido = leerRegistros(&l, *t_registros, *numProcesos, "Valores de RB/RL incorrectos.");
+    
+    // Lectura de los registros RBTS y RLTS de cada proceso
+    if (valido){
+    	lineaRangos = l;
+    	valido = leerRegistros(&l, t_segmentacion->RBTS_RLTS, *numProcesos, "Valores de RBTS/RLTS incorrectos.");
+    	
+    	if (valido && !rangosValidos(t_segmentacion->RBTS_RLTS, *numProcesos)){
+    		valido = errorFormato(&lineaRangos, "Valores de RBTS/RLTS incorrectos.");
+    	}
+    }
+    
+	// Solo tenemos una SDT global. Comprobamos que los valores RBTS/RLTS de cada proceso
+	// no se sobreescriban
+    estado = valido ? rangosSolapados(t_segmentacion->RBTS_RLTS, *numProcesos, NULL) : 0;
+    if (estado < 0){
+    	liberarDatos(*t_registros, t_paginacion, t_segmentacion);
+    	return -1;
+    }
+    if (estado){
+    	if (salida != NULL){
+    		fprintf (salida, "Valores de RBTS/RLTS incorrectos.\n");
+    	}
+    	valido = errorFormato(&lineaRangos, "Se esta usando una SDT global y se han introducido valores que se sobreescriben.");
+    	if (salida != NULL){
+    		rangosSolapados(t_segmentacion->RBTS_RLTS, *numProcesos, salida);
+    		fprintf (salida, "\n");
+    	}
+    }
+    
+    // Reserva de la SDT con el numero total de segmentos y lectura de los registros RB y RL de cada segmento
+    if (valido){
+    	t_segmentacion->numSegmentos = calcularDesplazamientos(t_segmentacion->RBTS_RLTS, *numProcesos, t_segmentacion->desplazamientoSDT);
+	    t_segmentacion->SDT = (registro*)malloc(sizeof(registro) * (t_segmentacion->numSegmentos + 1));
+	    if (t_segmentacion->SDT == NULL){
+	    	liberarDatos(*t_registros, t_paginacion, t_segmentacion);
+	    	return -1;
+	    }
+	    
+	    valido = leerRegistros(&l, t_segmentacion->SDT, t_segmentacion->numSegmentos, "Valores de RB/RL de cada segmento incorrectos.");
+    }
+    
+    // Lectura del tamaño de pagina
+    if (valido && (!leerEntero(&l, &t_paginacion->tamano) || t_paginacion->tamano <= 0 || leerCaracter(&l) != '\n')){
+    	valido = errorFormato(&l, "Valor de tamanyo de pagina incorrecto.");
+    }
+    t_paginacion->bitsPagina = bitsPotencia(t_paginacion->tamano);
+    
+    // Lectura del tipo de paginacion
+    if (valido && (!leerEntero(&l, &t_paginacion->tipo) || t_paginacion->tipo < 0 || t_paginacion->tipo > 3)){
+    	valido = errorFormato(&l, "Valor de tipo de paginacion incorrecto.");
+    }
+    
+    // Con tabla multinivel, en la misma linea van los bits de cada nivel
+    if (valido && t_paginacion->tipo == 3){
+    	for (c = 0, t_paginacion->numNiveles = 0 ; valido && t_paginacion->numNiveles < 4 && l.pos < l.fin && *l.pos == ' ' ; t_paginacion->numNiveles++){
+    		leerCaracter(&l);
+    		if (!leerEntero(&l, &t_paginacion->bitsNivel[t_paginacion->numNiveles]) || t_paginacion->bitsNivel[t_paginacion->numNiveles] < 1 ||
+    			t_paginacion->bitsNivel[t_paginacion->numNiveles] > 20){
+    			valido = errorFormato(&l, "Bits de un nivel de la tabla multinivel incorrectos (de 1 a 20).");
+    		}
+    		c += t_paginacion->bitsNivel[t_paginacion->numNiveles];
+    	}
+    	
+    	if (valido && (t_paginacion->numNiveles < 2 || c > 31)){
+    		valido = errorFormato(&l, "La tabla multinivel debe tener de 2 a 4 niveles y 31 bits como maximo en total.");
+    	}
+    }
+    
+    if (valido && leerCaracter(&l) != '\n'){
+    	valido = errorFormato(&l, "Valor de tipo de paginacion incorrecto.");
+    }
+    
+    // Lectura de los registros RBTP y RLTP de cada proceso
+    if (valido){
+    	lineaRangos = l;
+    	valido = leerRegistros(&l, t_paginacion->RBTP_RLTP, *numProcesos, "Valores de RBTP/RLTP incorrectos.");
+    	
+    	// Con tabla multinivel no hay una PMT con todas las paginas, asi que el total no esta limitado
+    	if (valido && !((t_paginacion->tipo == 3) ? rangosRadix(t_paginacion, *numProcesos) : rangosValidos(t_paginacion->RBTP_RLTP, *numProcesos))){
+    		valido = errorFormato(&lineaRangos, "Valores de RBTP/RLTP incorrectos.");
+    	}
+    }
+    
+    // Si tenemos una PMT Global, los RBTP y RLTP no deben sobreescribirse
+    estado = (valido && t_paginacion->tipo == 0) ? rangosSolapados(t_paginacion->RBTP_RLTP, *numProcesos, NULL) : 0;
+    if (estado < 0){
+    	liberarDatos(*t_registros, t_paginacion, t_segmentacion);
+    	return -1;
+    }
+    if (estado){
+    	if (salida != NULL){
+    		fprintf (salida, "Valores de RBTP/RLTP incorrectos.\n");
+    	}
+    	valido = errorFormato(&lineaRangos, "Se esta usando una PMT global y se han introducido valores para una PMT por proceso.");
+    	if (salida != NULL){
+    		rangosSolapados(t_paginacion->RBTP_RLTP, *numProcesos, salida);
+    		fprintf (salida, "\n");
+    	}
+    }
+    
+    // Con tabla multinivel, lectura de las regiones de paginas asignadas y construccion de los arboles
+    if (valido && t_paginacion->tipo == 3){
+    	memset(t_paginacion->desplazamientoPMT, 0, sizeof(int) * *numProcesos);
+    	lineaRangos = l;
+    	estado = leerRegiones(&l, t_paginacion, *numProcesos, "Regiones de paginas (proceso pagina marco paginas) incorrectas.");
+    	
+    	if (estado > 0 && (estado = construirRadix(t_paginacion, *numProcesos, salida)) == 0){
+    		errorFormato(&lineaRangos, "Con tabla de paginas multinivel cada pagina solo puede estar en una region.");
+    	}
+    	if (estado < 0){
+    		liberarDatos(*t_registros, t_paginacion, t_segmentacion);
+    		return -1;
+    	}
+    	valido = estado;
+    }
+    
+	// Reserva de la PMT con el numero total de paginas y lectura del marco de pagina asociado a cada pagina de cada proceso
+    else if (valido){
+	    t_paginacion->numEntradas = calcularDesplazamientos(t_paginacion->RBTP_RLTP, *numProcesos, t_paginacion->desplazamientoPMT);
+	    t_paginacion->PMT = (int*)malloc(sizeof(int) * (t_paginacion->numEntradas + 1));
+	    if (t_paginacion->PMT == NULL){
+	    	liberarDatos(*t_registros, t_paginacion, t_segmentacion);
+	    	return -1;
+	    }
+	    
+	    lineaRangos = l;
+	    valido = leerMarcos(&l, t_paginacion->PMT, t_paginacion->numEntradas, 1, "Valores de marcos de pagina asociados a cada pagina de cada proceso incorrectos.");
+    }
+    
+    // Con tabla invertida, la PMT leida se sustituye por la tabla indexada por marco
+    if (valido && t_paginacion->tipo == 2){
+    	int *PMT = t_paginacion->PMT;
+    	
+    	estado = construirInvertida(t_paginacion, *numProcesos, salida);
+    	if (estado < 0){
+    		liberarDatos(*t_registros, t_paginacion, t_segmentacion);
+    		return -1;
+    	}
+    	if (estado == 0){
+    		valido = errorFormato(&lineaRangos, "Con tabla de paginas invertida cada marco solo puede pertenecer a una pagina.");
+    	}
+    	else{
+    		free(PMT);
+    	}
+    }
+    
+    // Novena linea opcional: la tabla de paginas de cada segmento, para la segmentacion paginada
+    if (valido){
+    	lineaRangos = l;
+    	if (leerCaracter(&lineaRangos) == '\n' && lineaRangos.pos < lineaRangos.fin &&
+    		(*lineaRangos.pos == '-' || (*lineaRangos.pos >= '0' && *lineaRangos.pos <= '9'))){
+    		l = lineaRangos;
+    		estado = leerTablasSegmentos(&l, t_segmentacion, t_paginacion->tamano, "Valores de marcos de pagina asociados a cada pagina de cada segmento incorrectos.");
+    		if (estado < 0){
+    			liberarDatos(*t_registros, t_paginacion, t_segmentacion);
+    			return -1;
+    		}
+    		valido = estado;
+    	}
+    }
+    
+    // Tras el ultimo valor solo puede haber un espacio o un salto de linea antes del final de fichero
+    if (valido){
+    	c = leerCaracter(&l);
+    	if ((c != EOF && c != ' ' && c != '\n') || (c != EOF && leerCaracter(&l) != EOF)){
+    		valido = errorFormato(&l, "Final de fichero incorrecto.");
+    	}
+    }
+    
+    if (!valido){
+    	liberarDatos(*t_registros, t_paginacion, t_segmentacion);
+    }
+    
+    return valido;
+}
+
+
+
+//*************************************************************
+//*	Funcion:
+//*		Funcion que libera las tablas reservadas por leerDatos().
+//*
+//*************************************************************
+void liberarDatos(registro *t_registros, paginacion *t_paginacion, segmentacion *t_segmentacion){
+	free(t_registros);
+	
+	free(t_segmentacion->RBTS_RLTS);
+	free(t_segmentacion->desplazamientoSDT);
+	free(t_segmentacion->SDT);
+	free(t_segmentacion->marcosSegmentos);
+	free(t_segmentacion->tablasSegmentos);
+	free(t_segmentacion->contadores);
+	
+	free(t_paginacion->RBTP_RLTP);
+	free(t_paginacion->desplazamientoPMT);
+	free(t_paginacion->PMT);
+	liberarTablasPaginas(t_paginacion);
+}
+
+
+
+//*************************************************************
+//*	Funcion:
+//*		Funciones de la imagen binaria del fichero de datos.
+//*
+//*
+//* Algoritmo:
+//*		guardarImagen() escribe los datos ya validados en un fichero
+//*		binario: una cabecera con la marca "MEMIMAGE", la version del
+//*		formato, el orden de bytes de la maquina, la longitud total, una
+//*		suma de control y el numero de elementos de cada tabla, seguida de
+//*		las tablas, una a continuacion de otra y en el mismo formato que
+//*		tienen en memoria:
+//*			registros[numProcesos], RBTS_RLTS[numProcesos],
+//*			desplazamientoSDT[numProcesos], SDT[numSegmentos],
+//*			RBTP_RLTP[numProcesos], desplazamientoPMT[numProcesos],
+//*			PMT[numEntradas]
+//*
+//*		abrirImagen() reconoce la marca y proyecta el fichero en memoria
+//*		(mmap) de forma privada: las estructuras apuntan directamente a la
+//*		proyeccion, sin leer ni copiar nada, y el sistema comparte sus
+//*		paginas entre todos los procesos que usan la misma imagen. Solo
+//*		las paginas que se modifican (la PMT en la paginacion bajo demanda
+//*		o la SDT al compactar) se copian para el proceso que las modifica.
+//*		En Windows el fichero se lee completo en memoria.
+//*		Antes de usarla comprueba la version, el orden de bytes, la
+//*		longitud, la suma de control y que las posiciones de cada proceso
+//*		en la SDT y la PMT esten dentro de las tablas, ya que la traduccion
+//*		confia en ellas. Los errores se escriben en "salida", si no es NULL.
+//*		La tabla invertida (tipo 2) se guarda como su PMT equivalente y se
+//*		vuelve a construir en memoria al abrir la imagen.
+//*
+//*		La suma de control es la de Fletcher de 64 bits sobre palabras de
+//*		32 bits, que se calcula a la velocidad de lectura de la memoria.
+//*
+//*************************************************************
+static unsigned long long sumaFletcher(const unsigned int *datos, size_t n){
+	unsigned int a = 0, b = 0;
+	size_t i;
+	
+	for (i = 0 ; i < n ; i++){
+		a += datos[i];
+		b += a;
+	}
+	
+	return ((unsigned long long)b << 32) | a;
+}
+
+// Escribe una tabla de la imagen y acumula su suma de control
+static int escribirTabla(FILE *fp, const void *tabla, size_t bytes, unsigned int *a, unsigned int *b){
+	const unsigned int *datos = (const unsigned int*)tabla;
+	size_t i;
+	
+	for (i = 0 ; i < bytes / sizeof(unsigned int) ; i++){
+		*a += datos[i];
+		*b += *a;
+	}
+	
+	return bytes == 0 || fwrite(tabla, 1, bytes, fp) == bytes;
+}
+
+int guardarImagen(const char *fichero, int numProcesos, const registro t_registros[], const paginacion *t_paginacion, const segmentacion *t_segmentacion){
+	cabeceraImagen c;
+	unsigned int a = 0, b = 0;
+	FILE *fp;
+	int correcto;
+	int *PMT = t_paginacion->PMT;
+	
+	// La tabla invertida se guarda como su PMT equivalente
+	if (t_paginacion->tipo == 2 && (PMT = reconstruirPMT(t_paginacion)) == NULL){
+		return 0;
+	}
+	
+	if ((fp = fopen(fichero, "wb")) == NULL){
+		if (PMT != t_paginacion->PMT){
+			free(PMT);
+		}
+		return 0;
+	}
+	
+	memset(&c, 0, sizeof(cabeceraImagen));
+	memcpy(c.marca, marcaImagen, sizeof(c.marca));
+	c.version = versionImagen;
+	c.ordenBytes = 0x01020304;
+	c.numProcesos = numProcesos;
+	c.numSegmentos = t_segmentacion->numSegmentos;
+	c.numEntradas = t_paginacion->numEntradas;
+	c.tamanoPagina = t_paginacion->tamano;
+	c.tipo = t_paginacion->tipo;
+	c.longitud = sizeof(cabeceraImagen) + (unsigned long long)numProcesos * (3 * sizeof(registro) + 2 * sizeof(int))
+				 + (unsigned long long)c.numSegmentos * sizeof(registro) + (unsigned long long)c.numEntradas * sizeof(int);
+	
+	// La cabecera se escribe primero sin la suma de control, que se conoce al final
+	correcto = fwrite(&c, sizeof(cabeceraImagen), 1, fp) == 1
+			&& escribirTabla(fp, t_registros, sizeof(registro) * numProcesos, &a, &b)
+			&& escribirTabla(fp, t_segmentacion->RBTS_RLTS, sizeof(registro) * numProcesos, &a, &b)
+			&& escribirTabla(fp, t_segmentacion->desplazamientoSDT, sizeof(int) * numProcesos, &a, &b)
+			&& escribirTabla(fp, t_segmentacion->SDT, sizeof(registro) * c.numSegmentos, &a, &b)
+			&& escribirTabla(fp, t_paginacion->RBTP_RLTP, sizeof(registro) * numProcesos, &a, &b)
+			&& escribirTabla(fp, t_paginacion->desplazamientoPMT, sizeof(int) * numProcesos, &a, &b)
+			&& escribirTabla(fp, PMT, sizeof(int) * c.numEntradas, &a, &b);
+	
+	if (PMT != t_paginacion->PMT){
+		free(PMT);
+	}
+	
+	c.sumaControl = ((unsigned long long)b << 32) | a;
+	correcto = correcto && fseek(fp, 0, SEEK_SET) == 0 && fwrite(&c, sizeof(cabeceraImagen), 1, fp) == 1;
+	
+	return (fclose(fp) == 0) && correcto;
+}
+
+// Comprueba que los rangos de cada proceso caben en su tabla
+static int tablaValida(const registro rangos[], const int desplazamientos[], int numProcesos, int numElementos){
+	int i;
+	
+	for (i = 0 ; i < numProcesos ; i++){
+		if (rangos[i].limite < -1 || desplazamientos[i] < 0 || (long long)desplazamientos[i] + rangos[i].limite + 1 > numElementos){
+			return 0;
+		}
+	}
+	return 1;
+}
+
+// Escribe un error de abrirImagen() en "salida", si no es NULL
+static void errorImagen(FILE *salida, const char *mensaje){
+	if (salida != NULL){
+		fprintf (salida, "%s\n", mensaje);
+	}
+}
+
+int abrirImagen(FILE *fp, imagen *t_imagen, int *numProcesos, registro **t_registros, paginacion *t_paginacion, segmentacion *t_segmentacion, FILE *salida){
+	cabeceraImagen c;
+	char *p;
+	int np;
+	
+	memset(t_imagen, 0, sizeof(imagen));
+	
+	if (fread(&c, sizeof(cabeceraImagen), 1, fp) != 1 || memcmp(c.marca, marcaImagen, sizeof(c.marca)) != 0){
+		rewind(fp);
+		return 0;
+	}
+	
+	if (c.version != versionImagen || c.ordenBytes != 0x01020304){
+		errorImagen(salida, "Error. La imagen es de otra version del formato o de una maquina con otro orden de bytes. Vuelva a compilar el fichero de datos.");
+		return -1;
+	}
+	
+	np = c.numProcesos;
+	if (np <= 0 || c.numSegmentos < 0 || c.numEntradas < 0 || c.tamanoPagina <= 0 || c.tipo < 0 || c.tipo > 2 ||
+		c.longitud != sizeof(cabeceraImagen) + (unsigned long long)np * (3 * sizeof(registro) + 2 * sizeof(int))
+					  + (unsigned long long)c.numSegmentos * sizeof(registro) + (unsigned long long)c.numEntradas * sizeof(int) ||
+		c.longitud > (size_t)-1){
+		errorImagen(salida, "Error. La cabecera de la imagen no es valida.");
+		return -1;
+	}
+	
+	t_imagen->longitud = (size_t)c.longitud;
+	
+#ifdef _WIN32
+	// Sin mmap: la imagen se lee completa
+	if ((t_imagen->datos = malloc(t_imagen->longitud)) == NULL){
+		errorImagen(salida, "Error. No hay memoria suficiente para la imagen.");
+		return -1;
+	}
+	rewind(fp);
+	if (fread(t_imagen->datos, 1, t_imagen->longitud, fp) != t_imagen->longitud){
+		free(t_imagen->datos);
+		t_imagen->datos = NULL;
+		errorImagen(salida, "Error. La imagen esta incompleta.");
+		return -1;
+	}
+#else
+	{
+		struct stat informacion;
+		void *datos;
+		
+		if (fstat(fileno(fp), &informacion) != 0 || (unsigned long long)informacion.st_size != c.longitud){
+			errorImagen(salida, "Error. La imagen esta incompleta.");
+			return -1;
+		}
+		
+		datos = mmap(NULL, t_imagen->longitud, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(fp), 0);
+		if (datos == MAP_FAILED){
+			errorImagen(salida, "Error. No ha sido posible proyectar la imagen en memoria.");
+			return -1;
+		}
+		t_imagen->datos = datos;
+		t_imagen->proyectada = 1;
+	}
+#endif
+	
+	p = (char*)t_imagen->datos + sizeof(cabeceraImagen);
+	
+	if (sumaFletcher((const unsigned int*)p, (t_imagen->longitud - sizeof(cabeceraImagen)) / sizeof(unsigned int)) != c.sumaControl){
+		errorImagen(salida, "Error. La suma de control de la imagen no coincide: el fichero esta danado.");
+		cerrarImagen(t_imagen);
+		return -1;
+	}
+	
+	// Las estructuras apuntan a las tablas de la imagen, en el orden en que se escribieron
+	*numProcesos = np;
+	*t_registros = (registro*)p;						p += sizeof(registro) * np;
+	t_segmentacion->numSegmentos = c.numSegmentos;
+	t_segmentacion->RBTS_RLTS = (registro*)p;			p += sizeof(registro) * np;
+	t_segmentacion->desplazamientoSDT = (int*)p;		p += sizeof(int) * np;
+	t_segmentacion->SDT = (registro*)p;					p += sizeof(registro) * c.numSegmentos;
+	t_segmentacion->paginada = 0;
+	t_segmentacion->numPaginasSegmentos = 0;
+	t_segmentacion->marcosSegmentos = NULL;
+	t_segmentacion->tablasSegmentos = NULL;
+	t_segmentacion->contadores = NULL;
+	t_paginacion->tamano = c.tamanoPagina;
+	t_paginacion->bitsPagina = bitsPotencia(c.tamanoPagina);
+	t_paginacion->tipo = c.tipo;
+	t_paginacion->numEntradas = c.numEntradas;
+	t_paginacion->RBTP_RLTP = (registro*)p;				p += sizeof(registro) * np;
+	t_paginacion->desplazamientoPMT = (int*)p;			p += sizeof(int) * np;
+	t_paginacion->PMT = (int*)p;
+	t_paginacion->numMarcos = 0;
+	t_paginacion->invertida = NULL;
+	t_paginacion->anclas = NULL;
+	t_paginacion->numNiveles = 0;
+	t_paginacion->raices = NULL;
+	t_paginacion->radix = NULL;
+	t_paginacion->numRadix = 0;
+	t_paginacion->regiones = NULL;
+	t_paginacion->numRegiones = 0;
+	t_paginacion->contadores = NULL;
+	
+	if (!tablaValida(t_segmentacion->RBTS_RLTS, t_segmentacion->desplazamientoSDT, np, c.numSegmentos) ||
+		!tablaValida(t_paginacion->RBTP_RLTP, t_paginacion->desplazamientoPMT, np, c.numEntradas)){
+		errorImagen(salida, "Error. Las tablas de la imagen no son validas.");
+		cerrarImagen(t_imagen);
+		return -1;
+	}
+	
+	// La tabla invertida se construye en memoria a partir de la PMT de la imagen
+	if (c.tipo == 2 && construirInvertida(t_paginacion, np, salida) != 1){
+		errorImagen(salida, "Error. No ha sido posible construir la tabla de paginas invertida de la imagen.");
+		cerrarImagen(t_imagen);
+		return -1;
+	}
+	
+	return 1;
+}
+
+void cerrarImagen(imagen *t_imagen){
+#ifdef _WIN32
+	free(t_imagen->datos);
+#else
+	if (t_imagen->proyectada){
+		munmap(t_imagen->datos, t_imagen->longitud);
+	}
+#endif
+	t_imagen->datos = NULL;
+}
+
+// Libera los datos, tanto si se han leido del fichero de texto como de una imagen
+void liberarModelo(imagen *t_imagen, registro *t_registros, paginacion *t_paginacion, segmentacion *t_segmentacion){
+	if (t_imagen->datos != NULL){
+		cerrarImagen(t_imagen);
+		liberarTablasPaginas(t_paginacion);
+	}
+	else{
+		liberarDatos(t_registros, t_paginacion, t_segmentacion);
+	}
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funciones que traducen una direccion logica a fisica
+//*			 de un proceso con cada uno de los metodos.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Aplican las mismas comprobaciones que traducirDirecciones(), pero sin
+//*		mostrar nada por pantalla: devuelven TRAD_OK y la direccion fisica en
+//*		dFisica, o el codigo TRAD_* del error encontrado.
+//*		Las estructuras se reciben por referencia para no copiar las tablas
+//*		en cada traduccion. Con la segmentacion paginada (opcion "-sp"),
+//*		traducirSegmento() traduce con traducirSegmentoPaginado().
+//*
+//*************************************************************
+int traducirBaseLimite(const registro *particion, const direccion *d, int *dFisica){
+	if (d->formato != 1){
+		return TRAD_FORMATO;
+	}
+	
+	if (d->dLogica < 0 || d->dLogica > particion->limite){
+		return TRAD_DIRECCION;
+	}
+	
+	*dFisica = particion->base + d->dLogica;
+	return TRAD_OK;
+}
+
+int traducirSegmento(const segmentacion *t_segmentacion, int proceso, const direccion *d, int *dFisica){
+	const registro *rangoSDT = &t_segmentacion->RBTS_RLTS[proceso];
+	const registro *segmento;
+	
+	if (t_segmentacion->paginada){
+		return traducirSegmentoPaginado(t_segmentacion, proceso, d, dFisica);
+	}
+	
+	if (d->formato != 2){
+		return TRAD_FORMATO;
+	}
+	
+	if (d->nPag_Seg < 0 || d->nPag_Seg > rangoSDT->limite){
+		return TRAD_SEGMENTO;
+	}
+	
+	segmento = &t_segmentacion->SDT[t_segmentacion->desplazamientoSDT[proceso] + d->nPag_Seg];
+	if (d->nInstruccion < 0 || d->nInstruccion > segmento->limite){
+		return TRAD_INSTRUCCION;
+	}
+	
+	*dFisica = segmento->base + d->nInstruccion;
+	return TRAD_OK;
+}
+
+int traducirPagina(const paginacion *t_paginacion, int proceso, const direccion *d, int *dFisica){
+	int estado, nPagina, nInstruccion, marco;
+	
+	estado = separarPagina(t_paginacion, proceso, d, &nPagina, &nInstruccion);
+	if (estado != TRAD_OK){
+		return estado;
+	}
+	
+	marco = buscarMarco(t_paginacion, proceso, nPagina);
+	
+	if (marco < 0){
+		return TRAD_MARCO;
+	}
+	
+	*dFisica = marco * t_paginacion->tamano + nInstruccion;
+	return TRAD_OK;
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funcion que separa una direccion logica en numero de pagina
+//*			 y desplazamiento, comprobando que existen en el proceso.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Con el formato de un valor divide la direccion entre el tamano
+//*		de pagina (con partirDireccion()); con el de dos valores los toma
+//*		directamente.
+//*		Devuelve TRAD_OK, TRAD_PAGINA o TRAD_INSTRUCCION.
+//*
+//*************************************************************
+int separarPagina(const paginacion *t_paginacion, int proceso, const direccion *d, int *nPagina, int *nInstruccion){
+	// Si el formato es de un valor, lo convertimos al formato de dos valores.
+	if (d->formato == 1){
+		partirDireccion(t_paginacion, d->dLogica, nPagina, nInstruccion);
+	}
+	else{
+		*nPagina = d->nPag_Seg;
+		*nInstruccion = d->nInstruccion;
+	}
+	
+	if (*nPagina < 0 || *nPagina > t_paginacion->RBTP_RLTP[proceso].limite){
+		return TRAD_PAGINA;
+	}
+	
+	if (*nInstruccion < 0 || *nInstruccion >= t_paginacion->tamano){
+		return TRAD_INSTRUCCION;
+	}
+	
+	return TRAD_OK;
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funciones que separan una direccion de un valor en pagina y
+//*			 desplazamiento sin dividir si el tamano es potencia de dos.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		bitsPotencia() se calcula al cargar los datos: si el tamano de
+//*		pagina es 2^bits devuelve bits, y si no -1.
+//*		Con un tamano 2^bits la pagina es la direccion desplazada bits
+//*		posiciones a la derecha y el desplazamiento sus bits bajos
+//*		(mascara tamano - 1). Las direcciones negativas se dividen siempre,
+//*		porque la division redondea hacia cero y el desplazamiento hacia
+//*		abajo, y el error que se muestra debe ser el mismo.
+//*
+//*************************************************************
+static int bitsPotencia(int tamano){
+	int bits = 0;
+	
+	if (tamano <= 0 || (tamano & (tamano - 1)) != 0){
+		return -1;
+	}
+	
+	while ((1 << bits) < tamano){
+		bits++;
+	}
+	
+	return bits;
+}
+
+void partirDireccion(const paginacion *t_paginacion, int dLogica, int *nPagina, int *nInstruccion){
+	if (t_paginacion->bitsPagina >= 0 && dLogica >= 0){
+		*nPagina = dLogica >> t_paginacion->bitsPagina;
+		*nInstruccion = dLogica & (t_paginacion->tamano - 1);
+	}
+	else{
+		*nPagina = dLogica / t_paginacion->tamano;
+		*nInstruccion = dLogica % t_paginacion->tamano;
+	}
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funcion que traduce con paginacion un array de direcciones
+//*			 logicas (formato de un valor) de un mismo proceso.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Obtiene el mismo resultado que traducirPagina() para cada direccion,
+//*		escribiendo la direccion fisica en dFisicas (-1 si hay error) y el
+//*		estado (TRAD_OK, TRAD_PAGINA, TRAD_INSTRUCCION o TRAD_MARCO) en
+//*		estados, pero procesando varias direcciones por instruccion:
+//*			- AVX2: 8 direcciones. La division entre el tamano de pagina se
+//*			  hace multiplicando en doble precision por su inverso y
+//*			  corrigiendo el cociente en +-1 con el resto, la comprobacion del
+//*			  limite con comparaciones, la lectura de la PMT con una carga
+//*			  indexada (gather) enmascarada y marco * tamano + desplazamiento
+//*			  con multiplicacion y suma de enteros.
+//*			- SSE4.1: igual con 4 direcciones, leyendo la PMT una a una.
+//*			- Escalar: una a una, en procesadores sin estas extensiones o
+//*			  compiladores distintos de GCC/Clang.
+//*		La version se elige en tiempo de ejecucion segun el procesador.
+//*		Si el tamano de pagina es potencia de dos, la division y el resto se
+//*		sustituyen por un desplazamiento y una mascara, y el producto por
+//*		otro desplazamiento. La version escalar se especializa con la macro
+//*		definirPaginasPotencia para 256, 4096 y 65536, con los bits como
+//*		constante, y hay otra para el resto de potencias de dos.
+//*		Los grupos con alguna direccion negativa, y las ultimas direcciones
+//*		que no completan un grupo, se traducen con la version escalar.
+//*		Con la tabla invertida o la multinivel no hay PMT que leer de una
+//*		vez: cada pagina se busca en la tabla, una a una.
+//*
+//*************************************************************
+static void traducirPaginasEscalar(const paginacion *t_paginacion, int proceso, const int dLogicas[], int n, int dFisicas[], unsigned char estados[]){
+	const int *PMT = t_paginacion->PMT + t_paginacion->desplazamientoPMT[proceso];
+	int limite = t_paginacion->RBTP_RLTP[proceso].limite, tamano = t_paginacion->tamano;
+	int i, nPagina, nInstruccion, marco;
+	
+	for (i = 0 ; i < n ; i++){
+		nPagina = dLogicas[i] / tamano;
+		nInstruccion = dLogicas[i] % tamano;
+		dFisicas[i] = -1;
+		
+		if (nPagina < 0 || nPagina > limite){
+			estados[i] = TRAD_PAGINA;
+		}
+		else if (nInstruccion < 0){
+			estados[i] = TRAD_INSTRUCCION;
+		}
+		else if ((marco = PMT[nPagina]) < 0){
+			estados[i] = TRAD_MARCO;
+		}
+		else{
+			estados[i] = TRAD_OK;
+			dFisicas[i] = marco * tamano + nInstruccion;
+		}
+	}
+}
+
+// Version para la tabla invertida y la multinivel: el marco de cada pagina se busca en la tabla
+static void traducirPaginasBusqueda(const paginacion *t_paginacion, int proceso, const int dLogicas[], int n, int dFisicas[], unsigned char estados[]){
+	int limite = t_paginacion->RBTP_RLTP[proceso].limite;
+	int i, nPagina, nInstruccion, marco;
+	
+	for (i = 0 ; i < n ; i++){
+		partirDireccion(t_paginacion, dLogicas[i], &nPagina, &nInstruccion);
+		dFisicas[i] = -1;
+		
+		if (nPagina < 0 || nPagina > limite){
+			estados[i] = TRAD_PAGINA;
+		}
+		else if (nInstruccion < 0){
+			estados[i] = TRAD_INSTRUCCION;
+		}
+		else if ((marco = buscarMarco(t_paginacion, proceso, nPagina)) < 0){
+			estados[i] = TRAD_MARCO;
+		}
+		else{
+			estados[i] = TRAD_OK;
+			dFisicas[i] = marco * t_paginacion->tamano + nInstruccion;
+		}
+	}
+}
+
+// Version escalar para un tamano de pagina de 2^(expresion "bits") posiciones
+#define definirPaginasPotencia(nombre, bits) \
+static void nombre(const paginacion *t_paginacion, int proceso, const int dLogicas[], int n, int dFisicas[], unsigned char estados[]){ \
+	const int *PMT = t_paginacion->PMT + t_paginacion->desplazamientoPMT[proceso]; \
+	int limite = t_paginacion->RBTP_RLTP[proceso].limite, desplazamiento = (bits), mascara = (1 << desplazamiento) - 1; \
+	int i, nPagina, marco; \
+	\
+	for (i = 0 ; i < n ; i++){ \
+		if (dLogicas[i] < 0){ \
+			traducirPaginasEscalar(t_paginacion, proceso, dLogicas + i, 1, dFisicas + i, estados + i); \
+			continue; \
+		} \
+		\
+		nPagina = dLogicas[i] >> desplazamiento; \
+		dFisicas[i] = -1; \
+		\
+		if (nPagina > limite){ \
+			estados[i] = TRAD_PAGINA; \
+		} \
+		else if ((marco = PMT[nPagina]) < 0){ \
+			estados[i] = TRAD_MARCO; \
+		} \
+		else{ \
+			estados[i] = TRAD_OK; \
+			dFisicas[i] = (int)((unsigned int)marco << desplazamiento) | (dLogicas[i] & mascara); \
+		} \
+	} \
+}
+
+definirPaginasPotencia(traducirPaginas256, 8)
+definirPaginasPotencia(traducirPaginas4096, 12)
+definirPaginasPotencia(traducirPaginas65536, 16)
+definirPaginasPotencia(traducirPaginasPotencia, t_paginacion->bitsPagina)
+
+#if SIMD_X86
+
+__attribute__((target("avx2")))
+static void traducirPaginasAVX2(const paginacion *t_paginacion, int proceso, const int dLogicas[], int n, int dFisicas[], unsigned char estados[]){
+	const int *PMT = t_paginacion->PMT + t_paginacion->desplazamientoPMT[proceso];
+	const __m256d inverso = _mm256_set1_pd(1.0 / t_paginacion->tamano);
+	const __m256i tamano = _mm256_set1_epi32(t_paginacion->tamano);
+	const __m256i limite = _mm256_set1_epi32(t_paginacion->RBTP_RLTP[proceso].limite);
+	const __m256i cero = _mm256_setzero_si256(), todos = _mm256_set1_epi32(-1);
+	const __m256i codigoPagina = _mm256_set1_epi32(TRAD_PAGINA), codigoMarco = _mm256_set1_epi32(TRAD_MARCO);
+	const __m256i mascara = _mm256_set1_epi32(t_paginacion->tamano - 1);
+	const __m128i bits = _mm_cvtsi32_si128(t_paginacion->bitsPagina);
+	const int potencia = t_paginacion->bitsPagina >= 0;
+	__m256i d, q, r, ajuste, fuera, marco, sinMarco, error, fisica, estado;
+	__m128i estado16;
+	int i;
+	
+	for (i = 0 ; i + 8 <= n ; i += 8){
+		d = _mm256_loadu_si256((const __m256i*)(dLogicas + i));
+		if (_mm256_movemask_ps(_mm256_castsi256_ps(d)) != 0){
+			traducirPaginasEscalar(t_paginacion, proceso, dLogicas + i, 8, dFisicas + i, estados + i);
+			continue;
+		}
+		
+		if (potencia){
+			q = _mm256_srl_epi32(d, bits);
+			r = _mm256_and_si256(d, mascara);
+		}
+		else{
+			// Cociente aproximado en doble precision y correccion exacta con el resto
+			q = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(d)), inverso))),
+										_mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(d, 1)), inverso)), 1);
+			r = _mm256_sub_epi32(d, _mm256_mullo_epi32(q, tamano));
+			ajuste = _mm256_cmpgt_epi32(cero, r);
+			q = _mm256_add_epi32(q, ajuste);
+			r = _mm256_add_epi32(r, _mm256_and_si256(ajuste, tamano));
+			ajuste = _mm256_cmpgt_epi32(r, mascara);
+			q = _mm256_sub_epi32(q, ajuste);
+			r = _mm256_sub_epi32(r, _mm256_and_si256(ajuste, tamano));
+		}
+		
+		// Limite de la PMT y lectura de los marcos de las paginas validas
+		fuera = _mm256_cmpgt_epi32(q, limite);
+		marco = _mm256_mask_i32gather_epi32(todos, PMT, q, _mm256_xor_si256(fuera, todos), 4);
+		sinMarco = _mm256_andnot_si256(fuera, _mm256_cmpgt_epi32(cero, marco));
+		error = _mm256_or_si256(fuera, sinMarco);
+		
+		fisica = _mm256_add_epi32(potencia ? _mm256_sll_epi32(marco, bits) : _mm256_mullo_epi32(marco, tamano), r);
+		fisica = _mm256_or_si256(_mm256_andnot_si256(error, fisica), error);
+		estado = _mm256_or_si256(_mm256_and_si256(fuera, codigoPagina), _mm256_and_si256(sinMarco, codigoMarco));
+		
+		_mm256_storeu_si256((__m256i*)(dFisicas + i), fisica);
+		estado16 = _mm_packs_epi32(_mm256_castsi256_si128(estado), _mm256_extracti128_si256(estado, 1));
+		_mm_storel_epi64((__m128i*)(estados + i), _mm_packus_epi16(estado16, estado16));
+	}
+	
+	traducirPaginasEscalar(t_paginacion, proceso, dLogicas + i, n - i, dFisicas + i, estados + i);
+}
+
+__attribute__((target("sse4.1")))
+static void traducirPaginasSSE(const paginacion *t_paginacion, int proceso, const int dLogicas[], int n, int dFisicas[], unsigned char estados[]){
+	const int *PMT = t_paginacion->PMT + t_paginacion->desplazamientoPMT[proceso];
+	const __m128d inverso = _mm_set1_pd(1.0 / t_paginacion->tamano);
+	const __m128i tamano = _mm_set1_epi32(t_paginacion->tamano);
+	const __m128i limite = _mm_set1_epi32(t_paginacion->RBTP_RLTP[proceso].limite);
+	const __m128i cero = _mm_setzero_si128();
+	const __m128i codigoPagina = _mm_set1_epi32(TRAD_PAGINA), codigoMarco = _mm_set1_epi32(TRAD_MARCO);
+	const __m128i mascara = _mm_set1_epi32(t_paginacion->tamano - 1);
+	const __m128i bits = _mm_cvtsi32_si128(t_paginacion->bitsPagina);
+	const int potencia = t_paginacion->bitsPagina >= 0;
+	__m128i d, q, r, ajuste, fuera, marco, sinMarco, error, fisica, estado;
+	int i, paginas[4], empaquetado;
+	
+	// Las paginas fuera del limite leen la entrada 0, que debe existir
+	if (t_paginacion->RBTP_RLTP[proceso].limite < 0){
+		traducirPaginasEscalar(t_paginacion, proceso, dLogicas, n, dFisicas, estados);
+		return;
+	}
+	
+	for (i = 0 ; i + 4 <= n ; i += 4){
+		d = _mm_loadu_si128((const __m128i*)(dLogicas + i));
+		if (_mm_movemask_ps(_mm_castsi128_ps(d)) != 0){
+			traducirPaginasEscalar(t_paginacion, proceso, dLogicas + i, 4, dFisicas + i, estados + i);
+			continue;
+		}
+		
+		if (potencia){
+			q = _mm_srl_epi32(d, bits);
+			r = _mm_and_si128(d, mascara);
+		}
+		else{
+			q = _mm_unpacklo_epi64(_mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(d), inverso)),
+								   _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(d, 8)), inverso)));
+			r = _mm_sub_epi32(d, _mm_mullo_epi32(q, tamano));
+			ajuste = _mm_cmplt_epi32(r, cero);
+			q = _mm_add_epi32(q, ajuste);
+			r = _mm_add_epi32(r, _mm_and_si128(ajuste, tamano));
+			ajuste = _mm_cmpgt_epi32(r, mascara);
+			q = _mm_sub_epi32(q, ajuste);
+			r = _mm_sub_epi32(r, _mm_and_si128(ajuste, tamano));
+		}
+		
+		// Sin gather: los marcos de las paginas validas se leen uno a uno
+		fuera = _mm_cmpgt_epi32(q, limite);
+		_mm_storeu_si128((__m128i*)paginas, _mm_andnot_si128(fuera, q));
+		marco = _mm_setr_epi32(PMT[paginas[0]], PMT[paginas[1]], PMT[paginas[2]], PMT[paginas[3]]);
+		sinMarco = _mm_andnot_si128(fuera, _mm_cmplt_epi32(marco, cero));
+		error = _mm_or_si128(fuera, sinMarco);
+		
+		fisica = _mm_add_epi32(potencia ? _mm_sll_epi32(marco, bits) : _mm_mullo_epi32(marco, tamano), r);
+		fisica = _mm_or_si128(_mm_andnot_si128(error, fisica), error);
+		estado = _mm_or_si128(_mm_and_si128(fuera, codigoPagina), _mm_and_si128(sinMarco, codigoMarco));
+		
+		_mm_storeu_si128((__m128i*)(dFisicas + i), fisica);
+		estado = _mm_packs_epi32(estado, estado);
+		empaquetado = _mm_cvtsi128_si32(_mm_packus_epi16(estado, estado));
+		memcpy(estados + i, &empaquetado, 4);
+	}
+	
+	traducirPaginasEscalar(t_paginacion, proceso, dLogicas + i, n - i, dFisicas + i, estados + i);
+}
+
+#endif
+
+void traducirPaginasLote(const paginacion *t_paginacion, int proceso, const int dLogicas[], int n, int dFisicas[], unsigned char estados[]){
+	if (t_paginacion->tipo >= 2){
+		traducirPaginasBusqueda(t_paginacion, proceso, dLogicas, n, dFisicas, estados);
+		return;
+	}
+#if SIMD_X86
+	if (__builtin_cpu_supports("avx2")){
+		traducirPaginasAVX2(t_paginacion, proceso, dLogicas, n, dFisicas, estados);
+		return;
+	}
+	if (__builtin_cpu_supports("sse4.1")){
+		traducirPaginasSSE(t_paginacion, proceso, dLogicas, n, dFisicas, estados);
+		return;
+	}
+#endif
+	switch (t_paginacion->bitsPagina){
+		case -1:
+			traducirPaginasEscalar(t_paginacion, proceso, dLogicas, n, dFisicas, estados);
+			break;
+		case 8:
+			traducirPaginas256(t_paginacion, proceso, dLogicas, n, dFisicas, estados);
+			break;
+		case 12:
+			traducirPaginas4096(t_paginacion, proceso, dLogicas, n, dFisicas, estados);
+			break;
+		case 16:
+			traducirPaginas65536(t_paginacion, proceso, dLogicas, n, dFisicas, estados);
+			break;
+		default:
+			traducirPaginasPotencia(t_paginacion, proceso, dLogicas, n, dFisicas, estados);
+	}
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funciones de la segmentacion paginada.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Cada entrada de la SDT apunta a la tabla de paginas de su segmento
+//*		en lugar de a una particion contigua. La direccion (segmento,
+//*		desplazamiento) se comprueba con el RLTS y con el limite del
+//*		segmento; despues el desplazamiento se parte en pagina y
+//*		desplazamiento dentro de la pagina, y la pagina se comprueba con el
+//*		limite de la tabla del segmento antes de leer su marco.
+//*		leerTablasSegmentos() lee la novena linea del fichero: los marcos de
+//*		las paginas de cada segmento, en el orden de la SDT. Un segmento de
+//*		limite L tiene L / tamano + 1 paginas.
+//*		Devuelve 1, 0 si los valores no son correctos o -1 si no hay
+//*		memoria suficiente.
+//*		traducirSegmentoPaginado() traduce una direccion y, si la
+//*		segmentacion tiene contadores, anota las referencias a memoria de
+//*		las tablas: la entrada de la SDT y la de la tabla de paginas del
+//*		segmento, una mas que con segmentacion pura. El RLTS esta en un
+//*		registro del procesador y no cuenta.
+//*		traducirSegmentosLote() obtiene el mismo resultado para varias
+//*		direcciones de dos valores de un proceso. Con AVX2 traduce 8 a la
+//*		vez: la division entre el tamano de pagina es la de la paginacion
+//*		por lotes, y la SDT, la tabla del segmento y los marcos se leen con
+//*		cargas indexadas (gather) enmascaradas, solo en las direcciones que
+//*		han superado las comprobaciones anteriores. Los segmentos y
+//*		desplazamientos negativos son errores de esas comprobaciones, asi
+//*		que, a diferencia de la paginacion, no hace falta traducirlos con la
+//*		version escalar (llamarla desde el codigo AVX2 es lento). Sin AVX2,
+//*		una a una.
+//*		mostrarEstadisticasSegmentacion() muestra la memoria de las tablas
+//*		y las referencias a memoria por traduccion.
+//*
+//*************************************************************
+static int leerTablasSegmentos(lector *l, segmentacion *t_segmentacion, int tamano, const char *mensaje){
+	int i;
+	long long total = 0;
+	
+	t_segmentacion->tamanoPagina = tamano;
+	t_segmentacion->bitsPagina = bitsPotencia(tamano);
+	t_segmentacion->tablasSegmentos = (registro*)malloc(sizeof(registro) * (t_segmentacion->numSegmentos + 1));
+	t_segmentacion->contadores = (contadoresTabla*)calloc(1, sizeof(contadoresTabla));
+	if (t_segmentacion->tablasSegmentos == NULL || t_segmentacion->contadores == NULL){
+		return -1;
+	}
+	
+	// Posicion y ultima pagina de la tabla de cada segmento
+	for (i = 0 ; i < t_segmentacion->numSegmentos ; i++){
+		t_segmentacion->tablasSegmentos[i].base = (int)total;
+		t_segmentacion->tablasSegmentos[i].limite = (t_segmentacion->SDT[i].limite < 0) ? -1 : t_segmentacion->SDT[i].limite / tamano;
+		total += t_segmentacion->tablasSegmentos[i].limite + 1;
+		if (total > INT_MAX){
+			return errorFormato(l, mensaje);
+		}
+	}
+	
+	t_segmentacion->numPaginasSegmentos = (int)total;
+	t_segmentacion->marcosSegmentos = (int*)malloc(sizeof(int) * (total + 1));
+	if (t_segmentacion->marcosSegmentos == NULL){
+		return -1;
+	}
+	
+	return leerMarcos(l, t_segmentacion->marcosSegmentos, (int)total, 1, mensaje);
+}
+
+int traducirSegmentoPaginado(const segmentacion *t_segmentacion, int proceso, const direccion *d, int *dFisica){
+	const registro *tabla;
+	int segmento, nPagina, nInstruccion, marco, estado, referencias = 0;
+	
+	if (d->formato != 2){
+		return TRAD_FORMATO;
+	}
+	
+	if (d->nPag_Seg < 0 || d->nPag_Seg > t_segmentacion->RBTS_RLTS[proceso].limite){
+		estado = TRAD_SEGMENTO;
+	}
+	else{
+		// Primera referencia: la entrada del segmento en la SDT
+		segmento = t_segmentacion->desplazamientoSDT[proceso] + d->nPag_Seg;
+		referencias = 1;
+		
+		if (d->nInstruccion < 0 || d->nInstruccion > t_segmentacion->SDT[segmento].limite){
+			estado = TRAD_INSTRUCCION;
+		}
+		else{
+			nPagina = d->nInstruccion / t_segmentacion->tamanoPagina;
+			nInstruccion = d->nInstruccion % t_segmentacion->tamanoPagina;
+			tabla = &t_segmentacion->tablasSegmentos[segmento];
+			
+			if (nPagina > tabla->limite){
+				estado = TRAD_PAGINA;
+			}
+			else{
+				// Segunda referencia: la entrada de la pagina en la tabla del segmento
+				referencias = 2;
+				marco = t_segmentacion->marcosSegmentos[tabla->base + nPagina];
+				
+				if (marco < 0){
+					estado = TRAD_MARCO;
+				}
+				else{
+					estado = TRAD_OK;
+					*dFisica = marco * t_segmentacion->tamanoPagina + nInstruccion;
+				}
+			}
+		}
+	}
+	
+	if (t_segmentacion->contadores != NULL){
+		t_segmentacion->contadores->busquedas++;
+		t_segmentacion->contadores->accesos += referencias;
+	}
+	
+	return estado;
+}
+
+static void traducirSegmentosEscalar(const segmentacion *t_segmentacion, int proceso, const int segmentos[], const int desplazamientos[], int n, int dFisicas[], unsigned char estados[]){
+	direccion d;
+	int i;
+	
+	d.formato = 2;
+	d.proceso = proceso;
+	for (i = 0 ; i < n ; i++){
+		d.nPag_Seg = segmentos[i];
+		d.nInstruccion = desplazamientos[i];
+		dFisicas[i] = -1;
+		estados[i] = (unsigned char)traducirSegmentoPaginado(t_segmentacion, proceso, &d, &dFisicas[i]);
+	}
+}
+
+#if SIMD_X86
+
+__attribute__((target("avx2")))
+static void traducirSegmentosAVX2(const segmentacion *t_segmentacion, int proceso, const int segmentos[], const int desplazamientos[], int n, int dFisicas[], unsigned char estados[]){
+	const int *SDT = (const int*)(t_segmentacion->SDT + t_segmentacion->desplazamientoSDT[proceso]);
+	const int *tablas = (const int*)(t_segmentacion->tablasSegmentos + t_segmentacion->desplazamientoSDT[proceso]);
+	const __m256d inverso = _mm256_set1_pd(1.0 / t_segmentacion->tamanoPagina);
+	const __m256i tamano = _mm256_set1_epi32(t_segmentacion->tamanoPagina);
+	const __m256i mascara = _mm256_set1_epi32(t_segmentacion->tamanoPagina - 1);
+	const __m256i limiteSDT = _mm256_set1_epi32(t_segmentacion->RBTS_RLTS[proceso].limite);
+	const __m256i cero = _mm256_setzero_si256(), todos = _mm256_set1_epi32(-1);
+	const __m256i codigoSegmento = _mm256_set1_epi32(TRAD_SEGMENTO), codigoInstruccion = _mm256_set1_epi32(TRAD_INSTRUCCION);
+	const __m256i codigoPagina = _mm256_set1_epi32(TRAD_PAGINA), codigoMarco = _mm256_set1_epi32(TRAD_MARCO);
+	const __m128i bits = _mm_cvtsi32_si128(t_segmentacion->bitsPagina);
+	const int potencia = t_segmentacion->bitsPagina >= 0;
+	__m256i s, d, q, r, ajuste, indice, leeSDT, leeTabla, leeMarco, limiteSegmento, base, limiteTabla, marco;
+	__m256i fueraSegmento, fueraInstruccion, fueraPagina, sinMarco, error, fisica, estado;
+	__m128i estado16;
+	long long referencias = 0;
+	int i;
+	
+	for (i = 0 ; i + 8 <= n ; i += 8){
+		s = _mm256_loadu_si256((const __m256i*)(segmentos + i));
+		d = _mm256_loadu_si256((const __m256i*)(desplazamientos + i));
+		
+		// El cociente de los desplazamientos negativos no se usa: son errores
+		if (potencia){
+			q = _mm256_srl_epi32(d, bits);
+			r = _mm256_and_si256(d, mascara);
+		}
+		else{
+			q = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(d)), inverso))),
+										_mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(d, 1)), inverso)), 1);
+			r = _mm256_sub_epi32(d, _mm256_mullo_epi32(q, tamano));
+			ajuste = _mm256_cmpgt_epi32(cero, r);
+			q = _mm256_add_epi32(q, ajuste);
+			r = _mm256_add_epi32(r, _mm256_and_si256(ajuste, tamano));
+			ajuste = _mm256_cmpgt_epi32(r, mascara);
+			q = _mm256_sub_epi32(q, ajuste);
+			r = _mm256_sub_epi32(r, _mm256_and_si256(ajuste, tamano));
+		}
+		
+		// RLTS y limite del segmento en la SDT (dos enteros por entrada)
+		fueraSegmento = _mm256_or_si256(_mm256_cmpgt_epi32(cero, s), _mm256_cmpgt_epi32(s, limiteSDT));
+		leeSDT = _mm256_xor_si256(fueraSegmento, todos);
+		indice = _mm256_slli_epi32(s, 1);
+		limiteSegmento = _mm256_mask_i32gather_epi32(cero, SDT + 1, indice, leeSDT, 4);
+		fueraInstruccion = _mm256_and_si256(leeSDT, _mm256_or_si256(_mm256_cmpgt_epi32(cero, d), _mm256_cmpgt_epi32(d, limiteSegmento)));
+		
+		// Limite de la tabla de paginas del segmento y lectura del marco
+		leeTabla = _mm256_andnot_si256(fueraInstruccion, leeSDT);
+		base = _mm256_mask_i32gather_epi32(cero, tablas, indice, leeTabla, 4);
+		limiteTabla = _mm256_mask_i32gather_epi32(cero, tablas + 1, indice, leeTabla, 4);
+		fueraPagina = _mm256_and_si256(leeTabla, _mm256_cmpgt_epi32(q, limiteTabla));
+		leeMarco = _mm256_andnot_si256(fueraPagina, leeTabla);
+		marco = _mm256_mask_i32gather_epi32(todos, t_segmentacion->marcosSegmentos, _mm256_add_epi32(base, q), leeMarco, 4);
+		sinMarco = _mm256_and_si256(leeMarco, _mm256_cmpgt_epi32(cero, marco));
+		error = _mm256_or_si256(_mm256_xor_si256(leeMarco, todos), sinMarco);
+		
+		fisica = _mm256_add_epi32(potencia ? _mm256_sll_epi32(marco, bits) : _mm256_mullo_epi32(marco, tamano), r);
+		fisica = _mm256_or_si256(_mm256_andnot_si256(error, fisica), error);
+		estado = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(fueraSegmento, codigoSegmento), _mm256_and_si256(fueraInstruccion, codigoInstruccion)),
+								 _mm256_or_si256(_mm256_and_si256(fueraPagina, codigoPagina), _mm256_and_si256(sinMarco, codigoMarco)));
+		
+		_mm256_storeu_si256((__m256i*)(dFisicas + i), fisica);
+		estado16 = _mm_packs_epi32(_mm256_castsi256_si128(estado), _mm256_extracti128_si256(estado, 1));
+		_mm_storel_epi64((__m128i*)(estados + i), _mm_packus_epi16(estado16, estado16));
+		
+		referencias += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(leeSDT))) + __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(leeMarco)));
+	}
+	
+	// Las ultimas direcciones se cuentan en traducirSegmentoPaginado()
+	if (t_segmentacion->contadores != NULL){
+		t_segmentacion->contadores->busquedas += i;
+		t_segmentacion->contadores->accesos += referencias;
+	}
+	
+	traducirSegmentosEscalar(t_segmentacion, proceso, segmentos + i, desplazamientos + i, n - i, dFisicas + i, estados + i);
+}
+
+#endif
+
+void traducirSegmentosLote(const segmentacion *t_segmentacion, int proceso, const int segmentos[], const int desplazamientos[], int n, int dFisicas[], unsigned char estados[]){
+#if SIMD_X86
+	if (__builtin_cpu_supports("avx2")){
+		traducirSegmentosAVX2(t_segmentacion, proceso, segmentos, desplazamientos, n, dFisicas, estados);
+		return;
+	}
+#endif
+	traducirSegmentosEscalar(t_segmentacion, proceso, segmentos, desplazamientos, n, dFisicas, estados);
+}
+
+void mostrarEstadisticasSegmentacion(const segmentacion *t_segmentacion, FILE *salida){
+	const contadoresTabla *c = t_segmentacion->contadores;
+	
+	if (!t_segmentacion->paginada || c == NULL){
+		return;
+	}
+	
+	fprintf (salida, "Segmentacion paginada: %d segmentos, %d paginas en sus tablas\n", t_segmentacion->numSegmentos, t_segmentacion->numPaginasSegmentos);
+	if (c->busquedas > 0){
+		fprintf (salida, "\tTraducciones: %lld\tReferencias a memoria en las tablas: %lld (%.2f por traduccion, frente a una sola lectura de la SDT sin paginar)\n",
+				c->busquedas, c->accesos, (double)c->accesos / c->busquedas);
+	}
+	fprintf (salida, "\tMemoria: %zu bytes (la SDT con la tabla de cada segmento y las entradas de las tablas)\n",
+			sizeof(registro) * 2 * (size_t)t_segmentacion->numSegmentos + sizeof(int) * (size_t)t_segmentacion->numPaginasSegmentos);
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funciones de la tabla de paginas invertida (tipo 2).
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		La tabla invertida tiene una entrada por marco fisico con el
+//*		proceso y la pagina que lo ocupan, de modo que su tamano depende
+//*		de la memoria fisica y no de la suma de los espacios de direcciones
+//*		de los procesos. Para no recorrerla entera en cada traduccion, una
+//*		tabla de anclas (potencia de dos, con al menos tantas anclas como
+//*		marcos) guarda por cada valor del hash de (proceso, pagina) el
+//*		primer marco de su cadena, y cada entrada el siguiente marco de la
+//*		misma cadena.
+//*		construirInvertida() la crea a partir de la PMT leida del fichero
+//*		(o de la imagen) y libera la PMT. Un marco solo puede pertenecer a
+//*		una pagina, asi que los marcos repetidos son un error aunque se
+//*		permita compartir memoria. Devuelve 1, 0 si hay marcos repetidos
+//*		o -1 si no hay memoria suficiente.
+//*		buscarMarco() devuelve el marco de una pagina existente del proceso
+//*		(o -1 si no tiene) con cualquier tipo de tabla. Con la invertida
+//*		recorre la cadena de su ancla y, si la paginacion tiene contadores,
+//*		anota la busqueda y las entradas comparadas.
+//*		reconstruirPMT() obtiene la PMT equivalente, para la imagen binaria.
+//*		mostrarEstadisticasInvertida() muestra la ocupacion, la longitud
+//*		de las cadenas, el coste medio de las busquedas y la memoria de la
+//*		tabla frente a la de la PMT equivalente.
+//*
+//*************************************************************
+
+// Hash de (proceso, pagina) para la tabla de anclas
+static unsigned int hashPagina(int proceso, int nPagina){
+	unsigned int h = (unsigned int)proceso * 0x9E3779B1u ^ (unsigned int)nPagina * 0x85EBCA6Bu;
+	
+	return h ^ (h >> 15);
+}
+
+int buscarMarco(const paginacion *t_paginacion, int proceso, int nPagina){
+	const entradaInvertida *entrada;
+	int marco, recorridas = 0;
+	
+	if (t_paginacion->tipo == 3){
+		return buscarRadix(t_paginacion, proceso, nPagina);
+	}
+	if (t_paginacion->tipo != 2){
+		return t_paginacion->PMT[t_paginacion->desplazamientoPMT[proceso] + nPagina];
+	}
+	
+	marco = t_paginacion->anclas[hashPagina(proceso, nPagina) & t_paginacion->mascaraAnclas];
+	while (marco >= 0){
+		entrada = &t_paginacion->invertida[marco];
+		recorridas++;
+		if (entrada->proceso == proceso && entrada->pagina == nPagina){
+			break;
+		}
+		marco = entrada->siguiente;
+	}
+	
+	if (t_paginacion->contadores != NULL){
+		t_paginacion->contadores->busquedas++;
+		t_paginacion->contadores->accesos += recorridas;
+	}
+	
+	return marco;
+}
+
+static int construirInvertida(paginacion *t_paginacion, int numProcesos, FILE *salida){
+	entradaInvertida *invertida;
+	int *anclas;
+	contadoresTabla *contadores;
+	int i, j, marco, numAnclas, maxMarco = -1;
+	unsigned int h;
+	
+	for (i = 0 ; i < t_paginacion->numEntradas ; i++){
+		if (t_paginacion->PMT[i] > maxMarco){
+			maxMarco = t_paginacion->PMT[i];
+		}
+	}
+	
+	for (numAnclas = 1 ; numAnclas <= maxMarco && numAnclas < (1 << 30) ; numAnclas <<= 1);
+	
+	invertida = (entradaInvertida*)malloc(sizeof(entradaInvertida) * ((size_t)maxMarco + 1));
+	anclas = (int*)malloc(sizeof(int) * numAnclas);
+	contadores = (contadoresTabla*)calloc(1, sizeof(contadoresTabla));
+	if ((invertida == NULL && maxMarco >= 0) || anclas == NULL || contadores == NULL){
+		free(invertida);
+		free(anclas);
+		free(contadores);
+		return -1;
+	}
+	
+	for (marco = 0 ; marco <= maxMarco ; marco++){
+		invertida[marco].proceso = -1;
+	}
+	memset(anclas, -1, sizeof(int) * numAnclas);
+	
+	for (i = 0 ; i < numProcesos ; i++){
+		for (j = 0 ; j <= t_paginacion->RBTP_RLTP[i].limite ; j++){
+			marco = t_paginacion->PMT[t_paginacion->desplazamientoPMT[i] + j];
+			if (marco < 0){
+				continue;
+			}
+			
+			if (invertida[marco].proceso >= 0){
+				if (salida != NULL){
+					fprintf (salida, "Error. El marco %d esta asignado a la pagina %d del proceso %d y a la pagina %d del proceso %d.\n",
+							 marco, invertida[marco].pagina, invertida[marco].proceso, j, i);
+				}
+				free(invertida);
+				free(anclas);
+				free(contadores);
+				return 0;
+			}
+			
+			// La pagina se anade al principio de la cadena de su ancla
+			h = hashPagina(i, j) & (unsigned int)(numAnclas - 1);
+			invertida[marco].proceso = i;
+			invertida[marco].pagina = j;
+			invertida[marco].siguiente = anclas[h];
+			anclas[h] = marco;
+		}
+	}
+	
+	t_paginacion->numMarcos = maxMarco + 1;
+	t_paginacion->invertida = invertida;
+	t_paginacion->anclas = anclas;
+	t_paginacion->mascaraAnclas = numAnclas - 1;
+	t_paginacion->contadores = contadores;
+	t_paginacion->PMT = NULL;
+	
+	return 1;
+}
+
+// Libera la tabla invertida o multinivel, si la hay
+static void liberarTablasPaginas(paginacion *t_paginacion){
+	free(t_paginacion->invertida);
+	free(t_paginacion->anclas);
+	free(t_paginacion->raices);
+	free(t_paginacion->radix);
+	free(t_paginacion->regiones);
+	free(t_paginacion->contadores);
+	t_paginacion->invertida = NULL;
+	t_paginacion->anclas = NULL;
+	t_paginacion->raices = NULL;
+	t_paginacion->radix = NULL;
+	t_paginacion->regiones = NULL;
+	t_paginacion->contadores = NULL;
+}
+
+static int *reconstruirPMT(const paginacion *t_paginacion){
+	int *PMT = (int*)malloc(sizeof(int) * (t_paginacion->numEntradas + 1));
+	int marco;
+	
+	if (PMT == NULL){
+		return NULL;
+	}
+	
+	memset(PMT, -1, sizeof(int) * t_paginacion->numEntradas);
+	for (marco = 0 ; marco < t_paginacion->numMarcos ; marco++){
+		if (t_paginacion->invertida[marco].proceso >= 0){
+			PMT[t_paginacion->desplazamientoPMT[t_paginacion->invertida[marco].proceso] + t_paginacion->invertida[marco].pagina] = marco;
+		}
+	}
+	
+	return PMT;
+}
+
+// Memoria de las tablas de paginacion, en bytes
+size_t memoriaPaginacion(const paginacion *t_paginacion, int numProcesos){
+	size_t bytes = (sizeof(registro) + sizeof(int)) * (size_t)numProcesos;
+	
+	if (t_paginacion->tipo == 2){
+		return bytes + sizeof(entradaInvertida) * (size_t)t_paginacion->numMarcos + sizeof(int) * ((size_t)t_paginacion->mascaraAnclas + 1);
+	}
+	if (t_paginacion->tipo == 3){
+		return bytes + sizeof(int) * ((size_t)numProcesos + t_paginacion->numRadix);
+	}
+	return bytes + sizeof(int) * (size_t)t_paginacion->numEntradas;
+}
+
+static void mostrarEstadisticasInvertida(const paginacion *t_paginacion, int numProcesos, FILE *salida){
+	long long ocupados = 0, cadenas = 0, suma = 0, longitudes[5] = {0};
+	int i, marco, longitud, maxima = 0;
+	const contadoresTabla *c = t_paginacion->contadores;
+	
+	for (i = 0 ; i <= t_paginacion->mascaraAnclas ; i++){
+		for (longitud = 0, marco = t_paginacion->anclas[i] ; marco >= 0 ; marco = t_paginacion->invertida[marco].siguiente){
+			longitud++;
+		}
+		
+		longitudes[(longitud < 4) ? longitud : 4]++;
+		if (longitud > 0){
+			cadenas++;
+			ocupados += longitud;
+			suma += (long long)longitud * (longitud + 1) / 2;
+		}
+		if (longitud > maxima){
+			maxima = longitud;
+		}
+	}
+	
+	fprintf (salida, "Tabla invertida: %d marcos (%lld ocupados), %d anclas, %d paginas virtuales\n",
+			t_paginacion->numMarcos, ocupados, t_paginacion->mascaraAnclas + 1, t_paginacion->numEntradas);
+	fprintf (salida, "\tCadenas: %lld no vacias, longitud media %.2f, maxima %d (0: %lld, 1: %lld, 2: %lld, 3: %lld, 4 o mas: %lld)\n",
+			cadenas, (cadenas > 0) ? (double)ocupados / cadenas : 0, maxima,
+			longitudes[0], longitudes[1], longitudes[2], longitudes[3], longitudes[4]);
+	fprintf (salida, "\tEntradas comparadas por busqueda con exito: %.2f de media\n", (ocupados > 0) ? (double)suma / ocupados : 0);
+	if (c != NULL && c->busquedas > 0){
+		fprintf (salida, "\tBusquedas: %lld\tEntradas comparadas: %lld (%.2f por busqueda)\n",
+				c->busquedas, c->accesos, (double)c->accesos / c->busquedas);
+	}
+	fprintf (salida, "\tMemoria: %zu bytes (con PMT serian %zu bytes)\n",
+			memoriaPaginacion(t_paginacion, numProcesos), (sizeof(registro) + sizeof(int)) * (size_t)numProcesos + sizeof(int) * (size_t)t_paginacion->numEntradas);
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funciones de la tabla de paginas multinivel (tipo 3).
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Cada proceso tiene un arbol (radix) de 2 a 4 niveles. El numero de
+//*		pagina se parte en grupos de bits, del mas significativo al menos:
+//*		cada grupo indexa un nodo de su nivel, cuya entrada es la posicion
+//*		del nodo del nivel siguiente o, en el ultimo nivel, el marco. Solo
+//*		existen los nodos de las zonas con paginas asignadas, de modo que
+//*		un espacio de direcciones grande y disperso, con unas pocas
+//*		regiones usadas, ocupa unos pocos nodos.
+//*		Todos los nodos estan en un unico array de enteros ("radix"), uno a
+//*		continuacion de otro; las entradas sin nodo o sin marco valen -1.
+//*		leerRegiones() lee la octava linea del fichero: grupos de cuatro
+//*		valores "proceso pagina marco paginas" que asignan marcos
+//*		consecutivos a paginas consecutivas del proceso.
+//*		rangosRadix() comprueba los RBTP/RLTP: cada proceso puede tener
+//*		hasta 2^(suma de bits) paginas, sin limite para el total.
+//*		construirRadix() crea los arboles a partir de las regiones.
+//*		Devuelve 1, 0 si una pagina esta en dos regiones o -1 si no hay
+//*		memoria suficiente.
+//*		buscarRadix() recorre el arbol del proceso y devuelve el marco (-1
+//*		si la pagina no tiene), anotando la busqueda y los niveles leidos
+//*		si la paginacion tiene contadores.
+//*		mostrarEstadisticasRadix() muestra los nodos por nivel, la memoria
+//*		por proceso frente a la de una PMT por proceso y los niveles
+//*		leidos por busqueda.
+//*
+//*************************************************************
+static int leerRegiones(lector *l, paginacion *t_paginacion, int numProcesos, const char *mensaje){
+	regionPaginas r, *aux;
+	int capacidad = 0;
+	long long total = 0;
+	
+	t_paginacion->numRegiones = 0;
+	
+	// Los grupos siguen mientras despues de un espacio venga otro numero
+	while (l->pos < l->fin && *l->pos != '\n' && *l->pos != '\r'){
+		if (!leerEntero(l, &r.proceso) || leerCaracter(l) != ' ' || !leerEntero(l, &r.pagina) || leerCaracter(l) != ' ' ||
+			!leerEntero(l, &r.marco) || leerCaracter(l) != ' ' || !leerEntero(l, &r.paginas)){
+			return errorFormato(l, mensaje);
+		}
+		
+		if (r.proceso < 0 || r.proceso >= numProcesos || r.pagina < 0 || r.marco < 0 || r.paginas <= 0 ||
+			(long long)r.pagina + r.paginas - 1 > t_paginacion->RBTP_RLTP[r.proceso].limite || (long long)r.marco + r.paginas - 1 > INT_MAX ||
+			(total += r.paginas) > INT_MAX){
+			return errorFormato(l, mensaje);
+		}
+		
+		if (t_paginacion->numRegiones == capacidad){
+			capacidad = (capacidad == 0) ? 64 : capacidad * 2;
+			aux = (regionPaginas*)realloc(t_paginacion->regiones, sizeof(regionPaginas) * capacidad);
+			if (aux == NULL){
+				return -1;
+			}
+			t_paginacion->regiones = aux;
+		}
+		t_paginacion->regiones[t_paginacion->numRegiones++] = r;
+		
+		if (l->pos + 1 < l->fin && *l->pos == ' ' && (l->pos[1] == '-' || (l->pos[1] >= '0' && l->pos[1] <= '9'))){
+			leerCaracter(l);
+		}
+		else{
+			break;
+		}
+	}
+	
+	t_paginacion->numEntradas = (int)total;
+	return 1;
+}
+
+static int rangosRadix(const paginacion *t_paginacion, int numProcesos){
+	int i, bits = 0;
+	
+	for (i = 0 ; i < t_paginacion->numNiveles ; i++){
+		bits += t_paginacion->bitsNivel[i];
+	}
+	
+	for (i = 0 ; i < numProcesos ; i++){
+		if (t_paginacion->RBTP_RLTP[i].base < 0 || t_paginacion->RBTP_RLTP[i].limite < -1 ||
+			(long long)t_paginacion->RBTP_RLTP[i].limite >= (1LL << bits)){
+			return 0;
+		}
+	}
+	
+	return 1;
+}
+
+// Anade un nodo vacio de "entradas" entradas al final del array de nodos. Devuelve su posicion o -1
+static int nuevoNodoRadix(paginacion *t_paginacion, size_t *capacidad, int entradas){
+	int *aux, posicion;
+	
+	if (t_paginacion->numRadix + entradas > INT_MAX){
+		return -1;
+	}
+	
+	if (t_paginacion->numRadix + entradas > *capacidad){
+		while (t_paginacion->numRadix + entradas > *capacidad){
+			*capacidad = (*capacidad == 0) ? 4096 : *capacidad * 2;
+		}
+		aux = (int*)realloc(t_paginacion->radix, sizeof(int) * *capacidad);
+		if (aux == NULL){
+			return -1;
+		}
+		t_paginacion->radix = aux;
+	}
+	
+	posicion = (int)t_paginacion->numRadix;
+	memset(t_paginacion->radix + posicion, -1, sizeof(int) * entradas);
+	t_paginacion->numRadix += entradas;
+	
+	return posicion;
+}
+
+static int construirRadix(paginacion *t_paginacion, int numProcesos, FILE *salida){
+	const regionPaginas *r;
+	size_t capacidad = 0;
+	int i, k, nivel, nodo, entrada, desplazamiento, pagina, bits = 0;
+	
+	for (nivel = 0 ; nivel < t_paginacion->numNiveles ; nivel++){
+		bits += t_paginacion->bitsNivel[nivel];
+	}
+	
+	t_paginacion->numRadix = 0;
+	t_paginacion->raices = (int*)malloc(sizeof(int) * numProcesos);
+	if (t_paginacion->raices == NULL){
+		return -1;
+	}
+	for (i = 0 ; i < numProcesos ; i++){
+		t_paginacion->raices[i] = -1;
+	}
+	
+	for (i = 0 ; i < t_paginacion->numRegiones ; i++){
+		r = &t_paginacion->regiones[i];
+		
+		for (k = 0 ; k < r->paginas ; k++){
+			pagina = r->pagina + k;
+			
+			if (t_paginacion->raices[r->proceso] < 0 &&
+				(t_paginacion->raices[r->proceso] = nuevoNodoRadix(t_paginacion, &capacidad, 1 << t_paginacion->bitsNivel[0])) < 0){
+				return -1;
+			}
+			
+			// Se baja por el arbol creando los nodos que faltan
+			nodo = t_paginacion->raices[r->proceso];
+			desplazamiento = bits;
+			for (nivel = 0 ; nivel < t_paginacion->numNiveles - 1 ; nivel++){
+				desplazamiento -= t_paginacion->bitsNivel[nivel];
+				entrada = nodo + ((pagina >> desplazamiento) & ((1 << t_paginacion->bitsNivel[nivel]) - 1));
+				
+				if (t_paginacion->radix[entrada] < 0){
+					int hijo = nuevoNodoRadix(t_paginacion, &capacidad, 1 << t_paginacion->bitsNivel[nivel + 1]);
+					
+					if (hijo < 0){
+						return -1;
+					}
+					t_paginacion->radix[entrada] = hijo;
+				}
+				nodo = t_paginacion->radix[entrada];
+			}
+			
+			entrada = nodo + (pagina & ((1 << t_paginacion->bitsNivel[nivel]) - 1));
+			if (t_paginacion->radix[entrada] >= 0){
+				if (salida != NULL){
+					fprintf (salida, "Error. La pagina %d del proceso %d esta en mas de una region.\n", pagina, r->proceso);
+				}
+				return 0;
+			}
+			t_paginacion->radix[entrada] = r->marco + k;
+		}
+	}
+	
+	if ((t_paginacion->contadores = (contadoresTabla*)calloc(1, sizeof(contadoresTabla))) == NULL){
+		return -1;
+	}
+	
+	return 1;
+}
+
+static int buscarRadix(const paginacion *t_paginacion, int proceso, int nPagina){
+	int nivel, bits = 0, nodo = t_paginacion->raices[proceso];
+	
+	for (nivel = 0 ; nivel < t_paginacion->numNiveles ; nivel++){
+		bits += t_paginacion->bitsNivel[nivel];
+	}
+	
+	for (nivel = 0 ; nivel < t_paginacion->numNiveles && nodo >= 0 ; nivel++){
+		bits -= t_paginacion->bitsNivel[nivel];
+		nodo = t_paginacion->radix[nodo + ((nPagina >> bits) & ((1 << t_paginacion->bitsNivel[nivel]) - 1))];
+	}
+	
+	if (t_paginacion->contadores != NULL){
+		t_paginacion->contadores->busquedas++;
+		t_paginacion->contadores->accesos += nivel;
+	}
+	
+	// Tras el ultimo nivel "nodo" es el marco
+	return nodo;
+}
+
+// Cuenta los nodos de un subarbol, por nivel
+static long long contarNodosRadix(const paginacion *t_paginacion, int nodo, int nivel, long long nodos[]){
+	long long total = 1;
+	int i;
+	
+	nodos[nivel]++;
+	if (nivel < t_paginacion->numNiveles - 1){
+		for (i = 0 ; i < (1 << t_paginacion->bitsNivel[nivel]) ; i++){
+			if (t_paginacion->radix[nodo + i] >= 0){
+				total += contarNodosRadix(t_paginacion, t_paginacion->radix[nodo + i], nivel + 1, nodos);
+			}
+		}
+	}
+	
+	return total;
+}
+
+static void mostrarEstadisticasRadix(const paginacion *t_paginacion, int numProcesos, FILE *salida){
+	long long nodos[4] = {0}, nodosProceso[4], paginasPMT = 0;
+	size_t bytes, maximo = 0;
+	int i, nivel;
+	const contadoresTabla *c = t_paginacion->contadores;
+	
+	for (i = 0 ; i < numProcesos ; i++){
+		paginasPMT += t_paginacion->RBTP_RLTP[i].limite + 1;
+		if (t_paginacion->raices[i] < 0){
+			continue;
+		}
+		
+		memset(nodosProceso, 0, sizeof(nodosProceso));
+		contarNodosRadix(t_paginacion, t_paginacion->raices[i], 0, nodosProceso);
+		for (bytes = 0, nivel = 0 ; nivel < t_paginacion->numNiveles ; nivel++){
+			nodos[nivel] += nodosProceso[nivel];
+			bytes += sizeof(int) * ((size_t)nodosProceso[nivel] << t_paginacion->bitsNivel[nivel]);
+		}
+		if (bytes > maximo){
+			maximo = bytes;
+		}
+	}
+	
+	fprintf (salida, "Tabla multinivel: %d niveles (bits", t_paginacion->numNiveles);
+	for (nivel = 0 ; nivel < t_paginacion->numNiveles ; nivel++){
+		fprintf (salida, "%c%d", (nivel == 0) ? ' ' : '/', t_paginacion->bitsNivel[nivel]);
+	}
+	fprintf (salida, "), %d paginas asignadas en %d regiones\n", t_paginacion->numEntradas, t_paginacion->numRegiones);
+	
+	fprintf (salida, "\tNodos por nivel:");
+	for (nivel = 0 ; nivel < t_paginacion->numNiveles ; nivel++){
+		fprintf (salida, " %lld", nodos[nivel]);
+	}
+	fprintf (salida, "\n");
+	
+	bytes = memoriaPaginacion(t_paginacion, numProcesos);
+	fprintf (salida, "\tMemoria: %zu bytes (%.1f KiB por proceso de media, %.1f KiB como maximo; con PMT por proceso serian %lld bytes)\n",
+			bytes, bytes / 1024.0 / numProcesos, maximo / 1024.0, (long long)(sizeof(registro) + sizeof(int)) * numProcesos + (long long)sizeof(int) * paginasPMT);
+	
+	if (c != NULL && c->busquedas > 0){
+		fprintf (salida, "\tBusquedas: %lld\tNiveles leidos: %lld (%.2f por busqueda)\n",
+				c->busquedas, c->accesos, (double)c->accesos / c->busquedas);
+	}
+}
+
+
+
+// Muestra las estadisticas de la tabla invertida o multinivel; con PMT no muestra nada
+void mostrarEstadisticasPaginacion(const paginacion *t_paginacion, int numProcesos, FILE *salida){
+	if (t_paginacion->tipo == 2){
+		mostrarEstadisticasInvertida(t_paginacion, numProcesos, salida);
+	}
+	else if (t_paginacion->tipo == 3){
+		mostrarEstadisticasRadix(t_paginacion, numProcesos, salida);
+	}
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funciones del modelo de solo lectura, para usar la
+//*			 biblioteca desde otros programas.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		cargarModelo() lee el fichero de datos (de texto o imagen binaria)
+//*		igual que la aplicacion y guarda sus tablas en un modeloMemoria.
+//*		Quita los contadores de coste de las tablas invertida y multinivel
+//*		y de la segmentacion paginada, de modo que despues nada escribe en el
+//*		modelo: las traducciones solo leen las tablas a traves de punteros
+//*		y se pueden hacer a la vez desde varios hilos.
+//*		Devuelve NULL si el fichero no existe, no es valido o no hay memoria.
+//*		Los errores del fichero se escriben en "salida" (NULL para omitirlos);
+//*		recargarModelo() y recargarPublicado() la reciben con el mismo fin.
+//*		Si el fichero es de texto, el modelo conserva su contenido para que
+//*		recargarModelo() pueda compararlo con el fichero modificado.
+//*
+//*		Las funciones de traduccion son las de cada metodo sobre las tablas
+//*		del modelo. El proceso debe estar entre 0 y procesosModelo() - 1.
+//*		traducirModeloSegmentoPaginado() devuelve TRAD_FORMATO si el fichero
+//*		no tiene las tablas de paginas de los segmentos (novena linea), lo
+//*		que se puede saber antes con segmentosPaginadosModelo().
+//*
+//*************************************************************
+struct modeloMemoria{
+	int numProcesos;
+	registro *t_registros;
+	paginacion t_paginacion;
+	segmentacion t_segmentacion;
+	imagen t_imagen;									// Imagen de la que se han cargado las tablas, si la hay
+	char *contenido;									// Texto del fichero de datos, para comparar al recargarlo (NULL con imagen)
+	size_t longitud;
+};
+
+// Quita los contadores de las tablas: sin ellos, las traducciones no escriben en el modelo
+static void quitarContadores(modeloMemoria *m){
+	free(m->t_paginacion.contadores);
+	m->t_paginacion.contadores = NULL;
+	free(m->t_segmentacion.contadores);
+	m->t_segmentacion.contadores = NULL;
+	m->t_segmentacion.paginada = 0;
+}
+
+// Crea el modelo de un fichero de texto ya cargado en memoria, que pasa a ser del modelo
+static modeloMemoria *leerModeloTexto(char *contenido, size_t longitud, FILE *salida){
+	modeloMemoria *m;
+	
+	if ((m = (modeloMemoria*)calloc(1, sizeof(modeloMemoria))) == NULL){
+		free(contenido);
+		return NULL;
+	}
+	if (leerDatos(contenido, longitud, &m->numProcesos, &m->t_registros, &m->t_paginacion, &m->t_segmentacion, salida) != 1){
+		free(contenido);
+		free(m);
+		return NULL;
+	}
+	
+	quitarContadores(m);
+	m->contenido = contenido;
+	m->longitud = longitud;
+	
+	return m;
+}
+
+modeloMemoria *cargarModelo(const char *fichero, FILE *salida){
+	modeloMemoria *m;
+	FILE *fp;
+	char *contenido;
+	size_t longitud;
+	int estado;
+	
+	if ((m = (modeloMemoria*)calloc(1, sizeof(modeloMemoria))) == NULL){
+		return NULL;
+	}
+	if ((fp = fopen(fichero, "rb")) == NULL){
+		free(m);
+		return NULL;
+	}
+	
+	if ((estado = abrirImagen(fp, &m->t_imagen, &m->numProcesos, &m->t_registros, &m->t_paginacion, &m->t_segmentacion, salida)) == 0){
+		free(m);
+		contenido = leerFichero(fp, &longitud);
+		fclose(fp);
+		return (contenido == NULL) ? NULL : leerModeloTexto(contenido, longitud, salida);
+	}
+	fclose(fp);
+	
+	if (estado != 1){
+		free(m);
+		return NULL;
+	}
+	
+	quitarContadores(m);
+	return m;
+}
+
+void cerrarModelo(modeloMemoria *m){
+	if (m != NULL){
+		liberarModelo(&m->t_imagen, m->t_registros, &m->t_paginacion, &m->t_segmentacion);
+		free(m->contenido);
+		free(m);
+	}
+}
+
+int procesosModelo(const modeloMemoria *m){
+	return m->numProcesos;
+}
+
+int segmentosPaginadosModelo(const modeloMemoria *m){
+	return m->t_segmentacion.tablasSegmentos != NULL;
+}
+
+int traducirModeloBaseLimite(const modeloMemoria *m, int proceso, const direccion *d, int *dFisica){
+	return traducirBaseLimite(&m->t_registros[proceso], d, dFisica);
+}
+
+int traducirModeloSegmento(const modeloMemoria *m, int proceso, const direccion *d, int *dFisica){
+	return traducirSegmento(&m->t_segmentacion, proceso, d, dFisica);
+}
+
+int traducirModeloSegmentoPaginado(const modeloMemoria *m, int proceso, const direccion *d, int *dFisica){
+	if (m->t_segmentacion.tablasSegmentos == NULL){
+		return TRAD_FORMATO;
+	}
+	return traducirSegmentoPaginado(&m->t_segmentacion, proceso, d, dFisica);
+}
+
+int traducirModeloPagina(const modeloMemoria *m, int proceso, const direccion *d, int *dFisica){
+	return traducirPagina(&m->t_paginacion, proceso, d, dFisica);
+}
+
+void traducirModeloPaginasLote(const modeloMemoria *m, int proceso, const int dLogicas[], int n, int dFisicas[], unsigned char estados[]){
+	traducirPaginasLote(&m->t_paginacion, proceso, dLogicas, n, dFisicas, estados);
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funciones que recargan el modelo cuando cambia el fichero
+//*			 de datos.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		recargarModelo() vuelve a leer el fichero y lo compara linea a linea
+//*		con el contenido del que se cargo el modelo (con memcmp, sin convertir
+//*		numeros). Si solo han cambiado valores de las lineas 2 (RB/RL de los
+//*		procesos), 4 (SDT), 8 (marcos de la PMT o de la tabla invertida) o 9
+//*		(marcos de las tablas de los segmentos), sin cambiar su numero, el
+//*		modelo nuevo comparte con el anterior todas las tablas salvo las
+//*		modificadas, que se copian y se corrigen:
+//*			- En cada linea modificada se buscan el prefijo y el sufijo comunes
+//*			  y solo se leen los valores de la zona intermedia, ampliada hasta
+//*			  el principio y el final de un elemento (un valor o una pareja).
+//*			  La posicion del primer elemento es el numero de espacios del
+//*			  prefijo, ya que los valores van separados por un solo espacio.
+//*			- En la tabla invertida se quitan las paginas modificadas de sus
+//*			  marcos antiguos y de las cadenas del hash, y despues se anaden en
+//*			  los nuevos. Un marco nuevo ocupado o fuera de la tabla obliga a
+//*			  leer todo el fichero, que mostrara el error.
+//*			- Con la novena linea, un segmento no puede cambiar su numero de
+//*			  paginas.
+//*		Cualquier otro cambio (numero de procesos, de segmentos o de paginas,
+//*		tamano o tipo de paginacion, tabla multinivel, imagen binaria) se
+//*		resuelve leyendo el fichero completo, igual que cargarModelo(). Asi
+//*		el coste de la recarga es el de comparar el fichero a la velocidad de
+//*		memcmp mas el de la zona modificada y la copia de las tablas que
+//*		cambian, en lugar de convertir todos los numeros y volver a construir
+//*		todas las tablas.
+//*		"cambios" indica si se ha leido el fichero completo, cuantas tablas
+//*		se han sustituido y cuantos elementos han cambiado. Si el fichero no
+//*		es valido devuelve NULL, y el modelo anterior sigue siendo valido.
+//*
+//*		El modelo anterior nunca se modifica. retirarModelo() lo libera cuando
+//*		ya no se usa, sin liberar las tablas que comparte con el nuevo.
+//*
+//*************************************************************
+
+// Zona modificada de una linea del fichero de datos
+typedef struct cambioLinea{
+	int linea;											// Numero de linea: 2, 4, 8 o 9
+	int primero;										// Primer elemento (registro o marco) de la zona
+	int n;												// Valores de la zona (dos por elemento en las lineas de registros)
+	int *antes;											// Valores del contenido anterior
+	int *despues;										// Valores del contenido nuevo
+}cambioLinea;
+
+// Libera una tabla del modelo retirado si el modelo nuevo no la usa
+static void liberarNoCompartida(void *tabla, const void *compartida){
+	if (tabla != compartida){
+		free(tabla);
+	}
+}
+
+// Indica si un caracter separa los valores de una linea, como los espacios que salta leerEntero()
+static int esBlanco(char c){
+	return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Lee los valores de [p, fin) con las reglas de leerMarcos(). Devuelve cuantos hay, o -1 si el formato no es valido
+static int leerZona(const char *p, const char *fin, int valores[]){
+	long long v;
+	int n = 0, negativo;
+	
+	if (p < fin && esBlanco(fin[-1])){
+		return -1;
+	}
+	
+	while (p < fin){
+		while (p < fin && esBlanco(*p)){
+			p++;
+		}
+		negativo = (*p == '-');
+		if (*p == '-' || *p == '+'){
+			p++;
+		}
+		if (p == fin || *p < '0' || *p > '9'){
+			return -1;
+		}
+		for (v = 0 ; p < fin && *p >= '0' && *p <= '9' ; p++){
+			v = v * 10 + (*p - '0');
+			if (v > (long long)INT_MAX + 1){
+				return -1;
+			}
+		}
+		v = negativo ? -v : v;
+		if (v > INT_MAX){
+			return -1;
+		}
+		valores[n++] = (int)v;
+		
+		// Detras de cada numero tiene que haber un espacio, salvo al final de la zona
+		if (p < fin && *p != ' '){
+			return -1;
+		}
+	}
+	
+	return n;
+}
+
+// Obtiene la zona modificada entre dos versiones de una linea. Devuelve 1, 0 si no se puede comparar o -1 sin memoria
+static int compararLinea(const char *a, size_t la, const char *b, size_t lb, int porElemento, cambioLinea *c){
+	size_t p = 0, s = 0, finA, finB, i;
+	int valores = 0, zona = 0;
+	
+	while (p < la && p < lb && a[p] == b[p]){
+		p++;
+	}
+	while (s < la - p && s < lb - p && a[la - 1 - s] == b[lb - 1 - s]){
+		s++;
+	}
+	
+	// La zona empieza al principio de un elemento: se cuentan los valores del prefijo...
+	while (p > 0 && !esBlanco(a[p - 1])){
+		p--;
+	}
+	for (i = 0 ; i < p ; i++){
+		valores += (!esBlanco(a[i]) && (i == 0 || esBlanco(a[i - 1])));
+	}
+	if (valores % porElemento != 0){
+		while (p > 0 && esBlanco(a[p - 1])){
+			p--;
+		}
+		while (p > 0 && !esBlanco(a[p - 1])){
+			p--;
+		}
+		valores--;
+	}
+	
+	// ...y termina al final de otro. El sufijo es comun, asi que se amplia igual en las dos versiones
+	finA = la - s;
+	finB = lb - s;
+	while (finA < la && !esBlanco(a[finA])){
+		finA++;
+		finB++;
+	}
+	for (i = p ; i < finA ; i++){
+		zona += (!esBlanco(a[i]) && (i == p || esBlanco(a[i - 1])));
+	}
+	if (zona % porElemento != 0){
+		while (finA < la && esBlanco(a[finA])){
+			finA++;
+			finB++;
+		}
+		while (finA < la && !esBlanco(a[finA])){
+			finA++;
+			finB++;
+		}
+	}
+	
+	c->antes = (int*)malloc(sizeof(int) * ((finA - p) / 2 + 1));
+	c->despues = (int*)malloc(sizeof(int) * ((finB - p) / 2 + 1));
+	if (c->antes == NULL || c->despues == NULL){
+		free(c->antes);
+		free(c->despues);
+		return -1;
+	}
+	
+	c->primero = valores / porElemento;
+	c->n = leerZona(a + p, a + finA, c->antes);
+	if (c->n < 0 || c->n % porElemento != 0 || leerZona(b + p, b + finB, c->despues) != c->n){
+		free(c->antes);
+		free(c->despues);
+		return 0;
+	}
+	
+	return 1;
+}
+
+// Copia una tabla del modelo para modificarla en el nuevo
+static void *copiarTabla(const void *tabla, size_t bytes){
+	void *copia = malloc(bytes);
+	
+	if (copia != NULL){
+		memcpy(copia, tabla, bytes);
+	}
+	return copia;
+}
+
+// Cambia en la tabla invertida del modelo nuevo los marcos de la zona. Devuelve 1, 0 si hay que leer el fichero completo o -1
+static int cambiarInvertida(modeloMemoria *nuevo, const cambioLinea *c){
+	paginacion *t = &nuevo->t_paginacion;
+	int i, proceso, pagina, marco, anterior, izq, der;
+	int *procesos;
+	unsigned int h;
+	
+	if (t->numMarcos == 0){
+		return 0;										// Ningun marco asignado: cualquier marco nuevo amplia la tabla
+	}
+	if ((procesos = (int*)malloc(sizeof(int) * (c->n + 1))) == NULL){
+		return -1;
+	}
+	if ((t->invertida = (entradaInvertida*)copiarTabla(t->invertida, sizeof(entradaInvertida) * (size_t)t->numMarcos)) == NULL ||
+		(t->anclas = (int*)copiarTabla(t->anclas, sizeof(int) * ((size_t)t->mascaraAnclas + 1))) == NULL){
+		free(procesos);
+		return -1;
+	}
+	
+	// Proceso de cada entrada: el ultimo cuya primera pagina no esta despues de ella
+	for (i = 0 ; i < c->n ; i++){
+		for (izq = 0, der = nuevo->numProcesos - 1 ; izq < der ; ){
+			proceso = (izq + der + 1) / 2;
+			if (t->desplazamientoPMT[proceso] <= c->primero + i){
+				izq = proceso;
+			}
+			else{
+				der = proceso - 1;
+			}
+		}
+		procesos[i] = izq;
+	}
+	
+	// Primero se quitan las paginas de sus marcos antiguos...
+	for (i = 0 ; i < c->n ; i++){
+		marco = c->antes[i];
+		if (marco == c->despues[i] || marco < 0){
+			continue;
+		}
+		proceso = procesos[i];
+		pagina = c->primero + i - t->desplazamientoPMT[proceso];
+		if (marco >= t->numMarcos || t->invertida[marco].proceso != proceso || t->invertida[marco].pagina != pagina){
+			free(procesos);
+			return 0;
+		}
+		
+		h = hashPagina(proceso, pagina) & (unsigned int)t->mascaraAnclas;
+		if (t->anclas[h] == marco){
+			t->anclas[h] = t->invertida[marco].siguiente;
+		}
+		else{
+			for (anterior = t->anclas[h] ; anterior >= 0 && t->invertida[anterior].siguiente != marco ; anterior = t->invertida[anterior].siguiente);
+			if (anterior < 0){
+				free(procesos);
+				return 0;
+			}
+			t->invertida[anterior].siguiente = t->invertida[marco].siguiente;
+		}
+		t->invertida[marco].proceso = -1;
+	}
+	
+	// ...y despues se anaden en los nuevos, que deben estar libres
+	for (i = 0 ; i < c->n ; i++){
+		marco = c->despues[i];
+		if (marco == c->antes[i] || marco < 0){
+			continue;
+		}
+		if (marco >= t->numMarcos || t->invertida[marco].proceso >= 0){
+			free(procesos);
+			return 0;
+		}
+		
+		proceso = procesos[i];
+		pagina = c->primero + i - t->desplazamientoPMT[proceso];
+		h = hashPagina(proceso, pagina) & (unsigned int)t->mascaraAnclas;
+		t->invertida[marco].proceso = proceso;
+		t->invertida[marco].pagina = pagina;
+		t->invertida[marco].siguiente = t->anclas[h];
+		t->anclas[h] = marco;
+	}
+	
+	free(procesos);
+	return 1;
+}
+
+// Aplica al modelo nuevo la zona modificada de una linea. Devuelve 1, 0 si hay que leer el fichero completo o -1
+static int aplicarCambio(modeloMemoria *nuevo, const cambioLinea *c, cambiosModelo *cambios){
+	segmentacion *seg = &nuevo->t_segmentacion;
+	paginacion *pag = &nuevo->t_paginacion;
+	int porElemento = (c->linea == 2 || c->linea == 4) ? 2 : 1;
+	int i, elementos, cambiados = 0;
+	int *tabla;
+	
+	elementos = (c->linea == 2) ? nuevo->numProcesos : (c->linea == 4) ? seg->numSegmentos : (c->linea == 8) ? pag->numEntradas : seg->numPaginasSegmentos;
+	if (c->primero + c->n / porElemento > elementos){
+		return 0;
+	}
+	
+	for (i = 0 ; i < c->n ; i += porElemento){
+		if (c->antes[i] != c->despues[i] || (porElemento == 2 && c->antes[i + 1] != c->despues[i + 1])){
+			cambiados++;
+			
+			// Con la novena linea, cada segmento conserva el numero de paginas de su tabla
+			if (c->linea == 4 && seg->tablasSegmentos != NULL && c->antes[i + 1] != c->despues[i + 1] &&
+				((c->despues[i + 1] < 0) ? -1 : c->despues[i + 1] / seg->tamanoPagina) != seg->tablasSegmentos[c->primero + i / 2].limite){
+				return 0;
+			}
+		}
+	}
+	if (cambiados == 0){
+		return 1;
+	}
+	cambios->tablas++;
+	cambios->entradas += cambiados;
+	
+	if (c->linea == 8 && pag->tipo == 2){
+		return cambiarInvertida(nuevo, c);
+	}
+	
+	// Las demas tablas son arrays de enteros (los registros son parejas de enteros) en el orden del fichero
+	switch (c->linea){
+		case 2:
+			tabla = (int*)(nuevo->t_registros = (registro*)copiarTabla(nuevo->t_registros, sizeof(registro) * nuevo->numProcesos));
+			break;
+		case 4:
+			tabla = (int*)(seg->SDT = (registro*)copiarTabla(seg->SDT, sizeof(registro) * ((size_t)seg->numSegmentos + 1)));
+			break;
+		case 8:
+			tabla = pag->PMT = (int*)copiarTabla(pag->PMT, sizeof(int) * ((size_t)pag->numEntradas + 1));
+			break;
+		default:
+			tabla = seg->marcosSegmentos = (int*)copiarTabla(seg->marcosSegmentos, sizeof(int) * ((size_t)seg->numPaginasSegmentos + 1));
+			break;
+	}
+	if (tabla == NULL){
+		return -1;
+	}
+	
+	tabla += (size_t)c->primero * porElemento;
+	for (i = 0 ; i < c->n ; i++){
+		if (tabla[i] != c->antes[i]){
+			return 0;									// El contenido anterior no corresponde a las tablas
+		}
+		tabla[i] = c->despues[i];
+	}
+	
+	return 1;
+}
+
+// Recarga incremental: devuelve el modelo nuevo, o NULL si hay que leer el fichero completo
+static modeloMemoria *aplicarCambios(const modeloMemoria *m, const char *contenido, size_t longitud, cambiosModelo *cambios){
+	cambioLinea c[4];
+	modeloMemoria *nuevo;
+	const char *a = m->contenido, *finA = m->contenido + m->longitud, *b = contenido, *finB = contenido + longitud, *sa, *sb;
+	int i, linea, modificable, numCambios = 0, estado = 1;
+	
+	for (linea = 1 ; estado == 1 && (a < finA || b < finB) ; linea++){
+		if ((sa = (const char*)memchr(a, '\n', finA - a)) == NULL){
+			sa = finA;
+		}
+		if ((sb = (const char*)memchr(b, '\n', finB - b)) == NULL){
+			sb = finB;
+		}
+		
+		if (sa - a != sb - b || memcmp(a, b, sa - a) != 0){
+			modificable = (linea == 2 || linea == 4 || (linea == 8 && m->t_paginacion.tipo != 3) || (linea == 9 && m->t_segmentacion.tablasSegmentos != NULL));
+			estado = modificable ? compararLinea(a, sa - a, b, sb - b, (linea == 2 || linea == 4) ? 2 : 1, &c[numCambios]) : 0;
+			if (estado == 1){
+				c[numCambios++].linea = linea;
+			}
+		}
+		
+		a = (sa < finA) ? sa + 1 : finA;
+		b = (sb < finB) ? sb + 1 : finB;
+	}
+	
+	nuevo = NULL;
+	if (estado == 1 && (nuevo = (modeloMemoria*)malloc(sizeof(modeloMemoria))) != NULL){
+		*nuevo = *m;
+		nuevo->contenido = NULL;
+		for (i = 0 ; i < numCambios && estado == 1 ; i++){
+			estado = aplicarCambio(nuevo, &c[i], cambios);
+		}
+		if (estado != 1){
+			retirarModelo(nuevo, m);
+			nuevo = NULL;
+		}
+	}
+	
+	for (i = 0 ; i < numCambios ; i++){
+		free(c[i].antes);
+		free(c[i].despues);
+	}
+	
+	return nuevo;
+}
+
+modeloMemoria *recargarModelo(const modeloMemoria *m, const char *fichero, cambiosModelo *cambios, FILE *salida){
+	modeloMemoria *nuevo = NULL;
+	FILE *fp;
+	char *contenido;
+	size_t longitud;
+	
+	cambios->completa = 0;
+	cambios->tablas = 0;
+	cambios->entradas = 0;
+	
+	if ((fp = fopen(fichero, "rb")) == NULL){
+		return NULL;
+	}
+	contenido = leerFichero(fp, &longitud);
+	fclose(fp);
+	if (contenido == NULL){
+		return NULL;
+	}
+	
+	if (m->contenido != NULL && (longitud < strlen(marcaImagen) || memcmp(contenido, marcaImagen, strlen(marcaImagen)) != 0)){
+		nuevo = aplicarCambios(m, contenido, longitud, cambios);
+	}
+	if (nuevo != NULL){
+		nuevo->contenido = contenido;
+		nuevo->longitud = longitud;
+		return nuevo;
+	}
+	
+	// Cualquier otro cambio se resuelve leyendo el fichero completo
+	cambios->completa = 1;
+	cambios->tablas = 0;
+	cambios->entradas = 0;
+	if (longitud >= strlen(marcaImagen) && memcmp(contenido, marcaImagen, strlen(marcaImagen)) == 0){
+		free(contenido);
+		return cargarModelo(fichero, salida);
+	}
+	return leerModeloTexto(contenido, longitud, salida);
+}
+
+void retirarModelo(modeloMemoria *anterior, const modeloMemoria *nuevo){
+	if (anterior == NULL){
+		return;
+	}
+	if (nuevo == NULL || anterior->t_imagen.datos != NULL){
+		cerrarModelo(anterior);
+		return;
+	}
+	
+	liberarNoCompartida(anterior->t_registros, nuevo->t_registros);
+	
+	liberarNoCompartida(anterior->t_segmentacion.RBTS_RLTS, nuevo->t_segmentacion.RBTS_RLTS);
+	liberarNoCompartida(anterior->t_segmentacion.desplazamientoSDT, nuevo->t_segmentacion.desplazamientoSDT);
+	liberarNoCompartida(anterior->t_segmentacion.SDT, nuevo->t_segmentacion.SDT);
+	liberarNoCompartida(anterior->t_segmentacion.marcosSegmentos, nuevo->t_segmentacion.marcosSegmentos);
+	liberarNoCompartida(anterior->t_segmentacion.tablasSegmentos, nuevo->t_segmentacion.tablasSegmentos);
+	liberarNoCompartida(anterior->t_segmentacion.contadores, nuevo->t_segmentacion.contadores);
+	
+	liberarNoCompartida(anterior->t_paginacion.RBTP_RLTP, nuevo->t_paginacion.RBTP_RLTP);
+	liberarNoCompartida(anterior->t_paginacion.desplazamientoPMT, nuevo->t_paginacion.desplazamientoPMT);
+	liberarNoCompartida(anterior->t_paginacion.PMT, nuevo->t_paginacion.PMT);
+	liberarNoCompartida(anterior->t_paginacion.invertida, nuevo->t_paginacion.invertida);
+	liberarNoCompartida(anterior->t_paginacion.anclas, nuevo->t_paginacion.anclas);
+	liberarNoCompartida(anterior->t_paginacion.raices, nuevo->t_paginacion.raices);
+	liberarNoCompartida(anterior->t_paginacion.radix, nuevo->t_paginacion.radix);
+	liberarNoCompartida(anterior->t_paginacion.regiones, nuevo->t_paginacion.regiones);
+	liberarNoCompartida(anterior->t_paginacion.contadores, nuevo->t_paginacion.contadores);
+	
+	liberarNoCompartida(anterior->contenido, nuevo->contenido);
+	free(anterior);
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funciones que publican el modelo vigente para varios hilos
+//*			 lectores (RCU).
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		El modelo vigente es un puntero atomico. Cada lector tiene su propia
+//*		entrada, separada de las demas por una linea de cache, en la que
+//*		anota la epoca en la que ha empezado a usar el modelo, o 0 si no lo
+//*		esta usando: entrarModelo() anota la epoca actual y despues lee el
+//*		puntero, y salirModelo() anota 0. Los lectores nunca esperan ni
+//*		toman cerrojos, y entre entrarModelo() y salirModelo() ven siempre
+//*		la misma version completa del modelo.
+//*		publicarModelo() cambia el puntero por el del modelo nuevo, pasa a la
+//*		epoca siguiente y espera a que cada lector haya salido del modelo o
+//*		haya entrado en la nueva epoca, y por tanto vea el modelo nuevo. A
+//*		partir de ahi nadie puede estar usando el anterior, que se libera con
+//*		retirarModelo(). Las operaciones atomicas son secuencialmente
+//*		consistentes, de modo que un lector que anota su epoca despues de que
+//*		el que publica la haya comprobado lee tambien el puntero nuevo.
+//*		Solo un hilo puede publicar a la vez, y un lector no debe publicar
+//*		mientras esta dentro del modelo (se esperaria a si mismo).
+//*		recargarPublicado() recarga el fichero con recargarModelo() a partir
+//*		del modelo vigente y publica el resultado. Si el fichero no ha
+//*		cambiado, descarta el modelo nuevo sin publicarlo; si no es valido,
+//*		se sigue usando el vigente y devuelve 0.
+//*
+//*************************************************************
+
+// Entrada de un lector, que ocupa una linea de cache para no compartirla con otros lectores
+typedef struct lectorModelo{
+	_Atomic unsigned long long epoca;					// Epoca en la que ha entrado en el modelo, o 0 si no lo esta usando
+	char relleno[64 - sizeof(unsigned long long)];
+}lectorModelo;
+
+struct modeloPublicado{
+	_Atomic(modeloMemoria*) vigente;
+	_Atomic unsigned long long epoca;					// Empieza en 1: 0 indica que un lector no esta usando el modelo
+	int numLectores;
+	lectorModelo *lectores;
+};
+
+modeloPublicado *crearPublicacion(modeloMemoria *m, int numLectores){
+	modeloPublicado *p;
+	int i;
+	
+	if ((p = (modeloPublicado*)malloc(sizeof(modeloPublicado))) == NULL){
+		return NULL;
+	}
+	if ((p->lectores = (lectorModelo*)malloc(sizeof(lectorModelo) * numLectores)) == NULL){
+		free(p);
+		return NULL;
+	}
+	
+	atomic_init(&p->vigente, m);
+	atomic_init(&p->epoca, 1);
+	p->numLectores = numLectores;
+	for (i = 0 ; i < numLectores ; i++){
+		atomic_init(&p->lectores[i].epoca, 0);
+	}
+	
+	return p;
+}
+
+const modeloMemoria *entrarModelo(modeloPublicado *p, int lector){
+	atomic_store(&p->lectores[lector].epoca, atomic_load(&p->epoca));
+	return atomic_load(&p->vigente);
+}
+
+void salirModelo(modeloPublicado *p, int lector){
+	atomic_store_explicit(&p->lectores[lector].epoca, 0, memory_order_release);
+}
+
+void publicarModelo(modeloPublicado *p, modeloMemoria *nuevo){
+	modeloMemoria *anterior = atomic_exchange(&p->vigente, nuevo);
+	unsigned long long epoca = atomic_fetch_add(&p->epoca, 1) + 1, e;
+	int i;
+	
+	for (i = 0 ; i < p->numLectores ; i++){
+		while ((e = atomic_load(&p->lectores[i].epoca)) != 0 && e < epoca){
+			cederProcesador();
+		}
+	}
+	
+	retirarModelo(anterior, nuevo);
+}
+
+int recargarPublicado(modeloPublicado *p, const char *fichero, cambiosModelo *cambios, FILE *salida){
+	modeloMemoria *vigente = atomic_load(&p->vigente), *nuevo;
+	
+	if ((nuevo = recargarModelo(vigente, fichero, cambios, salida)) == NULL){
+		return 0;
+	}
+	
+	if (!cambios->completa && cambios->tablas == 0){
+		retirarModelo(nuevo, vigente);
+	}
+	else{
+		publicarModelo(p, nuevo);
+	}
+	return 1;
+}
+
+void cerrarPublicacion(modeloPublicado *p){
+	if (p != NULL){
+		cerrarModelo(atomic_load(&p->vigente));
+		free(p->lectores);
+		free(p);
+	}
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funciones que crean, destruyen y cambian de tamano procesos
+//*			 en tiempo de ejecucion (sistemaProcesos).
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Las tablas de todos los procesos estan en dos almacenes: uno de
+//*		marcos (la PMT) y otro de registros (la SDT). Cada almacen es un
+//*		solo array que crece duplicando su tamano, y cada proceso ocupa en
+//*		el un bloque contiguo de su clase de tamano, de modo que las tablas
+//*		son las mismas de una PMT por proceso (tipo 1) y de la SDT de un
+//*		fichero de datos: desplazamientoPMT/desplazamientoSDT son la
+//*		posicion del bloque y RBTP_RLTP/RBTS_RLTS su ultima entrada usada.
+//*		Asi traducirPagina(), traducirPaginasLote() y traducirSegmento()
+//*		traducen sin cambios las direcciones de los procesos dinamicos.
+//*
+//*		Hay cuatro clases por cada potencia de dos (4, 5, 6, 7, 8, 10, 12,
+//*		14, 16, 20... elementos), asi que un bloque desperdicia como mucho
+//*		una quinta parte de su tamano, y no la mitad como con potencias de
+//*		dos.
+//*		Los bloques libres de cada clase forman una lista enlazada a traves
+//*		de su primer elemento (como en un slab): reservar o liberar un
+//*		bloque es O(1) y no llama a malloc; solo se llama a realloc cuando
+//*		el array se llena, un numero logaritmico de veces. Como cada bloque
+//*		vuelve siempre a la lista de su clase, la rotacion de muchos
+//*		procesos de vida corta reutiliza los mismos bloques y el array no se
+//*		fragmenta: su tamano depende del maximo de procesos vivos a la vez.
+//*		Los identificadores de los procesos destruidos tambien se reutilizan
+//*		(el ultimo destruido es el primero en volver a usarse).
+//*
+//*		Al cambiar el tamano de un proceso, su bloque se conserva mientras
+//*		las tablas quepan en el y no ocupen menos de una cuarta parte; si no,
+//*		se copian a un bloque de la clase adecuada. Las paginas nuevas no
+//*		tienen marco (-1) y los segmentos nuevos estan vacios (limite -1).
+//*		Un proceso destruido no tiene paginas ni segmentos, asi que sus
+//*		direcciones son TRAD_PAGINA y TRAD_SEGMENTO.
+//*		redimensionarProceso() reserva los bloques de la PMT y de la SDT
+//*		antes de cambiar ninguna de las dos, asi que si falta memoria para
+//*		una el proceso conserva sus dos tablas como estaban.
+//*		Una tabla tiene como mucho 7 * 2^28 entradas, el tamano de la clase
+//*		mayor; con mas, las funciones devuelven -1 como si faltara memoria.
+//*		Los procesos de crearSistema() no pueden modificarse mientras otros
+//*		hilos traducen con ellos, porque el array puede moverse al crecer.
+//*
+//*		Todas las funciones que modifican el sistema devuelven 1 si la
+//*		operacion es correcta, 0 si el proceso o la entrada no existen y -1
+//*		si no hay memoria suficiente, salvo crearProceso() y anadirSegmento(),
+//*		que devuelven el proceso o el segmento creado o -1.
+//*
+//*************************************************************
+#define maxClases 116				// Clases de bloques: de 4 a 7 * 2^28 elementos
+#define sinBloque 0xFF					// Clase de un proceso sin tabla
+#define procesoDestruido 0xFE			// Clase de la PMT de un proceso destruido
+
+// Almacen de bloques de una tabla (PMT o SDT) dentro de un solo array que crece por duplicacion
+typedef struct almacenTablas{
+	char *datos;
+	size_t tamElemento;
+	int ocupados;										// Elementos repartidos en bloques, desde el principio del array
+	int capacidad;										// Elementos reservados
+	int libres[maxClases];								// Primer bloque libre de cada clase, o -1. Cada bloque libre guarda el siguiente
+	long long enUso;									// Elementos de los bloques que usan los procesos
+}almacenTablas;
+
+struct sistemaProcesos{
+	int numProcesos;									// Identificadores repartidos, de procesos vivos o destruidos
+	int capacidad;										// Procesos que caben en los arrays de los procesos
+	int vivos;
+	int *huecos;										// Pila de los identificadores destruidos, para reutilizarlos
+	int numHuecos;
+	unsigned char *clasePaginas;						// Clase del bloque de la PMT de cada proceso, o sinBloque
+	unsigned char *claseSegmentos;						// Clase del bloque de la SDT de cada proceso, o sinBloque
+	paginacion t_paginacion;							// PMT por proceso sobre el almacen de marcos
+	segmentacion t_segmentacion;						// SDT sobre el almacen de registros
+	almacenTablas marcos;
+	almacenTablas segmentos;
+};
+
+// Elementos de un bloque de la clase indicada: (4 + clase % 4) * 2^(clase / 4)
+static int tamanoClase(int clase){
+	return (4 + (clase & 3)) << (clase >> 2);
+}
+
+// Clase del bloque mas pequeno con al menos n elementos
+static int claseBloque(int n){
+	int desplazamiento, m;
+	
+	if (n <= 4){
+		return 0;
+	}
+	
+	// n - 1 = (4 a 7) * 2^desplazamiento mas un resto, y el bloque es el siguiente multiplo de 2^desplazamiento
+	for (desplazamiento = 0 ; ((n - 1) >> desplazamiento) >= 8 ; desplazamiento++);
+	m = ((n - 1) >> desplazamiento) + 1;
+	return (m == 8) ? (desplazamiento + 1) * 4 : desplazamiento * 4 + m - 4;
+}
+
+// Reserva un bloque de la clase indicada. Devuelve su posicion en el almacen, o -1 si no hay memoria
+static int reservarBloque(almacenTablas *a, int clase){
+	int posicion, capacidad;
+	char *datos;
+	
+	int tamano = tamanoClase(clase);
+	
+	if ((posicion = a->libres[clase]) >= 0){
+		memcpy(&a->libres[clase], a->datos + (size_t)posicion * a->tamElemento, sizeof(int));
+	}
+	else{
+		if ((long long)a->ocupados + tamano > a->capacidad){
+			if ((long long)a->ocupados + tamano > INT_MAX){
+				return -1;
+			}
+			for (capacidad = (a->capacidad > 0) ? a->capacidad : 1024 ; capacidad < a->ocupados + tamano ; capacidad = (capacidad > INT_MAX / 2) ? INT_MAX : capacidad * 2);
+			if ((datos = (char*)realloc(a->datos, (size_t)capacidad * a->tamElemento)) == NULL){
+				return -1;
+			}
+			a->datos = datos;
+			a->capacidad = capacidad;
+		}
+		posicion = a->ocupados;
+		a->ocupados += tamano;
+	}
+	
+	a->enUso += tamano;
+	return posicion;
+}
+
+// Devuelve un bloque a la lista de su clase
+static void liberarBloque(almacenTablas *a, int posicion, int clase){
+	memcpy(a->datos + (size_t)posicion * a->tamElemento, &a->libres[clase], sizeof(int));
+	a->libres[clase] = posicion;
+	a->enUso -= tamanoClase(clase);
+}
+
+// Reserva el bloque al que deben pasar las tablas de "nuevos" elementos de la clase indicada, sin cambiarlas.
+// Deja en "posicion" el bloque, o -1 si la tabla se queda en el suyo. Devuelve 1, o -1 si no hay memoria o no cabe en ninguna clase
+static int prepararTabla(almacenTablas *a, unsigned char clase, int nuevos, int *posicion){
+	int nueva;
+	
+	*posicion = -1;
+	if (nuevos == 0){
+		return 1;
+	}
+	if (nuevos > tamanoClase(maxClases - 1)){
+		return -1;
+	}
+	
+	// El bloque se conserva si las entradas caben y ocupan al menos una cuarta parte
+	nueva = claseBloque(nuevos);
+	if (clase == sinBloque || nueva > clase || nueva + 8 <= clase){
+		if ((*posicion = reservarBloque(a, nueva)) < 0){
+			return -1;
+		}
+	}
+	return 1;
+}
+
+// Cambia de "usados" a "nuevos" las entradas de la tabla de un proceso, pasandolas al bloque de prepararTabla() si lo hay, y rellena las nuevas con "vacio"
+static void cambiarTabla(almacenTablas *a, int *desplazamiento, unsigned char *clase, int usados, int nuevos, int posicion, const void *vacio){
+	int hechos;
+	char *destino;
+	
+	if (nuevos == 0){
+		if (*clase != sinBloque){
+			liberarBloque(a, *desplazamiento, *clase);
+		}
+		*clase = sinBloque;
+		*desplazamiento = 0;
+		return;
+	}
+	
+	if (posicion >= 0){
+		if (*clase != sinBloque){
+			memcpy(a->datos + (size_t)posicion * a->tamElemento, a->datos + (size_t)*desplazamiento * a->tamElemento, (size_t)((usados < nuevos) ? usados : nuevos) * a->tamElemento);
+			liberarBloque(a, *desplazamiento, *clase);
+		}
+		*desplazamiento = posicion;
+		*clase = (unsigned char)claseBloque(nuevos);
+	}
+	
+	// Las entradas nuevas se rellenan copiando las ya rellenas, duplicando cada vez
+	if (usados < nuevos){
+		destino = a->datos + ((size_t)*desplazamiento + usados) * a->tamElemento;
+		memcpy(destino, vacio, a->tamElemento);
+		for (hechos = 1 ; hechos < nuevos - usados ; hechos *= 2){
+			memcpy(destino + (size_t)hechos * a->tamElemento, destino, (size_t)((hechos < nuevos - usados - hechos) ? hechos : nuevos - usados - hechos) * a->tamElemento);
+		}
+	}
+}
+
+// Amplia un array de los procesos a "capacidad" elementos. Devuelve 0 si no hay memoria, y el array no cambia
+static int ampliarArray(void **array, size_t tamElemento, int capacidad){
+	void *nuevo = realloc(*array, tamElemento * capacidad);
+	
+	if (nuevo == NULL){
+		return 0;
+	}
+	*array = nuevo;
+	return 1;
+}
+
+// Indica si el proceso existe y no se ha destruido
+static int procesoVivo(const sistemaProcesos *s, int proceso){
+	return proceso >= 0 && proceso < s->numProcesos && s->clasePaginas[proceso] != procesoDestruido;
+}
+
+// Actualiza las tablas de traduccion tras reservar en los almacenes, que pueden haberse movido
+static void actualizarTablas(sistemaProcesos *s){
+	s->t_paginacion.PMT = (int*)s->marcos.datos;
+	s->t_paginacion.numEntradas = s->marcos.ocupados;
+	s->t_segmentacion.SDT = (registro*)s->segmentos.datos;
+	s->t_segmentacion.numSegmentos = s->segmentos.ocupados;
+}
+
+sistemaProcesos *crearSistema(int tamanoPagina){
+	sistemaProcesos *s;
+	int i;
+	
+	if (tamanoPagina <= 0 || (s = (sistemaProcesos*)calloc(1, sizeof(sistemaProcesos))) == NULL){
+		return NULL;
+	}
+	
+	s->t_paginacion.tamano = tamanoPagina;
+	s->t_paginacion.bitsPagina = bitsPotencia(tamanoPagina);
+	s->t_paginacion.tipo = 1;
+	s->marcos.tamElemento = sizeof(int);
+	s->segmentos.tamElemento = sizeof(registro);
+	for (i = 0 ; i < maxClases ; i++){
+		s->marcos.libres[i] = s->segmentos.libres[i] = -1;
+	}
+	
+	return s;
+}
+
+void cerrarSistema(sistemaProcesos *s){
+	if (s != NULL){
+		free(s->marcos.datos);
+		free(s->segmentos.datos);
+		free(s->t_paginacion.desplazamientoPMT);
+		free(s->t_paginacion.RBTP_RLTP);
+		free(s->t_segmentacion.desplazamientoSDT);
+		free(s->t_segmentacion.RBTS_RLTS);
+		free(s->clasePaginas);
+		free(s->claseSegmentos);
+		free(s->huecos);
+		free(s);
+	}
+}
+
+int crearProceso(sistemaProcesos *s, int paginas, int segmentos){
+	int proceso, capacidad;
+	
+	if (paginas < 0 || segmentos < 0){
+		return -1;
+	}
+	
+	// Los arrays de los procesos crecen por duplicacion, igual que los almacenes. Si falta memoria
+	// para alguno, los que ya han crecido se quedan asi: la capacidad solo cambia cuando crecen todos
+	if (s->numHuecos == 0 && s->numProcesos == s->capacidad){
+		capacidad = (s->capacidad > 0) ? s->capacidad * 2 : 64;
+		if (!ampliarArray((void**)&s->t_paginacion.desplazamientoPMT, sizeof(int), capacidad) ||
+			!ampliarArray((void**)&s->t_paginacion.RBTP_RLTP, sizeof(registro), capacidad) ||
+			!ampliarArray((void**)&s->t_segmentacion.desplazamientoSDT, sizeof(int), capacidad) ||
+			!ampliarArray((void**)&s->t_segmentacion.RBTS_RLTS, sizeof(registro), capacidad) ||
+			!ampliarArray((void**)&s->clasePaginas, 1, capacidad) ||
+			!ampliarArray((void**)&s->claseSegmentos, 1, capacidad) ||
+			!ampliarArray((void**)&s->huecos, sizeof(int), capacidad)){
+			return -1;
+		}
+		s->capacidad = capacidad;
+	}
+	
+	proceso = (s->numHuecos > 0) ? s->huecos[--s->numHuecos] : s->numProcesos++;
+	s->clasePaginas[proceso] = s->claseSegmentos[proceso] = sinBloque;
+	s->t_paginacion.desplazamientoPMT[proceso] = s->t_segmentacion.desplazamientoSDT[proceso] = 0;
+	s->t_paginacion.RBTP_RLTP[proceso].base = s->t_segmentacion.RBTS_RLTS[proceso].base = 0;
+	s->t_paginacion.RBTP_RLTP[proceso].limite = s->t_segmentacion.RBTS_RLTS[proceso].limite = -1;
+	s->vivos++;
+	
+	if (redimensionarProceso(s, proceso, paginas, segmentos) != 1){
+		destruirProceso(s, proceso);
+		return -1;
+	}
+	return proceso;
+}
+
+int destruirProceso(sistemaProcesos *s, int proceso){
+	if (!procesoVivo(s, proceso)){
+		return 0;
+	}
+	
+	redimensionarProceso(s, proceso, 0, 0);
+	s->clasePaginas[proceso] = procesoDestruido;
+	s->huecos[s->numHuecos++] = proceso;
+	s->vivos--;
+	return 1;
+}
+
+int redimensionarProceso(sistemaProcesos *s, int proceso, int paginas, int segmentos){
+	static const int sinMarco = -1;
+	static const registro segmentoVacio = {0, -1};
+	registro *rangoPaginas, *rangoSegmentos;
+	int bloquePaginas, bloqueSegmentos;
+	
+	if (!procesoVivo(s, proceso) || paginas < 0 || segmentos < 0){
+		return 0;
+	}
+	
+	// Los dos bloques se reservan antes de cambiar ninguna tabla: si falta el segundo, se libera el
+	// primero y el proceso se queda como estaba
+	rangoPaginas = &s->t_paginacion.RBTP_RLTP[proceso];
+	rangoSegmentos = &s->t_segmentacion.RBTS_RLTS[proceso];
+	if (prepararTabla(&s->marcos, s->clasePaginas[proceso], paginas, &bloquePaginas) != 1){
+		actualizarTablas(s);
+		return -1;
+	}
+	if (prepararTabla(&s->segmentos, s->claseSegmentos[proceso], segmentos, &bloqueSegmentos) != 1){
+		if (bloquePaginas >= 0){
+			liberarBloque(&s->marcos, bloquePaginas, claseBloque(paginas));
+		}
+		actualizarTablas(s);
+		return -1;
+	}
+	
+	cambiarTabla(&s->marcos, &s->t_paginacion.desplazamientoPMT[proceso], &s->clasePaginas[proceso], rangoPaginas->limite + 1, paginas, bloquePaginas, &sinMarco);
+	cambiarTabla(&s->segmentos, &s->t_segmentacion.desplazamientoSDT[proceso], &s->claseSegmentos[proceso], rangoSegmentos->limite + 1, segmentos, bloqueSegmentos, &segmentoVacio);
+	rangoPaginas->limite = paginas - 1;
+	rangoSegmentos->limite = segmentos - 1;
+	
+	actualizarTablas(s);
+	return 1;
+}
+
+int anadirSegmento(sistemaProcesos *s, int proceso, int base, int limite){
+	int segmento;
+	
+	if (!procesoVivo(s, proceso)){
+		return -1;
+	}
+	
+	segmento = s->t_segmentacion.RBTS_RLTS[proceso].limite + 1;
+	if (redimensionarProceso(s, proceso, s->t_paginacion.RBTP_RLTP[proceso].limite + 1, segmento + 1) != 1){
+		return -1;
+	}
+	definirSegmento(s, proceso, segmento, base, limite);
+	return segmento;
+}
+
+int definirSegmento(sistemaProcesos *s, int proceso, int segmento, int base, int limite){
+	registro *r;
+	
+	if (!procesoVivo(s, proceso) || segmento < 0 || segmento > s->t_segmentacion.RBTS_RLTS[proceso].limite){
+		return 0;
+	}
+	
+	r = &s->t_segmentacion.SDT[s->t_segmentacion.desplazamientoSDT[proceso] + segmento];
+	r->base = base;
+	r->limite = limite;
+	return 1;
+}
+
+int asignarMarco(sistemaProcesos *s, int proceso, int pagina, int marco){
+	if (!procesoVivo(s, proceso) || pagina < 0 || pagina > s->t_paginacion.RBTP_RLTP[proceso].limite){
+		return 0;
+	}
+	
+	s->t_paginacion.PMT[s->t_paginacion.desplazamientoPMT[proceso] + pagina] = marco;
+	return 1;
+}
+
+int asignarMarcos(sistemaProcesos *s, int proceso, int pagina, int n, const int marcos[]){
+	if (!procesoVivo(s, proceso) || pagina < 0 || n < 0 || (long long)pagina + n - 1 > s->t_paginacion.RBTP_RLTP[proceso].limite){
+		return 0;
+	}
+	
+	memcpy(&s->t_paginacion.PMT[s->t_paginacion.desplazamientoPMT[proceso] + pagina], marcos, sizeof(int) * n);
+	return 1;
+}
+
+int procesosSistema(const sistemaProcesos *s){
+	return s->numProcesos;
+}
+
+const paginacion *paginacionSistema(const sistemaProcesos *s){
+	return &s->t_paginacion;
+}
+
+const segmentacion *segmentacionSistema(const sistemaProcesos *s){
+	return &s->t_segmentacion;
+}
+
+size_t memoriaSistema(const sistemaProcesos *s, size_t *usada){
+	size_t porProceso = 2 * sizeof(int) + 2 * sizeof(registro) + 2 + sizeof(int);
+	
+	if (usada != NULL){
+		*usada = (size_t)s->marcos.enUso * s->marcos.tamElemento + (size_t)s->segmentos.enUso * s->segmentos.tamElemento + porProceso * (size_t)s->vivos;
+	}
+	return (size_t)s->marcos.capacidad * s->marcos.tamElemento + (size_t)s->segmentos.capacidad * s->segmentos.tamElemento + porProceso * (size_t)s->capacidad;
+}
+
+
+
+//*************************************************************
+//*	Funcion: 
+//* -------
+//*		Funciones del mapa de marcos fisicos libres (mapaMarcos).
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Mapa de bits jerarquico: en el nivel 0 cada bit es un marco (1 si
+//*		esta libre) y en cada nivel superior cada bit es una palabra de 64
+//*		bits del nivel inferior (1 si tiene algun marco libre), hasta un
+//*		nivel de una sola palabra. Con un numero de marcos de tipo int hay
+//*		como mucho seis niveles. Una segunda jerarquia con la misma forma
+//*		("vacias") marca en su nivel 1 las palabras del nivel 0 con sus 64
+//*		marcos libres. El mapa ocupa poco mas de un bit por marco (32 MiB
+//*		para 256 millones de marcos).
+//*			- reservarMarco() baja desde la palabra superior tomando en
+//*			  cada nivel el primer bit a 1 (contando los ceros finales de
+//*			  la palabra, una instruccion en x86 y ARM): obtiene el marco
+//*			  libre mas bajo con una lectura por nivel, sin recorrer el mapa.
+//*			- Al cambiar una palabra del nivel 0 (cambiarPalabra) solo se
+//*			  sube por una jerarquia si la palabra pasa de tener algun marco
+//*			  libre a no tener ninguno, o de estar completa a no estarlo, o
+//*			  al reves.
+//*			- siguienteBit() busca el primer bit a 1 desde una posicion:
+//*			  mira el resto de su palabra y, si no hay, sube hasta el nivel
+//*			  en el que haya un bit a 1 a la derecha y baja por el, saltando
+//*			  de una vez todas las palabras a 0.
+//*			- reservarMarcos() busca un hueco de n marcos consecutivos desde
+//*			  un cursor que queda tras el ultimo reservado (primer ajuste
+//*			  rotatorio), y al llegar al final vuelve al principio. Buscar
+//*			  siempre desde el marco 0 haria recorrer en cada llamada todos
+//*			  los huecos pequenos que se van acumulando al principio.
+//*			  Un hueco de 128 marcos o mas contiene una palabra completa, asi
+//*			  que para esos tamanos solo se miran los huecos que empiezan
+//*			  antes de una palabra de "vacias", sin pasar por los pequenos.
+//*			  Para tamanos menores se mira cada marco libre. En ambos casos
+//*			  el hueco se mide 64 marcos por palabra hasta el primero
+//*			  ocupado y, si no basta, se salta al siguiente. Ocupar y liberar
+//*			  rangos se hace por palabras completas.
+//*		Los bits de las posiciones que no son marcos (al final de la ultima
+//*		palabra de cada nivel) estan siempre a 0, de modo que nunca se
+//*		eligen.
+//*
+//*************************************************************
+
+// Posicion del bit a 1 mas bajo de una palabra distinta de 0
+static int primerBit(unsigned long long x){
+#if defined(__GNUC__)
+	return __builtin_ctzll(x);
+#else
+	int n = 0;
+	
+	while (!(x & 1)){
+		x >>= 1;
+		n++;
+	}
+	return n;
+#endif
+}
+
+// Numero de bits a 1 seguidos en la parte alta de una palabra distinta de ~0
+static int unosAltos(unsigned long long x){
+#if defined(__GNUC__)
+	return __builtin_clzll(~x);
+#else
+	int n = 0;
+	
+	while (x & (1ULL << 63)){
+		x <<= 1;
+		n++;
+	}
+	return n;
+#endif
+}
+
+// Numero de bits a 1 de una palabra
+static int contarBits(unsigned long long x){
+#if defined(__GNUC__)
+	return __builtin_popcountll(x);
+#else
+	int n = 0;
+	
+	for ( ; x != 0 ; x &= x - 1){
+		n++;
+	}
+	return n;
+#endif
+}
+
+// Mascara de los bits [desde, hasta) de una palabra, con 0 <= desde < hasta <= 64
+static unsigned long long mascaraBits(int desde, int hasta){
+	return (~0ULL << desde) & ((hasta == 64) ? ~0ULL : ((1ULL << hasta) - 1));
+}
+
+// Pone a "valor" el bit "i" del nivel indicado y sigue por el nivel superior si su palabra pasa de 0 a no serlo o al reves
+static void cambiarBit(unsigned long long *niveles[], int numNiveles, int nivel, int i, int valor){
+	unsigned long long antes, despues;
+	
+	for ( ; nivel < numNiveles ; nivel++, i >>= 6){
+		antes = niveles[nivel][i >> 6];
+		despues = valor ? (antes | (1ULL << (i & 63))) : (antes & ~(1ULL << (i & 63)));
+		niveles[nivel][i >> 6] = despues;
+		if ((antes == 0) == (despues == 0)){
+			break;
+		}
+	}
+}
+
+// Cambia la palabra "p" del nivel 0 y actualiza las dos jerarquias de resumen
+static void cambiarPalabra(mapaMarcos *m, int p, unsigned long long nueva){
+	unsigned long long antes = m->bits[0][p];
+	
+	m->bits[0][p] = nueva;
+	if ((antes == 0) != (nueva == 0)){
+		cambiarBit(m->bits, m->numNiveles, 1, p, nueva != 0);
+	}
+	if ((antes == ~0ULL) != (nueva == ~0ULL)){
+		cambiarBit(m->vacias, m->numNiveles, 1, p, nueva == ~0ULL);
+	}
+}
+
+// Primer bit a 1 de "primero" a partir de la posicion "i" (menor que "total"), o -1
+static int siguienteBit(unsigned long long *const niveles[], const int palabras[], int numNiveles, int primero, int i, int total){
+	unsigned long long w;
+	int nivel;
+	
+	if (i < 0 || i >= total){
+		return -1;
+	}
+	
+	for (nivel = primero ; nivel < numNiveles ; nivel++){
+		w = niveles[nivel][i >> 6] & (~0ULL << (i & 63));
+		if (w != 0){
+			i = (i & ~63) + primerBit(w);
+			break;
+		}
+		
+		// En el nivel superior se sigue por el bit de la palabra siguiente
+		i = (i >> 6) + 1;
+		if (i >= palabras[nivel]){
+			return -1;
+		}
+	}
+	if (nivel == numNiveles){
+		return -1;
+	}
+	
+	for (nivel-- ; nivel >= primero ; nivel--){
+		i = i * 64 + primerBit(niveles[nivel][i]);
+	}
+	return i;
+}
+
+// Primer marco ocupado de [desde, hasta), o "hasta" si estan todos libres
+static int siguienteOcupado(const mapaMarcos *m, int desde, int hasta){
+	unsigned long long w;
+	int i;
+	
+	for (i = desde ; i < hasta ; i = (i & ~63) + 64){
+		w = ~m->bits[0][i >> 6] & (~0ULL << (i & 63));
+		if (w != 0){
+			i = (i & ~63) + primerBit(w);
+			return (i < hasta) ? i : hasta;
+		}
+	}
+	return hasta;
+}
+
+// Ocupa (libre = 0) o libera (libre = 1) los marcos [marco, marco+n) y devuelve cuantos han cambiado
+static int cambiarMarcos(mapaMarcos *m, int marco, int n, int libre){
+	unsigned long long mascara, antes;
+	int i, fin, cambiados = 0;
+	
+	if (marco < 0 || n <= 0 || marco > m->numMarcos - n){
+		return 0;
+	}
+	
+	for (i = marco, fin = marco + n ; i < fin ; i = (i & ~63) + 64){
+		mascara = mascaraBits(i & 63, (fin - (i & ~63) >= 64) ? 64 : fin - (i & ~63));
+		antes = m->bits[0][i >> 6];
+		cambiados += contarBits(libre ? (mascara & ~antes) : (mascara & antes));
+		cambiarPalabra(m, i >> 6, libre ? (antes | mascara) : (antes & ~mascara));
+	}
+	
+	m->libres += libre ? cambiados : -cambiados;
+	return cambiados;
+}
+
+// Primer hueco de "n" marcos libres que empieza en [desde, ultimo], o -1
+static int buscarHueco(const mapaMarcos *m, int desde, int ultimo, int n){
+	int marco, fin, p;
+	
+	if (n < 128){
+		for (marco = siguienteBit(m->bits, m->palabras, m->numNiveles, 0, desde, m->numMarcos) ; marco >= 0 && marco <= ultimo ;
+			 marco = siguienteBit(m->bits, m->palabras, m->numNiveles, 0, fin, m->numMarcos)){
+			fin = siguienteOcupado(m, marco, marco + n);
+			if (fin == marco + n){
+				return marco;
+			}
+		}
+		return -1;
+	}
+	
+	// El hueco empieza en los marcos libres finales de la palabra anterior a la completa, o en "desde"
+	for (p = siguienteBit(m->vacias, m->palabras, m->numNiveles, 1, desde >> 6, m->palabras[0]) ; p >= 0 ;
+		 p = siguienteBit(m->vacias, m->palabras, m->numNiveles, 1, (fin >> 6) + 1, m->palabras[0])){
+		marco = (p > 0 && m->bits[0][p - 1] != ~0ULL) ? p * 64 - unosAltos(m->bits[0][p - 1]) : 0;
+		if (marco < desde){
+			marco = desde;
+		}
+		if (marco > ultimo){
+			break;
+		}
+		
+		fin = siguienteOcupado(m, marco, marco + n);
+		if (fin == marco + n){
+			return marco;
+		}
+	}
+	
+	return -1;
+}
+
+int crearMapaMarcos(mapaMarcos *m, int numMarcos){
+	size_t total = 0;
+	int nivel, i;
+	
+	memset(m, 0, sizeof(mapaMarcos));
+	if (numMarcos < 0){
+		return 0;
+	}
+	
+	// Palabras de cada nivel, hasta uno de una sola palabra
+	m->palabras[0] = (numMarcos > 0) ? (numMarcos - 1) / 64 + 1 : 1;
+	for (m->numNiveles = 1 ; m->palabras[m->numNiveles - 1] > 1 ; m->numNiveles++){
+		m->palabras[m->numNiveles] = (m->palabras[m->numNiveles - 1] + 63) / 64;
+	}
+	for (nivel = 0 ; nivel < m->numNiveles ; nivel++){
+		total += (size_t)m->palabras[nivel] * ((nivel == 0) ? 1 : 2);
+	}
+	
+	if ((m->bits[0] = (unsigned long long*)calloc(total, sizeof(unsigned long long))) == NULL){
+		return 0;
+	}
+	for (nivel = 1 ; nivel < m->numNiveles ; nivel++){
+		m->bits[nivel] = m->bits[nivel - 1] + m->palabras[nivel - 1];
+	}
+	for (nivel = 1 ; nivel < m->numNiveles ; nivel++){
+		m->vacias[nivel] = ((nivel == 1) ? m->bits[m->numNiveles - 1] + 1 : m->vacias[nivel - 1] + m->palabras[nivel - 1]);
+	}
+	
+	// Todos los marcos libres: las palabras completas del nivel 0 van a ~0 y la ultima a sus bits validos
+	for (i = 0 ; i < numMarcos / 64 ; i++){
+		m->bits[0][i] = ~0ULL;
+	}
+	if (numMarcos % 64 != 0){
+		m->bits[0][i] = mascaraBits(0, numMarcos % 64);
+	}
+	
+	// Resumenes: el bit de cada palabra del nivel inferior que tiene algun bit a 1 (o los 64, en el nivel 1 de "vacias")
+	for (nivel = 1 ; nivel < m->numNiveles ; nivel++){
+		for (i = 0 ; i < m->palabras[nivel - 1] ; i++){
+			if (m->bits[nivel - 1][i] != 0){
+				m->bits[nivel][i >> 6] |= 1ULL << (i & 63);
+			}
+			if ((nivel == 1) ? (m->bits[0][i] == ~0ULL) : (m->vacias[nivel - 1][i] != 0)){
+				m->vacias[nivel][i >> 6] |= 1ULL << (i & 63);
+			}
+		}
+	}
+	
+	m->numMarcos = numMarcos;
+	m->libres = numMarcos;
+	return 1;
+}
+
+void liberarMapaMarcos(mapaMarcos *m){
+	free(m->bits[0]);
+	memset(m, 0, sizeof(mapaMarcos));
+}
+
+int marcoLibre(const mapaMarcos *m, int marco){
+	return marco >= 0 && marco < m->numMarcos && ((m->bits[0][marco >> 6] >> (marco & 63)) & 1);
+}
+
+int reservarMarco(mapaMarcos *m){
+	int nivel, i = 0;
+	
+	if (m->libres == 0){
+		return -1;
+	}
+	
+	for (nivel = m->numNiveles - 1 ; nivel >= 0 ; nivel--){
+		i = i * 64 + primerBit(m->bits[nivel][i]);
+	}
+	
+	cambiarPalabra(m, i >> 6, m->bits[0][i >> 6] & ~(1ULL << (i & 63)));
+	m->libres--;
+	return i;
+}
+
+int reservarMarcos(mapaMarcos *m, int n){
+	int marco;
+	
+	if (n <= 0 || n > m->libres){
+		return -1;
+	}
+	
+	// Primero desde el cursor hasta el final y despues desde el principio hasta el cursor
+	marco = buscarHueco(m, m->cursor, m->numMarcos - n, n);
+	if (marco < 0 && m->cursor > 0){
+		marco = buscarHueco(m, 0, (m->cursor - 1 < m->numMarcos - n) ? m->cursor - 1 : m->numMarcos - n, n);
+	}
+	if (marco < 0){
+		return -1;
+	}
+	
+	cambiarMarcos(m, marco, n, 0);
+	m->cursor = (marco + n < m->numMarcos) ? marco + n : 0;
+	return marco;
+}
+
+int ocuparMarco(mapaMarcos *m, int marco){
+	if (!marcoLibre(m, marco)){
+		return 0;
+	}
+	
+	cambiarPalabra(m, marco >> 6, m->bits[0][marco >> 6] & ~(1ULL << (marco & 63)));
+	m->libres--;
+	return 1;
+}
+
+int ocuparMarcos(mapaMarcos *m, int marco, int n){
+	return cambiarMarcos(m, marco, n, 0);
+}
+
+int liberarMarcos(mapaMarcos *m, int marco, int n){
+	return cambiarMarcos(m, marco, n, 1);
+}
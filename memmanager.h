@@ -0,0 +1,335 @@
+/*
+					***************************************************
+					******* Biblioteca de Gestion de Memoria **********
+					***************************************************
+
+Nucleo del simulador, sin interfaz de usuario: las estructuras de los tres metodos de gestion
+de memoria (registro base/limite, segmentacion y paginacion), su lectura desde el fichero de
+datos o desde una imagen binaria, la comprobacion de colisiones en memoria fisica y la traduccion
+de direcciones logicas a fisicas. La aplicacion de consola (code.c) esta construida sobre ella,
+y otros programas pueden enlazarla directamente en lugar de leer la salida de la consola:
+
+	gcc -O2 -c memmanager.c
+	ar rcs libmemmanager.a memmanager.o
+	gcc -O2 -o herramienta herramienta.c libmemmanager.a
+
+La forma mas sencilla de usarla es un modelo de solo lectura (modeloMemoria):
+
+	modeloMemoria *m = cargarModelo("datos.txt", stderr);		// Errores del fichero en stderr (NULL: ninguno)
+	direccion d = {1, 306, 0, 0, -1};				// Direccion de un valor: 306
+	int dFisica;
+	
+	if (m != NULL && traducirModeloPagina(m, 0, &d, &dFisica) == TRAD_OK){
+		...
+	}
+	cerrarModelo(m);
+
+Las funciones de traduccion devuelven un codigo TRAD_* y, si es TRAD_OK, la direccion fisica.
+No reservan memoria, no escriben nada, no copian las tablas (las reciben por puntero) y no
+modifican el modelo, asi que varios hilos pueden traducir a la vez con el mismo modelo.
+
+Las funciones sobre las estructuras (traducirPagina(), traducirSegmento()...) son las que usa la
+aplicacion. Son igual de seguras entre hilos salvo por los contadores de coste: si "contadores" no
+es NULL cada busqueda los incrementa, y cada hilo debe usar los suyos. Los modelos de
+cargarModelo() no tienen contadores.
+
+Si el fichero de datos cambia, recargarModelo() crea un modelo nuevo a partir del anterior sin
+modificarlo: compara el fichero con el texto del que se cargo y, si solo han cambiado valores
+de las tablas (RB/RL, SDT, marcos de las paginas o de los segmentos), copia y corrige solo las
+tablas afectadas y comparte las demas. Cualquier otro cambio vuelve a leer el fichero completo.
+Para cambiar el modelo mientras otros hilos traducen se publica con un modeloPublicado (RCU):
+
+	modeloPublicado *p = crearPublicacion(m, numHilos);
+	
+	// Hilo lector i, sin esperas ni cerrojos
+	const modeloMemoria *vigente = entrarModelo(p, i);
+	traducirModeloPagina(vigente, 0, &d, &dFisica);
+	salirModelo(p, i);
+	
+	// Hilo que recarga (uno solo): publica el modelo nuevo y libera el anterior
+	// cuando ningun lector lo esta usando
+	cambiosModelo cambios;
+	if (!recargarPublicado(p, "datos.txt", &cambios, stderr)){
+		...											// Fichero no valido: se sigue usando el anterior
+	}
+	
+	cerrarPublicacion(p);							// Tambien cierra el modelo vigente
+
+Los procesos de un fichero de datos son fijos. Para crearlos, destruirlos y cambiar su numero de
+paginas o de segmentos mientras se simula se usa un sistemaProcesos, cuyas tablas se reparten en
+bloques de dos almacenes (PMT y SDT) sin llamar a malloc por proceso. Sus tablas son una PMT por
+proceso y una SDT normales, asi que se traducen con las funciones de siempre:
+
+	sistemaProcesos *s = crearSistema(4096);
+	int p = crearProceso(s, 16, 0);					// 16 paginas sin marco y ningun segmento
+	
+	asignarMarco(s, p, 0, 7);
+	anadirSegmento(s, p, 1000, 499);				// Segmento 0: base 1000, limite 499
+	redimensionarProceso(s, p, 64, 1);				// Ahora tiene 64 paginas
+	traducirPagina(paginacionSistema(s), p, &d, &dFisica);
+	destruirProceso(s, p);
+	cerrarSistema(s);
+
+Los marcos fisicos libres se llevan en un mapaMarcos, un mapa de bits con niveles de resumen que
+encuentra el marco libre mas bajo, o un hueco de n marcos consecutivos, sin recorrer el mapa
+(decenas de millones de marcos con reservas de unas decenas de nanosegundos):
+
+	mapaMarcos mapa;
+	crearMapaMarcos(&mapa, 1 << 24);				// 16M marcos, todos libres
+	ocuparMarco(&mapa, 7);							// 0 si ya estaba ocupado
+	int marco = reservarMarco(&mapa);				// Marco libre mas bajo (-1 si no queda ninguno)
+	int inicio = reservarMarcos(&mapa, 512);		// 512 marcos consecutivos tras los ultimos reservados (-1 si no hay hueco)
+	liberarMarcos(&mapa, inicio, 512);
+	liberarMapaMarcos(&mapa);
+
+La biblioteca no escribe por la salida estandar: la lectura del fichero de datos y de la imagen,
+la comprobacion y las estadisticas escriben sus mensajes en el fichero que reciben. La lectura
+acepta NULL para no escribir nada (la aplicacion de consola pasa stdout y el servidor stderr).
+
+*/
+
+#ifndef MEMMANAGER_H
+#define MEMMANAGER_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+// Resultado de la traduccion de una direccion logica con un metodo concreto
+#define TRAD_OK 0						// Direccion fisica valida
+#define TRAD_FORMATO 1					// El formato de la direccion no es compatible con el metodo
+#define TRAD_DIRECCION 2				// Direccion fuera del limite de la particion
+#define TRAD_SEGMENTO 3					// Segmento inexistente en el proceso
+#define TRAD_INSTRUCCION 4				// Desplazamiento fuera del segmento o de la pagina
+#define TRAD_PAGINA 5					// Pagina inexistente en el proceso
+#define TRAD_MARCO 6					// La pagina no tiene marco asignado
+
+#define maxNivelesMapa 6				// Niveles de un mapaMarcos: 64^6 marcos cubren cualquier numero de tipo int
+
+// Estructura que implementa los conceptos de base y limite para cualquier sistema que necesite hacer uso de los mismos
+// Lo usamos para los siguientes escenarios:
+//		- Implementar el metodo de gestion de memoria Registro Base/Limite
+//		- Implementar los RBTP y RLTP de las paginas de cada proceso	
+//		- Implementar los RBTS y RLTS de los segmentos de cada proceso
+typedef struct registro{
+	int base;											// valor entero que representa el registro base
+	int limite;											// valor entero que representa el registro limite
+}registro;
+
+// Estructura con una entrada de la tabla de paginas invertida: la pagina cargada en un marco
+typedef struct entradaInvertida{
+	int proceso;										// Proceso de la pagina cargada en el marco, o -1 si el marco esta libre
+	int pagina;											// Numero de pagina dentro del proceso
+	int siguiente;										// Siguiente marco de la misma cadena de la tabla de anclas, o -1
+}entradaInvertida;
+
+// Estructura con los contadores de coste de las busquedas en la tabla invertida o multinivel, o de la segmentacion paginada
+typedef struct contadoresTabla{
+	long long busquedas;								// Busquedas de (proceso, pagina)
+	long long accesos;									// Entradas de la tabla leidas en esas busquedas
+}contadoresTabla;
+
+// Estructura con una region de paginas consecutivas de un proceso cargadas en marcos consecutivos (tabla multinivel)
+typedef struct regionPaginas{
+	int proceso;
+	int pagina;											// Primera pagina de la region
+	int marco;											// Marco de la primera pagina
+	int paginas;										// Numero de paginas de la region
+}regionPaginas;
+
+// Estructura que implementa el metodo de gestion de memoria de la paginación.
+typedef struct paginacion{
+	int tamano;											// Valor entero que representa el tamano de pagina del sistema
+	int bitsPagina;										// log2(tamano) si el tamano es potencia de dos, o -1 si no lo es
+	int tipo;											// Entero que representa el tipo de tabla que usara el sistema:
+														// 		0 - PMT global para todos los procesos
+														// 		1 - PMT por proceso
+														// 		2 - Tabla de paginas invertida (una entrada por marco)
+														// 		3 - Tabla de paginas multinivel por proceso
+	
+	int numEntradas;									// Numero total de entradas de la PMT, suma de las paginas de todos los procesos
+	int *PMT;											// Array Unidimensional de "numEntradas" marcos. Las paginas de cada proceso se almacenan de forma contigua,
+														// tanto con PMT global como con PMT por proceso, de modo que la memoria depende solo de las paginas reales.
+	int *desplazamientoPMT;								// Array de "numProcesos" enteros. Posicion en PMT de la primera pagina de cada proceso.
+	
+	registro *RBTP_RLTP;								// Array de "numProcesos" registros. Almacena los registros RBTP y RLTP de cada proceso. Equivalen a:
+														// En el caso de PMT del sistema: Indice y longitud en la PMT global.
+														// En el caso de PMT por proceso: Indice y longitud de las entradas en la PMT del proceso.
+	
+	// Solo con tabla invertida (tipo 2). La PMT se usa para cargarla y despues es NULL.
+	int numMarcos;										// Entradas de la tabla invertida: el mayor marco asignado mas uno
+	entradaInvertida *invertida;						// Array de "numMarcos" entradas, indexado por marco
+	int *anclas;										// Array de "mascaraAnclas + 1" enteros. Primer marco de cada cadena del hash de (proceso, pagina), o -1
+	int mascaraAnclas;									// Numero de anclas (potencia de dos) menos uno
+	
+	// Solo con tabla multinivel (tipo 3). No hay PMT ni tabla invertida.
+	int numNiveles;										// Niveles de cada arbol, de 2 a 4
+	int bitsNivel[4];									// Bits del numero de pagina que indexan cada nivel, del mas significativo al menos
+	int *raices;										// Array de "numProcesos" enteros. Posicion en "radix" del nodo raiz de cada proceso, o -1
+	int *radix;											// Array de "numRadix" enteros con todos los nodos. Cada entrada es la posicion del nodo del
+	size_t numRadix;									// nivel siguiente o, en el ultimo nivel, el marco; -1 si no existe
+	regionPaginas *regiones;							// Array de "numRegiones" regiones, tal como se leen del fichero
+	int numRegiones;
+	
+	contadoresTabla *contadores;						// Coste de las busquedas con tabla invertida o multinivel, o NULL para no contarlo
+}paginacion;
+
+// Estructura que implementa el metodo de gestion de memoria de la segmentacion.
+typedef struct segmentacion{
+	int numSegmentos;									// Numero total de segmentos de la SDT, suma de los segmentos de todos los procesos
+	registro *SDT; 		 								// Array de "numSegmentos" registros. Representa la SDT, con los segmentos de cada proceso de forma contigua.
+	int *desplazamientoSDT;								// Array de "numProcesos" enteros. Posicion en SDT del primer segmento de cada proceso.
+	registro *RBTS_RLTS;	 							// Array de "numProcesos" registros. Lo utilizaremos para almacenar los datos de segmentacion de los procesos del sistema.
+	
+	// Solo con segmentacion paginada: cada segmento tiene su propia tabla de paginas (novena linea del fichero)
+	int paginada;										// 1 - La segmentacion se traduce a traves de la tabla de paginas de cada segmento (opcion "-sp")
+	int tamanoPagina;									// Tamano de pagina, el mismo que el de la paginacion
+	int bitsPagina;										// log2 del tamano de pagina si es potencia de dos, o -1
+	int numPaginasSegmentos;							// Numero total de entradas de las tablas de paginas de todos los segmentos
+	int *marcosSegmentos;								// Array de "numPaginasSegmentos" marcos, con la tabla de cada segmento de forma contigua
+	registro *tablasSegmentos;							// Array de "numSegmentos" registros, paralelo a la SDT, o NULL si el fichero no tiene tablas.
+														// Equivalen al RBTP y RLTP de cada segmento: posicion de su tabla en marcosSegmentos y ultima pagina.
+	contadoresTabla *contadores;						// Referencias a memoria de la segmentacion paginada, o NULL para no contarlas
+}segmentacion;
+
+// Estructura que representa una direccion logica en cualquiera de los dos formatos
+typedef struct direccion{
+	int formato;										// 1 - Valor entero (dLogica), 2 - Par de valores (nPag_Seg, nInstruccion)
+	int dLogica;										// Direccion logica en formato de valor entero
+	int nPag_Seg;										// Numero de pagina o segmento en formato de par de valores
+	int nInstruccion;									// Desplazamiento en formato de par de valores
+	int proceso;										// Proceso que genera la direccion, o -1 si se traduce en todos
+}direccion;
+
+// Estructura de la cabecera de una imagen binaria del fichero de datos
+typedef struct cabeceraImagen{
+	char marca[8];										// marcaImagen, sin el caracter nulo
+	unsigned int version;								// versionImagen
+	unsigned int ordenBytes;							// 0x01020304 en el orden de bytes de la maquina que la genero
+	unsigned long long longitud;						// Longitud total del fichero
+	unsigned long long sumaControl;						// Suma de Fletcher de todo lo que sigue a la cabecera
+	int numProcesos;
+	int numSegmentos;
+	int numEntradas;
+	int tamanoPagina;
+	int tipo;
+	int reservado;										// Mantiene la cabecera alineada a 8 bytes
+}cabeceraImagen;
+
+// Estructura que representa una imagen binaria cargada en memoria
+typedef struct imagen{
+	void *datos;										// Contenido de la imagen (NULL si los datos se han leido del fichero de texto)
+	size_t longitud;
+	int proyectada;										// 1 si se ha proyectado con mmap, 0 si se ha leido
+}imagen;
+
+// Estructura que representa un intervalo cerrado [inicio, fin] perteneciente a un proceso, para las comprobaciones de solapamiento
+typedef struct intervalo{
+	int inicio;											// Primer valor del intervalo
+	long long fin;										// Ultimo valor del intervalo (base+limite puede no caber en un int)
+	int proceso;										// Proceso al que pertenece
+	int indice;											// Elemento del proceso al que corresponde (segmento, pagina...)
+}intervalo;
+
+// Modelo de solo lectura con las tablas de un fichero de datos (ver cargarModelo())
+typedef struct modeloMemoria modeloMemoria;
+
+// Modelo vigente publicado para varios hilos lectores (ver crearPublicacion())
+typedef struct modeloPublicado modeloPublicado;
+
+// Procesos creados y destruidos en tiempo de ejecucion (ver crearSistema())
+typedef struct sistemaProcesos sistemaProcesos;
+
+// Estructura con el resultado de recargarModelo()
+typedef struct cambiosModelo{
+	int completa;										// 1 si se ha leido el fichero completo, 0 si solo se han corregido las tablas modificadas
+	int tablas;											// Tablas copiadas y corregidas (0 si el fichero no ha cambiado)
+	int entradas;										// Elementos de esas tablas que han cambiado
+}cambiosModelo;
+
+// Mapa jerarquico de marcos fisicos libres (ver crearMapaMarcos()). No se modifican sus campos directamente
+typedef struct mapaMarcos{
+	int numMarcos;										// Marcos fisicos 0..numMarcos-1
+	int libres;											// Marcos libres
+	int cursor;											// Marco desde el que reservarMarcos() busca el siguiente hueco
+	int numNiveles;										// Niveles del mapa (el ultimo es una sola palabra)
+	unsigned long long *bits[maxNivelesMapa];			// Nivel 0: un bit por marco (1 libre); nivel k: un bit por palabra del nivel k-1 (1 si tiene algun libre)
+	unsigned long long *vacias[maxNivelesMapa];			// Nivel 1: un bit por palabra del nivel 0 (1 si sus 64 marcos estan libres); nivel k: como en "bits"
+	int palabras[maxNivelesMapa];						// Palabras de 64 bits de cada nivel
+}mapaMarcos;
+
+/* Carga del modelo desde el fichero de datos o una imagen binaria */
+char *leerFichero(FILE *fp, size_t *longitud);
+int leerDatos(const char *contenido, size_t longitud, int *numProcesos, registro **t_registros, paginacion *t_paginacion, segmentacion *t_segmentacion, FILE *salida);
+void liberarDatos(registro *t_registros, paginacion *t_paginacion, segmentacion *t_segmentacion);
+int guardarImagen(const char *fichero, int numProcesos, const registro t_registros[], const paginacion *t_paginacion, const segmentacion *t_segmentacion);
+int abrirImagen(FILE *fp, imagen *t_imagen, int *numProcesos, registro **t_registros, paginacion *t_paginacion, segmentacion *t_segmentacion, FILE *salida);
+void cerrarImagen(imagen *t_imagen);
+void liberarModelo(imagen *t_imagen, registro *t_registros, paginacion *t_paginacion, segmentacion *t_segmentacion);
+
+/* Comprobacion de colisiones en memoria fisica */
+int compararIntervalos(const void *a, const void *b);
+int comprobarMemoriaFisica(int numProcesos, const registro t_registros[], const paginacion *t_paginacion, const segmentacion *t_segmentacion, int compartir, FILE *salida);
+
+/* Traduccion de direcciones logicas */
+int traducirBaseLimite(const registro *particion, const direccion *d, int *dFisica);
+int traducirSegmento(const segmentacion *t_segmentacion, int proceso, const direccion *d, int *dFisica);
+int traducirSegmentoPaginado(const segmentacion *t_segmentacion, int proceso, const direccion *d, int *dFisica);
+void traducirSegmentosLote(const segmentacion *t_segmentacion, int proceso, const int segmentos[], const int desplazamientos[], int n, int dFisicas[], unsigned char estados[]);
+int traducirPagina(const paginacion *t_paginacion, int proceso, const direccion *d, int *dFisica);
+int separarPagina(const paginacion *t_paginacion, int proceso, const direccion *d, int *nPagina, int *nInstruccion);
+void partirDireccion(const paginacion *t_paginacion, int dLogica, int *nPagina, int *nInstruccion);
+void traducirPaginasLote(const paginacion *t_paginacion, int proceso, const int dLogicas[], int n, int dFisicas[], unsigned char estados[]);
+int buscarMarco(const paginacion *t_paginacion, int proceso, int nPagina);
+
+/* Memoria y estadisticas de las tablas */
+size_t memoriaPaginacion(const paginacion *t_paginacion, int numProcesos);
+void mostrarEstadisticasSegmentacion(const segmentacion *t_segmentacion, FILE *salida);
+void mostrarEstadisticasPaginacion(const paginacion *t_paginacion, int numProcesos, FILE *salida);
+
+/* Modelo de solo lectura */
+modeloMemoria *cargarModelo(const char *fichero, FILE *salida);
+void cerrarModelo(modeloMemoria *m);
+int procesosModelo(const modeloMemoria *m);
+int segmentosPaginadosModelo(const modeloMemoria *m);
+int traducirModeloBaseLimite(const modeloMemoria *m, int proceso, const direccion *d, int *dFisica);
+int traducirModeloSegmento(const modeloMemoria *m, int proceso, const direccion *d, int *dFisica);
+int traducirModeloSegmentoPaginado(const modeloMemoria *m, int proceso, const direccion *d, int *dFisica);
+int traducirModeloPagina(const modeloMemoria *m, int proceso, const direccion *d, int *dFisica);
+void traducirModeloPaginasLote(const modeloMemoria *m, int proceso, const int dLogicas[], int n, int dFisicas[], unsigned char estados[]);
+
+/* Recarga del modelo y publicacion entre hilos (RCU) */
+modeloMemoria *recargarModelo(const modeloMemoria *m, const char *fichero, cambiosModelo *cambios, FILE *salida);
+void retirarModelo(modeloMemoria *anterior, const modeloMemoria *nuevo);
+modeloPublicado *crearPublicacion(modeloMemoria *m, int numLectores);
+const modeloMemoria *entrarModelo(modeloPublicado *p, int lector);
+void salirModelo(modeloPublicado *p, int lector);
+void publicarModelo(modeloPublicado *p, modeloMemoria *nuevo);
+int recargarPublicado(modeloPublicado *p, const char *fichero, cambiosModelo *cambios, FILE *salida);
+void cerrarPublicacion(modeloPublicado *p);
+
+/* Procesos dinamicos con las tablas en almacenes de bloques */
+sistemaProcesos *crearSistema(int tamanoPagina);
+void cerrarSistema(sistemaProcesos *s);
+int crearProceso(sistemaProcesos *s, int paginas, int segmentos);
+int destruirProceso(sistemaProcesos *s, int proceso);
+int redimensionarProceso(sistemaProcesos *s, int proceso, int paginas, int segmentos);
+int anadirSegmento(sistemaProcesos *s, int proceso, int base, int limite);
+int definirSegmento(sistemaProcesos *s, int proceso, int segmento, int base, int limite);
+int asignarMarco(sistemaProcesos *s, int proceso, int pagina, int marco);
+int asignarMarcos(sistemaProcesos *s, int proceso, int pagina, int n, const int marcos[]);
+int procesosSistema(const sistemaProcesos *s);
+const paginacion *paginacionSistema(const sistemaProcesos *s);
+const segmentacion *segmentacionSistema(const sistemaProcesos *s);
+size_t memoriaSistema(const sistemaProcesos *s, size_t *usada);
+
+/* Mapa de marcos fisicos libres */
+int crearMapaMarcos(mapaMarcos *m, int numMarcos);
+void liberarMapaMarcos(mapaMarcos *m);
+int marcoLibre(const mapaMarcos *m, int marco);
+int reservarMarco(mapaMarcos *m);
+int reservarMarcos(mapaMarcos *m, int n);
+int ocuparMarco(mapaMarcos *m, int marco);
+int ocuparMarcos(mapaMarcos *m, int marco, int n);
+int liberarMarcos(mapaMarcos *m, int marco, int n);
+
+#endif
@@ -0,0 +1,1450 @@
+/*
+					***************************************************
+					****** Servidor de traduccion de direcciones ******
+					***************************************************
+
+Carga un modelo (fichero de datos o imagen binaria) una sola vez con la biblioteca memmanager y
+traduce direcciones para otros programas a traves de un socket local (Unix), sin volver a leer
+ni validar el modelo en cada consulta. Un solo hilo atiende a todos los clientes con epoll, sin
+bloquearse en ninguno, y cada peticion puede llevar un lote de direcciones de un proceso.
+Solo funciona en Linux:
+
+	gcc -O2 -pthread -o servidor servidor.c memmanager.c
+	servidor -servir /tmp/memmanager.sock datos.txt
+
+El servidor sigue en marcha hasta recibir SIGINT o SIGTERM; entonces borra el socket y escribe
+por la salida de errores las conexiones, peticiones y direcciones atendidas.
+
+Si el fichero de datos cambia (se escribe o se sustituye por otro con el mismo nombre), el
+servidor lo vuelve a cargar sin detenerse con recargarModelo(): si solo han cambiado valores de
+las tablas se corrigen las tablas afectadas y, si no, se lee el fichero completo. Las peticiones
+se siguen atendiendo con el modelo anterior mientras se recarga, y cada peticion se traduce
+completa con uno de los dos. Si el fichero modificado no es valido se escribe el error y se
+sigue usando el modelo anterior.
+
+
+
+					**************************************
+					******** Protocolo de lineas *********
+					**************************************
+
+Cada peticion es una linea con el metodo, el proceso y las direcciones separadas por espacios,
+en cualquiera de los dos formatos (306 o 2,46):
+
+	pag 1 306 2,46 4000
+
+Los metodos son "bl" (registro base/limite), "seg" (segmentacion), "sp" (segmentacion paginada)
+y "pag" (paginacion). La respuesta es una linea con la direccion fisica o el motivo del error
+(FORMATO, DIRECCION, SEGMENTO, INSTRUCCION, PAGINA o MARCO) de cada direccion, en el mismo orden:
+
+	1405 PAGINA 3401
+
+Si la peticion no es valida la respuesta es "ERROR" seguido del motivo, tambien con "sp" si el
+fichero no tiene las tablas de paginas de los segmentos (novena linea). Tras el error de una linea
+de mas de 1.5 MB el servidor no atiende mas peticiones de la conexion. Las lineas vacias y las
+que empiezan por '#' no tienen respuesta. Se pueden enviar varias peticiones sin esperar las
+respuestas, que llegan en el mismo orden.
+
+
+
+					**************************************
+					********* Protocolo binario **********
+					**************************************
+
+Si los cuatro primeros bytes de la conexion son "MMB1", el resto de la conexion usa mensajes de
+enteros de 32 bits en el orden de bytes de la maquina, precedidos de su longitud en bytes (sin
+contar la propia longitud):
+
+	Peticion:	longitud, metodo (0 bl, 1 seg, 2 sp, 3 pag), proceso, formato (1 o 2), n,
+				y n direcciones (un entero cada una con el formato 1, dos con el formato 2)
+	Respuesta:	longitud, estado, n, y n resultados
+
+El estado es 0 si la peticion es valida, 1 si el metodo, el formato o el numero de direcciones no
+lo son, 2 si el proceso no existe y 3 si el modelo no tiene las tablas del metodo ("sp" con un
+fichero sin la novena linea); salvo con el 0, n es 0. Cada resultado es la
+direccion fisica o, si es negativo, el codigo TRAD_* del error cambiado de signo. Un lote tiene
+como maximo 65536 direcciones; un mensaje de longitud imposible cierra la conexion.
+
+
+
+					**************************************
+					********* Cliente y carga ************
+					**************************************
+
+Con "-cliente" se envian las peticiones de la entrada estandar al servidor con el protocolo de
+lineas, y se escriben sus respuestas por la salida estandar:
+
+	echo "pag 0 306 2,46" | servidor -cliente /tmp/memmanager.sock
+
+Con "-carga" se mide la latencia y el rendimiento del servidor con varios clientes simultaneos
+(un hilo y una conexion cada uno) que envian peticiones de direcciones aleatorias de un valor y
+esperan cada respuesta antes de enviar la siguiente. Los parametros son pares "clave=valor"
+separados por comas; los que no se indican toman el valor entre parentesis:
+
+	clientes (4), peticiones de cada cliente (100000), lote (1, direcciones por peticion),
+	metodo ("pag"), procesos (1; cada peticion elige uno al azar), rango (4096; las direcciones
+	van de 0 a rango - 1), protocolo ("binario" o "lineas") y semilla (1).
+
+	servidor -carga /tmp/memmanager.sock clientes=8,lote=64,procesos=16
+
+Se escriben las peticiones y direcciones por segundo, y la mediana, los percentiles 90, 99 y
+99.9 y el maximo de la latencia de las peticiones en microsegundos (desde que se envia la
+peticion hasta que se recibe la respuesta completa).
+
+*/
+
+#ifndef __linux__
+	#error "El servidor de traduccion necesita epoll y solo se puede compilar en Linux."
+#endif
+
+#define _GNU_SOURCE								// accept4()
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+
+#include "memmanager.h"
+
+#define maxEventos 64					// Eventos que se recogen en cada llamada a epoll_wait
+#define maxLote 65536					// Direcciones de una peticion como maximo
+#define tamLectura 65536				// Bytes que se leen de una conexion cada vez
+#define maxLinea (maxLote * 24)			// Longitud maxima de una peticion del protocolo de lineas
+#define marcaBinaria "MMB1"				// Primeros bytes de una conexion con el protocolo binario
+
+/* Metodos de traduccion de las peticiones */
+#define METODO_BASELIMITE 0
+#define METODO_SEGMENTACION 1
+#define METODO_PAGINADA 2				// Segmentacion paginada
+#define METODO_PAGINACION 3
+
+/* Protocolo de una conexion */
+#define PROTOCOLO_DESCONOCIDO -1		// Aun no se han recibido los primeros bytes
+#define PROTOCOLO_LINEAS 0
+#define PROTOCOLO_BINARIO 1
+
+/* Estado de la respuesta a una peticion binaria */
+#define PETICION_OK 0
+#define PETICION_INVALIDA 1				// Metodo, formato o numero de direcciones incorrectos
+#define PETICION_PROCESO 2				// El proceso no existe en el modelo
+#define PETICION_METODO 3				// El modelo no tiene las tablas del metodo ("sp" sin la novena linea del fichero)
+
+// Estructura con un buffer de bytes que crece segun se necesita
+typedef struct buffer{
+	char *datos;
+	size_t inicio;										// Primer byte aun no consumido (o enviado)
+	size_t longitud;									// Bytes ocupados, desde el principio de "datos"
+	size_t capacidad;
+}buffer;
+
+// Estructura que representa la conexion de un cliente
+typedef struct conexion{
+	int fd;
+	int protocolo;										// PROTOCOLO_DESCONOCIDO, PROTOCOLO_LINEAS o PROTOCOLO_BINARIO
+	int cerrar;											// El cliente ha cerrado su extremo: se cierra al enviar las respuestas pendientes
+	int descartar;										// 1 - Linea demasiado larga: se descarta la entrada hasta que el cliente cierre (2 tras cerrar el envio)
+	unsigned int eventos;								// Eventos de epoll registrados (EPOLLIN o EPOLLOUT)
+	buffer entrada;										// Peticiones recibidas
+	buffer salida;										// Respuestas pendientes de enviar
+	struct conexion *anterior, *siguiente;				// Lista de las conexiones abiertas
+}conexion;
+
+// Estructura compartida con el hilo que recarga el modelo cuando cambia el fichero
+typedef struct recarga{
+	modeloPublicado *publicacion;						// Modelo vigente, del que el bucle de eventos es el lector 0
+	const char *fichero;
+	pthread_mutex_t cerrojo;
+	pthread_cond_t aviso;
+	int pendiente;										// El fichero ha cambiado desde la ultima recarga
+	int terminar;
+}recarga;
+
+// Estructura con el estado del servidor
+typedef struct servidor{
+	const modeloMemoria *m;								// Modelo con el que se atienden los eventos de la vuelta actual del bucle
+	recarga r;
+	int fd;												// Socket que acepta las conexiones
+	int epoll;
+	int vigilancia;										// inotify del directorio del fichero de datos, o -1
+	const char *nombre;									// Nombre del fichero de datos dentro de su directorio
+	conexion *conexiones;								// Lista de las conexiones abiertas
+
+	// Espacio de trabajo de una peticion, de maxLote elementos
+	direccion *direcciones;
+	int *resultados;									// Direccion fisica, o -TRAD_* si hay error
+	int *dLogicas;										// Direcciones de un valor para traducirModeloPaginasLote()
+	int *dFisicas;
+	unsigned char *estados;
+
+	long long numConexiones;
+	long long peticiones;
+	long long traducciones;
+}servidor;
+
+// Estructura con los parametros del generador de carga
+typedef struct carga{
+	const char *ruta;									// Socket del servidor
+	int clientes;
+	long peticiones;									// Peticiones de cada cliente
+	int lote;											// Direcciones de cada peticion
+	int metodo;
+	int procesos;										// Las peticiones se reparten al azar entre los procesos 0 a procesos - 1
+	int rango;											// Las direcciones van de 0 a rango - 1
+	int protocolo;										// PROTOCOLO_BINARIO o PROTOCOLO_LINEAS
+	unsigned long long semilla;
+}carga;
+
+// Estructura con los resultados de un cliente del generador de carga
+typedef struct clienteCarga{
+	const carga *c;
+	int numero;											// Numero del cliente, para su semilla
+	double *latencias;									// Latencia de cada peticion (s)
+	long rechazadas;									// Peticiones que el servidor no ha considerado validas
+	int error;											// 1 si se ha perdido la conexion con el servidor
+}clienteCarga;
+
+/* Prototipos de las funciones auxiliares */
+int servir(const char *ruta, const char *fichero);
+int vigilarFichero(servidor *s, const char *fichero);
+int atenderVigilancia(servidor *s);
+void *hiloRecarga(void *arg);
+int crearSocket(const char *ruta);
+int conectar(const char *ruta);
+int reservarBuffer(buffer *b, size_t n);
+int atenderConexion(servidor *s, conexion *c, unsigned int eventos);
+int recibirConexion(servidor *s, conexion *c);
+int enviarConexion(conexion *c);
+void cerrarConexion(servidor *s, conexion *c);
+int atenderLineas(servidor *s, conexion *c);
+int responderLinea(servidor *s, conexion *c, const char *linea);
+int atenderBinario(servidor *s, conexion *c);
+int traducirPeticion(servidor *s, int metodo, int proceso, int n);
+int leerMetodo(const char *nombre, size_t longitud);
+int cliente(const char *ruta);
+int leerCarga(const char *opciones, carga *c);
+int generarCarga(const carga *c);
+void *hiloCarga(void *arg);
+int enviarTodo(int fd, const void *datos, size_t n);
+int recibirTodo(int fd, void *datos, size_t n);
+double segundosReloj(void);
+
+/* Funcion Principal */
+int main(int argc, char *argv[]){
+	carga t_carga;
+
+	if (argc == 4 && strcmp(argv[1], "-servir") == 0){
+		return servir(argv[2], argv[3]);
+	}
+	if (argc == 3 && strcmp(argv[1], "-cliente") == 0){
+		return cliente(argv[2]);
+	}
+	if ((argc == 3 || argc == 4) && strcmp(argv[1], "-carga") == 0){
+		if (!leerCarga((argc == 4) ? argv[3] : "", &t_carga)){
+			printf ("Error. Parametros de la carga incorrectos: \"%s\".\n", argv[3]);
+			return 1;
+		}
+		t_carga.ruta = argv[2];
+		return generarCarga(&t_carga);
+	}
+
+	printf ("Uso: %s -servir socket datos\n", argv[0]);
+	printf ("     %s -cliente socket < peticiones\n", argv[0]);
+	printf ("     %s -carga socket [clientes=4,peticiones=100000,lote=1,metodo=pag,procesos=1,rango=4096,protocolo=binario,semilla=1]\n", argv[0]);
+	return 1;
+}
+
+
+
+//*************************************************************
+//*	Funcion:
+//* -------
+//*		Funciones del servidor: bucle de eventos y conexiones.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		El modelo se carga una vez con cargarModelo(), que no tiene
+//*		contadores, asi que las traducciones no modifican nada.
+//*		Se publica con crearPublicacion() para un lector, el bucle de
+//*		eventos, que entra en el modelo al despertar de epoll_wait() y
+//*		sale antes de volver a esperar: todos los eventos de una vuelta
+//*		se atienden con el mismo modelo, y mientras espera no retiene
+//*		ninguno.
+//*		El socket que acepta conexiones y todas las conexiones son no
+//*		bloqueantes y estan registrados en epoll. Cada vuelta del bucle
+//*		espera eventos y, por cada uno:
+//*			- Socket de escucha: acepta todas las conexiones pendientes.
+//*			- Conexion con respuestas pendientes (solo tiene registrado
+//*			  EPOLLOUT): envia todo lo que el socket admita.
+//*			- Conexion sin respuestas pendientes (EPOLLIN): lee hasta
+//*			  tamLectura bytes, atiende todas las peticiones completas del
+//*			  buffer de entrada, deja las respuestas en el de salida e
+//*			  intenta enviarlas.
+//*		Mientras una conexion tiene respuestas sin enviar no se leen sus
+//*		peticiones, de modo que un cliente que no lee sus respuestas no
+//*		hace crecer la memoria del servidor ni retrasa a los demas. Cada
+//*		peticion se traduce completa al recibirla: son como mucho maxLote
+//*		traducciones sin reservar memoria (el espacio de trabajo es del
+//*		servidor), asi que ninguna conexion acapara el bucle.
+//*		El protocolo de la conexion se decide con sus primeros bytes: el
+//*		binario si son marcaBinaria y el de lineas en otro caso.
+//*		SIGINT y SIGTERM interrumpen epoll_wait() y terminan el bucle.
+//*
+//*		Los cambios del fichero de datos se vigilan con inotify en su
+//*		directorio (IN_CLOSE_WRITE al terminar de escribirlo e IN_MOVED_TO
+//*		al sustituirlo con rename(), como hacen muchos editores), cuyo
+//*		descriptor tambien esta en epoll. El bucle solo avisa al hilo de
+//*		recarga, que llama a recargarPublicado() fuera del bucle: leer y
+//*		comparar el fichero no retrasa ninguna peticion. Los avisos que
+//*		llegan durante una recarga se juntan en una sola recarga posterior.
+//*
+//*************************************************************
+static volatile sig_atomic_t terminar = 0;
+
+// Manejador de SIGINT y SIGTERM: el bucle de eventos termina en la siguiente vuelta
+static void detenerServidor(int senal){
+	(void)senal;
+	terminar = 1;
+}
+
+int servir(const char *ruta, const char *fichero){
+	servidor s;
+	struct epoll_event ev, eventos[maxEventos];
+	struct sigaction accion;
+	conexion *c;
+	modeloMemoria *m;
+	pthread_t hilo;
+	int i, n, fd, recargando = 0, estado = 0;
+
+	memset(&s, 0, sizeof(servidor));
+	s.fd = s.epoll = s.vigilancia = -1;
+
+	if ((m = cargarModelo(fichero, stderr)) == NULL){
+		fprintf (stderr, "Error. No ha sido posible cargar el modelo \"%s\".\n", fichero);
+		return 1;
+	}
+	if ((s.r.publicacion = crearPublicacion(m, 1)) == NULL){
+		fprintf (stderr, "Error. No hay memoria suficiente para el servidor.\n");
+		cerrarModelo(m);
+		return 1;
+	}
+	s.r.fichero = fichero;
+	pthread_mutex_init(&s.r.cerrojo, NULL);
+	pthread_cond_init(&s.r.aviso, NULL);
+
+	s.direcciones = (direccion*)malloc(sizeof(direccion) * maxLote);
+	s.resultados = (int*)malloc(sizeof(int) * maxLote);
+	s.dLogicas = (int*)malloc(sizeof(int) * maxLote);
+	s.dFisicas = (int*)malloc(sizeof(int) * maxLote);
+	s.estados = (unsigned char*)malloc(maxLote);
+
+	if (s.direcciones == NULL || s.resultados == NULL || s.dLogicas == NULL || s.dFisicas == NULL || s.estados == NULL){
+		fprintf (stderr, "Error. No hay memoria suficiente para el servidor.\n");
+		estado = 1;
+	}
+	else if ((s.fd = crearSocket(ruta)) < 0){
+		estado = 1;
+	}
+	else if ((s.epoll = epoll_create1(EPOLL_CLOEXEC)) < 0){
+		fprintf (stderr, "Error. No ha sido posible crear la instancia de epoll: %s.\n", strerror(errno));
+		estado = 1;
+	}
+	else{
+		ev.events = EPOLLIN;
+		ev.data.ptr = NULL;								// El socket de escucha es el unico sin conexion
+		if (epoll_ctl(s.epoll, EPOLL_CTL_ADD, s.fd, &ev) < 0){
+			fprintf (stderr, "Error. No ha sido posible esperar conexiones: %s.\n", strerror(errno));
+			estado = 1;
+		}
+	}
+
+	// Sin inotify o sin el hilo de recarga, el servidor funciona igual pero no recarga el modelo
+	if (estado == 0 && vigilarFichero(&s, fichero)){
+		if (pthread_create(&hilo, NULL, hiloRecarga, &s.r) == 0){
+			recargando = 1;
+		}
+		else{
+			fprintf (stderr, "Aviso. No ha sido posible crear el hilo de recarga: el modelo no se recargara.\n");
+		}
+	}
+
+	if (estado == 0){
+		memset(&accion, 0, sizeof(accion));
+		accion.sa_handler = detenerServidor;
+		sigemptyset(&accion.sa_mask);
+		sigaction(SIGINT, &accion, NULL);
+		sigaction(SIGTERM, &accion, NULL);
+		signal(SIGPIPE, SIG_IGN);
+
+		fprintf (stderr, "Servidor escuchando en \"%s\" con el modelo \"%s\" (%d procesos).\n", ruta, fichero, procesosModelo(m));
+	}
+
+	while (estado == 0 && !terminar){
+		if ((n = epoll_wait(s.epoll, eventos, maxEventos, -1)) < 0){
+			if (errno == EINTR){
+				continue;
+			}
+			fprintf (stderr, "Error. No ha sido posible esperar los eventos: %s.\n", strerror(errno));
+			estado = 1;
+			break;
+		}
+
+		s.m = entrarModelo(s.r.publicacion, 0);
+		for (i = 0 ; i < n ; i++){
+			if (eventos[i].data.ptr == &s.vigilancia){
+				if (!atenderVigilancia(&s) || !recargando){
+					epoll_ctl(s.epoll, EPOLL_CTL_DEL, s.vigilancia, NULL);
+				}
+				continue;
+			}
+			if (eventos[i].data.ptr != NULL){
+				c = (conexion*)eventos[i].data.ptr;
+				if (!atenderConexion(&s, c, eventos[i].events)){
+					cerrarConexion(&s, c);
+				}
+				continue;
+			}
+
+			// Nuevas conexiones
+			while ((fd = accept4(s.fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0){
+				if ((c = (conexion*)calloc(1, sizeof(conexion))) == NULL){
+					close(fd);
+					continue;
+				}
+				c->fd = fd;
+				c->protocolo = PROTOCOLO_DESCONOCIDO;
+				c->eventos = EPOLLIN;
+				ev.events = EPOLLIN;
+				ev.data.ptr = c;
+				if (epoll_ctl(s.epoll, EPOLL_CTL_ADD, fd, &ev) < 0){
+					close(fd);
+					free(c);
+					continue;
+				}
+
+				c->siguiente = s.conexiones;
+				if (s.conexiones != NULL){
+					s.conexiones->anterior = c;
+				}
+				s.conexiones = c;
+				s.numConexiones++;
+			}
+		}
+		salirModelo(s.r.publicacion, 0);
+	}
+
+	if (recargando){
+		pthread_mutex_lock(&s.r.cerrojo);
+		s.r.terminar = 1;
+		pthread_cond_signal(&s.r.aviso);
+		pthread_mutex_unlock(&s.r.cerrojo);
+		pthread_join(hilo, NULL);
+	}
+	if (s.vigilancia >= 0){
+		close(s.vigilancia);
+	}
+
+	if (s.fd >= 0){
+		fprintf (stderr, "Servidor detenido: %lld conexiones, %lld peticiones, %lld direcciones traducidas.\n", s.numConexiones, s.peticiones, s.traducciones);
+		close(s.fd);
+		unlink(ruta);
+	}
+	while (s.conexiones != NULL){
+		cerrarConexion(&s, s.conexiones);
+	}
+	if (s.epoll >= 0){
+		close(s.epoll);
+	}
+	free(s.direcciones);
+	free(s.resultados);
+	free(s.dLogicas);
+	free(s.dFisicas);
+	free(s.estados);
+	cerrarPublicacion(s.r.publicacion);
+	pthread_mutex_destroy(&s.r.cerrojo);
+	pthread_cond_destroy(&s.r.aviso);
+
+	return estado;
+}
+
+int vigilarFichero(servidor *s, const char *fichero){
+	struct epoll_event ev;
+	char directorio[PATH_MAX];
+	const char *barra = strrchr(fichero, '/');
+
+	// Se vigila el directorio, y no el fichero, para ver tambien los ficheros que lo sustituyen
+	if (barra == NULL){
+		strcpy(directorio, ".");
+		s->nombre = fichero;
+	}
+	else if (barra == fichero){
+		strcpy(directorio, "/");
+		s->nombre = barra + 1;
+	}
+	else if ((size_t)(barra - fichero) < sizeof(directorio)){
+		memcpy(directorio, fichero, barra - fichero);
+		directorio[barra - fichero] = '\0';
+		s->nombre = barra + 1;
+	}
+	else{
+		return 0;
+	}
+
+	if ((s->vigilancia = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) < 0 || inotify_add_watch(s->vigilancia, directorio, IN_CLOSE_WRITE | IN_MOVED_TO) < 0){
+		fprintf (stderr, "Aviso. No ha sido posible vigilar el fichero \"%s\": %s. El modelo no se recargara.\n", fichero, strerror(errno));
+		return 0;
+	}
+
+	ev.events = EPOLLIN;
+	ev.data.ptr = &s->vigilancia;
+	if (epoll_ctl(s->epoll, EPOLL_CTL_ADD, s->vigilancia, &ev) < 0){
+		fprintf (stderr, "Aviso. No ha sido posible vigilar el fichero \"%s\": %s. El modelo no se recargara.\n", fichero, strerror(errno));
+		return 0;
+	}
+
+	return 1;
+}
+
+int atenderVigilancia(servidor *s){
+	char eventos[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	const struct inotify_event *e;
+	ssize_t n;
+	char *p;
+	int cambiado = 0;
+
+	while ((n = read(s->vigilancia, eventos, sizeof(eventos))) > 0){
+		for (p = eventos ; p < eventos + n ; p += sizeof(struct inotify_event) + e->len){
+			e = (const struct inotify_event*)p;
+			cambiado |= (e->len > 0 && strcmp(e->name, s->nombre) == 0);
+		}
+	}
+	if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)){
+		return 0;
+	}
+
+	if (cambiado){
+		pthread_mutex_lock(&s->r.cerrojo);
+		s->r.pendiente = 1;
+		pthread_cond_signal(&s->r.aviso);
+		pthread_mutex_unlock(&s->r.cerrojo);
+	}
+	return 1;
+}
+
+void *hiloRecarga(void *arg){
+	recarga *r = (recarga*)arg;
+	cambiosModelo cambios;
+	double inicio;
+
+	pthread_mutex_lock(&r->cerrojo);
+	while (!r->terminar){
+		if (!r->pendiente){
+			pthread_cond_wait(&r->aviso, &r->cerrojo);
+			continue;
+		}
+		r->pendiente = 0;
+		pthread_mutex_unlock(&r->cerrojo);
+
+		inicio = segundosReloj();
+		if (!recargarPublicado(r->publicacion, r->fichero, &cambios, stderr)){
+			fprintf (stderr, "Error. El modelo modificado \"%s\" no es valido; se sigue usando el anterior.\n", r->fichero);
+		}
+		else if (cambios.completa){
+			fprintf (stderr, "Modelo recargado (fichero completo) en %.3f ms.\n", (segundosReloj() - inicio) * 1000);
+		}
+		else if (cambios.tablas > 0){
+			fprintf (stderr, "Modelo recargado (incremental): %d tablas, %d entradas modificadas, %.3f ms.\n",
+					cambios.tablas, cambios.entradas, (segundosReloj() - inicio) * 1000);
+		}
+
+		pthread_mutex_lock(&r->cerrojo);
+	}
+	pthread_mutex_unlock(&r->cerrojo);
+
+	return NULL;
+}
+
+int crearSocket(const char *ruta){
+	struct sockaddr_un dir;
+	struct stat info;
+	int fd;
+
+	if (strlen(ruta) >= sizeof(dir.sun_path)){
+		fprintf (stderr, "Error. La ruta del socket \"%s\" es demasiado larga.\n", ruta);
+		return -1;
+	}
+
+	// Un socket al que nadie responde es de un servidor que no termino bien, y se reemplaza
+	if (lstat(ruta, &info) == 0){
+		if (!S_ISSOCK(info.st_mode)){
+			fprintf (stderr, "Error. \"%s\" ya existe y no es un socket.\n", ruta);
+			return -1;
+		}
+		if ((fd = conectar(ruta)) >= 0){
+			close(fd);
+			fprintf (stderr, "Error. Ya hay un servidor escuchando en \"%s\".\n", ruta);
+			return -1;
+		}
+		unlink(ruta);
+	}
+
+	memset(&dir, 0, sizeof(dir));
+	dir.sun_family = AF_UNIX;
+	strcpy(dir.sun_path, ruta);
+
+	if ((fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) < 0 ||
+		bind(fd, (struct sockaddr*)&dir, sizeof(dir)) < 0 || listen(fd, SOMAXCONN) < 0){
+		fprintf (stderr, "Error. No ha sido posible escuchar en \"%s\": %s.\n", ruta, strerror(errno));
+		if (fd >= 0){
+			close(fd);
+		}
+		return -1;
+	}
+
+	return fd;
+}
+
+int conectar(const char *ruta){
+	struct sockaddr_un dir;
+	int fd;
+
+	if (strlen(ruta) >= sizeof(dir.sun_path)){
+		return -1;
+	}
+	memset(&dir, 0, sizeof(dir));
+	dir.sun_family = AF_UNIX;
+	strcpy(dir.sun_path, ruta);
+
+	if ((fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0){
+		return -1;
+	}
+	if (connect(fd, (struct sockaddr*)&dir, sizeof(dir)) < 0){
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+int reservarBuffer(buffer *b, size_t n){
+	size_t capacidad;
+	char *datos;
+
+	// Los bytes ya consumidos se descartan antes de crecer
+	if (b->inicio > 0){
+		memmove(b->datos, b->datos + b->inicio, b->longitud - b->inicio);
+		b->longitud -= b->inicio;
+		b->inicio = 0;
+	}
+	if (b->capacidad - b->longitud >= n){
+		return 1;
+	}
+
+	for (capacidad = (b->capacidad > 0) ? b->capacidad : tamLectura ; capacidad - b->longitud < n ; capacidad *= 2);
+	if ((datos = (char*)realloc(b->datos, capacidad)) == NULL){
+		return 0;
+	}
+	b->datos = datos;
+	b->capacidad = capacidad;
+
+	return 1;
+}
+
+int atenderConexion(servidor *s, conexion *c, unsigned int eventos){
+	struct epoll_event ev;
+	unsigned int nuevos;
+
+	if (c->salida.inicio < c->salida.longitud){
+		if (!enviarConexion(c)){
+			return 0;
+		}
+	}
+	else if (eventos & (EPOLLIN | EPOLLHUP | EPOLLERR)){
+		if (!recibirConexion(s, c) || !enviarConexion(c)){
+			return 0;
+		}
+	}
+
+	if (c->salida.inicio == c->salida.longitud && c->cerrar){
+		return 0;
+	}
+
+	// Enviado el error de una linea demasiado larga, el cliente ve el final de la conexion. Se sigue
+	// leyendo hasta que cierre: cerrar con datos sin leer anularia la respuesta
+	if (c->salida.inicio == c->salida.longitud && c->descartar == 1){
+		shutdown(c->fd, SHUT_WR);
+		c->descartar = 2;
+	}
+
+	// Mientras queden respuestas por enviar no se leen mas peticiones
+	nuevos = (c->salida.inicio < c->salida.longitud) ? EPOLLOUT : EPOLLIN;
+	if (nuevos != c->eventos){
+		ev.events = nuevos;
+		ev.data.ptr = c;
+		if (epoll_ctl(s->epoll, EPOLL_CTL_MOD, c->fd, &ev) < 0){
+			return 0;
+		}
+		c->eventos = nuevos;
+	}
+
+	return 1;
+}
+
+int recibirConexion(servidor *s, conexion *c){
+	buffer *b = &c->entrada;
+	ssize_t leidos;
+	size_t disponibles, marca = strlen(marcaBinaria);
+
+	if (!reservarBuffer(b, tamLectura)){
+		return 0;
+	}
+
+	if ((leidos = recv(c->fd, b->datos + b->longitud, tamLectura, 0)) < 0){
+		return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+	}
+	if (leidos == 0){
+		c->cerrar = 1;									// Las peticiones incompletas se descartan
+		return 1;
+	}
+	if (c->descartar){
+		return 1;
+	}
+	b->longitud += leidos;
+	disponibles = b->longitud - b->inicio;
+
+	if (c->protocolo == PROTOCOLO_DESCONOCIDO){
+		if (memcmp(b->datos + b->inicio, marcaBinaria, (disponibles < marca) ? disponibles : marca) != 0){
+			c->protocolo = PROTOCOLO_LINEAS;
+		}
+		else if (disponibles >= marca){
+			c->protocolo = PROTOCOLO_BINARIO;
+			b->inicio += marca;
+		}
+		else{
+			return 1;									// Faltan bytes para saber si es la marca
+		}
+	}
+
+	return (c->protocolo == PROTOCOLO_BINARIO) ? atenderBinario(s, c) : atenderLineas(s, c);
+}
+
+int enviarConexion(conexion *c){
+	buffer *b = &c->salida;
+	ssize_t enviados;
+
+	while (b->inicio < b->longitud){
+		if ((enviados = send(c->fd, b->datos + b->inicio, b->longitud - b->inicio, MSG_NOSIGNAL)) < 0){
+			if (errno == EINTR){
+				continue;
+			}
+			return (errno == EAGAIN || errno == EWOULDBLOCK);
+		}
+		b->inicio += enviados;
+	}
+	b->inicio = b->longitud = 0;
+
+	return 1;
+}
+
+void cerrarConexion(servidor *s, conexion *c){
+	if (c->anterior != NULL){
+		c->anterior->siguiente = c->siguiente;
+	}
+	else{
+		s->conexiones = c->siguiente;
+	}
+	if (c->siguiente != NULL){
+		c->siguiente->anterior = c->anterior;
+	}
+
+	close(c->fd);										// Tambien lo quita de epoll
+	free(c->entrada.datos);
+	free(c->salida.datos);
+	free(c);
+}
+
+
+
+//*************************************************************
+//*	Funcion:
+//* -------
+//*		Funciones que atienden las peticiones de los dos protocolos.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Las dos funciones recorren el buffer de entrada y atienden cada
+//*		peticion completa; la ultima, si esta incompleta, se queda en el
+//*		buffer hasta la siguiente lectura. Las direcciones se decodifican
+//*		en el espacio de trabajo del servidor y traducirPeticion() las
+//*		traduce con el metodo pedido. Con la paginacion, las direcciones
+//*		de un valor se traducen juntas con traducirModeloPaginasLote()
+//*		(instrucciones vectoriales si el procesador las tiene) y las de dos
+//*		valores una a una.
+//*		Un error en una peticion se responde y la conexion sigue abierta;
+//*		solo se cierra si ya no se puede saber donde empieza la siguiente.
+//*		Un mensaje binario de longitud imposible la cierra sin respuesta.
+//*		Una linea mas larga que maxLinea se responde con ERROR, se cierra
+//*		el envio y se descarta lo que llegue hasta que el cliente cierre.
+//*		traducirPeticion() devuelve el estado PETICION_* de la peticion.
+//*
+//*************************************************************
+int traducirPeticion(servidor *s, int metodo, int proceso, int n){
+	const direccion *d = s->direcciones;
+	int i, k, estado, dFisica = 0;
+
+	if (proceso < 0 || proceso >= procesosModelo(s->m)){
+		return PETICION_PROCESO;
+	}
+	if (metodo == METODO_PAGINADA && !segmentosPaginadosModelo(s->m)){
+		return PETICION_METODO;
+	}
+
+	if (metodo == METODO_PAGINACION){
+		for (i = 0, k = 0 ; i < n ; i++){
+			if (d[i].formato == 1){
+				s->dLogicas[k++] = d[i].dLogica;
+			}
+		}
+		if (k > 0){
+			traducirModeloPaginasLote(s->m, proceso, s->dLogicas, k, s->dFisicas, s->estados);
+		}
+	}
+
+	for (i = 0, k = 0 ; i < n ; i++){
+		switch (metodo){
+			case METODO_BASELIMITE:
+				estado = traducirModeloBaseLimite(s->m, proceso, &d[i], &dFisica);
+				break;
+			case METODO_SEGMENTACION:
+				estado = traducirModeloSegmento(s->m, proceso, &d[i], &dFisica);
+				break;
+			case METODO_PAGINADA:
+				estado = traducirModeloSegmentoPaginado(s->m, proceso, &d[i], &dFisica);
+				break;
+			default:
+				if (d[i].formato == 1){
+					estado = s->estados[k];
+					dFisica = s->dFisicas[k++];
+				}
+				else{
+					estado = traducirModeloPagina(s->m, proceso, &d[i], &dFisica);
+				}
+				break;
+		}
+		s->resultados[i] = (estado == TRAD_OK) ? dFisica : -estado;
+	}
+
+	s->traducciones += n;
+	return PETICION_OK;
+}
+
+int leerMetodo(const char *nombre, size_t longitud){
+	static const char *metodos[] = {"bl", "seg", "sp", "pag"};
+	int i;
+
+	for (i = 0 ; i < 4 ; i++){
+		if (strlen(metodos[i]) == longitud && strncmp(nombre, metodos[i], longitud) == 0){
+			return i;
+		}
+	}
+	return -1;
+}
+
+// Lee un entero decimal con signo opcional y avanza el puntero. Devuelve 0 si no hay digitos o no cabe en un int
+static int leerEntero(const char **p, int *valor){
+	const char *q = *p;
+	long long v = 0;
+	int negativo = (*q == '-');
+
+	if (*q == '-' || *q == '+'){
+		q++;
+	}
+	if (*q < '0' || *q > '9'){
+		return 0;
+	}
+	while (*q >= '0' && *q <= '9'){
+		v = v * 10 + (*q++ - '0');
+		if (v > (long long)INT_MAX + 1){
+			return 0;
+		}
+	}
+	if (negativo){
+		v = -v;
+	}
+	if (v > INT_MAX || v < INT_MIN){
+		return 0;
+	}
+
+	*valor = (int)v;
+	*p = q;
+	return 1;
+}
+
+// Escribe un entero en decimal y devuelve el final
+static char *escribirEntero(char *p, int valor){
+	char cifras[12];
+	unsigned int v = (valor < 0) ? 0u - (unsigned int)valor : (unsigned int)valor;
+	int n = 0;
+
+	if (valor < 0){
+		*p++ = '-';
+	}
+	do{
+		cifras[n++] = (char)('0' + v % 10);
+		v /= 10;
+	}while (v > 0);
+	while (n > 0){
+		*p++ = cifras[--n];
+	}
+	return p;
+}
+
+// Deja en la salida de la conexion la respuesta de error del protocolo de lineas
+static int responderError(conexion *c, const char *motivo){
+	size_t n = strlen(motivo);
+
+	if (!reservarBuffer(&c->salida, n + 8)){
+		return 0;
+	}
+	memcpy(c->salida.datos + c->salida.longitud, "ERROR ", 6);
+	memcpy(c->salida.datos + c->salida.longitud + 6, motivo, n);
+	c->salida.datos[c->salida.longitud + 6 + n] = '\n';
+	c->salida.longitud += n + 7;
+	return 1;
+}
+
+int atenderLineas(servidor *s, conexion *c){
+	buffer *b = &c->entrada;
+	char *fin;
+
+	while ((fin = (char*)memchr(b->datos + b->inicio, '\n', b->longitud - b->inicio)) != NULL){
+		*fin = '\0';
+		if (fin > b->datos + b->inicio && fin[-1] == '\r'){
+			fin[-1] = '\0';
+		}
+		if (!responderLinea(s, c, b->datos + b->inicio)){
+			return 0;
+		}
+		b->inicio = fin + 1 - b->datos;
+	}
+
+	// No se sabe donde empieza la siguiente peticion: se responde y se descarta el resto de la entrada
+	if (b->longitud - b->inicio > maxLinea){
+		c->descartar = 1;
+		b->inicio = b->longitud = 0;
+		return responderError(c, "linea demasiado larga");
+	}
+	if (b->inicio == b->longitud){
+		b->inicio = b->longitud = 0;
+	}
+
+	return 1;
+}
+
+int responderLinea(servidor *s, conexion *c, const char *linea){
+	static const char *errores[] = {"", "FORMATO", "DIRECCION", "SEGMENTO", "INSTRUCCION", "PAGINA", "MARCO"};
+	const char *p = linea + strspn(linea, " \t");
+	char *q;
+	size_t longitud;
+	int metodo, proceso, n = 0, i;
+	direccion *d;
+
+	if (*p == '\0' || *p == '#'){
+		return 1;
+	}
+	s->peticiones++;
+
+	longitud = strcspn(p, " \t");
+	if ((metodo = leerMetodo(p, longitud)) < 0){
+		return responderError(c, "metodo desconocido (bl, seg, sp o pag)");
+	}
+	p += longitud;
+	p += strspn(p, " \t");
+	if (!leerEntero(&p, &proceso) || (*p != ' ' && *p != '\t' && *p != '\0')){
+		return responderError(c, "proceso incorrecto");
+	}
+
+	for (p += strspn(p, " \t") ; *p != '\0' ; p += strspn(p, " \t")){
+		if (n == maxLote){
+			return responderError(c, "demasiadas direcciones");
+		}
+		d = &s->direcciones[n];
+		d->proceso = proceso;
+		if (!leerEntero(&p, &d->dLogica)){
+			return responderError(c, "direccion incorrecta");
+		}
+		d->formato = 1;
+		if (*p == ','){
+			p++;
+			d->nPag_Seg = d->dLogica;
+			if (!leerEntero(&p, &d->nInstruccion)){
+				return responderError(c, "direccion incorrecta");
+			}
+			d->formato = 2;
+		}
+		if (*p != ' ' && *p != '\t' && *p != '\0'){
+			return responderError(c, "direccion incorrecta");
+		}
+		n++;
+	}
+
+	if (n == 0){
+		return responderError(c, "peticion sin direcciones");
+	}
+	switch (traducirPeticion(s, metodo, proceso, n)){
+		case PETICION_PROCESO:
+			return responderError(c, "proceso inexistente");
+		case PETICION_METODO:
+			return responderError(c, "el modelo no tiene tablas de paginas de los segmentos");
+	}
+
+	// Cada resultado ocupa como mucho 12 caracteres (11 cifras y el separador)
+	if (!reservarBuffer(&c->salida, (size_t)n * 12 + 1)){
+		return 0;
+	}
+	q = c->salida.datos + c->salida.longitud;
+	for (i = 0 ; i < n ; i++){
+		if (i > 0){
+			*q++ = ' ';
+		}
+		if (s->resultados[i] >= 0){
+			q = escribirEntero(q, s->resultados[i]);
+		}
+		else{
+			longitud = strlen(errores[-s->resultados[i]]);
+			memcpy(q, errores[-s->resultados[i]], longitud);
+			q += longitud;
+		}
+	}
+	*q++ = '\n';
+	c->salida.longitud = q - c->salida.datos;
+
+	return 1;
+}
+
+int atenderBinario(servidor *s, conexion *c){
+	buffer *b = &c->entrada;
+	unsigned int longitud, respuesta;
+	int cabecera[4], estado, i, n;
+	const char *p;
+	direccion *d;
+
+	while (b->longitud - b->inicio >= sizeof(longitud)){
+		memcpy(&longitud, b->datos + b->inicio, sizeof(longitud));
+		if (longitud < sizeof(cabecera) || longitud > sizeof(cabecera) + (size_t)maxLote * 2 * sizeof(int)){
+			return 0;									// No se puede saber donde empieza el siguiente mensaje
+		}
+		if (b->longitud - b->inicio < sizeof(longitud) + longitud){
+			break;
+		}
+		p = b->datos + b->inicio + sizeof(longitud);
+		memcpy(cabecera, p, sizeof(cabecera));
+		p += sizeof(cabecera);
+		s->peticiones++;
+
+		// cabecera: metodo, proceso, formato, n
+		n = cabecera[3];
+		estado = PETICION_OK;
+		if (cabecera[0] < METODO_BASELIMITE || cabecera[0] > METODO_PAGINACION || (cabecera[2] != 1 && cabecera[2] != 2) ||
+			n < 1 || n > maxLote || longitud != sizeof(cabecera) + (size_t)n * cabecera[2] * sizeof(int)){
+			estado = PETICION_INVALIDA;
+		}
+		else{
+			for (i = 0 ; i < n ; i++){
+				d = &s->direcciones[i];
+				d->formato = cabecera[2];
+				d->proceso = cabecera[1];
+				if (d->formato == 1){
+					memcpy(&d->dLogica, p, sizeof(int));
+					p += sizeof(int);
+				}
+				else{
+					memcpy(&d->nPag_Seg, p, sizeof(int));
+					memcpy(&d->nInstruccion, p + sizeof(int), sizeof(int));
+					p += 2 * sizeof(int);
+				}
+			}
+			estado = traducirPeticion(s, cabecera[0], cabecera[1], n);
+		}
+		if (estado != PETICION_OK){
+			n = 0;
+		}
+		b->inicio += sizeof(longitud) + longitud;
+
+		// Respuesta: longitud, estado, n y los resultados
+		respuesta = (unsigned int)((2 + n) * sizeof(int));
+		if (!reservarBuffer(&c->salida, sizeof(respuesta) + respuesta)){
+			return 0;
+		}
+		memcpy(c->salida.datos + c->salida.longitud, &respuesta, sizeof(respuesta));
+		memcpy(c->salida.datos + c->salida.longitud + sizeof(respuesta), &estado, sizeof(int));
+		memcpy(c->salida.datos + c->salida.longitud + sizeof(respuesta) + sizeof(int), &n, sizeof(int));
+		memcpy(c->salida.datos + c->salida.longitud + sizeof(respuesta) + 2 * sizeof(int), s->resultados, n * sizeof(int));
+		c->salida.longitud += sizeof(respuesta) + respuesta;
+	}
+
+	if (b->inicio == b->longitud){
+		b->inicio = b->longitud = 0;
+	}
+
+	return 1;
+}
+
+
+
+//*************************************************************
+//*	Funcion:
+//* -------
+//*		Cliente del protocolo de lineas.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		Lee las peticiones de la entrada estandar y envia cada una al
+//*		servidor, espera su respuesta y la escribe por la salida estandar.
+//*		Las lineas vacias y los comentarios no se envian, porque no tienen
+//*		respuesta. Termina con error si el servidor cierra la conexion.
+//*
+//*************************************************************
+int cliente(const char *ruta){
+	FILE *respuestas;
+	char *linea = NULL, *respuesta = NULL;
+	size_t capacidad = 0, capacidadRespuesta = 0;
+	ssize_t longitud;
+	const char *p;
+	int fd, estado = 0;
+
+	if ((fd = conectar(ruta)) < 0){
+		fprintf (stderr, "Error. No ha sido posible conectar con el servidor \"%s\".\n", ruta);
+		return 1;
+	}
+	if ((respuestas = fdopen(fd, "r")) == NULL){
+		fprintf (stderr, "Error. No hay memoria suficiente para el cliente.\n");
+		close(fd);
+		return 1;
+	}
+
+	while ((longitud = getline(&linea, &capacidad, stdin)) > 0){
+		p = linea + strspn(linea, " \t\r\n");
+		if (*p == '\0' || *p == '#'){
+			continue;
+		}
+
+		if (linea[longitud - 1] != '\n'){
+			if (!enviarTodo(fd, linea, longitud) || !enviarTodo(fd, "\n", 1)){
+				estado = 1;
+			}
+		}
+		else if (!enviarTodo(fd, linea, longitud)){
+			estado = 1;
+		}
+
+		if (estado != 0 || getline(&respuesta, &capacidadRespuesta, respuestas) <= 0){
+			fprintf (stderr, "Error. El servidor ha cerrado la conexion.\n");
+			estado = 1;
+			break;
+		}
+		fputs (respuesta, stdout);
+	}
+
+	free(linea);
+	free(respuesta);
+	fclose(respuestas);
+
+	return estado;
+}
+
+
+
+//*************************************************************
+//*	Funcion:
+//* -------
+//*		Funciones del generador de carga.
+//*
+//*
+//*
+//*	Algoritmo:
+//* ---------
+//*		leerCarga() interpreta las opciones "clave=valor" separadas por
+//*		comas de "-carga", igual que las de "-generar" de la aplicacion.
+//*		Cada cliente es un hilo con su propia conexion y su propia semilla,
+//*		que prepara cada peticion, mide el tiempo desde que empieza a
+//*		enviarla hasta que ha recibido la respuesta completa y no envia la
+//*		siguiente hasta entonces (un cliente cerrado: la latencia no incluye
+//*		colas del propio generador). Al terminar se juntan las latencias de
+//*		todos los clientes y se ordenan para obtener los percentiles. El
+//*		rendimiento se calcula con el tiempo total, desde que se crean los
+//*		hilos hasta que terminan todos.
+//*
+//*************************************************************
+int leerCarga(const char *opciones, carga *c){
+	char clave[16], valor[32];
+	int longitud;
+
+	c->ruta = NULL;
+	c->clientes = 4;
+	c->peticiones = 100000;
+	c->lote = 1;
+	c->metodo = METODO_PAGINACION;
+	c->procesos = 1;
+	c->rango = 4096;
+	c->protocolo = PROTOCOLO_BINARIO;
+	c->semilla = 1;
+
+	while (*opciones != '\0'){
+		longitud = (int)strcspn(opciones, ",");
+		if (sscanf(opciones, "%15[^=,]=%31[^,]", clave, valor) != 2){
+			return 0;
+		}
+
+		if (strcmp(clave, "clientes") == 0)				c->clientes = atoi(valor);
+		else if (strcmp(clave, "peticiones") == 0)		c->peticiones = atol(valor);
+		else if (strcmp(clave, "lote") == 0)			c->lote = atoi(valor);
+		else if (strcmp(clave, "metodo") == 0)			c->metodo = leerMetodo(valor, strlen(valor));
+		else if (strcmp(clave, "procesos") == 0)		c->procesos = atoi(valor);
+		else if (strcmp(clave, "rango") == 0)			c->rango = atoi(valor);
+		else if (strcmp(clave, "semilla") == 0)			c->semilla = strtoull(valor, NULL, 10);
+		else if (strcmp(clave, "protocolo") == 0){
+			if (strcmp(valor, "binario") == 0)			c->protocolo = PROTOCOLO_BINARIO;
+			else if (strcmp(valor, "lineas") == 0)		c->protocolo = PROTOCOLO_LINEAS;
+			else										return 0;
+		}
+		else{
+			return 0;
+		}
+
+		opciones += longitud;
+		if (*opciones == ','){
+			opciones++;
+		}
+	}
+
+	return (c->clientes > 0 && c->peticiones > 0 && c->lote > 0 && c->lote <= maxLote && c->metodo >= 0 && c->procesos > 0 && c->rango > 0);
+}
+
+// Generador aleatorio xorshift64*: mismo resultado en cualquier plataforma
+static unsigned long long aleatorio(unsigned long long *semilla){
+	*semilla ^= *semilla >> 12;
+	*semilla ^= *semilla << 25;
+	*semilla ^= *semilla >> 27;
+	return *semilla * 2685821657736338717ULL;
+}
+
+// Orden de las latencias para obtener los percentiles
+static int compararTiempos(const void *a, const void *b){
+	double x = *(const double*)a, y = *(const double*)b;
+
+	return (x > y) - (x < y);
+}
+
+int generarCarga(const carga *c){
+	static const char *metodos[] = {"bl", "seg", "sp", "pag"};
+	clienteCarga *clientes;
+	pthread_t *hilos;
+	double *latencias, segundos, inicio;
+	long rechazadas = 0;
+	size_t total = (size_t)c->clientes * c->peticiones, k;
+	int i, creados, estado = 0;
+
+	clientes = (clienteCarga*)calloc(c->clientes, sizeof(clienteCarga));
+	hilos = (pthread_t*)malloc(sizeof(pthread_t) * c->clientes);
+	latencias = (double*)malloc(sizeof(double) * total);
+
+	if (clientes == NULL || hilos == NULL || latencias == NULL){
+		fprintf (stderr, "Error. No hay memoria suficiente para el generador de carga.\n");
+		free(clientes);
+		free(hilos);
+		free(latencias);
+		return 1;
+	}
+
+	// Cada cliente escribe sus latencias en su parte del array comun
+	for (i = 0 ; i < c->clientes ; i++){
+		clientes[i].c = c;
+		clientes[i].numero = i;
+		clientes[i].latencias = latencias + (size_t)i * c->peticiones;
+	}
+
+	inicio = segundosReloj();
+	for (creados = 0 ; creados < c->clientes && pthread_create(&hilos[creados], NULL, hiloCarga, &clientes[creados]) == 0 ; creados++);
+	for (i = 0 ; i < creados ; i++){
+		pthread_join(hilos[i], NULL);
+	}
+	segundos = segundosReloj() - inicio;
+
+	for (i = 0 ; i < c->clientes ; i++){
+		if (i >= creados || clientes[i].error){
+			estado = 1;
+		}
+		rechazadas += clientes[i].rechazadas;
+	}
+
+	if (estado != 0){
+		fprintf (stderr, "Error. No ha sido posible completar la carga con el servidor \"%s\".\n", c->ruta);
+	}
+	else{
+		qsort(latencias, total, sizeof(double), compararTiempos);
+
+		printf ("# clientes\tlote\tmetodo\tprotocolo\tpeticiones\tsegundos\tpeticiones/s\tdirecciones/s\tmediana (us)\tp90 (us)\tp99 (us)\tp99.9 (us)\tmaximo (us)\n");
+		printf ("%d\t%d\t%s\t%s\t%zu\t%.3f\t%.0f\t%.0f", c->clientes, c->lote, metodos[c->metodo], (c->protocolo == PROTOCOLO_BINARIO) ? "binario" : "lineas",
+				total, segundos, total / segundos, total * (double)c->lote / segundos);
+		for (k = 0 ; k < 4 ; k++){
+			printf ("\t%.2f", latencias[(size_t)((total - 1) * ((k == 0) ? 0.5 : (k == 1) ? 0.9 : (k == 2) ? 0.99 : 0.999))] * 1e6);
+		}
+		printf ("\t%.2f\n", latencias[total - 1] * 1e6);
+
+		if (rechazadas > 0){
+			fprintf (stderr, "Aviso. El servidor ha rechazado %ld peticiones (proceso inexistente o metodo no disponible).\n", rechazadas);
+		}
+	}
+
+	free(clientes);
+	free(hilos);
+	free(latencias);
+
+	return estado;
+}
+
+void *hiloCarga(void *arg){
+	clienteCarga *cc = (clienteCarga*)arg;
+	const carga *c = cc->c;
+	static const char *metodos[] = {"bl", "seg", "sp", "pag"};
+	unsigned long long semilla = c->semilla + 0x9E3779B97F4A7C15ULL * (cc->numero + 1);
+	size_t longitud, recibidos;
+	unsigned int tamano;
+	int *peticion, *respuesta;
+	char *texto, *p;
+	ssize_t leidos;
+	double inicio;
+	long r;
+	int fd, i, proceso;
+
+	peticion = (int*)malloc(sizeof(int) * (5 + c->lote));
+	respuesta = (int*)malloc(sizeof(int) * (3 + c->lote));
+	texto = (char*)malloc((size_t)c->lote * 12 + 32);
+
+	if (peticion == NULL || respuesta == NULL || texto == NULL || (fd = conectar(c->ruta)) < 0){
+		free(peticion);
+		free(respuesta);
+		free(texto);
+		cc->error = 1;
+		return NULL;
+	}
+	if (c->protocolo == PROTOCOLO_BINARIO && !enviarTodo(fd, marcaBinaria, strlen(marcaBinaria))){
+		cc->error = 1;
+	}
+	if (semilla == 0){
+		semilla = 1;
+	}
+
+	for (r = 0 ; r < c->peticiones && !cc->error ; r++){
+		proceso = (int)(aleatorio(&semilla) % c->procesos);
+
+		if (c->protocolo == PROTOCOLO_BINARIO){
+			peticion[0] = (int)((4 + c->lote) * sizeof(int));
+			peticion[1] = c->metodo;
+			peticion[2] = proceso;
+			peticion[3] = 1;
+			peticion[4] = c->lote;
+			for (i = 0 ; i < c->lote ; i++){
+				peticion[5 + i] = (int)(aleatorio(&semilla) % c->rango);
+			}
+
+			inicio = segundosReloj();
+			if (!enviarTodo(fd, peticion, (5 + c->lote) * sizeof(int)) || !recibirTodo(fd, &tamano, sizeof(tamano)) ||
+				tamano > (2 + c->lote) * sizeof(int) || !recibirTodo(fd, respuesta, tamano)){
+				cc->error = 1;
+				break;
+			}
+			cc->latencias[r] = segundosReloj() - inicio;
+			cc->rechazadas += (respuesta[0] != PETICION_OK);
+		}
+		else{
+			p = texto + sprintf(texto, "%s %d", metodos[c->metodo], proceso);
+			for (i = 0 ; i < c->lote ; i++){
+				p += sprintf(p, " %d", (int)(aleatorio(&semilla) % c->rango));
+			}
+			*p++ = '\n';
+			longitud = p - texto;
+
+			// La respuesta es una sola linea, y no llega nada mas hasta la siguiente peticion
+			inicio = segundosReloj();
+			if (!enviarTodo(fd, texto, longitud)){
+				cc->error = 1;
+				break;
+			}
+			for (recibidos = 0 ; recibidos == 0 || texto[recibidos - 1] != '\n' ; recibidos += leidos){
+				if ((leidos = recv(fd, texto + recibidos, (size_t)c->lote * 12 + 31 - recibidos, 0)) <= 0){
+					cc->error = 1;
+					break;
+				}
+			}
+			if (cc->error){
+				break;
+			}
+			cc->latencias[r] = segundosReloj() - inicio;
+			cc->rechazadas += (strncmp(texto, "ERROR", 5) == 0);
+		}
+	}
+
+	close(fd);
+	free(peticion);
+	free(respuesta);
+	free(texto);
+	return NULL;
+}
+
+int enviarTodo(int fd, const void *datos, size_t n){
+	const char *p = (const char*)datos;
+	ssize_t enviados;
+
+	while (n > 0){
+		if ((enviados = send(fd, p, n, MSG_NOSIGNAL)) < 0){
+			if (errno == EINTR){
+				continue;
+			}
+			return 0;
+		}
+		p += enviados;
+		n -= enviados;
+	}
+	return 1;
+}
+
+int recibirTodo(int fd, void *datos, size_t n){
+	char *p = (char*)datos;
+	ssize_t leidos;
+
+	while (n > 0){
+		if ((leidos = recv(fd, p, n, 0)) <= 0){
+			if (leidos < 0 && errno == EINTR){
+				continue;
+			}
+			return 0;
+		}
+		p += leidos;
+		n -= leidos;
+	}
+	return 1;
+}
+
+double segundosReloj(void){
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec / 1e9;
+}